@@ -0,0 +1,122 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+
+#include "../TSBK03/AssetArchive.h"
+
+// Packs loose asset files into an archive that the engine mounts at startup.
+//
+// Usage: AssetPacker [-c] <archive> <file | @list> [<file | @list> ...]
+//
+// -c compresses the entries that shrink by at least an eighth. A list file
+// names one file per line, lines starting with # are skipped. Entry names
+// are the paths as given, so run the packer from the directory the engine
+// runs in.
+namespace
+{
+	bool readList(
+		const std::string &listPath,
+		std::vector<std::string> &files)
+	{
+		std::ifstream list{ listPath };
+
+		if (!list.is_open())
+		{
+			std::cerr << "[PACKER] Could not open list " << listPath << std::endl;
+			return false;
+		}
+
+		std::string line;
+
+		while (std::getline(list, line))
+		{
+			// Strip carriage returns from lists edited on Windows.
+			if (!line.empty() && line.back() == '\r')
+			{
+				line.pop_back();
+			}
+
+			if (line.empty() || line[0] == '#')
+			{
+				continue;
+			}
+
+			files.push_back(line);
+		}
+
+		return true;
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	bool compress = false;
+	int argument = 1;
+
+	if (argument < argc && std::string{ argv[argument] } == "-c")
+	{
+		compress = true;
+		++argument;
+	}
+
+	if (argc - argument < 2)
+	{
+		std::cerr << "Usage: " << argv[0] << " [-c] <archive> <file | @list> [<file | @list> ...]" << std::endl;
+		return 1;
+	}
+
+	std::string archivePath{ argv[argument++] };
+
+	std::vector<std::string> files;
+
+	for (; argument < argc; ++argument)
+	{
+		std::string source{ argv[argument] };
+
+		if (source[0] == '@')
+		{
+			if (!readList(source.substr(1), files))
+			{
+				return 1;
+			}
+		}
+		else
+		{
+			files.push_back(source);
+		}
+	}
+
+	auto start = std::chrono::high_resolution_clock::now();
+
+	try
+	{
+		AssetArchive::build(archivePath, files, compress);
+
+		// Read the archive back to make sure that it is valid.
+		AssetArchive archive{ archivePath };
+
+		unsigned long long size = 0;
+		unsigned long long storedSize = 0;
+
+		for (const auto& it : archive.getEntries())
+		{
+			size += it.second.size;
+			storedSize += it.second.storedSize;
+		}
+
+		std::chrono::duration<float, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+		std::cout << "[PACKER] Packed " << archive.getEntries().size() << " files, "
+			<< size / 1024 << " KB into " << storedSize / 1024 << " KB in "
+			<< elapsed.count() << "ms" << std::endl;
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << "[PACKER] " << e.what() << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,375 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <functional>
+#include <cstdlib>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "../TSBK03/Frustum.h"
+#include "../TSBK03/AABB.h"
+#include "../TSBK03/FrustumCulling.h"
+#include "../TSBK03/BoundingVolumeHierarchy.h"
+
+// Measures how many boxes per second the frustum culling paths classify:
+// the eight corner test of Frustum::boxIntersect, the scalar p/n-vertex
+// kernel and the SIMD kernel, with and without plane hints, and the
+// bounding volume hierarchy of the renderer. The camera turns a little
+// between frames, like it does in the game, so the hints are mostly but not
+// always right. The hierarchy is also timed for refitting moving props and
+// for the radius and ray queries, against testing every box.
+//
+// Usage: CullingBenchmark [-b <boxes>] [-n <frames>] [-s <seed>]
+//
+// The best time of all frames is reported to keep the numbers comparable
+// between runs.
+namespace
+{
+	struct CullingResult
+	{
+		double milliseconds{ 0.0 };
+		size_t outside{ 0 };
+		size_t intersecting{ 0 };
+		size_t inside{ 0 };
+	};
+
+	Frustum getFrustum(
+		int frame)
+	{
+		// The projection of the game.
+		glm::mat4 projection = glm::perspective(glm::radians(70.f), 16.f / 9.f, 0.1f, 200.f);
+
+		float angle = glm::radians(static_cast<float>(frame));
+
+		glm::mat4 view = glm::lookAt(
+			glm::vec3{ 512.f, 40.f, 512.f },
+			glm::vec3{ 512.f + std::cos(angle), 39.8f, 512.f + std::sin(angle) },
+			glm::vec3{ 0.f, 1.f, 0.f });
+
+		return Frustum{ projection * view };
+	}
+
+	CullingResult run(
+		int frames,
+		const std::vector<int8_t> &reference,
+		const std::function<void(const Frustum&, int8_t *)> &cull)
+	{
+		CullingResult result;
+		result.milliseconds = 1e30;
+
+		std::vector<int8_t> results(reference.size());
+
+		for (int frame = 0; frame < frames; ++frame)
+		{
+			Frustum frustum = getFrustum(frame);
+
+			auto start = std::chrono::high_resolution_clock::now();
+
+			cull(frustum, results.data());
+
+			auto stop = std::chrono::high_resolution_clock::now();
+
+			result.milliseconds = std::min(result.milliseconds, std::chrono::duration<double, std::milli>(stop - start).count());
+		}
+
+		// The last frame is compared with the corner test. Boxes touching a
+		// plane can come out either way, since the distances are rounded
+		// differently.
+		size_t mismatches = 0;
+
+		for (size_t i = 0; i < results.size(); ++i)
+		{
+			if (results[i] != reference[i])
+			{
+				++mismatches;
+			}
+
+			if (results[i] < 0)
+			{
+				++result.outside;
+			}
+			else if (results[i] == 0)
+			{
+				++result.intersecting;
+			}
+			else
+			{
+				++result.inside;
+			}
+		}
+
+		if (mismatches > 0)
+		{
+			std::cerr << "[BENCHMARK] " << mismatches << " boxes were classified differently from the corner test" << std::endl;
+		}
+
+		return result;
+	}
+
+	template <typename F>
+	double measure(
+		int frames,
+		F function)
+	{
+		double best = 1e30;
+
+		for (int frame = 0; frame < frames; ++frame)
+		{
+			auto start = std::chrono::high_resolution_clock::now();
+
+			function(frame);
+
+			auto stop = std::chrono::high_resolution_clock::now();
+
+			best = std::min(best, std::chrono::duration<double, std::milli>(stop - start).count());
+		}
+
+		return best;
+	}
+
+	void printRow(
+		const std::string &name,
+		size_t boxes,
+		const CullingResult &result)
+	{
+		double boxesPerSecond = result.milliseconds > 0.0 ? boxes / (result.milliseconds / 1000.0) : 0.0;
+
+		std::cout << std::left << std::setw(24) << name << std::right
+			<< std::setw(10) << std::fixed << std::setprecision(3) << result.milliseconds
+			<< std::setw(14) << std::fixed << std::setprecision(1) << boxesPerSecond / 1e6
+			<< std::setw(10) << result.outside
+			<< std::setw(10) << result.intersecting
+			<< std::setw(10) << result.inside << std::endl;
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	size_t boxCount = 100000;
+	int frames = 100;
+	unsigned int seed = 1;
+
+	for (int argument = 1; argument < argc; ++argument)
+	{
+		std::string option{ argv[argument] };
+
+		if (option == "-b" && argument + 1 < argc)
+		{
+			boxCount = std::max(1, std::atoi(argv[++argument]));
+		}
+		else if (option == "-n" && argument + 1 < argc)
+		{
+			frames = std::max(1, std::atoi(argv[++argument]));
+		}
+		else if (option == "-s" && argument + 1 < argc)
+		{
+			seed = static_cast<unsigned int>(std::atoi(argv[++argument]));
+		}
+		else
+		{
+			std::cerr << "Usage: " << argv[0] << " [-b <boxes>] [-n <frames>] [-s <seed>]" << std::endl;
+			return 1;
+		}
+	}
+
+	// Boxes of the size of the props scattered over a terrain.
+	std::mt19937 random{ seed };
+	std::uniform_real_distribution<float> position{ 0.f, 1024.f };
+	std::uniform_real_distribution<float> height{ 0.f, 80.f };
+	std::uniform_real_distribution<float> size{ 0.5f, 10.f };
+
+	std::vector<AABB> aabbs;
+	CullingBoxes boxes;
+
+	aabbs.reserve(boxCount);
+	boxes.reserve(boxCount);
+
+	for (size_t i = 0; i < boxCount; ++i)
+	{
+		glm::vec3 center{ position(random), height(random), position(random) };
+		glm::vec3 extents{ size(random), size(random), size(random) };
+
+		AABB aabb;
+
+		aabb.minX = center.x - extents.x;
+		aabb.minY = center.y - extents.y;
+		aabb.minZ = center.z - extents.z;
+
+		aabb.maxX = center.x + extents.x;
+		aabb.maxY = center.y + extents.y;
+		aabb.maxZ = center.z + extents.z;
+
+		aabbs.push_back(aabb);
+		boxes.add(center, extents);
+	}
+
+	std::vector<int8_t> reference(boxCount);
+
+	Frustum lastFrustum = getFrustum(frames - 1);
+
+	for (size_t i = 0; i < boxCount; ++i)
+	{
+		reference[i] = static_cast<int8_t>(lastFrustum.boxIntersect(aabbs[i].getPoints()));
+	}
+
+	std::vector<uint8_t> planeHints(boxCount, 0);
+
+	std::cout << "[BENCHMARK] Culling " << boxCount << " boxes, best of " << frames << " frames" << std::endl << std::endl;
+
+	std::cout << std::left << std::setw(24) << "Kernel" << std::right
+		<< std::setw(10) << "ms"
+		<< std::setw(14) << "Mboxes/s"
+		<< std::setw(10) << "Outside"
+		<< std::setw(10) << "Partial"
+		<< std::setw(10) << "Inside" << std::endl;
+
+	printRow("Corners", boxCount, run(frames, reference, [&](const Frustum &frustum, int8_t *results)
+	{
+		for (size_t i = 0; i < aabbs.size(); ++i)
+		{
+			results[i] = static_cast<int8_t>(frustum.boxIntersect(aabbs[i].getPoints()));
+		}
+	}));
+
+	printRow("Scalar", boxCount, run(frames, reference, [&](const Frustum &frustum, int8_t *results)
+	{
+		cullBoxesScalar(frustum, boxes, results);
+	}));
+
+	std::fill(planeHints.begin(), planeHints.end(), 0);
+
+	printRow("Scalar, plane hints", boxCount, run(frames, reference, [&](const Frustum &frustum, int8_t *results)
+	{
+		cullBoxesScalar(frustum, boxes, results, planeHints.data());
+	}));
+
+	printRow("SIMD", boxCount, run(frames, reference, [&](const Frustum &frustum, int8_t *results)
+	{
+		cullBoxes(frustum, boxes, results);
+	}));
+
+	std::fill(planeHints.begin(), planeHints.end(), 0);
+
+	printRow("SIMD, plane hints", boxCount, run(frames, reference, [&](const Frustum &frustum, int8_t *results)
+	{
+		cullBoxes(frustum, boxes, results, planeHints.data());
+	}));
+
+	BoundingVolumeHierarchy tree;
+	std::vector<int> proxies;
+
+	proxies.reserve(boxCount);
+
+	auto buildStart = std::chrono::high_resolution_clock::now();
+
+	for (size_t i = 0; i < boxCount; ++i)
+	{
+		proxies.push_back(tree.insert(aabbs[i], static_cast<uint32_t>(i)));
+	}
+
+	auto buildStop = std::chrono::high_resolution_clock::now();
+
+	std::vector<uint32_t> values;
+	std::vector<int8_t> treeResults;
+
+	printRow("BVH", boxCount, run(frames, reference, [&](const Frustum &frustum, int8_t *results)
+	{
+		values.clear();
+		treeResults.clear();
+
+		tree.cull(frustum, values, treeResults);
+
+		std::fill(results, results + boxCount, static_cast<int8_t>(-1));
+
+		for (size_t i = 0; i < values.size(); ++i)
+		{
+			results[values[i]] = treeResults[i];
+		}
+	}));
+
+	std::cout << std::endl << "[BENCHMARK] Hierarchy of height " << tree.getHeight() << " built in "
+		<< std::fixed << std::setprecision(3)
+		<< std::chrono::duration<double, std::milli>(buildStop - buildStart).count() << " ms" << std::endl;
+
+	// One prop in a hundred walks a little every frame.
+	std::vector<AABB> moved = aabbs;
+	std::uniform_real_distribution<float> step{ -0.2f, 0.2f };
+
+	double refit = measure(frames, [&](int frame)
+	{
+		for (size_t i = frame % 100; i < boxCount; i += 100)
+		{
+			float dx = step(random);
+			float dz = step(random);
+
+			moved[i].minX += dx;
+			moved[i].maxX += dx;
+			moved[i].minZ += dz;
+			moved[i].maxZ += dz;
+
+			tree.move(proxies[i], moved[i]);
+		}
+	});
+
+	std::cout << "[BENCHMARK] Refitting " << boxCount / 100 << " moving props took " << refit << " ms" << std::endl;
+
+	// The hierarchy has changed, the queries are compared with the moved
+	// boxes.
+	std::vector<glm::vec3> centers;
+
+	for (int i = 0; i < 64; ++i)
+	{
+		centers.push_back(glm::vec3{ position(random), height(random), position(random) });
+	}
+
+	size_t found = 0;
+	size_t expected = 0;
+
+	double radiusTree = measure(frames, [&](int frame)
+	{
+		values.clear();
+		tree.queryRadius(centers[frame % centers.size()], 20.f, values);
+		found += values.size();
+	});
+
+	double radiusLinear = measure(frames, [&](int frame)
+	{
+		const glm::vec3 &center = centers[frame % centers.size()];
+
+		for (const AABB &box : moved)
+		{
+			glm::vec3 delta = glm::clamp(center, box.getMinPoint(), box.getMaxPoint()) - center;
+
+			if (glm::dot(delta, delta) <= 20.f * 20.f)
+			{
+				++expected;
+			}
+		}
+	});
+
+	if (found != expected)
+	{
+		std::cerr << "[BENCHMARK] The radius query found " << found << " boxes instead of " << expected << std::endl;
+	}
+
+	std::cout << "[BENCHMARK] Radius query of 20: " << radiusTree << " ms, testing every box: " << radiusLinear << " ms" << std::endl;
+
+	std::vector<std::pair<float, uint32_t>> hits;
+
+	double rayTree = measure(frames, [&](int frame)
+	{
+		const glm::vec3 &target = centers[frame % centers.size()];
+
+		hits.clear();
+		tree.queryRay(glm::vec3{ 512.f, 40.f, 512.f }, target - glm::vec3{ 512.f, 40.f, 512.f }, 1.f, hits);
+	});
+
+	std::cout << "[BENCHMARK] Ray query: " << rayTree << " ms, " << hits.size() << " boxes hit" << std::endl;
+
+	return 0;
+}
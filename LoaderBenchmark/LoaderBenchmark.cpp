@@ -0,0 +1,301 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <chrono>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdlib>
+
+#include <rapidxml/rapidxml.hpp>
+
+#include "../TSBK03/AssetFileSystem.h"
+#include "../TSBK03/TGA.h"
+#include "../TSBK03/BMP.h"
+#include "../TSBK03/STBTextureFile.h"
+#include "../TSBK03/WaveFile.h"
+
+// Measures how long the asset loaders take over the bundled assets, once with
+// loose files read into buffers, once with loose files memory mapped and,
+// if given, once from an archive.
+//
+// Usage: LoaderBenchmark [-a <archive>] [-n <iterations>] [<file | @list> ...]
+//
+// Without files the assets in @assets.txt are loaded. Run it from the
+// directory the engine runs in. The best time of all iterations is reported
+// to keep the numbers comparable between runs. Sizes are the decoded sizes
+// for images and sounds, and the file sizes for everything else.
+namespace
+{
+	struct LoaderResult
+	{
+		size_t files{ 0 };
+		size_t bytes{ 0 };
+		double milliseconds{ 0.0 };
+	};
+
+	typedef std::map<std::string, LoaderResult> LoaderResults;
+
+	bool readList(
+		const std::string &listPath,
+		std::vector<std::string> &files)
+	{
+		std::ifstream list{ listPath };
+
+		if (!list.is_open())
+		{
+			std::cerr << "[BENCHMARK] Could not open list " << listPath << std::endl;
+			return false;
+		}
+
+		std::string line;
+
+		while (std::getline(list, line))
+		{
+			if (!line.empty() && line.back() == '\r')
+			{
+				line.pop_back();
+			}
+
+			if (line.empty() || line[0] == '#')
+			{
+				continue;
+			}
+
+			files.push_back(line);
+		}
+
+		return true;
+	}
+
+	std::string getExtension(
+		const std::string &file)
+	{
+		std::string extension = file.substr(file.find_last_of('.') + 1);
+
+		std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+
+		return extension;
+	}
+
+	// Loads the file the way the engine does and returns the size of the
+	// loaded data.
+	size_t load(
+		const std::string &file,
+		const std::string &extension)
+	{
+		std::unique_ptr<TextureFile> image;
+
+		// Images are decoded into memory provided by the caller, like
+		// Texture2D decodes them into a mapped pixel unpack buffer.
+		if (extension == "tga")
+		{
+			image.reset(new TGA{ file.c_str(), false });
+		}
+		else if (extension == "bmp")
+		{
+			image.reset(new BMP{ file.c_str(), false });
+		}
+		else if (extension == "png" || extension == "jpg")
+		{
+			image.reset(new STBTextureFile{ file, false });
+		}
+
+		if (image)
+		{
+			static std::vector<unsigned char> pixels;
+
+			pixels.resize(image->getPixelsSize());
+			image->decode(pixels.data());
+
+			return pixels.size();
+		}
+
+		if (extension == "wav")
+		{
+			return WaveFile{ file }.getSize();
+		}
+
+		AssetStream stream = AssetFileSystem::open(file);
+
+		if (extension == "xml")
+		{
+			std::vector<char> text(stream.getData(), stream.getData() + stream.getSize());
+			text.push_back('\0');
+
+			rapidxml::xml_document<> doc;
+			doc.parse<0>(text.data());
+
+			return stream.getSize();
+		}
+
+		// Everything else is only read, touch every page so that mapped files
+		// are actually paged in.
+		volatile unsigned char sum = 0;
+
+		for (size_t i = 0; i < stream.getSize(); i += 4096)
+		{
+			sum += stream.getData()[i];
+		}
+
+		return stream.getSize();
+	}
+
+	LoaderResults run(
+		const std::vector<std::string> &files,
+		int iterations)
+	{
+		LoaderResults best;
+
+		for (int iteration = 0; iteration < iterations; ++iteration)
+		{
+			LoaderResults results;
+
+			for (const auto& file : files)
+			{
+				std::string extension = getExtension(file);
+
+				auto start = std::chrono::high_resolution_clock::now();
+
+				size_t bytes;
+
+				try
+				{
+					bytes = load(file, extension);
+				}
+				catch (const std::exception& e)
+				{
+					if (iteration == 0)
+					{
+						std::cerr << "[BENCHMARK] " << e.what() << std::endl;
+					}
+
+					continue;
+				}
+
+				std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+				LoaderResult &result = results[extension];
+				result.files++;
+				result.bytes += bytes;
+				result.milliseconds += elapsed.count();
+			}
+
+			for (const auto& it : results)
+			{
+				auto bestIt = best.find(it.first);
+
+				if (bestIt == best.end() || it.second.milliseconds < bestIt->second.milliseconds)
+				{
+					best[it.first] = it.second;
+				}
+			}
+		}
+
+		return best;
+	}
+
+	void print(
+		const std::string &mode,
+		const LoaderResults &results)
+	{
+		LoaderResult total;
+
+		std::cout << std::endl << mode << std::endl;
+		std::cout << std::left << std::setw(8) << "Type" << std::right
+			<< std::setw(8) << "Files"
+			<< std::setw(12) << "KB"
+			<< std::setw(12) << "ms"
+			<< std::setw(12) << "MB/s" << std::endl;
+
+		auto printRow = [](const std::string &name, const LoaderResult &result)
+		{
+			double megabytesPerSecond = result.milliseconds > 0.0
+				? result.bytes / (1024.0 * 1024.0) / (result.milliseconds / 1000.0)
+				: 0.0;
+
+			std::cout << std::left << std::setw(8) << name << std::right
+				<< std::setw(8) << result.files
+				<< std::setw(12) << result.bytes / 1024
+				<< std::setw(12) << std::fixed << std::setprecision(2) << result.milliseconds
+				<< std::setw(12) << std::fixed << std::setprecision(1) << megabytesPerSecond << std::endl;
+		};
+
+		for (const auto& it : results)
+		{
+			printRow(it.first, it.second);
+
+			total.files += it.second.files;
+			total.bytes += it.second.bytes;
+			total.milliseconds += it.second.milliseconds;
+		}
+
+		printRow("total", total);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	std::string archivePath;
+	int iterations = 5;
+
+	std::vector<std::string> files;
+
+	for (int argument = 1; argument < argc; ++argument)
+	{
+		std::string option{ argv[argument] };
+
+		if (option == "-a" && argument + 1 < argc)
+		{
+			archivePath = argv[++argument];
+		}
+		else if (option == "-n" && argument + 1 < argc)
+		{
+			iterations = std::max(1, std::atoi(argv[++argument]));
+		}
+		else if (option[0] == '@')
+		{
+			if (!readList(option.substr(1), files))
+			{
+				return 1;
+			}
+		}
+		else if (option[0] == '-')
+		{
+			std::cerr << "Usage: " << argv[0] << " [-a <archive>] [-n <iterations>] [<file | @list> ...]" << std::endl;
+			return 1;
+		}
+		else
+		{
+			files.push_back(option);
+		}
+	}
+
+	if (files.empty() && !readList("assets.txt", files))
+	{
+		return 1;
+	}
+
+	std::cout << "[BENCHMARK] Loading " << files.size() << " files, best of " << iterations << " iterations" << std::endl;
+
+	AssetFileSystem::setMemoryMapping(false);
+	print("Loose files, buffered", run(files, iterations));
+
+	AssetFileSystem::setMemoryMapping(true);
+	print("Loose files, memory mapped", run(files, iterations));
+
+	if (!archivePath.empty())
+	{
+		if (!AssetFileSystem::mount(archivePath))
+		{
+			return 1;
+		}
+
+		print("Archive " + archivePath, run(files, iterations));
+	}
+
+	return 0;
+}
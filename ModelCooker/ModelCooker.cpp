@@ -0,0 +1,105 @@
+#include <iostream>
+#include <string>
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include "../TSBK03/Model.h"
+#include "../TSBK03/Timer.h"
+
+// Offline converter from any format Assimp understands to the cooked .model
+// format loaded by the engine.
+//
+// Usage: ModelCooker <source> [<source> ...]
+//
+// Each source is written next to itself with the extension replaced by
+// .model. The meshes are uploaded when a model is constructed, so a hidden
+// window is created to get an OpenGL context.
+int main(int argc, char *argv[])
+{
+	if (argc < 2)
+	{
+		std::cerr << "Usage: " << argv[0] << " <source> [<source> ...]" << std::endl;
+		return 1;
+	}
+
+	glfwInit();
+
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+	GLFWwindow *window = glfwCreateWindow(1, 1, "ModelCooker", NULL, NULL);
+
+	if (window == nullptr)
+	{
+		std::cerr << "Could not create window" << std::endl;
+
+		glfwTerminate();
+		return 1;
+	}
+
+	glfwMakeContextCurrent(window);
+	glewExperimental = GL_TRUE;
+
+	if (glewInit() != GLEW_OK)
+	{
+		std::cerr << "Could not initialize GLEW" << std::endl;
+		glfwTerminate();
+		return 1;
+	}
+
+	int result = 0;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string source{ argv[i] };
+		std::string destination = Model::getCookedFileName(source);
+
+		if (destination == source)
+		{
+			std::cerr << "[COOKER] " << source << " is already cooked" << std::endl;
+			continue;
+		}
+
+		Timer timer;
+
+		// Always import the source, even if an old cooked file exists.
+		Model model{ source, false };
+
+		float importTime = timer.restart();
+
+		if (model.getMeshes().empty())
+		{
+			std::cerr << "[COOKER] " << source << " contains no meshes" << std::endl;
+			result = 1;
+			continue;
+		}
+
+		try
+		{
+			model.saveCookedModel(destination);
+		}
+		catch (const std::invalid_argument &ex)
+		{
+			std::cerr << "[COOKER] " << ex.what() << std::endl;
+			result = 1;
+			continue;
+		}
+
+		timer.restart();
+
+		Model cooked{ destination };
+
+		float loadTime = timer.restart();
+
+		std::cout << "[COOKER] " << source << " -> " << destination
+			<< " (import " << importTime * 1000.f << "ms, cooked load " << loadTime * 1000.f << "ms)" << std::endl;
+	}
+
+	glfwDestroyWindow(window);
+	glfwTerminate();
+
+	return result;
+}
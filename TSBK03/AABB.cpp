@@ -59,6 +59,35 @@ AABB AABB::transform(
 	return ret;
 }
 
+AABB AABB::getBoundingBox(
+	const glm::mat4 &matrix) const
+{
+	glm::vec3 center = matrix * glm::vec4{ getCenter(), 1.f };
+
+	// Each axis is reached by the extents through the absolute values of
+	// the rotation and scale.
+	glm::mat3 absolute{ matrix };
+
+	for (int i = 0; i < 3; ++i)
+	{
+		absolute[i] = glm::abs(absolute[i]);
+	}
+
+	glm::vec3 extents = absolute * (getSize() * 0.5f);
+
+	AABB ret;
+
+	ret.minX = center.x - extents.x;
+	ret.minY = center.y - extents.y;
+	ret.minZ = center.z - extents.z;
+
+	ret.maxX = center.x + extents.x;
+	ret.maxY = center.y + extents.y;
+	ret.maxZ = center.z + extents.z;
+
+	return ret;
+}
+
 bool AABB::contains(
 	const glm::vec3 &point) const
 {
@@ -25,6 +25,10 @@ struct AABB
 
 	AABB transform(const glm::mat4& matrix) const;
 
+	// The axis aligned box enclosing the box after the transform, which may
+	// rotate it.
+	AABB getBoundingBox(const glm::mat4& matrix) const;
+
 	bool contains(const glm::vec3& point) const;
 
 	bool intersects(const AABB& other, AABB *crossSection = nullptr) const;
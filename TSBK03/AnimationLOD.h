@@ -0,0 +1,50 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+
+#include <glm/glm.hpp>
+
+class Model;
+class SkinnedModelInstance;
+
+// Controls how often the pose of a skinned model is re-evaluated. Nodes
+// closer than nearDistance are animated every frame, nodes further away than
+// farDistance only every maxInterval frames and everything in between is
+// interpolated linearly. The pose is held in the frames in between.
+struct AnimationLOD
+{
+	bool enabled{ true };
+
+	float nearDistance{ 20.f };
+	float farDistance{ 150.f };
+
+	unsigned int maxInterval{ 8 };
+};
+
+// The last evaluated pose of a skinned node.
+struct AnimationPoseCache
+{
+	std::string animation;
+
+	// Model the pose was evaluated for. The resolved model changes once the
+	// real model has replaced the placeholder.
+	const Model *model{ nullptr };
+
+	// Renderer frame the pose was evaluated in.
+	unsigned long long frame{ 0 };
+
+	// Renderer frame the pose was last used in.
+	unsigned long long lastUsed{ 0 };
+
+	bool valid{ false };
+
+	std::vector<glm::mat4> boneTransforms;
+
+	// Pre-skinned vertices shared by all render passes.
+	std::shared_ptr<SkinnedModelInstance> skinnedInstance;
+
+	// Renderer frame the vertices were last skinned in.
+	unsigned long long skinnedFrame{ 0 };
+};
@@ -0,0 +1,200 @@
+#include "AnimationPoseTexture.h"
+
+#include "Model.h"
+
+#include <iostream>
+#include <cstring>
+
+AnimationPoseTexture::AnimationPoseTexture(
+	Model *model,
+	float sampleRate)
+	: _sampleRate{ sampleRate }
+{
+	bake(model);
+}
+
+AnimationPoseTexture::~AnimationPoseTexture()
+{
+	if (glIsTexture(_handle))
+	{
+		glDeleteTextures(1, &_handle);
+	}
+}
+
+bool AnimationPoseTexture::isValid() const
+{
+	return _handle != 0;
+}
+
+void AnimationPoseTexture::bind(
+	GLuint texUnit) const
+{
+	glActiveTexture(GL_TEXTURE0 + texUnit);
+	glBindTexture(GL_TEXTURE_2D, _handle);
+}
+
+GLuint AnimationPoseTexture::getHandle() const
+{
+	return _handle;
+}
+
+unsigned int AnimationPoseTexture::getNumBones() const
+{
+	return _numBones;
+}
+
+unsigned int AnimationPoseTexture::getNumFrames() const
+{
+	return _numFrames;
+}
+
+float AnimationPoseTexture::getSampleRate() const
+{
+	return _sampleRate;
+}
+
+bool AnimationPoseTexture::hasClip(
+	const std::string &name) const
+{
+	return _clipMapping.find(name) != _clipMapping.end();
+}
+
+const AnimationPoseTextureClip & AnimationPoseTexture::getClip(
+	const std::string &name) const
+{
+	return _clips.at(_clipMapping.at(name));
+}
+
+const std::vector<AnimationPoseTextureClip> & AnimationPoseTexture::getClips() const
+{
+	return _clips;
+}
+
+void AnimationPoseTexture::bake(
+	Model *model)
+{
+	_numBones = static_cast<unsigned int>(model->getBoneInfo().size());
+
+	if (!model->isSkinned() || model->getAnimations().empty())
+	{
+		std::cerr << "[POSE] Model " << model->getFileName() << " has no animations to bake" << std::endl;
+		return;
+	}
+
+	GLint maxTextureSize;
+	glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+
+	// Each bone matrix is stored as four RGBA texels, one per column.
+	const unsigned int texelsPerFrame = _numBones * 4;
+
+	if (texelsPerFrame > static_cast<unsigned int>(maxTextureSize))
+	{
+		std::cerr << "[POSE] Model " << model->getFileName() << " has too many bones to bake into a texture" << std::endl;
+		return;
+	}
+
+	std::vector<float> durations;
+	float totalDuration = 0.f;
+
+	for (const auto& animation : model->getAnimations())
+	{
+		float ticksPerSecond = animation.ticksPerSecond;
+
+		if (ticksPerSecond == 0.f)
+		{
+			ticksPerSecond = 25.f;
+		}
+
+		durations.push_back(animation.duration / ticksPerSecond);
+		totalDuration += durations.back();
+	}
+
+	// Every clip rounds up to at least one extra frame, so leave one row per
+	// clip when lowering the rate to make all frames fit.
+	const float availableFrames = static_cast<float>(maxTextureSize) - static_cast<float>(durations.size());
+
+	if (availableFrames < 1.f)
+	{
+		std::cerr << "[POSE] Model " << model->getFileName() << " has too many animations to bake into a texture" << std::endl;
+		return;
+	}
+
+	if (totalDuration * _sampleRate > availableFrames)
+	{
+		_sampleRate = availableFrames / totalDuration;
+
+		std::cerr << "[POSE] Lowered the sample rate for " << model->getFileName() << " to " << _sampleRate << " to fit the maximum texture size" << std::endl;
+	}
+
+	// Figure out how many frames each clip needs at the chosen rate.
+	for (size_t i = 0; i < durations.size(); ++i)
+	{
+		AnimationPoseTextureClip clip;
+
+		clip.name = model->getAnimations()[i].name;
+		clip.duration = durations[i];
+		clip.firstFrame = _numFrames;
+		clip.frameCount = glm::max(1u, static_cast<unsigned int>(glm::ceil(clip.duration * _sampleRate)));
+
+		_numFrames += clip.frameCount;
+
+		_clipMapping.emplace(clip.name, static_cast<unsigned int>(_clips.size()));
+		_clips.push_back(clip);
+	}
+
+	// Guards against rounding in the rate above; never upload a texture the
+	// driver cannot hold.
+	if (_numFrames > static_cast<unsigned int>(maxTextureSize))
+	{
+		std::cerr << "[POSE] Baked poses for " << model->getFileName() << " exceed the maximum texture size" << std::endl;
+
+		_clips.clear();
+		_clipMapping.clear();
+		return;
+	}
+
+	std::vector<float> data(static_cast<size_t>(texelsPerFrame) * _numFrames * 4);
+
+	std::vector<glm::mat4> transforms;
+
+	for (const auto& clip : _clips)
+	{
+		for (unsigned int frame = 0; frame < clip.frameCount; ++frame)
+		{
+			float time = static_cast<float>(frame) / _sampleRate;
+
+			model->getBoneTransforms(time, transforms, clip.name);
+
+			float *row = &data[static_cast<size_t>(clip.firstFrame + frame) * texelsPerFrame * 4];
+
+			for (unsigned int bone = 0; bone < _numBones; ++bone)
+			{
+				memcpy(&row[bone * 16], glm::value_ptr(transforms[bone]), 16 * sizeof(float));
+			}
+		}
+	}
+
+	glGenTextures(1, &_handle);
+	glBindTexture(GL_TEXTURE_2D, _handle);
+
+	glTexImage2D(
+		GL_TEXTURE_2D,
+		0,
+		GL_RGBA32F,
+		texelsPerFrame,
+		_numFrames,
+		0,
+		GL_RGBA,
+		GL_FLOAT,
+		data.data());
+
+	// The poses are read with texelFetch, so no filtering may be applied.
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
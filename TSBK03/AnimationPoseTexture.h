@@ -0,0 +1,71 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+
+#include <GL/glew.h>
+
+class Model;
+
+// A single baked animation clip. The frames of the clip are stored as
+// consecutive rows in the pose texture.
+struct AnimationPoseTextureClip
+{
+	std::string name;
+
+	unsigned int firstFrame;
+	unsigned int frameCount;
+
+	// Clip length in seconds
+	float duration;
+};
+
+// Bakes all animation clips of a skinned model into a floating point texture
+// where each row is one sampled pose and each bone occupies four texels (the
+// columns of the bone matrix). The skinned instanced shader reads the poses
+// with texelFetch, so no animation has to be evaluated on the CPU per instance.
+class AnimationPoseTexture
+{
+public:
+	explicit AnimationPoseTexture(Model *model, float sampleRate = 30.f);
+
+	AnimationPoseTexture(const AnimationPoseTexture& other) = delete;
+	AnimationPoseTexture(AnimationPoseTexture&& other) = delete;
+
+	AnimationPoseTexture& operator=(const AnimationPoseTexture& other) = delete;
+	AnimationPoseTexture& operator=(AnimationPoseTexture&& other) = delete;
+
+	~AnimationPoseTexture();
+
+	// False when the model had nothing to bake or the poses did not fit in a
+	// texture. No texture is created in that case.
+	bool isValid() const;
+
+	void bind(GLuint texUnit) const;
+
+	GLuint getHandle() const;
+
+	unsigned int getNumBones() const;
+	unsigned int getNumFrames() const;
+
+	float getSampleRate() const;
+
+	bool hasClip(const std::string& name) const;
+	const AnimationPoseTextureClip& getClip(const std::string& name) const;
+	const std::vector<AnimationPoseTextureClip>& getClips() const;
+
+private:
+
+	void bake(Model *model);
+
+	float _sampleRate;
+
+	unsigned int _numBones{ 0 };
+	unsigned int _numFrames{ 0 };
+
+	std::vector<AnimationPoseTextureClip> _clips{};
+	std::map<std::string, unsigned int> _clipMapping{};
+
+	GLuint _handle{ 0 };
+};
@@ -2,6 +2,7 @@
 
 #include <iostream>
 #include <vector>
+#include <fstream>
 
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
@@ -23,6 +24,8 @@
 #include "Color.h"
 #include "DirectionalLightSceneNode.h"
 #include "AssetManager.h"
+#include "AssetAsyncLoader.h"
+#include "AssetFileSystem.h"
 #include "Terrain.h"
 #include "KeyEvent.h"
 
@@ -30,6 +33,7 @@
 #include "MouseMovedEvent.h"
 #include "MouseButtonEvent.h"
 #include "Game.h"
+#include "Benchmark.h"
 
 #include <sstream>
 
@@ -548,6 +552,11 @@ void drawAssetList(AssetManager *assetManager)
 
 	auto modelPool = assetManager->getPool<Model>();
 
+	ImGui::Text("CPU: %.1f MB, GPU: %.1f MB, Evicted: %u",
+		modelPool->getCPUMemoryUsage() / (1024.f * 1024.f),
+		modelPool->getGPUMemoryUsage() / (1024.f * 1024.f),
+		modelPool->getNumEvicted());
+
 	for (auto it : modelPool->getAssets())
 	{
 		if (ImGui::TreeNode(it.first.c_str()))
@@ -558,6 +567,8 @@ void drawAssetList(AssetManager *assetManager)
 			ImGui::Text("Filename: %s", it.second->getFileName().c_str());
 			ImGui::Text("Vertices: %i", it.second->getVertexCount());
 			ImGui::Text("Indices: %i", it.second->getIndicesCount());
+			ImGui::Text("Cooked: %s", it.second->isCooked() ? "Yes" : "No");
+			ImGui::Text("GPU memory: %.1f KB", it.second->getGPUMemoryUsage() / 1024.f);
 
 			ImGui::TreePop();
 		}
@@ -569,6 +580,10 @@ void drawAssetList(AssetManager *assetManager)
 
 	auto texturePool = assetManager->getPool<Texture2D>();
 
+	ImGui::Text("GPU: %.1f MB, Evicted: %u",
+		texturePool->getGPUMemoryUsage() / (1024.f * 1024.f),
+		texturePool->getNumEvicted());
+
 	ImGui::PushID(1);
 
 	for (auto it : texturePool->getAssets())
@@ -643,8 +658,14 @@ void drawAssetList(AssetManager *assetManager)
 	ImGui::PopID();
 }
 
-Application::Application()
+Application::Application(
+	const BenchmarkSettings *benchmarkSettings)
 {
+	if (benchmarkSettings != nullptr)
+	{
+		_benchmark = new Benchmark{ *benchmarkSettings };
+	}
+
 	glm::mat4 proj = glm::perspective(
 		glm::radians(FOV),
 		static_cast<float>(windowWidth) / static_cast<float>(windowHeight),
@@ -653,12 +674,30 @@ Application::Application()
 
 	glfwInit();
 
+	Timer startupTimer;
+
+	_startupTime = static_cast<float>(glfwGetTime());
+
+	// Serve assets from the packed archive when it has been built, loose
+	// files are used for anything it does not contain.
+	if (std::ifstream{ "assets.pak" }.good() && AssetFileSystem::mount("assets.pak"))
+	{
+		std::cout << "[STARTUP] Mounted assets.pak" << std::endl;
+	}
+
 	const char* glsl_version = "#version 430 core";
 	glfwWindowHint(GLFW_SAMPLES, 4);
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
 	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
+	// Nothing is shown while benchmarking, which also lets it run on a
+	// software renderer without a visible desktop.
+	if (_benchmark != nullptr)
+	{
+		glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	}
+
 	_window = glfwCreateWindow(1280, 768, "Title", NULL, NULL);
 
 	if (_window == nullptr)
@@ -670,7 +709,7 @@ Application::Application()
 	}
 
 	glfwMakeContextCurrent(_window);
-	glfwSwapInterval(1);
+	glfwSwapInterval(_benchmark != nullptr ? 0 : 1);
 	glewExperimental = GL_TRUE;
 
 	if (glewInit() != GLEW_OK)
@@ -709,18 +748,38 @@ Application::Application()
 
 	glEnable(GL_DEPTH_TEST);
 
+	float contextTime = startupTimer.restart();
+
+	// Placeholders are shown while the real assets are loaded in the background.
+	GLubyte white[4]{ 255, 255, 255, 255 };
+
+	_assetManager.setPlaceholder(new Texture2D{ 1, 1, TEXTURE_2D_FORMAT::RGBA, TEXTURE_2D_DATATYPE::UNSIGNED_BYTE, white });
+	_assetManager.setPlaceholder(new TextureCubeMap{ Color{ 0.5f, 0.5f, 0.5f } });
+
+	// The skybox needs the sphere up front anyway, so it doubles as the model
+	// placeholder.
 	_assetManager.load<Model>("skyboxSphere", "sphere.obj");
+	_assetManager.setPlaceholder<Model>("skyboxSphere");
 
-	_assetManager.load<Model>("terrain", "testscene2.obj");
+	_assetManager.loadAsync<Model>("terrain", "testscene2.obj");
 
-	_assetManager.load<Model>("palm1", "Prop_Tree_Palm_1.obj");
-	_assetManager.load<Model>("palm2", "Prop_Tree_Palm_2.obj");
-	_assetManager.load<Model>("palm3", "Prop_Tree_Palm_3.obj");
+	_assetManager.loadAsync<Model>("palm1", "Prop_Tree_Palm_1.obj");
+	_assetManager.loadAsync<Model>("palm2", "Prop_Tree_Palm_2.obj");
+	_assetManager.loadAsync<Model>("palm3", "Prop_Tree_Palm_3.obj");
 
-	Model *characterModel = _assetManager.load<Model>("warrior", "model.dae");
+	_assetManager.loadAsync<Model>("warrior", "model.dae").onReady([](Model *characterModel)
+	{
+		characterModel->setCorrectionRotation(glm::vec3(-90.f, 0.f, -90.f));
+	});
 
-	characterModel->setCorrectionRotation(glm::vec3(-90.f, 0.f, -90.f));
+	// The correction rotation would be lost if the model was evicted and
+	// reloaded, so keep it referenced.
+	_characterModel = _assetManager.acquire<Model>("warrior");
 
+	_assetManager.setBudget<Model>(256 * 1024 * 1024, 256 * 1024 * 1024);
+	_assetManager.setBudget<Texture2D>(0, 512 * 1024 * 1024);
+
+	// The terrain is needed for placing objects, so it is still loaded up front.
 	std::vector<std::string> terrains;
 	terrains.push_back("NvF5e.tga");
 
@@ -728,13 +787,13 @@ Application::Application()
 
 	offsets.push_back(glm::vec3{ 0.f, 0.f, 0.f });
 
-	Terrain *terrain = _assetManager.load<Terrain>("terrain", terrains, offsets);
+	_assetManager.load<Terrain>("terrain", terrains, offsets);
 
-	_assetManager.load<Texture2D>("grass", "grass.tga");
-	_assetManager.load<Texture2D>("char", "diffuse.tga");
-	_assetManager.load<Texture2D>("icons", "gaming-icon-maker-15.jpg");
+	_assetManager.loadAsync<Texture2D>("grass", "grass.tga");
+	_assetManager.loadAsync<Texture2D>("char", "diffuse.tga");
+	_assetManager.loadAsync<Texture2D>("icons", "gaming-icon-maker-15.jpg");
 
-	TextureCubeMap *texCubeMap = _assetManager.load<TextureCubeMap>("skyboxTexture",
+	_assetManager.loadAsync<TextureCubeMap>("skyboxTexture",
 		"stormydays_ft.tga",
 		"stormydays_bk.tga",
 		"stormydays_dn.tga",
@@ -742,7 +801,7 @@ Application::Application()
 		"stormydays_rt.tga",
 		"stormydays_lf.tga");
 
-	_assetManager.load<TextureCubeMap>("skyboxTexture1",
+	_assetManager.loadAsync<TextureCubeMap>("skyboxTexture1",
 		"purplenebula_ft.tga",
 		"purplenebula_bk.tga",
 		"purplenebula_dn.tga",
@@ -750,18 +809,52 @@ Application::Application()
 		"purplenebula_rt.tga",
 		"purplenebula_lf.tga");
 
+	float assetTime = startupTimer.restart();
+
 	_renderer = new Renderer{ static_cast<int>(windowWidth), static_cast<int>(windowHeight), &_assetManager , proj };
 
-	_currentFrame = new Game(this);
+	// Mips of the cooked textures beyond what fits are dropped, starting with
+	// the ones furthest away.
+	_renderer->getTextureStreamer().setBudget(256 * 1024 * 1024);
+
+	float rendererTime = startupTimer.restart();
+
+	// Benchmark runs use a fixed seed, so that they spawn the same enemies.
+	uint32_t seed = _benchmark != nullptr ? _benchmark->getSettings().seed : static_cast<uint32_t>(time(nullptr));
+
+	Game *game = new Game(this, seed);
+
+	_currentFrame = game;
+
+	float gameTime = startupTimer.restart();
+
+	std::cout << "[STARTUP] Context: " << contextTime * 1000.f << "ms, "
+		<< "Assets: " << assetTime * 1000.f << "ms, "
+		<< "Renderer: " << rendererTime * 1000.f << "ms, "
+		<< "Game: " << gameTime * 1000.f << "ms, "
+		<< "Total: " << (contextTime + assetTime + rendererTime + gameTime) * 1000.f << "ms, "
+		<< "Assets pending: " << _assetManager.getNumPending() << std::endl;
+
+	if (_benchmark != nullptr)
+	{
+		// Every run measures the same assets.
+		_assetManager.waitForAll();
+
+		_benchmark->start(game, _renderer->getProfiler());
+	}
 }
 
 Application::~Application()
 {
 	if(_currentFrame)
 	{
+		_renderer->clearPickingRequests();
+
 		delete _currentFrame;
 	}
 
+	delete _benchmark;
+
 	ImGui_ImplOpenGL3_Shutdown();
 	ImGui_ImplGlfw_Shutdown();
 	ImGui::DestroyContext();
@@ -773,6 +866,15 @@ void Application::run()
 {
 	while (!glfwWindowShouldClose(_window) && !_appShouldClose)
 	{
+		Profiler& profiler = _renderer->getProfiler();
+
+		if (_benchmark != nullptr)
+		{
+			_benchmark->beginFrame(profiler);
+		}
+
+		profiler.beginFrame();
+
 		static bool wireframe = false;
 
 		float time = static_cast<float>(glfwGetTime());
@@ -1035,14 +1137,27 @@ void Application::run()
 
 				ImGui::Separator();
 
+				bool gpuPicking = _renderer->getGPUPicking();
+
+				if (ImGui::Checkbox("GPU Picking", &gpuPicking))
+				{
+					_renderer->setGPUPicking(gpuPicking);
+				}
+
 				double xpos;
 				double ypos;
 
 				glfwGetCursorPos(_window, &xpos, &ypos);
 
-				RendererPickingInfo info = _renderer->getPickingInfo(static_cast<int>(xpos), static_cast<int>(ypos));
+				_renderer->requestPicking(
+					static_cast<int>(xpos),
+					static_cast<int>(ypos),
+					[this](const RendererPickingInfo& info)
+				{
+					_cursorPickingInfo = info;
+				});
 
-				int objectID = static_cast<int>(info.objectID);
+				int objectID = static_cast<int>(_cursorPickingInfo.objectID);
 
 				ImGui::Text("Object ID: %d", objectID);
 				ImGui::Text("Cursor Pos: %f,%f", xpos, ypos);
@@ -1053,6 +1168,13 @@ void Application::run()
 
 				ImGui::Text("Last Rendering Time [GPU]: %.3fms (%.0f FPS)", _renderer->getLastGPURenderTime(), fps);
 
+				int maxFramesInFlight = static_cast<int>(_renderer->getMaxFramesInFlight());
+
+				if (ImGui::SliderInt("Max Frames In Flight", &maxFramesInFlight, 1, MAX_FRAMES_IN_FLIGHT))
+				{
+					_renderer->setMaxFramesInFlight(static_cast<unsigned int>(maxFramesInFlight));
+				}
+
 				static float timeAccumulator = 0.f;
 				static float lastTime = static_cast<float>(glfwGetTime());
 
@@ -1091,6 +1213,40 @@ void Application::run()
 
 				ImGui::Separator();
 
+				const RendererFrameStats& frameStats = _renderer->getFrameStats();
+
+				ImGui::Text("Animation evaluations: %u", frameStats.animationEvaluations);
+				ImGui::Text("Animation evaluations skipped: %u", frameStats.animationSkipped);
+				ImGui::Text("Idle poses cached: %u", frameStats.animationIdleCached);
+				ImGui::Text("Skinned models: %u", frameStats.skinnedModels);
+				ImGui::Text("Scene changes: %u", frameStats.sceneChanges);
+				ImGui::Text("Static models moved: %u", frameStats.movedStaticModels);
+				ImGui::Text("Static models visible: %u", frameStats.visibleStaticModels);
+				ImGui::Text("Draw calls: %u", frameStats.drawCalls);
+				ImGui::Text("Triangles: %u", frameStats.triangles);
+
+				ImGui::Separator();
+
+				TextureStreamer& textureStreamer = _renderer->getTextureStreamer();
+
+				ImGui::Text("Streamed textures: %u", static_cast<unsigned int>(Texture2D::getStreamedTextures().size()));
+				ImGui::Text("Streamed texture memory: %.1f / %.1f MB",
+					textureStreamer.getResidentMemory() / (1024.f * 1024.f),
+					textureStreamer.getBudget() / (1024.f * 1024.f));
+				ImGui::Text("Mips streamed in: %u, dropped: %u, in flight: %u",
+					textureStreamer.getNumStreamedIn(),
+					textureStreamer.getNumDropped(),
+					textureStreamer.getNumInFlight());
+
+				float levelBias = textureStreamer.getLevelBias();
+
+				if (ImGui::SliderFloat("Mip Level Bias", &levelBias, -2.f, 4.f))
+				{
+					textureStreamer.setLevelBias(levelBias);
+				}
+
+				ImGui::Separator();
+
 				float godrayDensity = _renderer->getGodrayDensity();
 				float godrayWeight = _renderer->getGodrayWeight();
 				float godrayDecay = _renderer->getGodrayDecay();
@@ -1337,7 +1493,7 @@ void Application::run()
 		eye.y = center.y + radius * glm::sin(theta);
 		eye.z = center.z + radius * glm::sin(phi) * glm::cos(theta);
 
-		float heightAtCamera = _assetManager.fetch<Terrain>(terrainNode->getTerrain())->getHeight(eye.x, eye.z);
+		float heightAtCamera = _assetManager.resolve(terrainNode->getTerrainRef(), terrainNode->getTerrain())->getHeight(eye.x, eye.z);
 
 		if (eye.y <= heightAtCamera + 1.f)
 		{
@@ -1355,14 +1511,81 @@ void Application::run()
 
 		float deltaTime = _timer.restart();
 
-		update(deltaTime);
+		// The benchmark steps the game by the same time every frame, however
+		// long the frames take.
+		if (_benchmark != nullptr)
+		{
+			deltaTime = _benchmark->getSettings().timeStep;
+		}
+
+		{
+			ProfilerScope scope{ profiler, "Assets", true };
+
+			// Finish assets that have been decoded in the background.
+			_assetManager.update(_assetUploadBudget);
+		}
+
+		{
+			ProfilerScope scope{ profiler, "Update" };
+
+			update(deltaTime);
+		}
+
+		if (_benchmark != nullptr)
+		{
+			Game *game = dynamic_cast<Game *>(_currentFrame);
+
+			if (game != nullptr)
+			{
+				_benchmark->update(game, _renderer, _assetManager.fetch<Terrain>("terrain"));
+			}
+		}
 
 		render();
 
-		glfwSwapBuffers(_window);
+		{
+			ProfilerScope scope{ profiler, "Swap" };
+
+			glfwSwapBuffers(_window);
+		}
+
+		profiler.endFrame();
+
+		if (_benchmark != nullptr)
+		{
+			_benchmark->endFrame(_renderer->getFrameStats());
+
+			if (_benchmark->isDone())
+			{
+				finishBenchmark();
+			}
+		}
+
+		if (_firstFrame)
+		{
+			std::cout << "[STARTUP] First frame after " << (static_cast<float>(glfwGetTime()) - _startupTime) * 1000.f << "ms" << std::endl;
+
+			_firstFrame = false;
+		}
 	}
 }
 
+void Application::finishBenchmark()
+{
+	Profiler& profiler = _renderer->getProfiler();
+
+	// Read the timestamps of the last frames.
+	glFinish();
+
+	profiler.resolveFrames();
+	profiler.finishCapture();
+	profiler.setFrameCallback(nullptr);
+
+	_benchmark->writeReport(reinterpret_cast<const char *>(glGetString(GL_RENDERER)));
+
+	_appShouldClose = true;
+}
+
 void Application::update(
 	float dt)
 {
@@ -1376,18 +1599,26 @@ void Application::update(
 
 void Application::render()
 {
-	if (_currentFrame != nullptr)
+	Profiler& profiler = _renderer->getProfiler();
+
 	{
-		_currentFrame->renderUI();
-	}
+		ProfilerScope scope{ profiler, "UI" };
 
-	ImGui::Render();
+		if (_currentFrame != nullptr)
+		{
+			_currentFrame->renderUI();
+		}
+
+		ImGui::Render();
+	}
 
 	if (_currentFrame != nullptr)
 	{
 		_currentFrame->render(_renderer);
 	}
 
+	ProfilerScope scope{ profiler, "UI Draw", true };
+
 	ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 }
 
@@ -1401,6 +1632,9 @@ void Application::changeFrame(
 {
 	if (_currentFrame != nullptr)
 	{
+		// The frame may be waiting for picking results.
+		_renderer->clearPickingRequests();
+
 		delete _currentFrame;
 	}
 
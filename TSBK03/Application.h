@@ -6,11 +6,15 @@
 #include "AudioManager.h"
 
 class Frame;
+class Benchmark;
+struct BenchmarkSettings;
 
 class Application
 {
 public:
-	Application();
+	// With benchmark settings the window is hidden, vsync is off and the
+	// application closes once the benchmark has run.
+	explicit Application(const BenchmarkSettings *benchmarkSettings = nullptr);
 	Application(const Application&) = delete;
 	Application& operator=(const Application&) = delete;
 	~Application();
@@ -53,17 +57,34 @@ public:
 
 private:
 
+	// Writes the benchmark report and closes the application.
+	void finishBenchmark();
+
 	bool _appShouldClose{false};
 
 	EventManager _eventManager;
 	AssetManager _assetManager;
+
+	AssetRef<Model> _characterModel{};
 	Renderer *_renderer;
 
 	GLFWwindow *_window;
 
 	Timer _timer;
 
+	// Time in milliseconds per frame spent finishing asynchronously loaded assets
+	float _assetUploadBudget{ 4.f };
+
+	float _startupTime{ 0.f };
+	bool _firstFrame{ true };
+
+	// Object under the cursor, shown in the debug window. With GPU picking
+	// it is a frame or two behind.
+	RendererPickingInfo _cursorPickingInfo{};
+
 	Frame *_currentFrame;
 
+	Benchmark *_benchmark{ nullptr };
+
 	AudioManager _audioManager{};
 };
\ No newline at end of file
@@ -0,0 +1,276 @@
+#include "AssetArchive.h"
+
+#include "MappedFile.h"
+#include "AssetCompression.h"
+
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <cstring>
+#include <cctype>
+#include <stdexcept>
+
+#define ARCHIVE_MAGIC "TPAK"
+#define ARCHIVE_HEADER_SIZE 24
+
+namespace
+{
+	template <typename T>
+	T readValue(
+		const unsigned char *&p,
+		const unsigned char *end)
+	{
+		if (static_cast<size_t>(end - p) < sizeof(T))
+		{
+			throw std::invalid_argument("Archive index is truncated.");
+		}
+
+		T value;
+		memcpy(&value, p, sizeof(T));
+		p += sizeof(T);
+
+		return value;
+	}
+
+	template <typename T>
+	void writeValue(
+		std::ofstream &stream,
+		T value)
+	{
+		stream.write(reinterpret_cast<const char *>(&value), sizeof(T));
+	}
+
+	uint64_t align(
+		uint64_t value)
+	{
+		return (value + AssetArchive::ALIGNMENT - 1) / AssetArchive::ALIGNMENT * AssetArchive::ALIGNMENT;
+	}
+}
+
+AssetArchive::AssetArchive(
+	const std::string &archivePath)
+	: _filePath{ archivePath }
+{
+	_mapping = std::make_shared<MappedFile>(archivePath);
+
+	const unsigned char *data = _mapping->getData();
+	const unsigned char *end = data + _mapping->getSize();
+
+	if (_mapping->getSize() < ARCHIVE_HEADER_SIZE || memcmp(data, ARCHIVE_MAGIC, 4) != 0)
+	{
+		throw std::invalid_argument("File (" + archivePath + ") is not an asset archive.");
+	}
+
+	const unsigned char *p = data + 4;
+
+	uint32_t version = readValue<uint32_t>(p, end);
+
+	if (version != VERSION)
+	{
+		throw std::invalid_argument("Archive (" + archivePath + ") has unsupported version " + std::to_string(version) + ".");
+	}
+
+	uint32_t entryCount = readValue<uint32_t>(p, end);
+	readValue<uint32_t>(p, end);
+	uint64_t indexSize = readValue<uint64_t>(p, end);
+
+	if (indexSize > static_cast<uint64_t>(end - p))
+	{
+		throw std::invalid_argument("Archive (" + archivePath + ") index is truncated.");
+	}
+
+	const unsigned char *indexEnd = p + indexSize;
+
+	for (uint32_t i = 0; i < entryCount; ++i)
+	{
+		AssetArchiveEntry entry;
+
+		uint32_t nameLength = readValue<uint32_t>(p, indexEnd);
+
+		if (nameLength > static_cast<size_t>(indexEnd - p))
+		{
+			throw std::invalid_argument("Archive (" + archivePath + ") index is truncated.");
+		}
+
+		entry.name.assign(reinterpret_cast<const char *>(p), nameLength);
+		p += nameLength;
+
+		entry.offset = readValue<uint64_t>(p, indexEnd);
+		entry.storedSize = readValue<uint64_t>(p, indexEnd);
+		entry.size = readValue<uint64_t>(p, indexEnd);
+		entry.compression = static_cast<AssetCompressionType>(readValue<uint32_t>(p, indexEnd));
+
+		if (entry.offset > _mapping->getSize() || entry.storedSize > _mapping->getSize() - entry.offset)
+		{
+			throw std::invalid_argument("Archive (" + archivePath + ") entry " + entry.name + " is out of bounds.");
+		}
+
+		_entries.emplace(entry.name, entry);
+	}
+}
+
+AssetArchive::~AssetArchive()
+{
+}
+
+bool AssetArchive::contains(
+	const std::string &name) const
+{
+	return _entries.find(normalizePath(name)) != _entries.end();
+}
+
+AssetStream AssetArchive::open(
+	const std::string &name) const
+{
+	auto it = _entries.find(normalizePath(name));
+
+	if (it == _entries.end())
+	{
+		return AssetStream{};
+	}
+
+	const AssetArchiveEntry &entry = it->second;
+
+	const unsigned char *data = _mapping->getData() + entry.offset;
+
+	if (entry.compression == AssetCompressionType::NONE)
+	{
+		return AssetStream{ name, _mapping, data, static_cast<size_t>(entry.size) };
+	}
+
+	std::vector<unsigned char> buffer(static_cast<size_t>(entry.size));
+
+	decompressBlock(data, static_cast<size_t>(entry.storedSize), buffer.data(), buffer.size());
+
+	return AssetStream{ name, std::move(buffer) };
+}
+
+const std::map<std::string, AssetArchiveEntry> & AssetArchive::getEntries() const
+{
+	return _entries;
+}
+
+const std::string & AssetArchive::getFilePath() const
+{
+	return _filePath;
+}
+
+void AssetArchive::build(
+	const std::string &archivePath,
+	const std::vector<std::string> &files,
+	bool compress)
+{
+	std::vector<AssetArchiveEntry> entries;
+	std::vector<std::vector<unsigned char>> blobs;
+
+	uint64_t indexSize = 0;
+
+	for (const auto& file : files)
+	{
+		std::ifstream stream{ file, std::ios::binary };
+
+		if (!stream.is_open())
+		{
+			throw std::invalid_argument("File (" + file + ") could not be opened.");
+		}
+
+		std::vector<unsigned char> data{ std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>() };
+
+		AssetArchiveEntry entry;
+		entry.name = normalizePath(file);
+		entry.offset = 0;
+		entry.size = data.size();
+		entry.compression = AssetCompressionType::NONE;
+
+		if (compress && !data.empty())
+		{
+			std::vector<unsigned char> compressed = compressBlock(data.data(), data.size());
+
+			if (compressed.size() < data.size() - data.size() / 8)
+			{
+				data = std::move(compressed);
+				entry.compression = AssetCompressionType::LZ;
+			}
+		}
+
+		entry.storedSize = data.size();
+
+		indexSize += sizeof(uint32_t) + entry.name.size() + 3 * sizeof(uint64_t) + sizeof(uint32_t);
+
+		entries.push_back(entry);
+		blobs.push_back(std::move(data));
+	}
+
+	uint64_t offset = align(ARCHIVE_HEADER_SIZE + indexSize);
+
+	for (auto& entry : entries)
+	{
+		entry.offset = offset;
+		offset = align(offset + entry.storedSize);
+	}
+
+	std::ofstream stream{ archivePath, std::ios::binary | std::ios::trunc };
+
+	if (!stream.is_open())
+	{
+		throw std::invalid_argument("File (" + archivePath + ") could not be opened.");
+	}
+
+	stream.write(ARCHIVE_MAGIC, 4);
+	writeValue<uint32_t>(stream, VERSION);
+	writeValue<uint32_t>(stream, static_cast<uint32_t>(entries.size()));
+	writeValue<uint32_t>(stream, 0);
+	writeValue<uint64_t>(stream, indexSize);
+
+	for (const auto& entry : entries)
+	{
+		writeValue<uint32_t>(stream, static_cast<uint32_t>(entry.name.size()));
+		stream.write(entry.name.data(), entry.name.size());
+		writeValue<uint64_t>(stream, entry.offset);
+		writeValue<uint64_t>(stream, entry.storedSize);
+		writeValue<uint64_t>(stream, entry.size);
+		writeValue<uint32_t>(stream, static_cast<uint32_t>(entry.compression));
+	}
+
+	for (size_t i = 0; i < entries.size(); ++i)
+	{
+		// Pad up to the aligned blob offset.
+		uint64_t position = static_cast<uint64_t>(stream.tellp());
+		std::vector<char> padding(static_cast<size_t>(entries[i].offset - position), 0);
+
+		stream.write(padding.data(), padding.size());
+		stream.write(reinterpret_cast<const char *>(blobs[i].data()), blobs[i].size());
+	}
+
+	if (!stream.good())
+	{
+		throw std::invalid_argument("File (" + archivePath + ") could not be written.");
+	}
+}
+
+std::string AssetArchive::normalizePath(
+	const std::string &path)
+{
+	std::string result;
+	result.reserve(path.size());
+
+	for (char c : path)
+	{
+		result.push_back(c == '\\' ? '/' : static_cast<char>(std::tolower(static_cast<unsigned char>(c))));
+	}
+
+	// Drop "./" segments.
+	size_t position;
+
+	while ((position = result.find("/./")) != std::string::npos)
+	{
+		result.erase(position, 2);
+	}
+
+	while (result.compare(0, 2, "./") == 0)
+	{
+		result.erase(0, 2);
+	}
+
+	return result;
+}
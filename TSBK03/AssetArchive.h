@@ -0,0 +1,89 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <cstdint>
+
+#include "AssetStream.h"
+
+class MappedFile;
+
+enum class AssetCompressionType : uint32_t
+{
+	NONE = 0,
+	LZ = 1
+};
+
+struct AssetArchiveEntry
+{
+	std::string name;
+
+	// Offset from the start of the archive
+	uint64_t offset;
+
+	// Bytes stored in the archive
+	uint64_t storedSize;
+
+	// Bytes after decompression
+	uint64_t size;
+
+	AssetCompressionType compression;
+};
+
+// Packed archive of asset files.
+//
+// Layout, little endian:
+//	Header:	"TPAK", version, entry count, reserved, index size (u64)
+//	Index:	per entry the name length (u32), the name, offset (u64),
+//			stored size (u64), size (u64) and compression (u32)
+//	Blobs:	the entries, each aligned to ALIGNMENT bytes so that mapped
+//			data can be read in place
+//
+// The archive is memory mapped. Uncompressed entries are served straight
+// from the mapping without copying.
+class AssetArchive
+{
+public:
+	static const uint32_t VERSION = 1;
+	static const uint64_t ALIGNMENT = 64;
+
+	explicit AssetArchive(const std::string& archivePath);
+
+	AssetArchive(const AssetArchive& other) = delete;
+	AssetArchive(AssetArchive&& other) = delete;
+
+	AssetArchive& operator=(const AssetArchive& other) = delete;
+	AssetArchive& operator=(AssetArchive&& other) = delete;
+
+	~AssetArchive();
+
+	bool contains(const std::string& name) const;
+
+	// Returns a closed stream if the archive has no such entry.
+	AssetStream open(const std::string& name) const;
+
+	const std::map<std::string, AssetArchiveEntry>& getEntries() const;
+
+	const std::string& getFilePath() const;
+
+	// Packs the files into a new archive. Entries are compressed when
+	// compress is set and it saves at least an eighth of their size.
+	static void build(
+		const std::string& archivePath,
+		const std::vector<std::string>& files,
+		bool compress);
+
+	// Archive names use forward slashes, no "./" segments and lower case, so
+	// that lookups match the case insensitive file system on Windows.
+	static std::string normalizePath(const std::string& path);
+
+private:
+
+	std::string _filePath;
+
+	std::shared_ptr<MappedFile> _mapping{};
+
+	std::map<std::string, AssetArchiveEntry> _entries{};
+};
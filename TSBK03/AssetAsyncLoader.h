@@ -0,0 +1,142 @@
+#pragma once
+
+#include <string>
+#include <memory>
+
+#include "Model.h"
+#include "Texture.h"
+#include "TextureFile.h"
+#include "KTXFile.h"
+
+// Splits the loading of an asset type into a decode step that runs on a
+// worker thread and a finalize step that runs on the main thread where the
+// OpenGL context is current. Only types with a specialization can be loaded
+// with AssetManager::loadAsync.
+template <typename T>
+struct AssetAsyncLoader;
+
+template <>
+struct AssetAsyncLoader<Model>
+{
+	// The model itself is built on the worker, only the buffers are deferred.
+	using Intermediate = Model;
+
+	static Model *decode(const std::string& fileName)
+	{
+		return new Model{ fileName, true, true };
+	}
+
+	static Model *finalize(Model *model)
+	{
+		model->upload();
+
+		return model;
+	}
+};
+
+struct DecodedTexture2D
+{
+	std::string filePath;
+	TextureFile *file;
+
+	// Set instead of file if there is a cooked compressed texture.
+	std::shared_ptr<KTXFile> compressed;
+
+	~DecodedTexture2D()
+	{
+		delete file;
+	}
+};
+
+template <>
+struct AssetAsyncLoader<Texture2D>
+{
+	using Intermediate = DecodedTexture2D;
+
+	static DecodedTexture2D *decode(const std::string& filePath)
+	{
+		std::shared_ptr<KTXFile> compressed{ Texture2D::decodeCompressed(filePath) };
+
+		if (compressed)
+		{
+			return new DecodedTexture2D{ filePath, nullptr, compressed };
+		}
+
+		return new DecodedTexture2D{ filePath, Texture2D::decode(filePath), nullptr };
+	}
+
+	static Texture2D *finalize(DecodedTexture2D *decoded)
+	{
+		Texture2D *texture = decoded->compressed
+			? new Texture2D{ decoded->filePath, decoded->compressed }
+			: new Texture2D{ decoded->filePath, decoded->file };
+
+		delete decoded;
+
+		return texture;
+	}
+};
+
+struct DecodedTextureCubeMap
+{
+	std::string fileNames[6];
+	TextureFile *files[6]{};
+
+	// Set instead of files if there is a cooked compressed cube map.
+	KTXFile *compressed{ nullptr };
+
+	~DecodedTextureCubeMap()
+	{
+		for (auto file : files)
+		{
+			delete file;
+		}
+
+		delete compressed;
+	}
+};
+
+template <>
+struct AssetAsyncLoader<TextureCubeMap>
+{
+	using Intermediate = DecodedTextureCubeMap;
+
+	static DecodedTextureCubeMap *decode(
+		const std::string& posXfile,
+		const std::string& negXfile,
+		const std::string& posYfile,
+		const std::string& negYfile,
+		const std::string& posZfile,
+		const std::string& negZfile)
+	{
+		DecodedTextureCubeMap *decoded = new DecodedTextureCubeMap{ { posXfile, negXfile, posYfile, negYfile, posZfile, negZfile } };
+
+		try
+		{
+			decoded->compressed = TextureCubeMap::decodeCompressed(decoded->fileNames);
+
+			for (unsigned int i = 0; i < 6 && !decoded->compressed; ++i)
+			{
+				decoded->files[i] = TextureCubeMap::decodeFace(decoded->fileNames[i]);
+			}
+		}
+		catch (...)
+		{
+			delete decoded;
+			throw;
+		}
+
+		return decoded;
+	}
+
+	static TextureCubeMap *finalize(DecodedTextureCubeMap *decoded)
+	{
+		TextureCubeMap *texture = decoded->compressed
+			? new TextureCubeMap{ decoded->fileNames, decoded->compressed }
+			: new TextureCubeMap{ decoded->fileNames, decoded->files };
+
+		delete decoded;
+
+		return texture;
+	}
+};
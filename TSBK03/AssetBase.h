@@ -8,4 +8,11 @@ public:
 	virtual ~AssetBase() {}
 
 	virtual void removeAsset(const std::string& assetID) = 0;
-};
+
+	// Called once per frame by the asset manager.
+	virtual void evict(unsigned long long frame) = 0;
+
+	// Reloads the evicted assets that have been fetched since the last call.
+	// Called once per frame by the asset manager, outside of rendering.
+	virtual void reloadEvicted() = 0;
+};
\ No newline at end of file
@@ -0,0 +1,214 @@
+#include "AssetCompression.h"
+
+#include <cstring>
+#include <cstdint>
+#include <stdexcept>
+
+#define MIN_MATCH 4
+#define MAX_OFFSET 65535
+#define HASH_BITS 16
+
+namespace
+{
+	uint32_t read32(
+		const unsigned char *p)
+	{
+		uint32_t value;
+		memcpy(&value, p, sizeof(value));
+		return value;
+	}
+
+	uint32_t hash(
+		uint32_t sequence)
+	{
+		return (sequence * 2654435761u) >> (32 - HASH_BITS);
+	}
+
+	void writeLength(
+		std::vector<unsigned char> &output,
+		size_t length)
+	{
+		while (length >= 255)
+		{
+			output.push_back(255);
+			length -= 255;
+		}
+
+		output.push_back(static_cast<unsigned char>(length));
+	}
+
+	void writeSequence(
+		std::vector<unsigned char> &output,
+		const unsigned char *literals,
+		size_t literalCount,
+		size_t offset,
+		size_t matchLength)
+	{
+		size_t matchCode = matchLength - MIN_MATCH;
+
+		unsigned char token = static_cast<unsigned char>(
+			((literalCount < 15 ? literalCount : 15) << 4) |
+			(matchLength == 0 ? 0 : (matchCode < 15 ? matchCode : 15)));
+
+		output.push_back(token);
+
+		if (literalCount >= 15)
+		{
+			writeLength(output, literalCount - 15);
+		}
+
+		output.insert(output.end(), literals, literals + literalCount);
+
+		// The last sequence carries no match.
+		if (matchLength == 0)
+		{
+			return;
+		}
+
+		output.push_back(static_cast<unsigned char>(offset & 0xFF));
+		output.push_back(static_cast<unsigned char>(offset >> 8));
+
+		if (matchCode >= 15)
+		{
+			writeLength(output, matchCode - 15);
+		}
+	}
+
+	size_t readLength(
+		const unsigned char *&ip,
+		const unsigned char *end,
+		size_t length)
+	{
+		if (length != 15)
+		{
+			return length;
+		}
+
+		unsigned char byte;
+
+		do
+		{
+			if (ip >= end)
+			{
+				throw std::invalid_argument("Compressed block is truncated.");
+			}
+
+			byte = *ip++;
+			length += byte;
+		} while (byte == 255);
+
+		return length;
+	}
+}
+
+std::vector<unsigned char> compressBlock(
+	const unsigned char *source,
+	size_t size)
+{
+	std::vector<unsigned char> output;
+	output.reserve(size / 2 + 16);
+
+	std::vector<int64_t> table(static_cast<size_t>(1) << HASH_BITS, -1);
+
+	size_t anchor = 0;
+	size_t i = 0;
+
+	while (i + MIN_MATCH <= size)
+	{
+		uint32_t sequence = read32(source + i);
+		uint32_t h = hash(sequence);
+
+		int64_t candidate = table[h];
+		table[h] = static_cast<int64_t>(i);
+
+		if (candidate >= 0 &&
+			i - static_cast<size_t>(candidate) <= MAX_OFFSET &&
+			read32(source + candidate) == sequence)
+		{
+			size_t match = static_cast<size_t>(candidate);
+			size_t length = MIN_MATCH;
+
+			while (i + length < size && source[match + length] == source[i + length])
+			{
+				++length;
+			}
+
+			writeSequence(output, source + anchor, i - anchor, i - match, length);
+
+			i += length;
+			anchor = i;
+		}
+		else
+		{
+			++i;
+		}
+	}
+
+	writeSequence(output, source + anchor, size - anchor, 0, 0);
+
+	return output;
+}
+
+void decompressBlock(
+	const unsigned char *source,
+	size_t size,
+	unsigned char *destination,
+	size_t decompressedSize)
+{
+	const unsigned char *ip = source;
+	const unsigned char *end = source + size;
+
+	unsigned char *op = destination;
+	unsigned char *opEnd = destination + decompressedSize;
+
+	while (ip < end)
+	{
+		unsigned char token = *ip++;
+
+		size_t literalCount = readLength(ip, end, token >> 4);
+
+		if (literalCount > static_cast<size_t>(end - ip) || literalCount > static_cast<size_t>(opEnd - op))
+		{
+			throw std::invalid_argument("Compressed block has too many literals.");
+		}
+
+		memcpy(op, ip, literalCount);
+		ip += literalCount;
+		op += literalCount;
+
+		if (ip >= end)
+		{
+			break;
+		}
+
+		if (end - ip < 2)
+		{
+			throw std::invalid_argument("Compressed block is truncated.");
+		}
+
+		size_t offset = ip[0] | (static_cast<size_t>(ip[1]) << 8);
+		ip += 2;
+
+		size_t matchLength = readLength(ip, end, token & 0x0F) + MIN_MATCH;
+
+		if (offset == 0 || offset > static_cast<size_t>(op - destination) || matchLength > static_cast<size_t>(opEnd - op))
+		{
+			throw std::invalid_argument("Compressed block has an invalid match.");
+		}
+
+		// Matches may overlap the bytes they produce, so copy forwards.
+		const unsigned char *match = op - offset;
+
+		for (size_t i = 0; i < matchLength; ++i)
+		{
+			op[i] = match[i];
+		}
+
+		op += matchLength;
+	}
+
+	if (op != opEnd)
+	{
+		throw std::invalid_argument("Compressed block has the wrong size.");
+	}
+}
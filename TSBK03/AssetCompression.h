@@ -0,0 +1,23 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+// Byte oriented LZ77 block codec for archive entries. The block layout
+// follows LZ4: each sequence is a token byte holding the literal count and
+// match length (minus four) in its high and low nibble, extended by 255-run
+// bytes when a nibble is 15, followed by the literals, a 16 bit little endian
+// match offset and the extended match length. The last sequence has literals
+// only. Decoding is a tight copy loop, which keeps it far cheaper than the
+// disk read it saves.
+std::vector<unsigned char> compressBlock(
+	const unsigned char *source,
+	size_t size);
+
+// Throws std::invalid_argument if the block is corrupt or does not decode
+// to exactly decompressedSize bytes.
+void decompressBlock(
+	const unsigned char *source,
+	size_t size,
+	unsigned char *destination,
+	size_t decompressedSize);
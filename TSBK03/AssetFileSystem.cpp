@@ -0,0 +1,177 @@
+#include "AssetFileSystem.h"
+#include "MappedFile.h"
+
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+// Modification time of a loose file, false if there is no such file.
+static bool getModificationTime(
+	const std::string &path,
+	time_t &time)
+{
+	struct stat info;
+
+	if (stat(path.c_str(), &info) != 0)
+	{
+		return false;
+	}
+
+	time = info.st_mtime;
+
+	return true;
+}
+
+std::vector<std::shared_ptr<AssetArchive>> AssetFileSystem::_archives{};
+std::mutex AssetFileSystem::_mutex{};
+std::atomic<bool> AssetFileSystem::_memoryMapping{ true };
+
+bool AssetFileSystem::mount(
+	const std::string &archivePath)
+{
+	std::shared_ptr<AssetArchive> archive;
+
+	try
+	{
+		archive = std::make_shared<AssetArchive>(archivePath);
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << "[ARCHIVE] " << e.what() << std::endl;
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock{ _mutex };
+
+	_archives.insert(_archives.begin(), archive);
+
+	return true;
+}
+
+void AssetFileSystem::unmountAll()
+{
+	std::lock_guard<std::mutex> lock{ _mutex };
+
+	_archives.clear();
+}
+
+AssetStream AssetFileSystem::open(
+	const std::string &path)
+{
+	for (const auto& archive : getArchives())
+	{
+		AssetStream stream = archive->open(path);
+
+		if (stream.isOpen())
+		{
+			return stream;
+		}
+	}
+
+	return openLooseFile(path);
+}
+
+bool AssetFileSystem::exists(
+	const std::string &path)
+{
+	for (const auto& archive : getArchives())
+	{
+		if (archive->contains(path))
+		{
+			return true;
+		}
+	}
+
+	return std::ifstream{ path }.good();
+}
+
+bool AssetFileSystem::isUpToDate(
+	const std::string &derivedPath,
+	const std::string &sourcePath)
+{
+	for (const auto& archive : getArchives())
+	{
+		if (archive->contains(derivedPath))
+		{
+			return true;
+		}
+	}
+
+	time_t derivedTime;
+	time_t sourceTime;
+
+	if (!getModificationTime(derivedPath, derivedTime))
+	{
+		return false;
+	}
+
+	return !getModificationTime(sourcePath, sourceTime) || derivedTime >= sourceTime;
+}
+
+void AssetFileSystem::setMemoryMapping(
+	bool enabled)
+{
+	_memoryMapping = enabled;
+}
+
+bool AssetFileSystem::getMemoryMapping()
+{
+	return _memoryMapping;
+}
+
+AssetStream AssetFileSystem::openLooseFile(
+	const std::string &path)
+{
+	if (_memoryMapping)
+	{
+		std::shared_ptr<MappedFile> mapping;
+
+		try
+		{
+			mapping = std::make_shared<MappedFile>(path);
+		}
+		catch (const std::invalid_argument&)
+		{
+			// Some files can not be mapped, e.g. on network drives. Those are
+			// read into a buffer instead.
+		}
+
+		if (mapping)
+		{
+			const unsigned char *data = mapping->getData();
+			size_t size = mapping->getSize();
+
+			return AssetStream{ path, std::move(mapping), data, size };
+		}
+	}
+
+	return readLooseFile(path);
+}
+
+AssetStream AssetFileSystem::readLooseFile(
+	const std::string &path)
+{
+	std::ifstream stream{ path, std::ios::binary | std::ios::ate };
+
+	if (!stream.is_open())
+	{
+		throw std::invalid_argument("File (" + path + ") could not be opened.");
+	}
+
+	std::vector<unsigned char> buffer(static_cast<size_t>(stream.tellg()));
+
+	stream.seekg(0, std::ios::beg);
+	stream.read(reinterpret_cast<char *>(buffer.data()), buffer.size());
+
+	return AssetStream{ path, std::move(buffer) };
+}
+
+std::vector<std::shared_ptr<AssetArchive>> AssetFileSystem::getArchives()
+{
+	std::lock_guard<std::mutex> lock{ _mutex };
+
+	return _archives;
+}
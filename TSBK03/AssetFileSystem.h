@@ -0,0 +1,49 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+
+#include "AssetStream.h"
+#include "AssetArchive.h"
+
+// Single entry point for reading asset files. Mounted archives are searched
+// first, most recently mounted first, and anything not found in an archive
+// is read from the loose file on disk. Loose files are memory mapped, with a
+// buffered read as fallback. Safe to use from the asset workers.
+class AssetFileSystem
+{
+public:
+	// Returns false if the archive could not be opened.
+	static bool mount(const std::string& archivePath);
+
+	static void unmountAll();
+
+	// Throws std::invalid_argument if the file exists nowhere.
+	static AssetStream open(const std::string& path);
+
+	static bool exists(const std::string& path);
+
+	// Whether a file derived from the source, e.g. a cooked model, is at least
+	// as new as the source. Files in archives and files whose source is
+	// missing count as up to date, missing derived files do not.
+	static bool isUpToDate(const std::string& derivedPath, const std::string& sourcePath);
+
+	// Loose files are read into a buffer when disabled.
+	static void setMemoryMapping(bool enabled);
+	static bool getMemoryMapping();
+
+private:
+
+	static AssetStream openLooseFile(const std::string& path);
+	static AssetStream readLooseFile(const std::string& path);
+
+	static std::vector<std::shared_ptr<AssetArchive>> getArchives();
+
+	static std::vector<std::shared_ptr<AssetArchive>> _archives;
+	static std::mutex _mutex;
+
+	static std::atomic<bool> _memoryMapping;
+};
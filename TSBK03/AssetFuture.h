@@ -0,0 +1,101 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <functional>
+
+enum class AssetStatus
+{
+	PENDING,
+	READY,
+	FAILED
+};
+
+// Shared between the AssetFuture handles and the loading job. The status may
+// be read from any thread, everything else is only touched on the main thread.
+template <typename T>
+struct AssetFutureState
+{
+	std::atomic<AssetStatus> status{ AssetStatus::PENDING };
+
+	T *asset{ nullptr };
+	T *placeholder{ nullptr };
+
+	std::vector<std::function<void(T *)>> callbacks{};
+
+	void resolve(T *loadedAsset)
+	{
+		asset = loadedAsset;
+		status = AssetStatus::READY;
+
+		for (auto& callback : callbacks)
+		{
+			callback(asset);
+		}
+
+		callbacks.clear();
+	}
+
+	void fail()
+	{
+		status = AssetStatus::FAILED;
+		callbacks.clear();
+	}
+};
+
+// Handle to an asset that is loaded in the background by
+// AssetManager::loadAsync. Until the asset is ready get() returns the
+// placeholder registered for the asset type.
+template <typename T>
+class AssetFuture
+{
+public:
+	AssetFuture() = default;
+
+	explicit AssetFuture(std::shared_ptr<AssetFutureState<T>> state)
+		: _state{ state }
+	{}
+
+	bool isReady() const
+	{
+		return _state && _state->status == AssetStatus::READY;
+	}
+
+	bool isFailed() const
+	{
+		return !_state || _state->status == AssetStatus::FAILED;
+	}
+
+	T *get() const
+	{
+		if (!_state)
+		{
+			return nullptr;
+		}
+
+		return isReady() ? _state->asset : _state->placeholder;
+	}
+
+	// The callback is invoked on the main thread once the asset has been
+	// uploaded, or immediately if it already has been.
+	void onReady(std::function<void(T *)> callback) const
+	{
+		if (!_state)
+		{
+			return;
+		}
+
+		if (isReady())
+		{
+			callback(_state->asset);
+		}
+		else if (!isFailed())
+		{
+			_state->callbacks.push_back(callback);
+		}
+	}
+
+private:
+	std::shared_ptr<AssetFutureState<T>> _state{};
+};
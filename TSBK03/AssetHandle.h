@@ -0,0 +1,20 @@
+#pragma once
+
+#include <limits>
+
+// Typed reference to a slot in an AssetPool. Resolving a handle is an array
+// index, unlike fetching by asset ID. The generation is bumped whenever the
+// asset in the slot is disposed, which makes older handles stale.
+template <typename T>
+struct AssetHandle
+{
+	static constexpr unsigned int INVALID_INDEX = std::numeric_limits<unsigned int>::max();
+
+	unsigned int index{ INVALID_INDEX };
+	unsigned int generation{ 0 };
+
+	bool isNull() const
+	{
+		return index == INVALID_INDEX;
+	}
+};
@@ -0,0 +1,117 @@
+#include "AssetIOSystem.h"
+
+#include "AssetFileSystem.h"
+
+#include <cstring>
+#include <stdexcept>
+
+AssetIOStream::AssetIOStream(
+	AssetStream &&stream)
+	: _stream{ std::move(stream) }
+{}
+
+size_t AssetIOStream::Read(
+	void *buffer,
+	size_t size,
+	size_t count)
+{
+	if (size == 0)
+	{
+		return 0;
+	}
+
+	// Like fread, only whole elements are read.
+	size_t available = (_stream.getSize() - _stream.tell()) / size;
+
+	if (count > available)
+	{
+		count = available;
+	}
+
+	return _stream.read(buffer, size * count) / size;
+}
+
+size_t AssetIOStream::Write(
+	const void * /*buffer*/,
+	size_t /*size*/,
+	size_t /*count*/)
+{
+	// Assets are read only.
+	return 0;
+}
+
+aiReturn AssetIOStream::Seek(
+	size_t offset,
+	aiOrigin origin)
+{
+	size_t position;
+
+	switch (origin)
+	{
+	case aiOrigin_SET:
+		position = offset;
+		break;
+	case aiOrigin_CUR:
+		position = _stream.tell() + offset;
+		break;
+	case aiOrigin_END:
+		// The offset is negative for aiOrigin_END.
+		position = _stream.getSize() + offset;
+		break;
+	default:
+		return aiReturn_FAILURE;
+	}
+
+	return _stream.seek(position) ? aiReturn_SUCCESS : aiReturn_FAILURE;
+}
+
+size_t AssetIOStream::Tell() const
+{
+	return _stream.tell();
+}
+
+size_t AssetIOStream::FileSize() const
+{
+	return _stream.getSize();
+}
+
+void AssetIOStream::Flush()
+{
+}
+
+bool AssetIOSystem::Exists(
+	const char *file) const
+{
+	return AssetFileSystem::exists(file);
+}
+
+char AssetIOSystem::getOsSeparator() const
+{
+	return '/';
+}
+
+Assimp::IOStream * AssetIOSystem::Open(
+	const char *file,
+	const char *mode)
+{
+	// Assets are read only.
+	if (strchr(mode, 'w') != nullptr || strchr(mode, 'a') != nullptr)
+	{
+		return nullptr;
+	}
+
+	try
+	{
+		return new AssetIOStream{ AssetFileSystem::open(file) };
+	}
+	catch (const std::invalid_argument&)
+	{
+		return nullptr;
+	}
+}
+
+void AssetIOSystem::Close(
+	Assimp::IOStream *file)
+{
+	delete file;
+}
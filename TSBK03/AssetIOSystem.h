@@ -0,0 +1,39 @@
+#pragma once
+
+#include <assimp/IOSystem.hpp>
+#include <assimp/IOStream.hpp>
+
+#include "AssetStream.h"
+
+// Lets Assimp read models, and the material files they refer to, through
+// the AssetFileSystem so that they can be served from an archive.
+class AssetIOStream : public Assimp::IOStream
+{
+public:
+	explicit AssetIOStream(AssetStream&& stream);
+
+	size_t Read(void *buffer, size_t size, size_t count) override;
+	size_t Write(const void *buffer, size_t size, size_t count) override;
+
+	aiReturn Seek(size_t offset, aiOrigin origin) override;
+
+	size_t Tell() const override;
+	size_t FileSize() const override;
+
+	void Flush() override;
+
+private:
+	AssetStream _stream;
+};
+
+class AssetIOSystem : public Assimp::IOSystem
+{
+public:
+	bool Exists(const char *file) const override;
+
+	char getOsSeparator() const override;
+
+	Assimp::IOStream *Open(const char *file, const char *mode = "rb") override;
+
+	void Close(Assimp::IOStream *file) override;
+};
@@ -3,6 +3,8 @@
 #include "Texture.h"
 #include "Terrain.h"
 
+#include <atomic>
+
 AssetManager::AssetManager()
 {
 	registerAsset<Model>();
@@ -13,8 +15,59 @@ AssetManager::AssetManager()
 
 AssetManager::~AssetManager()
 {
+	// Make sure no worker is still decoding into the pools.
+	_workers.shutdown();
+
 	for(auto it : _assets)
 	{
-		delete it.second;
+		delete it;
+	}
+}
+
+void AssetManager::update(
+	float budgetMs)
+{
+	// Types that were never registered leave gaps.
+	for (auto it : _assets)
+	{
+		if (it != nullptr)
+		{
+			it->reloadEvicted();
+		}
 	}
+
+	_workers.runFinalizers(budgetMs);
+
+	++_frame;
+
+	for (auto it : _assets)
+	{
+		if (it != nullptr)
+		{
+			it->evict(_frame);
+		}
+	}
+}
+
+void AssetManager::waitForAll()
+{
+	_workers.waitForAll();
+}
+
+unsigned int AssetManager::getNumPending() const
+{
+	return _workers.getNumPending();
+}
+
+unsigned int AssetManager::allocateTypeIndex()
+{
+	static std::atomic<unsigned int> nextTypeIndex{ 0 };
+
+	return nextTypeIndex++;
+}
+
+void AssetManager::setProfiler(
+	Profiler *profiler)
+{
+	_workers.setProfiler(profiler);
 }
@@ -1,13 +1,21 @@
 #pragma once
 
 #include <string>
-#include <map>
-#include <typeindex>
+#include <vector>
+#include <iostream>
 
 #include "AssetPool.h"
+#include "AssetRef.h"
+#include "AssetFuture.h"
+#include "AssetWorkerPool.h"
 
 // TODO: Load asset from file
 
+// Specialized in AssetAsyncLoader.h, which has to be included where
+// loadAsync is used.
+template <typename T>
+struct AssetAsyncLoader;
+
 class AssetManager
 {
 public:
@@ -23,15 +31,76 @@ public:
 	template <typename T, typename ... Args>
 	T *load(const std::string& assetID, Args ... args);
 
+	// Decodes the asset on a worker thread and uploads it on the main thread
+	// during update(). Until then fetch returns the placeholder of the type.
+	// Requires an AssetAsyncLoader specialization for T.
+	template <typename T, typename ... Args>
+	AssetFuture<T> loadAsync(const std::string& assetID, Args ... args);
+
+	// Reloads the evicted assets fetched since the last update, finishes
+	// asynchronously loaded assets and evicts assets from pools that are over
+	// budget. Must be called on the main thread once per frame.
+	void update(float budgetMs);
+
+	// Blocks until every asynchronously loaded asset is finished.
+	void waitForAll();
+
+	unsigned int getNumPending() const;
+
+	// Adds the jobs of the worker threads to the captures of the profiler.
+	void setProfiler(Profiler *profiler);
+
+	template <typename T>
+	bool isLoaded(const std::string& assetID) const;
+
+	// Same as above for a resolved reference, without the lookup by asset ID.
+	template <typename T>
+	bool isLoaded(const AssetRef<T>& ref) const;
+
+	template <typename T>
+	void setPlaceholder(T *placeholder);
+
+	// Shares an asset that has already been loaded as the placeholder.
+	template <typename T>
+	void setPlaceholder(const std::string& assetID);
+
+	// Returns a reference that keeps the asset from being evicted.
+	template <typename T>
+	AssetRef<T> acquire(const std::string& assetID);
+
+	// Unreferenced assets loaded with load or loadAsync are evicted, least
+	// recently used first, when the pool goes over budget. They are reloaded
+	// the next time they are fetched. A budget of zero means no limit.
+	template <typename T>
+	void setBudget(size_t cpuBytes, size_t gpuBytes);
+
 	template <typename T>
 	void store(const std::string& assetID, T *assetPtr);
 
 	template <typename T>
 	void store(const std::string& assetID, T& assetRef);
 
+	// Looks the asset up by ID. Meant for setup and tooling, per-frame code
+	// should keep an AssetHandle instead.
 	template <typename T>
 	T *fetch(const std::string& assetID) const;
 
+	template <typename T>
+	AssetHandle<T> getHandle(const std::string& assetID);
+
+	template <typename T>
+	T *fetch(AssetHandle<T> handle) const;
+
+	// Fetches through the handle, looking it up by ID first if it is null or
+	// has gone stale.
+	template <typename T>
+	T *resolve(AssetHandle<T>& handle, const std::string& assetID);
+
+	// Same as above, but the reference also keeps the asset from being
+	// evicted while it is held, e.g. by a scene node.
+	template <typename T>
+	T *resolve(AssetRef<T>& ref, const std::string& assetID);
+
 	template <typename T>
 	void dispose(const std::string& assetID);
 
@@ -42,7 +111,19 @@ public:
 	AssetPool<T> *getPool() const;
 private:
 
-	std::map<size_t, AssetBase *> _assets{};
+	// Dense index per asset type, used to find the pool without hashing.
+	template <typename T>
+	static unsigned int getTypeIndex();
+
+	// Shared by every instantiation of getTypeIndex, defined once in
+	// AssetManager.cpp.
+	static unsigned int allocateTypeIndex();
+
+	std::vector<AssetBase *> _assets{};
+
+	unsigned long long _frame{ 0 };
+
+	AssetWorkerPool _workers{};
 };
 
 #include "AssetManager.inl"
\ No newline at end of file
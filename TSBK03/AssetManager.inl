@@ -5,7 +5,137 @@ T *AssetManager::load(
 {
 	AssetPool<T> *pool = getPool<T>();
 
-	return pool->loadAsset(assetID, std::forward<Args>(args)...);
+	// Passed as copies, since the reloader below needs them after loading.
+	T *asset = pool->loadAsset(assetID, args...);
+
+	pool->setReloader(assetID, [pool, assetID, args...]()
+	{
+		pool->loadAsset(assetID, args...);
+	});
+
+	return asset;
+}
+
+template <typename T, typename ... Args>
+AssetFuture<T> AssetManager::loadAsync(
+	const std::string &assetID,
+	Args... args)
+{
+	using Loader = AssetAsyncLoader<T>;
+	using Intermediate = typename Loader::Intermediate;
+
+	AssetPool<T> *pool = getPool<T>();
+
+	auto state = std::make_shared<AssetFutureState<T>>();
+	state->placeholder = pool->getPlaceholder();
+
+	pool->markPending(assetID);
+
+	pool->setReloader(assetID, [this, assetID, args...]()
+	{
+		loadAsync<T>(assetID, args...);
+	});
+
+	AssetWorkerPool *workers = &_workers;
+
+	_workers.enqueue([workers, pool, state, assetID, args...]()
+	{
+		Intermediate *decoded{ nullptr };
+		std::string error{};
+
+		try
+		{
+			decoded = Loader::decode(args...);
+		}
+		catch (const std::exception& e)
+		{
+			error = e.what();
+		}
+
+		workers->finalize([pool, state, assetID, decoded, error]()
+		{
+			pool->clearPending(assetID);
+
+			if (decoded == nullptr)
+			{
+				std::cerr << "[ASSET] Failed to load " << assetID << ": " << error << std::endl;
+
+				// Don't retry on every fetch.
+				pool->setReloader(assetID, nullptr);
+
+				state->fail();
+				return;
+			}
+
+			T *asset = Loader::finalize(decoded);
+
+			pool->storeAsset(assetID, asset);
+			state->resolve(asset);
+		},
+		[decoded]()
+		{
+			delete decoded;
+		});
+	});
+
+	return AssetFuture<T>{ state };
+}
+
+template <typename T>
+bool AssetManager::isLoaded(
+	const std::string &assetID) const
+{
+	AssetPool<T> *pool = getPool<T>();
+
+	T *asset = pool->fetchAsset(assetID);
+
+	return asset != nullptr && !pool->isPending(assetID);
+}
+
+template <typename T>
+bool AssetManager::isLoaded(
+	const AssetRef<T> &ref) const
+{
+	AssetPool<T> *pool = getPool<T>();
+
+	return pool->isLoaded(ref.getHandle());
+}
+
+template <typename T>
+void AssetManager::setPlaceholder(
+	T *placeholder)
+{
+	AssetPool<T> *pool = getPool<T>();
+
+	pool->setPlaceholder(placeholder);
+}
+
+template <typename T>
+void AssetManager::setPlaceholder(
+	const std::string &assetID)
+{
+	AssetPool<T> *pool = getPool<T>();
+
+	pool->setPlaceholder(assetID);
+}
+
+template <typename T>
+AssetRef<T> AssetManager::acquire(
+	const std::string &assetID)
+{
+	AssetPool<T> *pool = getPool<T>();
+
+	return AssetRef<T>{ pool, pool->getHandle(assetID) };
+}
+
+template <typename T>
+void AssetManager::setBudget(
+	size_t cpuBytes,
+	size_t gpuBytes)
+{
+	AssetPool<T> *pool = getPool<T>();
+
+	pool->setBudget(cpuBytes, gpuBytes);
 }
 
 template <typename T>
@@ -37,6 +167,54 @@ T * AssetManager::fetch(
 	return pool->fetchAsset(assetID);
 }
 
+template <typename T>
+AssetHandle<T> AssetManager::getHandle(
+	const std::string &assetID)
+{
+	AssetPool<T> *pool = getPool<T>();
+
+	return pool->getHandle(assetID);
+}
+
+template <typename T>
+T * AssetManager::fetch(
+	AssetHandle<T> handle) const
+{
+	AssetPool<T> *pool = getPool<T>();
+
+	return pool->fetchAsset(handle);
+}
+
+template <typename T>
+T * AssetManager::resolve(
+	AssetHandle<T> &handle,
+	const std::string &assetID)
+{
+	AssetPool<T> *pool = getPool<T>();
+
+	if (!pool->isValid(handle))
+	{
+		handle = pool->getHandle(assetID);
+	}
+
+	return pool->fetchAsset(handle);
+}
+
+template <typename T>
+T * AssetManager::resolve(
+	AssetRef<T> &ref,
+	const std::string &assetID)
+{
+	AssetPool<T> *pool = getPool<T>();
+
+	if (!pool->isValid(ref.getHandle()))
+	{
+		ref = AssetRef<T>{ pool, pool->getHandle(assetID) };
+	}
+
+	return ref.get();
+}
+
 template <typename T>
 void AssetManager::dispose(
 	const std::string &assetID)
@@ -49,29 +227,36 @@ void AssetManager::dispose(
 template <typename T>
 void AssetManager::registerAsset()
 {
-	size_t id = std::type_index{ typeid(T) }.hash_code();
+	unsigned int index = getTypeIndex<T>();
 
-	auto it = _assets.find(id);
+	if (index >= _assets.size())
+	{
+		_assets.resize(index + 1, nullptr);
+	}
 
-	if (it == _assets.end())
+	if (_assets[index] == nullptr)
 	{
-		_assets.emplace(id, new AssetPool<T>{});
+		_assets[index] = new AssetPool<T>{};
 	}
 }
 
 template <typename T>
 AssetPool<T> * AssetManager::getPool() const
 {
-	size_t id = std::type_index{ typeid(T) }.hash_code();
-
-	auto it = _assets.find(id);
+	unsigned int index = getTypeIndex<T>();
 
-	if (it == _assets.end())
+	if (index >= _assets.size())
 	{
 		return nullptr;
 	}
 
-	AssetPool<T> *pool = dynamic_cast<AssetPool<T> *>(it->second);
+	return static_cast<AssetPool<T> *>(_assets[index]);
+}
+
+template <typename T>
+unsigned int AssetManager::getTypeIndex()
+{
+	static unsigned int index = allocateTypeIndex();
 
-	return pool;
+	return index;
 }
@@ -1,11 +1,43 @@
 #pragma once
 
 #include "AssetBase.h"
+#include "AssetHandle.h"
 
 #include <string>
 #include <map>
+#include <set>
+#include <vector>
+#include <functional>
 #include <typeindex>
 
+template <typename T>
+struct AssetSlot
+{
+	T *asset{ nullptr };
+
+	unsigned int generation{ 0 };
+
+	bool pending{ false };
+
+	// Number of AssetRefs holding on to the slot. Referenced assets are
+	// never evicted.
+	unsigned int refCount{ 0 };
+
+	// Frame in which the asset was last fetched
+	unsigned long long lastUsed{ 0 };
+
+	size_t cpuBytes{ 0 };
+	size_t gpuBytes{ 0 };
+
+	// Loads the asset again after it has been evicted. Assets without a
+	// reloader are never evicted.
+	std::function<void()> reload{};
+
+	// Fetched after being evicted. The placeholder is returned until the
+	// asset manager reloads it.
+	bool reloadRequested{ false };
+};
+
 template <typename T>
 class AssetPool : public AssetBase
 {
@@ -22,7 +54,27 @@ public:
 
 	void removeAsset(const std::string& assetID) override;
 
-	T *fetchAsset(const std::string& assetID) const;
+	// Evicts the least recently used unreferenced assets until the pool is
+	// within its budget.
+	void evict(unsigned long long frame) override;
+
+	void reloadEvicted() override;
+
+	T *fetchAsset(const std::string& assetID);
+
+	// Returns a handle to the slot of the asset, creating an empty slot if the
+	// asset has not been loaded yet.
+	AssetHandle<T> getHandle(const std::string& assetID);
+
+	// Returns nullptr if the handle is stale, and the placeholder if the asset
+	// is still being loaded. An evicted asset is reloaded by the next
+	// reloadEvicted, so fetching never loads in the middle of a frame.
+	T *fetchAsset(AssetHandle<T> handle);
+
+	bool isValid(AssetHandle<T> handle) const;
+
+	// False while the asset is pending or evicted, or if the handle is stale.
+	bool isLoaded(AssetHandle<T> handle) const;
 
 	template <typename ... Args>
 	T *loadAsset(const std::string& assetID, Args ... args);
@@ -32,8 +84,70 @@ public:
 
 	const std::map<std::string, T *>& getAssets() const;
 
+	// Assets that are being loaded asynchronously or wait to be reloaded.
+	// Fetching a pending asset returns the placeholder.
+	void markPending(const std::string& assetID);
+	void clearPending(const std::string& assetID);
+	bool isPending(const std::string& assetID) const;
+
+	// The pool takes ownership of the placeholder.
+	void setPlaceholder(T *placeholder);
+
+	// Uses an asset already stored in the pool as the placeholder. The asset
+	// is referenced so that it is never evicted.
+	void setPlaceholder(const std::string& assetID);
+	T *getPlaceholder() const;
+
+	void acquire(AssetHandle<T> handle);
+	void release(AssetHandle<T> handle);
+
+	void setReloader(const std::string& assetID, std::function<void()> reload);
+
+	// A budget of zero means no limit.
+	void setBudget(size_t cpuBytes, size_t gpuBytes);
+
+	size_t getCPUBudget() const;
+	size_t getGPUBudget() const;
+
+	size_t getCPUMemoryUsage() const;
+	size_t getGPUMemoryUsage() const;
+
+	unsigned int getNumEvicted() const;
+
 private:
+
+	AssetSlot<T>& getSlot(const std::string& assetID);
+
+	void setSlotAsset(const std::string& assetID, T *assetPtr);
+
+	void clearSlotAsset(AssetSlot<T>& slot);
+
+	// The memory use of assets changes after they are stored, e.g. when
+	// their meshes are uploaded or their mips are streamed in.
+	void updateMemoryUsage();
+
+	bool isOverBudget() const;
+
+	// Lookup by asset ID. Only used when resolving handles and by tooling.
 	std::map<std::string, T *> _assets{};
+
+	std::vector<AssetSlot<T>> _slots{};
+	std::map<std::string, unsigned int> _slotIndices{};
+
+	std::set<std::string> _pending{};
+
+	T *_placeholder{ nullptr };
+	bool _ownsPlaceholder{ false };
+
+	unsigned long long _frame{ 0 };
+
+	size_t _cpuBudget{ 0 };
+	size_t _gpuBudget{ 0 };
+
+	size_t _cpuMemoryUsage{ 0 };
+	size_t _gpuMemoryUsage{ 0 };
+
+	unsigned int _numEvicted{ 0 };
 };
 
 #include "AssetPool.inl"
\ No newline at end of file
@@ -1,5 +1,3 @@
-
-
 template <typename T>
 AssetPool<T>::~AssetPool()
 {
@@ -7,35 +5,172 @@ AssetPool<T>::~AssetPool()
 	{
 		delete it.second;
 	}
+
+	if (_ownsPlaceholder)
+	{
+		delete _placeholder;
+	}
 }
 
 template <typename T>
 void AssetPool<T>::removeAsset(
 	const std::string &assetID)
 {
-	auto it = _assets.find(assetID);
+	auto it = _slotIndices.find(assetID);
 
-	if (it == _assets.end())
+	if (it == _slotIndices.end())
 	{
 		return;
 	}
 
-	delete it->second;
-	_assets.erase(it);
+	AssetSlot<T>& slot = _slots[it->second];
+
+	if (!_ownsPlaceholder && slot.asset == _placeholder)
+	{
+		_placeholder = nullptr;
+	}
+
+	clearSlotAsset(slot);
+
+	slot.reload = nullptr;
+	slot.reloadRequested = false;
+	slot.refCount = 0;
+	++slot.generation;
+}
+
+template <typename T>
+void AssetPool<T>::evict(
+	unsigned long long frame)
+{
+	_frame = frame;
+
+	updateMemoryUsage();
+
+	while (isOverBudget())
+	{
+		AssetSlot<T> *oldest{ nullptr };
+
+		for (auto& slot : _slots)
+		{
+			// Keep anything used during this or the previous frame.
+			if (slot.asset == nullptr ||
+				slot.pending ||
+				slot.refCount > 0 ||
+				!slot.reload ||
+				slot.lastUsed + 1 >= frame)
+			{
+				continue;
+			}
+
+			if (oldest == nullptr || slot.lastUsed < oldest->lastUsed)
+			{
+				oldest = &slot;
+			}
+		}
+
+		if (oldest == nullptr)
+		{
+			break;
+		}
+
+		clearSlotAsset(*oldest);
+
+		++_numEvicted;
+	}
+}
+
+template <typename T>
+void AssetPool<T>::reloadEvicted()
+{
+	// By index, since reloading may add slots.
+	for (size_t i = 0; i < _slots.size(); ++i)
+	{
+		if (!_slots[i].reloadRequested)
+		{
+			continue;
+		}
+
+		_slots[i].reloadRequested = false;
+
+		if (_slots[i].asset == nullptr && !_slots[i].pending && _slots[i].reload)
+		{
+			// The reloader may replace itself, so call a copy of it.
+			std::function<void()> reload = _slots[i].reload;
+
+			reload();
+		}
+	}
 }
 
 template <typename T>
 T * AssetPool<T>::fetchAsset(
-	const std::string &assetID) const
+	const std::string &assetID)
 {
-	auto it = _assets.find(assetID);
+	auto it = _slotIndices.find(assetID);
 
-	if (it == _assets.end())
+	if (it == _slotIndices.end())
 	{
 		return nullptr;
 	}
 
-	return it->second;
+	AssetHandle<T> handle;
+	handle.index = it->second;
+	handle.generation = _slots[it->second].generation;
+
+	return fetchAsset(handle);
+}
+
+template <typename T>
+AssetHandle<T> AssetPool<T>::getHandle(
+	const std::string &assetID)
+{
+	AssetSlot<T>& slot = getSlot(assetID);
+
+	AssetHandle<T> handle;
+	handle.index = _slotIndices.at(assetID);
+	handle.generation = slot.generation;
+
+	return handle;
+}
+
+template <typename T>
+T * AssetPool<T>::fetchAsset(
+	AssetHandle<T> handle)
+{
+	if (!isValid(handle))
+	{
+		return nullptr;
+	}
+
+	AssetSlot<T>& slot = _slots[handle.index];
+
+	if (slot.asset == nullptr && !slot.pending && slot.reload)
+	{
+		slot.reloadRequested = true;
+	}
+
+	slot.lastUsed = _frame;
+
+	if (slot.asset == nullptr && (slot.pending || slot.reloadRequested))
+	{
+		return _placeholder;
+	}
+
+	return slot.asset;
+}
+
+template <typename T>
+bool AssetPool<T>::isValid(
+	AssetHandle<T> handle) const
+{
+	return handle.index < _slots.size() && _slots[handle.index].generation == handle.generation;
+}
+
+template <typename T>
+bool AssetPool<T>::isLoaded(
+	AssetHandle<T> handle) const
+{
+	return isValid(handle) && _slots[handle.index].asset != nullptr && !_slots[handle.index].pending;
 }
 
 template <typename T>
@@ -46,7 +181,7 @@ T *AssetPool<T>::loadAsset(
 {
 	T *ret = new T(std::forward<Args>(args)...);
 
-	_assets.emplace(assetID, ret);
+	setSlotAsset(assetID, ret);
 
 	return ret;
 }
@@ -56,7 +191,7 @@ void AssetPool<T>::storeAsset(
 	const std::string &assetID,
 	T *assetPtr)
 {
-	_assets.emplace(assetID, assetPtr);
+	setSlotAsset(assetID, assetPtr);
 }
 
 template <typename T>
@@ -64,7 +199,7 @@ void AssetPool<T>::storeAsset(
 	const std::string &assetID,
 	T &assetRef)
 {
-	_assets.emplace(assetID, &assetRef);
+	setSlotAsset(assetID, &assetRef);
 }
 
 template <typename T>
@@ -72,3 +207,233 @@ const std::map<std::string, T *> & AssetPool<T>::getAssets() const
 {
 	return _assets;
 }
+
+template <typename T>
+void AssetPool<T>::markPending(
+	const std::string &assetID)
+{
+	_pending.insert(assetID);
+
+	getSlot(assetID).pending = true;
+}
+
+template <typename T>
+void AssetPool<T>::clearPending(
+	const std::string &assetID)
+{
+	_pending.erase(assetID);
+
+	getSlot(assetID).pending = false;
+}
+
+template <typename T>
+bool AssetPool<T>::isPending(
+	const std::string &assetID) const
+{
+	if (_pending.find(assetID) != _pending.end())
+	{
+		return true;
+	}
+
+	// Evicted assets waiting to be reloaded also show the placeholder.
+	auto it = _slotIndices.find(assetID);
+
+	return it != _slotIndices.end() && _slots[it->second].reloadRequested;
+}
+
+template <typename T>
+void AssetPool<T>::setPlaceholder(
+	T *placeholder)
+{
+	if (_ownsPlaceholder)
+	{
+		delete _placeholder;
+	}
+
+	_placeholder = placeholder;
+	_ownsPlaceholder = true;
+}
+
+template <typename T>
+void AssetPool<T>::setPlaceholder(
+	const std::string &assetID)
+{
+	if (_ownsPlaceholder)
+	{
+		delete _placeholder;
+	}
+
+	AssetHandle<T> handle = getHandle(assetID);
+
+	acquire(handle);
+
+	_placeholder = fetchAsset(handle);
+	_ownsPlaceholder = false;
+}
+
+template <typename T>
+T * AssetPool<T>::getPlaceholder() const
+{
+	return _placeholder;
+}
+
+template <typename T>
+void AssetPool<T>::acquire(
+	AssetHandle<T> handle)
+{
+	if (isValid(handle))
+	{
+		++_slots[handle.index].refCount;
+	}
+}
+
+template <typename T>
+void AssetPool<T>::release(
+	AssetHandle<T> handle)
+{
+	if (isValid(handle) && _slots[handle.index].refCount > 0)
+	{
+		--_slots[handle.index].refCount;
+	}
+}
+
+template <typename T>
+void AssetPool<T>::setReloader(
+	const std::string &assetID,
+	std::function<void()> reload)
+{
+	getSlot(assetID).reload = reload;
+}
+
+template <typename T>
+void AssetPool<T>::setBudget(
+	size_t cpuBytes,
+	size_t gpuBytes)
+{
+	_cpuBudget = cpuBytes;
+	_gpuBudget = gpuBytes;
+}
+
+template <typename T>
+size_t AssetPool<T>::getCPUBudget() const
+{
+	return _cpuBudget;
+}
+
+template <typename T>
+size_t AssetPool<T>::getGPUBudget() const
+{
+	return _gpuBudget;
+}
+
+template <typename T>
+size_t AssetPool<T>::getCPUMemoryUsage() const
+{
+	return _cpuMemoryUsage;
+}
+
+template <typename T>
+size_t AssetPool<T>::getGPUMemoryUsage() const
+{
+	return _gpuMemoryUsage;
+}
+
+template <typename T>
+unsigned int AssetPool<T>::getNumEvicted() const
+{
+	return _numEvicted;
+}
+
+template <typename T>
+AssetSlot<T> & AssetPool<T>::getSlot(
+	const std::string &assetID)
+{
+	auto it = _slotIndices.find(assetID);
+
+	if (it != _slotIndices.end())
+	{
+		return _slots[it->second];
+	}
+
+	_slotIndices.emplace(assetID, static_cast<unsigned int>(_slots.size()));
+	_slots.emplace_back();
+
+	return _slots.back();
+}
+
+template <typename T>
+void AssetPool<T>::setSlotAsset(
+	const std::string &assetID,
+	T *assetPtr)
+{
+	// An asset that is already stored under the ID is kept.
+	if (!_assets.emplace(assetID, assetPtr).second)
+	{
+		return;
+	}
+
+	AssetSlot<T>& slot = getSlot(assetID);
+
+	slot.asset = assetPtr;
+	slot.lastUsed = _frame;
+	slot.cpuBytes = assetPtr->getCPUMemoryUsage();
+	slot.gpuBytes = assetPtr->getGPUMemoryUsage();
+
+	_cpuMemoryUsage += slot.cpuBytes;
+	_gpuMemoryUsage += slot.gpuBytes;
+}
+
+template <typename T>
+void AssetPool<T>::clearSlotAsset(
+	AssetSlot<T> &slot)
+{
+	if (slot.asset == nullptr)
+	{
+		return;
+	}
+
+	for (auto it = _assets.begin(); it != _assets.end(); ++it)
+	{
+		if (it->second == slot.asset)
+		{
+			_assets.erase(it);
+			break;
+		}
+	}
+
+	delete slot.asset;
+	slot.asset = nullptr;
+
+	_cpuMemoryUsage -= slot.cpuBytes;
+	_gpuMemoryUsage -= slot.gpuBytes;
+
+	slot.cpuBytes = 0;
+	slot.gpuBytes = 0;
+}
+
+template <typename T>
+void AssetPool<T>::updateMemoryUsage()
+{
+	_cpuMemoryUsage = 0;
+	_gpuMemoryUsage = 0;
+
+	for (auto& slot : _slots)
+	{
+		if (slot.asset != nullptr)
+		{
+			slot.cpuBytes = slot.asset->getCPUMemoryUsage();
+			slot.gpuBytes = slot.asset->getGPUMemoryUsage();
+		}
+
+		_cpuMemoryUsage += slot.cpuBytes;
+		_gpuMemoryUsage += slot.gpuBytes;
+	}
+}
+
+template <typename T>
+bool AssetPool<T>::isOverBudget() const
+{
+	return
+		(_cpuBudget > 0 && _cpuMemoryUsage > _cpuBudget) ||
+		(_gpuBudget > 0 && _gpuMemoryUsage > _gpuBudget);
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "AssetPool.h"
+
+// Counted reference to an asset. While at least one AssetRef to an asset
+// exists the asset is never evicted. Assets that are changed after loading
+// should be held through an AssetRef, since eviction reloads them from disk.
+template <typename T>
+class AssetRef
+{
+public:
+	AssetRef() = default;
+
+	AssetRef(AssetPool<T> *pool, AssetHandle<T> handle)
+		: _pool{ pool }, _handle{ handle }
+	{
+		acquire();
+	}
+
+	AssetRef(const AssetRef& other)
+		: _pool{ other._pool }, _handle{ other._handle }
+	{
+		acquire();
+	}
+
+	AssetRef(AssetRef&& other) noexcept
+		: _pool{ other._pool }, _handle{ other._handle }
+	{
+		other._pool = nullptr;
+	}
+
+	AssetRef& operator=(const AssetRef& other)
+	{
+		if (this != &other)
+		{
+			release();
+
+			_pool = other._pool;
+			_handle = other._handle;
+
+			acquire();
+		}
+
+		return *this;
+	}
+
+	AssetRef& operator=(AssetRef&& other) noexcept
+	{
+		if (this != &other)
+		{
+			release();
+
+			_pool = other._pool;
+			_handle = other._handle;
+
+			other._pool = nullptr;
+		}
+
+		return *this;
+	}
+
+	~AssetRef()
+	{
+		release();
+	}
+
+	T *get() const
+	{
+		return _pool != nullptr ? _pool->fetchAsset(_handle) : nullptr;
+	}
+
+	AssetHandle<T> getHandle() const
+	{
+		return _handle;
+	}
+
+private:
+
+	void acquire()
+	{
+		if (_pool != nullptr)
+		{
+			_pool->acquire(_handle);
+		}
+	}
+
+	void release()
+	{
+		if (_pool != nullptr)
+		{
+			_pool->release(_handle);
+			_pool = nullptr;
+		}
+	}
+
+	AssetPool<T> *_pool{ nullptr };
+	AssetHandle<T> _handle{};
+};
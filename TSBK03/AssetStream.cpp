@@ -0,0 +1,105 @@
+#include "AssetStream.h"
+
+#include "MappedFile.h"
+
+#include <cstring>
+#include <algorithm>
+
+AssetStream::AssetStream(
+	const std::string &name,
+	std::shared_ptr<const MappedFile> mapping,
+	const unsigned char *data,
+	size_t size)
+	: _name{ name },
+	_mapping{ mapping },
+	_data{ data },
+	_size{ size },
+	_open{ true }
+{}
+
+AssetStream::AssetStream(
+	const std::string &name,
+	std::vector<unsigned char> &&buffer)
+	: _name{ name },
+	_buffer{ std::move(buffer) },
+	_open{ true }
+{
+	_data = _buffer.data();
+	_size = _buffer.size();
+}
+
+bool AssetStream::isOpen() const
+{
+	return _open;
+}
+
+size_t AssetStream::read(
+	void *destination,
+	size_t size)
+{
+	size_t count = std::min(size, _size - _position);
+
+	if (count > 0)
+	{
+		memcpy(destination, _data + _position, count);
+	}
+
+	_position += count;
+
+	return count;
+}
+
+bool AssetStream::seek(
+	size_t position)
+{
+	if (position > _size)
+	{
+		_position = _size;
+		return false;
+	}
+
+	_position = position;
+
+	return true;
+}
+
+bool AssetStream::skip(
+	size_t size)
+{
+	return seek(_position + size);
+}
+
+size_t AssetStream::tell() const
+{
+	return _position;
+}
+
+bool AssetStream::eof() const
+{
+	return _position >= _size;
+}
+
+size_t AssetStream::getSize() const
+{
+	return _size;
+}
+
+const unsigned char * AssetStream::getData() const
+{
+	return _data;
+}
+
+const unsigned char * AssetStream::getCurrent() const
+{
+	return _data + _position;
+}
+
+std::string AssetStream::getString() const
+{
+	return std::string{ reinterpret_cast<const char *>(_data), _size };
+}
+
+const std::string & AssetStream::getName() const
+{
+	return _name;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstddef>
+
+class MappedFile;
+
+// Read-only view of the bytes of an asset, wherever they come from. Every
+// asset lives in contiguous memory: either inside a memory mapped archive,
+// in which case reading is zero-copy, or in a buffer owned by the stream
+// (decompressed archive entries and loose files).
+class AssetStream
+{
+public:
+	AssetStream() = default;
+
+	// Views a range of a mapping that is kept alive by the stream.
+	AssetStream(
+		const std::string& name,
+		std::shared_ptr<const MappedFile> mapping,
+		const unsigned char *data,
+		size_t size);
+
+	// Owns the bytes.
+	AssetStream(
+		const std::string& name,
+		std::vector<unsigned char>&& buffer);
+
+	AssetStream(const AssetStream& other) = delete;
+	AssetStream(AssetStream&& other) = default;
+
+	AssetStream& operator=(const AssetStream& other) = delete;
+	AssetStream& operator=(AssetStream&& other) = default;
+
+	bool isOpen() const;
+
+	// Copies up to size bytes and advances the position. Returns the number of
+	// bytes copied.
+	size_t read(void *destination, size_t size);
+
+	// Returns false if the position is past the end.
+	bool seek(size_t position);
+	bool skip(size_t size);
+
+	size_t tell() const;
+
+	bool eof() const;
+
+	size_t getSize() const;
+
+	// The complete contents, valid for the lifetime of the stream.
+	const unsigned char *getData() const;
+
+	// Pointer to the current position.
+	const unsigned char *getCurrent() const;
+
+	std::string getString() const;
+
+	const std::string& getName() const;
+
+private:
+
+	std::string _name{};
+
+	std::shared_ptr<const MappedFile> _mapping{};
+	std::vector<unsigned char> _buffer{};
+
+	const unsigned char *_data{ nullptr };
+	size_t _size{ 0 };
+	size_t _position{ 0 };
+
+	bool _open{ false };
+};
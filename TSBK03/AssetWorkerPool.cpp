@@ -0,0 +1,217 @@
+#include "AssetWorkerPool.h"
+
+#include "Profiler.h"
+
+#include <chrono>
+#include <limits>
+
+AssetWorkerPool::AssetWorkerPool(
+	unsigned int numThreads,
+	const std::string &name)
+	: _name{ name }
+{
+	if (numThreads == 0)
+	{
+		// Leave one core for the main thread.
+		unsigned int numCores = std::thread::hardware_concurrency();
+
+		numThreads = numCores > 1 ? numCores - 1 : 1;
+	}
+
+	for (unsigned int i = 0; i < numThreads; ++i)
+	{
+		_threads.emplace_back(&AssetWorkerPool::workerLoop, this, i);
+	}
+}
+
+AssetWorkerPool::~AssetWorkerPool()
+{
+	shutdown();
+}
+
+void AssetWorkerPool::enqueue(
+	std::function<void()> job)
+{
+	{
+		std::lock_guard<std::mutex> lock{ _mutex };
+
+		_jobs.push_back(job);
+		++_numPending;
+	}
+
+	_jobAvailable.notify_one();
+}
+
+void AssetWorkerPool::finalize(
+	std::function<void()> work,
+	std::function<void()> discard)
+{
+	{
+		std::lock_guard<std::mutex> lock{ _mutex };
+
+		_finalizers.push_back(Finalizer{ work, discard });
+	}
+
+	_finalizerAvailable.notify_one();
+}
+
+unsigned int AssetWorkerPool::runFinalizers(
+	float budgetMs)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+
+	unsigned int numRun = 0;
+
+	while (true)
+	{
+		std::function<void()> work;
+
+		{
+			std::lock_guard<std::mutex> lock{ _mutex };
+
+			if (_finalizers.empty())
+			{
+				break;
+			}
+
+			work = _finalizers.front().work;
+			_finalizers.pop_front();
+		}
+
+		work();
+
+		{
+			std::lock_guard<std::mutex> lock{ _mutex };
+
+			--_numPending;
+		}
+
+		++numRun;
+
+		std::chrono::duration<float, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+		if (elapsed.count() >= budgetMs)
+		{
+			break;
+		}
+	}
+
+	return numRun;
+}
+
+void AssetWorkerPool::waitForAll()
+{
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock{ _mutex };
+
+			_finalizerAvailable.wait(lock, [this]() { return !_finalizers.empty() || _numPending == 0; });
+
+			if (_finalizers.empty() && _numPending == 0)
+			{
+				return;
+			}
+		}
+
+		runFinalizers(std::numeric_limits<float>::max());
+	}
+}
+
+unsigned int AssetWorkerPool::getNumPending() const
+{
+	std::lock_guard<std::mutex> lock{ _mutex };
+
+	return _numPending;
+}
+
+void AssetWorkerPool::shutdown()
+{
+	{
+		std::lock_guard<std::mutex> lock{ _mutex };
+
+		if (_stop)
+		{
+			return;
+		}
+
+		_stop = true;
+	}
+
+	_jobAvailable.notify_all();
+
+	for (auto& thread : _threads)
+	{
+		thread.join();
+	}
+
+	_threads.clear();
+
+	// Nothing is left to add finalizers once the workers have stopped.
+	std::deque<Finalizer> finalizers;
+
+	{
+		std::lock_guard<std::mutex> lock{ _mutex };
+
+		finalizers.swap(_finalizers);
+
+		_jobs.clear();
+		_numPending = 0;
+	}
+
+	for (auto& finalizer : finalizers)
+	{
+		if (finalizer.discard)
+		{
+			finalizer.discard();
+		}
+	}
+}
+
+void AssetWorkerPool::setProfiler(
+	Profiler *profiler)
+{
+	std::lock_guard<std::mutex> lock{ _mutex };
+
+	_profiler = profiler;
+}
+
+void AssetWorkerPool::workerLoop(
+	unsigned int index)
+{
+	std::string threadName = _name + " " + std::to_string(index);
+
+	while (true)
+	{
+		std::function<void()> job;
+
+		{
+			std::unique_lock<std::mutex> lock{ _mutex };
+
+			_jobAvailable.wait(lock, [this]() { return _stop || !_jobs.empty(); });
+
+			if (_stop)
+			{
+				return;
+			}
+
+			job = _jobs.front();
+			_jobs.pop_front();
+		}
+
+		auto start = std::chrono::steady_clock::now();
+
+		job();
+
+		auto end = std::chrono::steady_clock::now();
+
+		// Held while adding the scope so the profiler cannot be swapped out
+		// in the middle.
+		std::lock_guard<std::mutex> lock{ _mutex };
+
+		if (_profiler != nullptr)
+		{
+			_profiler->addThreadScope(threadName, _name, start, end);
+		}
+	}
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <deque>
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+class Profiler;
+
+// Runs asset decoding jobs on a set of worker threads. Jobs hand their
+// OpenGL work back to the main thread through finalize(), and the main thread
+// drains those finalizers with runFinalizers() within a time budget.
+class AssetWorkerPool
+{
+public:
+	// The name is shown for the worker threads in profiler captures.
+	explicit AssetWorkerPool(unsigned int numThreads = 0, const std::string& name = "Asset Worker");
+
+	AssetWorkerPool(const AssetWorkerPool& other) = delete;
+	AssetWorkerPool(AssetWorkerPool&& other) = delete;
+
+	AssetWorkerPool& operator=(const AssetWorkerPool& other) = delete;
+	AssetWorkerPool& operator=(AssetWorkerPool&& other) = delete;
+
+	~AssetWorkerPool();
+
+	// Queues a job to be run on a worker thread.
+	void enqueue(std::function<void()> job);
+
+	// Queues work to be run on the main thread. May be called from any thread.
+	// If the pool is shut down before the work has run, discard is run instead
+	// to free whatever the work would have taken ownership of.
+	void finalize(std::function<void()> work, std::function<void()> discard = nullptr);
+
+	// Runs queued main thread work until budgetMs has passed. At least one
+	// item is always run so that loading makes progress. Returns the number of
+	// items run.
+	unsigned int runFinalizers(float budgetMs);
+
+	// Blocks until every queued job and finalizer has run.
+	void waitForAll();
+
+	// Number of jobs that have been queued but not yet finalized.
+	unsigned int getNumPending() const;
+
+	// Stops the worker threads. Jobs that have not started are dropped, and
+	// the finalizers that have not run are discarded.
+	void shutdown();
+
+	// Jobs are added to the captures of the profiler. Once this returns no
+	// worker uses the previous profiler, so it can be destroyed.
+	void setProfiler(Profiler *profiler);
+
+private:
+
+	struct Finalizer
+	{
+		std::function<void()> work;
+		std::function<void()> discard;
+	};
+
+	void workerLoop(unsigned int index);
+
+	std::string _name;
+
+	std::vector<std::thread> _threads{};
+
+	std::deque<std::function<void()>> _jobs{};
+	std::deque<Finalizer> _finalizers{};
+
+	mutable std::mutex _mutex{};
+	std::condition_variable _jobAvailable{};
+	std::condition_variable _finalizerAvailable{};
+
+	unsigned int _numPending{ 0 };
+
+	Profiler *_profiler{ nullptr };
+
+	bool _stop{ false };
+};
@@ -6,9 +6,11 @@
 */
 
 #include "BMP.h"
+#include "AssetFileSystem.h"
+#include "ImageKernels.h"
 
-#include <fstream>
 #include <string>
+#include <stdexcept>
 
 
 /**
@@ -103,12 +105,12 @@ struct BitmapImageHeader
 	/**
 	* @brief Image width in pixels.
 	*/
-	uint32_t biWidth;
+	int32_t biWidth;
 
 	/**
-	* @brief Image height in pixels.
+	* @brief Image height in pixels. Negative if the first row is the top row.
 	*/
-	uint32_t biHeigth;
+	int32_t biHeigth;
 
 	/**
 	* @brief Number of image planes in file. Should be 1.
@@ -118,7 +120,7 @@ struct BitmapImageHeader
 	/**
 	* @brief Bits per pixel.
 	*/
-	uint32_t biBitCount;
+	uint16_t biBitCount;
 
 
 	/**
@@ -159,21 +161,11 @@ struct BitmapImageHeader
 // Unpack again.
 #pragma pack(pop)
 
-BMP::BMP(const char* filePath)
+BMP::BMP(const char* filePath, bool decodePixels)
+	: filePath{ filePath }
 {
-	// Open the binary file in a stream
-	std::fstream hFile(filePath, std::ios::in | std::ios::binary);
-
-	// Check if we got a valid file.
-	if (!hFile.is_open())
-	{
-		throw std::invalid_argument(std::string("File (") + filePath + ") could not be opened.");
-	}
-
-	// Search for end and save position, then return to beginning.
-	hFile.seekg(0, std::ios::end);
-	std::size_t fileLength = hFile.tellg();
-	hFile.seekg(0, std::ios::beg);
+	// Open the file. Throws if it could not be opened.
+	AssetStream hFile = AssetFileSystem::open(filePath);
 
 	// Read file header.
 	BitmapFileHeader fileHeader;
@@ -187,20 +179,17 @@ BMP::BMP(const char* filePath)
 
 	if (fileHeader.bfType[0] != 'B' || fileHeader.bfType[1] != 'M')
 	{
-		hFile.close();
 		// Signature mismatch!
 		throw std::invalid_argument(std::string("Signature mismatch in (") + filePath + "). Should be 'B''M', got '" + fileHeader.bfType[0] + "''" + fileHeader.bfType[1] + "'");
 	}
 
 	if (imageHeader.biBitCount != BI_BITCOUNT_24 && imageHeader.biBitCount != BI_BITCOUNT_32)
 	{
-		hFile.close();
 		throw std::invalid_argument(std::string("Invalid file format in file (") + filePath + "). Expected 24 or 32 bit image.");
 	}
 
 	if (imageHeader.biCompression != BI_COMPRESSION_NONE)
 	{
-		hFile.close();
 		throw std::invalid_argument(std::string("File (") + filePath + ") is compressed.");
 	}
 
@@ -211,26 +200,59 @@ BMP::BMP(const char* filePath)
 	bitsPerPixel = imageHeader.biBitCount;
 
 	// Width and height of image.
-	width = imageHeader.biWidth;
-	height = imageHeader.biHeigth;
+	width = static_cast<uint32_t>(imageHeader.biWidth);
+	height = static_cast<uint32_t>(imageHeader.biHeigth < 0 ? -imageHeader.biHeigth : imageHeader.biHeigth);
+	isTopToBottom = imageHeader.biHeigth < 0;
 
 	// Offset to pixel array from start of file.
-	uint32_t pixelOffset = fileHeader.bfOffBits;
+	pixelOffset = fileHeader.bfOffBits;
+
+	file = std::move(hFile);
+
+	if (decodePixels)
+	{
+		pixels.resize(getPixelsSize());
+		decode(pixels.data());
+	}
+}
+
+void BMP::decode(
+	unsigned char *destination,
+	bool premultiplyAlpha)
+{
+	if (!file.isOpen())
+	{
+		throw std::logic_error(std::string("The pixels of file (") + filePath + ") are already decoded.");
+	}
+
+	const unsigned int bytesPerPixel = bitsPerPixel / 8;
 
-	// Size in bytes of pixel array.
-	uint32_t size = (width * bitsPerPixel + 31) / 8 * height;
+	// Rows are padded to a multiple of four bytes.
+	const size_t stride = (static_cast<size_t>(width) * bitsPerPixel + 31) / 32 * 4;
+
+	if (pixelOffset > file.getSize() || file.getSize() - pixelOffset < stride * height)
+	{
+		throw std::invalid_argument(std::string("Unexpected end of file in file (") + filePath + ").");
+	}
 
-	// Resize the vector to the expected size.
-	pixels.resize(size);
+	// Pixels are stored as BGR(A), OpenGL wants the bottom row first.
+	unsigned int flags = IMAGE_CONVERT_SWIZZLE_RED_BLUE;
 
-	// Set filestream marker at start of pixel array
-	hFile.seekg(pixelOffset, std::ios::beg);
+	if (premultiplyAlpha)
+	{
+		flags |= IMAGE_CONVERT_PREMULTIPLY_ALPHA;
+	}
+
+	if (isTopToBottom)
+	{
+		flags |= IMAGE_CONVERT_FLIP_VERTICALLY;
+	}
 
-	// Read the array into the data region of the pixel vector
-	hFile.read(reinterpret_cast<char*>(pixels.data()), size);
+	// Convert straight from the file contents.
+	convertRows(destination, file.getData() + pixelOffset, width, height, bytesPerPixel, stride, flags);
 
-	// Close the filestream
-	hFile.close();
+	// Release the file.
+	file = AssetStream{};
 }
 
 const std::vector<uint8_t>& BMP::getPixels() const
@@ -8,7 +8,10 @@
 #pragma once
 
 #include <vector>
+#include <string>
+#include <cstdint>
 #include "TextureFile.h"
+#include "AssetStream.h"
 
 /**
 * @brief BMP (Bitmap) representation.
@@ -20,8 +23,10 @@ public:
 	/**
 	* @brief Constructor
 	* @param filePath Path to the bmp file.
+	* @param decodePixels False to only read the headers and decode the
+	* pixels later with decode.
 	*/
-	explicit BMP(const char* filePath);
+	explicit BMP(const char* filePath, bool decodePixels = true);
 
 	/**
 	* @brief Gets the pixels in the file.
@@ -47,8 +52,35 @@ public:
 	*/
 	bool hasAlpha() const override;
 
+	/**
+	* @brief Decodes the pixels as RGB(A) into the destination.
+	* @param destination Memory for getPixelsSize() bytes.
+	* @param premultiplyAlpha True to multiply the colors with the alpha.
+	*/
+	void decode(unsigned char *destination, bool premultiplyAlpha = false) override;
+
 private:
 
+	/**
+	* @brief The file, open until the pixels are decoded.
+	*/
+	AssetStream file;
+
+	/**
+	* @brief Path to the file.
+	*/
+	std::string filePath;
+
+	/**
+	* @brief Offset to the pixel array from the start of the file.
+	*/
+	uint32_t pixelOffset;
+
+	/**
+	* @brief True if the first row in the file is the top row.
+	*/
+	bool isTopToBottom;
+
 	/**
 	* @brief The width of the image.
 	*/
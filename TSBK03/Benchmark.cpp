@@ -0,0 +1,392 @@
+#include "Benchmark.h"
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#include "Game.h"
+#include "Renderer.h"
+#include "Terrain.h"
+#include "TerrainChunk.h"
+#include "Profiler.h"
+#include "ScriptExecutionException.h"
+#include "Utils.h"
+
+#include <GLFW/glfw3.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/constants.hpp>
+
+// Enemies are spawned in waves spread evenly over the measured frames, a
+// little ahead of the camera.
+static const unsigned int NUM_SPAWN_WAVES = 8;
+static const unsigned int ENEMIES_PER_WAVE = 4;
+
+// Nearest rank percentile of sorted values.
+static float getPercentile(
+	const std::vector<float> &sorted,
+	float percentile)
+{
+	size_t rank = static_cast<size_t>(std::ceil(percentile / 100.f * sorted.size()));
+
+	return sorted[std::max<size_t>(rank, 1) - 1];
+}
+
+static void writeSummary(
+	std::ostream &stream,
+	const std::string &name,
+	std::vector<float> values)
+{
+	writeJSONString(stream, name);
+	stream << ":{";
+
+	if (!values.empty())
+	{
+		std::sort(values.begin(), values.end());
+
+		double sum = 0.0;
+
+		for (float value : values)
+		{
+			sum += value;
+		}
+
+		stream << "\"mean\":" << sum / values.size()
+			<< ",\"p50\":" << getPercentile(values, 50.f)
+			<< ",\"p95\":" << getPercentile(values, 95.f)
+			<< ",\"p99\":" << getPercentile(values, 99.f)
+			<< ",\"max\":" << values.back()
+			<< ",";
+	}
+
+	stream << "\"count\":" << values.size() << "}";
+}
+
+Benchmark::Benchmark(
+	const BenchmarkSettings &settings)
+	: _settings{ settings }
+{
+	_settings.numFrames = std::max(_settings.numFrames, 1u);
+}
+
+bool Benchmark::parseArguments(
+	int argc,
+	char **argv,
+	BenchmarkSettings &settings)
+{
+	bool benchmark = false;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const char *arg = argv[i];
+		const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+
+		if (std::strcmp(arg, "--benchmark") == 0)
+		{
+			benchmark = true;
+		}
+		else if (value == nullptr)
+		{
+			std::cerr << "[BENCHMARK] Ignoring " << arg << std::endl;
+		}
+		else if (std::strcmp(arg, "--frames") == 0)
+		{
+			settings.numFrames = static_cast<unsigned int>(std::strtoul(value, nullptr, 10));
+			++i;
+		}
+		else if (std::strcmp(arg, "--warmup") == 0)
+		{
+			settings.numWarmUpFrames = static_cast<unsigned int>(std::strtoul(value, nullptr, 10));
+			++i;
+		}
+		else if (std::strcmp(arg, "--seed") == 0)
+		{
+			settings.seed = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+			++i;
+		}
+		else if (std::strcmp(arg, "--csv") == 0)
+		{
+			settings.csvPath = value;
+			++i;
+		}
+		else if (std::strcmp(arg, "--json") == 0)
+		{
+			settings.jsonPath = value;
+			++i;
+		}
+		else if (std::strcmp(arg, "--trace") == 0)
+		{
+			settings.tracePath = value;
+			++i;
+		}
+		else if (std::strcmp(arg, "--script") == 0)
+		{
+			settings.scriptPath = value;
+			++i;
+		}
+		else
+		{
+			std::cerr << "[BENCHMARK] Ignoring " << arg << std::endl;
+		}
+	}
+
+	return benchmark;
+}
+
+const BenchmarkSettings & Benchmark::getSettings() const
+{
+	return _settings;
+}
+
+void Benchmark::start(
+	Game *game,
+	Profiler &profiler)
+{
+	if (!_settings.scriptPath.empty())
+	{
+		try
+		{
+			game->getScriptManager()->doFile(_settings.scriptPath);
+		}
+		catch (const ScriptExecutionException& ex)
+		{
+			std::cerr << "[BENCHMARK] " << ex.what() << std::endl;
+		}
+	}
+
+	profiler.setEnabled(true);
+
+	profiler.setFrameCallback([this](unsigned long long frame, float cpuTime, float gpuTime)
+	{
+		if (frame < _firstProfilerFrame || frame - _firstProfilerFrame >= _results.size())
+		{
+			return;
+		}
+
+		FrameResult& result = _results[static_cast<size_t>(frame - _firstProfilerFrame)];
+
+		result.cpuTime = cpuTime;
+		result.gpuTime = gpuTime;
+	});
+
+	_startTime = glfwGetTime();
+
+	std::cout << "[BENCHMARK] Running " << _settings.numWarmUpFrames << " warm-up and "
+		<< _settings.numFrames << " measured frames" << std::endl;
+}
+
+void Benchmark::beginFrame(
+	Profiler &profiler)
+{
+	// Animations, the game update and the shaders all read this clock.
+	glfwSetTime(_startTime + _frame * static_cast<double>(_settings.timeStep));
+
+	if (_frame == _settings.numWarmUpFrames)
+	{
+		_firstProfilerFrame = profiler.getFrame() + 1;
+
+		if (!_settings.tracePath.empty())
+		{
+			profiler.startCapture(_settings.numFrames, _settings.tracePath);
+		}
+	}
+}
+
+void Benchmark::update(
+	Game *game,
+	Renderer *renderer,
+	const Terrain *terrain)
+{
+	float progress = getProgress();
+
+	unsigned int measuredFrame = _frame > _settings.numWarmUpFrames ? _frame - _settings.numWarmUpFrames : 0;
+
+	while (_nextWave < NUM_SPAWN_WAVES && measuredFrame >= _nextWave * _settings.numFrames / NUM_SPAWN_WAVES)
+	{
+		glm::vec3 center = getPathPosition(terrain, progress + 0.05f);
+
+		for (unsigned int i = 0; i < ENEMIES_PER_WAVE; ++i)
+		{
+			glm::vec3 offset{ 3.f * (i % 2) - 1.5f, 0.f, 3.f * (i / 2) - 1.5f };
+
+			game->spawnEnemy(glm::vec3{ center.x + offset.x, 0.f, center.z + offset.z });
+		}
+
+		++_nextWave;
+	}
+
+	glm::vec3 eye = getPathPosition(terrain, progress);
+
+	// Look at the ground a little further along the path.
+	glm::vec3 center = getPathPosition(terrain, progress + 0.02f);
+	center.y -= 4.f;
+
+	glm::mat4 view = glm::lookAt(eye, center, glm::vec3{ 0.f, 1.f, 0.f });
+
+	renderer->setCameraTransform(view);
+	renderer->setCameraPosition(eye);
+	renderer->setCameraDirection(glm::normalize(eye - center));
+}
+
+void Benchmark::endFrame(
+	const RendererFrameStats &stats)
+{
+	if (_frame >= _settings.numWarmUpFrames)
+	{
+		FrameResult result;
+		result.drawCalls = stats.drawCalls;
+		result.triangles = stats.triangles;
+
+		_results.push_back(result);
+	}
+
+	++_frame;
+}
+
+bool Benchmark::isDone() const
+{
+	return _results.size() >= _settings.numFrames;
+}
+
+void Benchmark::writeReport(
+	const std::string &rendererName) const
+{
+	std::ofstream csv{ _settings.csvPath };
+
+	if (!csv)
+	{
+		std::cerr << "[BENCHMARK] Could not open " << _settings.csvPath << std::endl;
+		return;
+	}
+
+	std::ofstream json{ _settings.jsonPath };
+
+	if (!json)
+	{
+		std::cerr << "[BENCHMARK] Could not open " << _settings.jsonPath << std::endl;
+		return;
+	}
+
+	std::vector<float> cpuTimes;
+	std::vector<float> gpuTimes;
+	std::vector<float> drawCalls;
+	std::vector<float> triangles;
+
+	csv << std::fixed << std::setprecision(3);
+	csv << "frame,cpu_ms,gpu_ms,draw_calls,triangles\n";
+
+	for (size_t i = 0; i < _results.size(); ++i)
+	{
+		const FrameResult& result = _results[i];
+
+		csv << i << ",";
+
+		if (result.cpuTime >= 0.f)
+		{
+			csv << result.cpuTime;
+			cpuTimes.push_back(result.cpuTime);
+		}
+
+		csv << ",";
+
+		if (result.gpuTime >= 0.f)
+		{
+			csv << result.gpuTime;
+			gpuTimes.push_back(result.gpuTime);
+		}
+
+		csv << "," << result.drawCalls << "," << result.triangles << "\n";
+
+		drawCalls.push_back(static_cast<float>(result.drawCalls));
+		triangles.push_back(static_cast<float>(result.triangles));
+	}
+
+	json << std::fixed << std::setprecision(3);
+	json << "{\"renderer\":";
+	writeJSONString(json, rendererName);
+	json << ",\"frames\":" << _results.size()
+		<< ",\"warmUpFrames\":" << _settings.numWarmUpFrames
+		<< ",\"timeStep\":" << _settings.timeStep
+		<< ",\"seed\":" << _settings.seed << ",";
+
+	writeSummary(json, "cpuFrameTime", cpuTimes);
+	json << ",";
+	writeSummary(json, "gpuFrameTime", gpuTimes);
+	json << ",";
+	writeSummary(json, "drawCalls", drawCalls);
+	json << ",";
+	writeSummary(json, "triangles", triangles);
+	json << "}\n";
+
+	std::sort(cpuTimes.begin(), cpuTimes.end());
+	std::sort(gpuTimes.begin(), gpuTimes.end());
+
+	std::cout << std::fixed << std::setprecision(3);
+
+	if (!cpuTimes.empty())
+	{
+		std::cout << "[BENCHMARK] CPU p50: " << getPercentile(cpuTimes, 50.f) << "ms, "
+			<< "p95: " << getPercentile(cpuTimes, 95.f) << "ms, "
+			<< "p99: " << getPercentile(cpuTimes, 99.f) << "ms" << std::endl;
+	}
+
+	if (!gpuTimes.empty())
+	{
+		std::cout << "[BENCHMARK] GPU p50: " << getPercentile(gpuTimes, 50.f) << "ms, "
+			<< "p95: " << getPercentile(gpuTimes, 95.f) << "ms, "
+			<< "p99: " << getPercentile(gpuTimes, 99.f) << "ms" << std::endl;
+	}
+
+	std::cout << std::defaultfloat;
+
+	std::cout << "[BENCHMARK] Wrote " << _settings.csvPath << " and " << _settings.jsonPath << std::endl;
+}
+
+glm::vec3 Benchmark::getPathPosition(
+	const Terrain *terrain,
+	float progress) const
+{
+	glm::vec2 minCorner{ 0.f, 0.f };
+	glm::vec2 maxCorner{ 0.f, 0.f };
+
+	const std::vector<TerrainChunk *>& chunks = terrain->getChunks();
+
+	for (size_t i = 0; i < chunks.size(); ++i)
+	{
+		glm::vec2 chunkMin{ chunks[i]->getOffsetX(), chunks[i]->getOffsetZ() };
+		glm::vec2 chunkMax = chunkMin + glm::vec2{ chunks[i]->getSizeX(), chunks[i]->getSizeZ() };
+
+		minCorner = i == 0 ? chunkMin : glm::min(minCorner, chunkMin);
+		maxCorner = i == 0 ? chunkMax : glm::max(maxCorner, chunkMax);
+	}
+
+	glm::vec2 center = 0.5f * (minCorner + maxCorner);
+	glm::vec2 size = maxCorner - minCorner;
+
+	// A loop around the middle of the terrain that swings in and out, so that
+	// both open and crowded views are measured.
+	float angle = glm::two_pi<float>() * progress;
+	float radius = 0.3f * glm::min(size.x, size.y) * (1.f + 0.25f * glm::sin(3.f * angle));
+
+	glm::vec3 position{
+		center.x + radius * glm::cos(angle),
+		0.f,
+		center.y + radius * glm::sin(angle) };
+
+	position.y = terrain->getHeight(position.x, position.z) + 6.f + 4.f * glm::sin(2.f * angle);
+
+	return position;
+}
+
+float Benchmark::getProgress() const
+{
+	if (_frame < _settings.numWarmUpFrames)
+	{
+		return 0.f;
+	}
+
+	return static_cast<float>(_frame - _settings.numWarmUpFrames) / _settings.numFrames;
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "RendererFrameStats.h"
+
+class Game;
+class Renderer;
+class Terrain;
+class Profiler;
+
+struct BenchmarkSettings
+{
+	// Frames that are measured, after the warm-up frames.
+	unsigned int numFrames{ 1000 };
+
+	// Frames run before measuring, while the camera waits at the start of the
+	// path for textures to stream in.
+	unsigned int numWarmUpFrames{ 120 };
+
+	// Simulated time per frame, so that every run shows the same scene no
+	// matter how fast it renders.
+	float timeStep{ 1.f / 60.f };
+
+	// Seed of the random generator of the game, so that every run makes the
+	// same random choices.
+	uint32_t seed{ 1 };
+
+	// One row per measured frame.
+	std::string csvPath{ "benchmark.csv" };
+
+	// Percentiles over the measured frames.
+	std::string jsonPath{ "benchmark.json" };
+
+	// The measured frames are captured as a Chrome trace when set.
+	std::string tracePath{};
+
+	// Lua script run once the assets have loaded, when set.
+	std::string scriptPath{};
+};
+
+// Runs the game without input for a fixed number of frames, flying the camera
+// along a fixed path over the terrain and spawning enemies on a fixed
+// schedule, and reports the CPU and GPU frame times, draw calls and triangles.
+class Benchmark
+{
+public:
+	explicit Benchmark(const BenchmarkSettings& settings);
+
+	Benchmark(const Benchmark& other) = delete;
+	Benchmark& operator=(const Benchmark& other) = delete;
+
+	// Fills in the settings from the command line. Returns false if
+	// --benchmark is not given.
+	static bool parseArguments(int argc, char **argv, BenchmarkSettings& settings);
+
+	const BenchmarkSettings& getSettings() const;
+
+	// Runs the script of the settings and starts taking the frame times from
+	// the profiler. Call once the assets have loaded.
+	void start(Game *game, Profiler& profiler);
+
+	// Sets the clock to the simulated time of the frame and starts the
+	// capture at the first measured frame. Call before the profiler begins
+	// the frame.
+	void beginFrame(Profiler& profiler);
+
+	// Spawns the enemies of the frame and moves the camera along the path.
+	// Call after the game has been updated, so the camera of the player is
+	// replaced.
+	void update(Game *game, Renderer *renderer, const Terrain *terrain);
+
+	// Keeps the draw calls and triangles of the frame. Call after rendering.
+	void endFrame(const RendererFrameStats& stats);
+
+	bool isDone() const;
+
+	// Writes the CSV and JSON reports. Frames whose GPU timestamps have not
+	// been read by then are left out of the GPU times. Nothing is written if
+	// either file can not be opened.
+	void writeReport(const std::string& rendererName) const;
+
+private:
+
+	struct FrameResult
+	{
+		// In milliseconds, negative until the profiler reports them.
+		float cpuTime{ -1.f };
+		float gpuTime{ -1.f };
+
+		unsigned int drawCalls{ 0 };
+		unsigned int triangles{ 0 };
+	};
+
+	// Position along the closed path over the terrain, progress from zero to
+	// one.
+	glm::vec3 getPathPosition(const Terrain *terrain, float progress) const;
+
+	// Progress of the current frame along the path, zero while warming up.
+	float getProgress() const;
+
+	BenchmarkSettings _settings;
+
+	// Frames begun, including the warm-up frames.
+	unsigned int _frame{ 0 };
+
+	unsigned int _nextWave{ 0 };
+
+	double _startTime{ 0.0 };
+
+	// Profiler frame of the first measured frame. The profiler is enabled
+	// throughout, so the later ones follow in order.
+	unsigned long long _firstProfilerFrame{ 0 };
+
+	std::vector<FrameResult> _results{};
+};
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+// Capsule around the vertices that mostly follow one bone, in the bind pose
+// of the model. Moving the ends by the skinning transform of the bone gives
+// the capsule in the current pose.
+struct BoneCapsule
+{
+	unsigned int bone{ 0 };
+
+	glm::vec3 start{};
+	glm::vec3 end{};
+
+	float radius{ 0.f };
+};
@@ -0,0 +1,713 @@
+#include "BoundingVolumeHierarchy.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace
+{
+	AABB combine(
+		const AABB &a,
+		const AABB &b)
+	{
+		AABB ret;
+
+		ret.minX = std::min(a.minX, b.minX);
+		ret.minY = std::min(a.minY, b.minY);
+		ret.minZ = std::min(a.minZ, b.minZ);
+
+		ret.maxX = std::max(a.maxX, b.maxX);
+		ret.maxY = std::max(a.maxY, b.maxY);
+		ret.maxZ = std::max(a.maxZ, b.maxZ);
+
+		return ret;
+	}
+
+	AABB grow(
+		const AABB &box,
+		float margin)
+	{
+		AABB ret;
+
+		ret.minX = box.minX - margin;
+		ret.minY = box.minY - margin;
+		ret.minZ = box.minZ - margin;
+
+		ret.maxX = box.maxX + margin;
+		ret.maxY = box.maxY + margin;
+		ret.maxZ = box.maxZ + margin;
+
+		return ret;
+	}
+
+	// Half the surface area, which is all the insertion cost needs.
+	float getArea(
+		const AABB &box)
+	{
+		float x = box.maxX - box.minX;
+		float y = box.maxY - box.minY;
+		float z = box.maxZ - box.minZ;
+
+		return x * y + y * z + z * x;
+	}
+
+	bool containsBox(
+		const AABB &outer,
+		const AABB &inner)
+	{
+		return
+			outer.minX <= inner.minX && outer.minY <= inner.minY && outer.minZ <= inner.minZ &&
+			inner.maxX <= outer.maxX && inner.maxY <= outer.maxY && inner.maxZ <= outer.maxZ;
+	}
+
+	bool overlapsSphere(
+		const AABB &box,
+		const glm::vec3 &center,
+		float radius)
+	{
+		glm::vec3 closest = glm::clamp(center, box.getMinPoint(), box.getMaxPoint());
+		glm::vec3 delta = closest - center;
+
+		return glm::dot(delta, delta) <= radius * radius;
+	}
+
+	// Slab test, gives the distance where the ray enters the box.
+	bool intersectRay(
+		const AABB &box,
+		const glm::vec3 &origin,
+		const glm::vec3 &inverseDirection,
+		float maxDistance,
+		float &distance)
+	{
+		glm::vec3 t0 = (box.getMinPoint() - origin) * inverseDirection;
+		glm::vec3 t1 = (box.getMaxPoint() - origin) * inverseDirection;
+
+		glm::vec3 nearest = glm::min(t0, t1);
+		glm::vec3 farthest = glm::max(t0, t1);
+
+		float enter = std::max(std::max(nearest.x, nearest.y), std::max(nearest.z, 0.f));
+		float exit = std::min(std::min(farthest.x, farthest.y), std::min(farthest.z, maxDistance));
+
+		distance = enter;
+
+		return enter <= exit;
+	}
+}
+
+bool BoundingVolumeHierarchy::Node::isLeaf() const
+{
+	return child1 == NULL_NODE;
+}
+
+BoundingVolumeHierarchy::BoundingVolumeHierarchy(
+	float margin)
+	: _margin{ margin }
+{
+}
+
+int BoundingVolumeHierarchy::insert(
+	const AABB &box,
+	uint32_t value)
+{
+	int leaf = allocateNode();
+
+	_nodes[leaf].box = grow(box, _margin);
+	_nodes[leaf].leafBox = box;
+	_nodes[leaf].value = value;
+	_nodes[leaf].height = 0;
+
+	insertLeaf(leaf);
+
+	++_leafCount;
+
+	return leaf;
+}
+
+void BoundingVolumeHierarchy::remove(
+	int proxy)
+{
+	assert(_nodes[proxy].isLeaf());
+
+	removeLeaf(proxy);
+	freeNode(proxy);
+
+	--_leafCount;
+}
+
+bool BoundingVolumeHierarchy::move(
+	int proxy,
+	const AABB &box)
+{
+	Node &node = _nodes[proxy];
+
+	node.leafBox = box;
+
+	if (containsBox(node.box, box))
+	{
+		return false;
+	}
+
+	removeLeaf(proxy);
+
+	_nodes[proxy].box = grow(box, _margin);
+
+	insertLeaf(proxy);
+
+	return true;
+}
+
+void BoundingVolumeHierarchy::clear()
+{
+	_nodes.clear();
+
+	_root = NULL_NODE;
+	_freeList = NULL_NODE;
+
+	_leafCount = 0;
+}
+
+uint32_t BoundingVolumeHierarchy::getValue(
+	int proxy) const
+{
+	return _nodes[proxy].value;
+}
+
+void BoundingVolumeHierarchy::setValue(
+	int proxy,
+	uint32_t value)
+{
+	_nodes[proxy].value = value;
+}
+
+const AABB & BoundingVolumeHierarchy::getBox(
+	int proxy) const
+{
+	return _nodes[proxy].leafBox;
+}
+
+size_t BoundingVolumeHierarchy::size() const
+{
+	return _leafCount;
+}
+
+int BoundingVolumeHierarchy::getHeight() const
+{
+	return _root == NULL_NODE ? 0 : _nodes[_root].height;
+}
+
+void BoundingVolumeHierarchy::cull(
+	const Frustum &frustum,
+	std::vector<uint32_t> &values,
+	std::vector<int8_t> &results) const
+{
+	if (_root == NULL_NODE)
+	{
+		return;
+	}
+
+	const uint8_t allPlanes = 0x3F;
+
+	_batchValues.clear();
+	_batchBoxes.clear();
+
+	_stack.clear();
+	_stack.emplace_back(_root, allPlanes);
+
+	while (!_stack.empty())
+	{
+		int index = _stack.back().first;
+		uint8_t planeMask = _stack.back().second;
+
+		_stack.pop_back();
+
+		const Node &node = _nodes[index];
+
+		int8_t result = cullBox(frustum, node.box.getCenter(), node.box.getSize() * 0.5f, planeMask);
+
+		if (result < 0)
+		{
+			continue;
+		}
+
+		if (result == 1)
+		{
+			// The exact boxes are inside the grown ones.
+			addLeaves(index, values, results);
+		}
+		else if (node.isLeaf())
+		{
+			// Only the grown box is known to intersect the frustum.
+			_batchValues.push_back(node.value);
+			_batchBoxes.add(node.leafBox.getCenter(), node.leafBox.getSize() * 0.5f);
+		}
+		else
+		{
+			_stack.emplace_back(node.child2, planeMask);
+			_stack.emplace_back(node.child1, planeMask);
+		}
+	}
+
+	_batchResults.resize(_batchValues.size());
+
+	cullBoxes(frustum, _batchBoxes, _batchResults.data());
+
+	for (size_t i = 0; i < _batchValues.size(); ++i)
+	{
+		if (_batchResults[i] >= 0)
+		{
+			values.push_back(_batchValues[i]);
+			results.push_back(_batchResults[i]);
+		}
+	}
+}
+
+void BoundingVolumeHierarchy::queryRay(
+	const glm::vec3 &origin,
+	const glm::vec3 &direction,
+	float maxDistance,
+	std::vector<std::pair<float, uint32_t>> &hits) const
+{
+	if (_root == NULL_NODE)
+	{
+		return;
+	}
+
+	const glm::vec3 inverseDirection = 1.f / direction;
+
+	size_t firstHit = hits.size();
+
+	_stack.clear();
+	_stack.emplace_back(_root, 0);
+
+	while (!_stack.empty())
+	{
+		const Node &node = _nodes[_stack.back().first];
+
+		_stack.pop_back();
+
+		float distance;
+
+		if (!intersectRay(node.box, origin, inverseDirection, maxDistance, distance))
+		{
+			continue;
+		}
+
+		if (node.isLeaf())
+		{
+			if (intersectRay(node.leafBox, origin, inverseDirection, maxDistance, distance))
+			{
+				hits.emplace_back(distance, node.value);
+			}
+		}
+		else
+		{
+			_stack.emplace_back(node.child1, 0);
+			_stack.emplace_back(node.child2, 0);
+		}
+	}
+
+	std::sort(hits.begin() + firstHit, hits.end());
+}
+
+void BoundingVolumeHierarchy::queryRadius(
+	const glm::vec3 &center,
+	float radius,
+	std::vector<uint32_t> &values) const
+{
+	if (_root == NULL_NODE)
+	{
+		return;
+	}
+
+	_stack.clear();
+	_stack.emplace_back(_root, 0);
+
+	while (!_stack.empty())
+	{
+		const Node &node = _nodes[_stack.back().first];
+
+		_stack.pop_back();
+
+		if (node.isLeaf())
+		{
+			if (overlapsSphere(node.leafBox, center, radius))
+			{
+				values.push_back(node.value);
+			}
+		}
+		else if (overlapsSphere(node.box, center, radius))
+		{
+			_stack.emplace_back(node.child1, 0);
+			_stack.emplace_back(node.child2, 0);
+		}
+	}
+}
+
+void BoundingVolumeHierarchy::queryBox(
+	const AABB &box,
+	std::vector<uint32_t> &values) const
+{
+	if (_root == NULL_NODE)
+	{
+		return;
+	}
+
+	_stack.clear();
+	_stack.emplace_back(_root, 0);
+
+	while (!_stack.empty())
+	{
+		const Node &node = _nodes[_stack.back().first];
+
+		_stack.pop_back();
+
+		if (node.isLeaf())
+		{
+			if (node.leafBox.intersects(box))
+			{
+				values.push_back(node.value);
+			}
+		}
+		else if (node.box.intersects(box))
+		{
+			_stack.emplace_back(node.child1, 0);
+			_stack.emplace_back(node.child2, 0);
+		}
+	}
+}
+
+void BoundingVolumeHierarchy::addLeaves(
+	int index,
+	std::vector<uint32_t> &values,
+	std::vector<int8_t> &results) const
+{
+	_subtreeStack.clear();
+	_subtreeStack.push_back(index);
+
+	while (!_subtreeStack.empty())
+	{
+		const Node &node = _nodes[_subtreeStack.back()];
+
+		_subtreeStack.pop_back();
+
+		if (node.isLeaf())
+		{
+			values.push_back(node.value);
+			results.push_back(1);
+		}
+		else
+		{
+			_subtreeStack.push_back(node.child2);
+			_subtreeStack.push_back(node.child1);
+		}
+	}
+}
+
+int BoundingVolumeHierarchy::allocateNode()
+{
+	if (_freeList == NULL_NODE)
+	{
+		_nodes.emplace_back();
+
+		return static_cast<int>(_nodes.size() - 1);
+	}
+
+	int index = _freeList;
+
+	_freeList = _nodes[index].parent;
+	_nodes[index] = Node{};
+
+	return index;
+}
+
+void BoundingVolumeHierarchy::freeNode(
+	int index)
+{
+	_nodes[index].parent = _freeList;
+	_nodes[index].height = -1;
+
+	_freeList = index;
+}
+
+void BoundingVolumeHierarchy::insertLeaf(
+	int leaf)
+{
+	if (_root == NULL_NODE)
+	{
+		_root = leaf;
+		_nodes[leaf].parent = NULL_NODE;
+
+		return;
+	}
+
+	const AABB leafBox = _nodes[leaf].box;
+
+	// Walk down to the sibling that makes the tree grow the least. Every
+	// node above the new one grows by the same amount as its new parent.
+	int index = _root;
+
+	while (!_nodes[index].isLeaf())
+	{
+		const Node &node = _nodes[index];
+
+		float area = getArea(node.box);
+		float combinedArea = getArea(combine(node.box, leafBox));
+
+		// Cost of making the leaf a sibling of this node.
+		float cost = 2.f * combinedArea;
+
+		// Cost of pushing the leaf further down.
+		float inheritanceCost = 2.f * (combinedArea - area);
+
+		float childCosts[2];
+		int children[2] = { node.child1, node.child2 };
+
+		for (int i = 0; i < 2; ++i)
+		{
+			const Node &child = _nodes[children[i]];
+
+			float childArea = getArea(combine(child.box, leafBox));
+
+			if (!child.isLeaf())
+			{
+				childArea -= getArea(child.box);
+			}
+
+			childCosts[i] = childArea + inheritanceCost;
+		}
+
+		if (cost < childCosts[0] && cost < childCosts[1])
+		{
+			break;
+		}
+
+		index = childCosts[0] < childCosts[1] ? children[0] : children[1];
+	}
+
+	int sibling = index;
+	int oldParent = _nodes[sibling].parent;
+
+	// Might move the nodes.
+	int newParent = allocateNode();
+
+	_nodes[newParent].parent = oldParent;
+	_nodes[newParent].box = combine(leafBox, _nodes[sibling].box);
+	_nodes[newParent].height = _nodes[sibling].height + 1;
+	_nodes[newParent].child1 = sibling;
+	_nodes[newParent].child2 = leaf;
+
+	_nodes[sibling].parent = newParent;
+	_nodes[leaf].parent = newParent;
+
+	if (oldParent != NULL_NODE)
+	{
+		if (_nodes[oldParent].child1 == sibling)
+		{
+			_nodes[oldParent].child1 = newParent;
+		}
+		else
+		{
+			_nodes[oldParent].child2 = newParent;
+		}
+	}
+	else
+	{
+		_root = newParent;
+	}
+
+	refit(oldParent);
+}
+
+void BoundingVolumeHierarchy::removeLeaf(
+	int leaf)
+{
+	if (leaf == _root)
+	{
+		_root = NULL_NODE;
+
+		return;
+	}
+
+	int parent = _nodes[leaf].parent;
+	int grandParent = _nodes[parent].parent;
+	int sibling = _nodes[parent].child1 == leaf ? _nodes[parent].child2 : _nodes[parent].child1;
+
+	// The sibling takes the place of the parent.
+	if (grandParent != NULL_NODE)
+	{
+		if (_nodes[grandParent].child1 == parent)
+		{
+			_nodes[grandParent].child1 = sibling;
+		}
+		else
+		{
+			_nodes[grandParent].child2 = sibling;
+		}
+
+		_nodes[sibling].parent = grandParent;
+
+		freeNode(parent);
+
+		refit(grandParent);
+	}
+	else
+	{
+		_root = sibling;
+		_nodes[sibling].parent = NULL_NODE;
+
+		freeNode(parent);
+	}
+}
+
+int BoundingVolumeHierarchy::balance(
+	int indexA)
+{
+	Node &a = _nodes[indexA];
+
+	if (a.isLeaf() || a.height < 2)
+	{
+		return indexA;
+	}
+
+	int indexB = a.child1;
+	int indexC = a.child2;
+
+	Node &b = _nodes[indexB];
+	Node &c = _nodes[indexC];
+
+	int difference = c.height - b.height;
+
+	// Rotate C up, A takes the lower child of C.
+	if (difference > 1)
+	{
+		int indexF = c.child1;
+		int indexG = c.child2;
+
+		Node &f = _nodes[indexF];
+		Node &g = _nodes[indexG];
+
+		c.child1 = indexA;
+		c.parent = a.parent;
+		a.parent = indexC;
+
+		if (c.parent != NULL_NODE)
+		{
+			if (_nodes[c.parent].child1 == indexA)
+			{
+				_nodes[c.parent].child1 = indexC;
+			}
+			else
+			{
+				_nodes[c.parent].child2 = indexC;
+			}
+		}
+		else
+		{
+			_root = indexC;
+		}
+
+		if (f.height > g.height)
+		{
+			c.child2 = indexF;
+			a.child2 = indexG;
+			g.parent = indexA;
+
+			a.box = combine(b.box, g.box);
+			c.box = combine(a.box, f.box);
+
+			a.height = 1 + std::max(b.height, g.height);
+			c.height = 1 + std::max(a.height, f.height);
+		}
+		else
+		{
+			c.child2 = indexG;
+			a.child2 = indexF;
+			f.parent = indexA;
+
+			a.box = combine(b.box, f.box);
+			c.box = combine(a.box, g.box);
+
+			a.height = 1 + std::max(b.height, f.height);
+			c.height = 1 + std::max(a.height, g.height);
+		}
+
+		return indexC;
+	}
+
+	// Rotate B up, A takes the lower child of B.
+	if (difference < -1)
+	{
+		int indexD = b.child1;
+		int indexE = b.child2;
+
+		Node &d = _nodes[indexD];
+		Node &e = _nodes[indexE];
+
+		b.child1 = indexA;
+		b.parent = a.parent;
+		a.parent = indexB;
+
+		if (b.parent != NULL_NODE)
+		{
+			if (_nodes[b.parent].child1 == indexA)
+			{
+				_nodes[b.parent].child1 = indexB;
+			}
+			else
+			{
+				_nodes[b.parent].child2 = indexB;
+			}
+		}
+		else
+		{
+			_root = indexB;
+		}
+
+		if (d.height > e.height)
+		{
+			b.child2 = indexD;
+			a.child1 = indexE;
+			e.parent = indexA;
+
+			a.box = combine(c.box, e.box);
+			b.box = combine(a.box, d.box);
+
+			a.height = 1 + std::max(c.height, e.height);
+			b.height = 1 + std::max(a.height, d.height);
+		}
+		else
+		{
+			b.child2 = indexE;
+			a.child1 = indexD;
+			d.parent = indexA;
+
+			a.box = combine(c.box, d.box);
+			b.box = combine(a.box, e.box);
+
+			a.height = 1 + std::max(c.height, d.height);
+			b.height = 1 + std::max(a.height, e.height);
+		}
+
+		return indexB;
+	}
+
+	return indexA;
+}
+
+void BoundingVolumeHierarchy::refit(
+	int index)
+{
+	while (index != NULL_NODE)
+	{
+		index = balance(index);
+
+		Node &node = _nodes[index];
+
+		const Node &child1 = _nodes[node.child1];
+		const Node &child2 = _nodes[node.child2];
+
+		node.height = 1 + std::max(child1.height, child2.height);
+		node.box = combine(child1.box, child2.box);
+
+		index = node.parent;
+	}
+}
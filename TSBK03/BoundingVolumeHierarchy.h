@@ -0,0 +1,140 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include <glm/glm.hpp>
+
+#include "AABB.h"
+#include "Frustum.h"
+#include "FrustumCulling.h"
+
+// Dynamic bounding volume hierarchy over world space boxes, each carrying a
+// value chosen by the owner. Leaves store their box grown by a margin, so
+// objects moving a little only update their exact box and the tree is only
+// changed when a box leaves its grown box. Inserting picks the sibling that
+// grows the surface area of the tree the least and rotations keep the tree
+// balanced, the same way as the dynamic tree of Box2D.
+class BoundingVolumeHierarchy
+{
+public:
+	static const int NULL_NODE = -1;
+
+	explicit BoundingVolumeHierarchy(float margin = 0.5f);
+
+	// Returns the proxy of the box, which stays the same until it is removed.
+	int insert(const AABB& box, uint32_t value);
+	void remove(int proxy);
+
+	// Updates the box of a proxy. Returns true if the proxy had to be moved
+	// in the tree.
+	bool move(int proxy, const AABB& box);
+
+	void clear();
+
+	uint32_t getValue(int proxy) const;
+	void setValue(int proxy, uint32_t value);
+
+	const AABB& getBox(int proxy) const;
+
+	size_t size() const;
+
+	// Longest path from the root to a leaf, zero for a single leaf.
+	int getHeight() const;
+
+	// Classifies the boxes against the frustum like cullBoxes and appends
+	// the values and results of the boxes that are not outside. Subtrees
+	// entirely inside are accepted without testing their leaves, the leaves
+	// of intersecting nodes are tested in one batch.
+	void cull(
+		const Frustum& frustum,
+		std::vector<uint32_t>& values,
+		std::vector<int8_t>& results) const;
+
+	// Appends the values and entry distances of the boxes hit by the ray
+	// within maxDistance, nearest first. The direction does not need to be
+	// normalized, the distances are in multiples of it.
+	void queryRay(
+		const glm::vec3& origin,
+		const glm::vec3& direction,
+		float maxDistance,
+		std::vector<std::pair<float, uint32_t>>& hits) const;
+
+	// Appends the values of the boxes touching the sphere.
+	void queryRadius(
+		const glm::vec3& center,
+		float radius,
+		std::vector<uint32_t>& values) const;
+
+	// Appends the values of the boxes touching the box.
+	void queryBox(
+		const AABB& box,
+		std::vector<uint32_t>& values) const;
+
+private:
+
+	// 64 bytes, the fields used by the traversal first.
+	struct Node
+	{
+		// Grown by the margin for leaves.
+		AABB box;
+
+		int child1{ NULL_NODE };
+
+		// Leaves have no children and keep their value instead.
+		union
+		{
+			int child2{ NULL_NODE };
+			uint32_t value;
+		};
+
+		// Parent while in the tree, next free node in the free list.
+		int parent{ NULL_NODE };
+
+		// Zero for leaves, -1 for free nodes.
+		int height{ 0 };
+
+		// The exact box, only used for leaves.
+		AABB leafBox;
+
+		bool isLeaf() const;
+	};
+
+	// Appends the values of all leaves below a node as inside.
+	void addLeaves(
+		int index,
+		std::vector<uint32_t>& values,
+		std::vector<int8_t>& results) const;
+
+	int allocateNode();
+	void freeNode(int index);
+
+	void insertLeaf(int leaf);
+	void removeLeaf(int leaf);
+
+	// Rotates the subtree if one child is more than one level higher than
+	// the other and returns its new root.
+	int balance(int index);
+
+	// Refits the boxes and heights from a node up to the root, balancing
+	// on the way.
+	void refit(int index);
+
+	float _margin;
+
+	std::vector<Node> _nodes{};
+
+	int _root{ NULL_NODE };
+	int _freeList{ NULL_NODE };
+
+	size_t _leafCount{ 0 };
+
+	// Scratch memory for the queries, kept to avoid allocations.
+	mutable std::vector<std::pair<int, uint8_t>> _stack{};
+	mutable std::vector<int> _subtreeStack{};
+	mutable std::vector<uint32_t> _batchValues{};
+	mutable CullingBoxes _batchBoxes{};
+	mutable std::vector<int8_t> _batchResults{};
+};
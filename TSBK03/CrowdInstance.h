@@ -0,0 +1,21 @@
+#pragma once
+
+#include <string>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+struct CrowdInstance
+{
+	// Transform relative to the owning crowd node.
+	glm::mat4 transform{ 1.f };
+
+	std::string animation{};
+
+	// Offset into the clip in seconds, so that instances playing the same
+	// animation do not move in lockstep.
+	float timeOffset{ 0.f };
+
+	float playbackRate{ 1.f };
+};
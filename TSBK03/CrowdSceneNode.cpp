@@ -0,0 +1,73 @@
+#include "CrowdSceneNode.h"
+
+CrowdSceneNode::CrowdSceneNode(
+	const std::string &model,
+	const std::string &tag)
+	:SceneNode(SceneNodeType::CROWD, tag),
+	_model{ model }
+{
+
+}
+
+const std::string & CrowdSceneNode::getModel() const
+{
+	return _model;
+}
+
+const std::string & CrowdSceneNode::getTexture() const
+{
+	return _texture;
+}
+
+void CrowdSceneNode::setTexture(
+	const std::string &newTexture)
+{
+	_texture = newTexture;
+	_textureRef = AssetRef<Texture2D>{};
+
+	notifyChanged(SceneNodeChange::TEXTURE);
+}
+
+unsigned int CrowdSceneNode::addInstance(
+	const CrowdInstance &instance)
+{
+	_instances.push_back(instance);
+
+	notifyChanged(SceneNodeChange::INSTANCES);
+
+	return static_cast<unsigned int>(_instances.size() - 1);
+}
+
+void CrowdSceneNode::clearInstances()
+{
+	_instances.clear();
+
+	notifyChanged(SceneNodeChange::INSTANCES);
+}
+
+const std::vector<CrowdInstance> & CrowdSceneNode::getInstances() const
+{
+	return _instances;
+}
+
+std::vector<CrowdInstance> & CrowdSceneNode::getInstances()
+{
+	notifyChanged(SceneNodeChange::INSTANCES);
+
+	return _instances;
+}
+
+unsigned int CrowdSceneNode::getInstanceCount() const
+{
+	return static_cast<unsigned int>(_instances.size());
+}
+
+AssetRef<Model> & CrowdSceneNode::getModelRef() const
+{
+	return _modelRef;
+}
+
+AssetRef<Texture2D> & CrowdSceneNode::getTextureRef() const
+{
+	return _textureRef;
+}
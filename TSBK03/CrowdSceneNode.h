@@ -0,0 +1,45 @@
+#pragma once
+
+#include "SceneNode.h"
+#include "CrowdInstance.h"
+#include "Model.h"
+#include "Texture.h"
+#include "AssetRef.h"
+
+// A scene node drawing many instances of the same skinned model in a single
+// instanced draw call. The poses are read from a baked AnimationPoseTexture,
+// so the instances are never animated on the CPU.
+class CrowdSceneNode : public SceneNode
+{
+public:
+	CrowdSceneNode(
+		const std::string& model,
+		const std::string& tag);
+
+	const std::string& getModel() const;
+
+	const std::string& getTexture() const;
+	void setTexture(const std::string& newTexture);
+
+	unsigned int addInstance(const CrowdInstance& instance);
+	void clearInstances();
+
+	const std::vector<CrowdInstance>& getInstances() const;
+	// Marks the instances as changed.
+	std::vector<CrowdInstance>& getInstances();
+	unsigned int getInstanceCount() const;
+
+	// Resolved by the renderer the first time the crowd is drawn and reset
+	// when the texture changes.
+	AssetRef<Model>& getModelRef() const;
+	AssetRef<Texture2D>& getTextureRef() const;
+private:
+	std::string _model;
+
+	std::string _texture;
+
+	std::vector<CrowdInstance> _instances{};
+
+	mutable AssetRef<Model> _modelRef{};
+	mutable AssetRef<Texture2D> _textureRef{};
+};
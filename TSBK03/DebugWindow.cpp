@@ -2,8 +2,12 @@
 
 #include <iostream>
 #include <sstream>
+#include <algorithm>
+#include <cmath>
 
 #include "Game.h"
+#include "Application.h"
+#include "Profiler.h"
 #include "ScriptExecutionException.h"
 
 DebugWindow::DebugWindow(
@@ -148,6 +152,189 @@ void DebugWindow::render(
 	ImGui::End();
 }
 
+void DebugWindow::renderProfiler(
+	bool *pOpen)
+{
+	ImGui::SetNextWindowSize(ImVec2(640, 480), ImGuiCond_FirstUseEver);
+
+	if (!ImGui::Begin("Profiler", pOpen))
+	{
+		ImGui::End();
+
+		return;
+	}
+
+	Profiler& profiler = _game->getApplication()->getRenderer()->getProfiler();
+
+	bool enabled = profiler.isEnabled();
+
+	if (ImGui::Checkbox("Enabled", &enabled))
+	{
+		profiler.setEnabled(enabled);
+	}
+
+	float frameTime = profiler.getAverageFrameTime();
+
+	ImGui::SameLine();
+	ImGui::Text("Frame: %.3fms, averaged over %u frames", frameTime, profiler.getWindowSize());
+
+	ImGui::Separator();
+
+	// Both lanes share the scale of the CPU frame, the GPU usually finishes
+	// within it.
+	ImGui::Text("CPU");
+	renderProfilerTimeline(profiler, false, frameTime);
+
+	ImGui::Text("GPU");
+	renderProfilerTimeline(profiler, true, frameTime);
+
+	ImGui::Separator();
+
+	ImGui::Columns(5, "ProfilerColumns");
+
+	ImGui::Text("Scope");
+	ImGui::NextColumn();
+	ImGui::Text("CPU [ms]");
+	ImGui::NextColumn();
+	ImGui::Text("CPU Max [ms]");
+	ImGui::NextColumn();
+	ImGui::Text("GPU [ms]");
+	ImGui::NextColumn();
+	ImGui::Text("GPU Max [ms]");
+	ImGui::NextColumn();
+
+	ImGui::Separator();
+
+	for (int index : profiler.getRoots())
+	{
+		renderProfilerNode(profiler, index);
+	}
+
+	ImGui::Columns(1);
+
+	ImGui::End();
+}
+
+void DebugWindow::renderProfilerTimeline(
+	const Profiler &profiler,
+	bool gpu,
+	float frameTime)
+{
+	const std::vector<Profiler::Node>& nodes = profiler.getNodes();
+
+	int maxDepth = 0;
+
+	for (const auto& node : nodes)
+	{
+		if (!gpu || node.gpu)
+		{
+			maxDepth = std::max(maxDepth, node.depth);
+		}
+	}
+
+	const float rowHeight = ImGui::GetTextLineHeight() + 4.f;
+
+	ImVec2 origin = ImGui::GetCursorScreenPos();
+	ImVec2 size{ ImGui::GetContentRegionAvailWidth(), rowHeight * (maxDepth + 1) };
+
+	ImDrawList *drawList = ImGui::GetWindowDrawList();
+
+	drawList->AddRectFilled(origin, ImVec2(origin.x + size.x, origin.y + size.y), ImColor(0.1f, 0.1f, 0.1f, 1.f));
+
+	float scale = frameTime > 0.f ? size.x / frameTime : 0.f;
+
+	for (size_t i = 0; i < nodes.size(); ++i)
+	{
+		const Profiler::Node& node = nodes[i];
+
+		if (gpu && !node.gpu)
+		{
+			continue;
+		}
+
+		int index = static_cast<int>(i);
+
+		float start = gpu ? profiler.getAverageGPUStart(index) : profiler.getAverageCPUStart(index);
+		float time = gpu ? profiler.getAverageGPUTime(index) : profiler.getAverageCPUTime(index);
+
+		ImVec2 min{ origin.x + start * scale, origin.y + node.depth * rowHeight };
+		ImVec2 max{ std::min(min.x + std::max(time * scale, 1.f), origin.x + size.x), min.y + rowHeight - 1.f };
+
+		if (min.x >= origin.x + size.x)
+		{
+			continue;
+		}
+
+		// Neighbours differ in hue, levels in brightness.
+		ImColor color = ImColor::HSV(std::fmod(i * 0.13f, 1.f), 0.6f, 0.8f - 0.08f * std::min(node.depth, 5));
+
+		drawList->AddRectFilled(min, max, color);
+
+		if (ImGui::CalcTextSize(node.name.c_str()).x + 4.f < max.x - min.x)
+		{
+			drawList->AddText(ImVec2(min.x + 2.f, min.y + 2.f), ImColor(0.f, 0.f, 0.f, 1.f), node.name.c_str());
+		}
+
+		if (ImGui::IsMouseHoveringRect(min, max))
+		{
+			ImGui::SetTooltip("%s\n%.3fms at %.3fms", node.name.c_str(), time, start);
+		}
+	}
+
+	ImGui::Dummy(size);
+}
+
+void DebugWindow::renderProfilerNode(
+	const Profiler &profiler,
+	int index)
+{
+	const Profiler::Node& node = profiler.getNodes()[index];
+
+	ImGui::PushID(index);
+
+	ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_DefaultOpen;
+
+	if (node.children.empty())
+	{
+		flags |= ImGuiTreeNodeFlags_Leaf;
+	}
+
+	bool open = ImGui::TreeNodeEx(node.name.c_str(), flags);
+
+	ImGui::NextColumn();
+	ImGui::Text("%.3f", profiler.getAverageCPUTime(index));
+	ImGui::NextColumn();
+	ImGui::Text("%.3f", profiler.getMaxCPUTime(index));
+	ImGui::NextColumn();
+
+	if (node.gpu)
+	{
+		ImGui::Text("%.3f", profiler.getAverageGPUTime(index));
+		ImGui::NextColumn();
+		ImGui::Text("%.3f", profiler.getMaxGPUTime(index));
+		ImGui::NextColumn();
+	}
+	else
+	{
+		ImGui::Text("-");
+		ImGui::NextColumn();
+		ImGui::Text("-");
+		ImGui::NextColumn();
+	}
+
+	if (open)
+	{
+		for (int child : node.children)
+		{
+			renderProfilerNode(profiler, child);
+		}
+
+		ImGui::TreePop();
+	}
+
+	ImGui::PopID();
+}
+
 void DebugWindow::executeCommand(const std::string& str)
 {
 	addToLog(std::string{ "# " } +str);
@@ -6,6 +6,7 @@
 #include <string>
 
 class Game;
+class Profiler;
 
 #define INPUT_BUFFER_SIZE 256
 
@@ -20,12 +21,22 @@ public:
 
 	void render(bool *pOpen);
 
+	// Shows the scopes of the profiler as a timeline of the average frame,
+	// with a row per level, and as a tree with their average and largest
+	// times.
+	void renderProfiler(bool *pOpen);
+
 	void executeCommand(const std::string& str);
 
 private:
 	static int textEditCallbackStub(ImGuiInputTextCallbackData *data);
 	int textEditCallback(ImGuiInputTextCallbackData *data);
 
+	// Draws one lane of the timeline, either the CPU or the GPU times.
+	void renderProfilerTimeline(const Profiler& profiler, bool gpu, float frameTime);
+
+	void renderProfilerNode(const Profiler& profiler, int index);
+
 	char _inputBuffer[INPUT_BUFFER_SIZE];
 	std::vector<std::string> _items;
 	bool _scrollToBottom = true;
@@ -10,6 +10,8 @@ DirectionalLightSceneNode::DirectionalLightSceneNode(
 
 DirectionalLight & DirectionalLightSceneNode::getDirectionalLight()
 {
+	notifyChanged(SceneNodeChange::LIGHT);
+
 	return _directionalLight;
 }
 
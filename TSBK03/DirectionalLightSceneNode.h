@@ -10,6 +10,7 @@ public:
 		const DirectionalLight& directionalLight, 
 		const std::string& tag);
 
+	// The light is returned for modification, so it is marked as changed.
 	DirectionalLight& getDirectionalLight();
 	const DirectionalLight& getDirectionalLight() const;
 private:
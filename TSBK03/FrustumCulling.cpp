@@ -0,0 +1,292 @@
+#include "FrustumCulling.h"
+
+#include <cmath>
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define FRUSTUM_CULLING_SSE 1
+#include <emmintrin.h>
+#else
+#define FRUSTUM_CULLING_SSE 0
+#endif
+
+namespace
+{
+	int8_t cullBox(
+		const Frustum &frustum,
+		const CullingBoxes &boxes,
+		size_t index,
+		uint8_t *planeHint)
+	{
+		const float cx = boxes.centerX[index];
+		const float cy = boxes.centerY[index];
+		const float cz = boxes.centerZ[index];
+
+		const float ex = boxes.extentX[index];
+		const float ey = boxes.extentY[index];
+		const float ez = boxes.extentZ[index];
+
+		int8_t result = 1;
+
+		for (unsigned int i = 0; i < 6; ++i)
+		{
+			// Start with the plane that rejected the box last time.
+			unsigned int planeIndex = planeHint != nullptr ? (*planeHint + i) % 6 : i;
+
+			const Plane &plane = frustum.planes[planeIndex];
+
+			float distance = plane.a * cx + plane.b * cy + plane.c * cz + plane.d;
+			float radius = std::abs(plane.a) * ex + std::abs(plane.b) * ey + std::abs(plane.c) * ez;
+
+			// The p-vertex is behind the plane.
+			if (distance + radius < 0.f)
+			{
+				if (planeHint != nullptr)
+				{
+					*planeHint = static_cast<uint8_t>(planeIndex);
+				}
+
+				return -1;
+			}
+
+			// The n-vertex is behind the plane.
+			if (distance - radius < 0.f)
+			{
+				result = 0;
+			}
+		}
+
+		return result;
+	}
+
+#if FRUSTUM_CULLING_SSE
+	inline __m128 absolute(
+		__m128 value)
+	{
+		return _mm_andnot_ps(_mm_set1_ps(-0.f), value);
+	}
+
+	// Narrows four 32 bit lanes to bytes and stores them.
+	inline void storeLanes(
+		void *destination,
+		__m128i lanes)
+	{
+		__m128i packed = _mm_packs_epi16(_mm_packs_epi32(lanes, lanes), lanes);
+		int32_t bytes = _mm_cvtsi128_si32(packed);
+
+		memcpy(destination, &bytes, sizeof(bytes));
+	}
+
+	size_t cullBoxesSSE2(
+		const Frustum &frustum,
+		const CullingBoxes &boxes,
+		int8_t *results,
+		uint8_t *planeHints)
+	{
+		const size_t count = boxes.size();
+		const __m128 zero = _mm_setzero_ps();
+
+		size_t i = 0;
+
+		for (; i + 4 <= count; i += 4)
+		{
+			const __m128 cx = _mm_loadu_ps(&boxes.centerX[i]);
+			const __m128 cy = _mm_loadu_ps(&boxes.centerY[i]);
+			const __m128 cz = _mm_loadu_ps(&boxes.centerZ[i]);
+
+			const __m128 ex = _mm_loadu_ps(&boxes.extentX[i]);
+			const __m128 ey = _mm_loadu_ps(&boxes.extentY[i]);
+			const __m128 ez = _mm_loadu_ps(&boxes.extentZ[i]);
+
+			__m128 outside = zero;
+			__m128 intersecting = zero;
+
+			// The lanes can not each start with their own plane. When the four
+			// boxes were rejected by the same plane last time, which is the
+			// common case for neighbouring objects, that plane goes first.
+			int firstPlane = 0;
+
+			if (planeHints != nullptr)
+			{
+				uint32_t hints;
+				memcpy(&hints, planeHints + i, sizeof(hints));
+
+				if (hints == (hints & 0xFF) * 0x01010101u)
+				{
+					firstPlane = static_cast<int>((hints & 0xFF) % 6);
+				}
+			}
+
+			// Boxes that are not rejected get plane 0 as their hint.
+			__m128i rejectingPlane = _mm_setzero_si128();
+
+			for (int j = 0; j < 6; ++j)
+			{
+				const int planeIndex = (firstPlane + j) % 6;
+				const Plane &plane = frustum.planes[planeIndex];
+
+				__m128 distance = _mm_add_ps(
+					_mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.a), cx), _mm_mul_ps(_mm_set1_ps(plane.b), cy)),
+					_mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.c), cz), _mm_set1_ps(plane.d)));
+
+				__m128 radius = _mm_add_ps(
+					_mm_add_ps(_mm_mul_ps(_mm_set1_ps(std::abs(plane.a)), ex), _mm_mul_ps(_mm_set1_ps(std::abs(plane.b)), ey)),
+					_mm_mul_ps(_mm_set1_ps(std::abs(plane.c)), ez));
+
+				__m128 rejected = _mm_andnot_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, radius), zero));
+
+				// Remember the first plane that rejected each box.
+				rejectingPlane = _mm_or_si128(
+					_mm_andnot_si128(_mm_castps_si128(rejected), rejectingPlane),
+					_mm_and_si128(_mm_castps_si128(rejected), _mm_set1_epi32(planeIndex)));
+
+				outside = _mm_or_ps(outside, rejected);
+				intersecting = _mm_or_ps(intersecting, _mm_cmplt_ps(_mm_sub_ps(distance, radius), zero));
+
+				if (_mm_movemask_ps(outside) == 0xF)
+				{
+					break;
+				}
+			}
+
+			// 1 - intersecting, and -1 where outside. The masks are -1 where set.
+			__m128i result = _mm_add_epi32(_mm_set1_epi32(1), _mm_castps_si128(intersecting));
+			result = _mm_or_si128(_mm_andnot_si128(_mm_castps_si128(outside), result), _mm_castps_si128(outside));
+
+			storeLanes(results + i, result);
+
+			if (planeHints != nullptr)
+			{
+				storeLanes(planeHints + i, rejectingPlane);
+			}
+		}
+
+		return i;
+	}
+#endif
+}
+
+size_t CullingBoxes::size() const
+{
+	return centerX.size();
+}
+
+void CullingBoxes::clear()
+{
+	centerX.clear();
+	centerY.clear();
+	centerZ.clear();
+
+	extentX.clear();
+	extentY.clear();
+	extentZ.clear();
+}
+
+void CullingBoxes::reserve(
+	size_t count)
+{
+	centerX.reserve(count);
+	centerY.reserve(count);
+	centerZ.reserve(count);
+
+	extentX.reserve(count);
+	extentY.reserve(count);
+	extentZ.reserve(count);
+}
+
+void CullingBoxes::add(
+	const glm::vec3 &center,
+	const glm::vec3 &extents)
+{
+	centerX.push_back(center.x);
+	centerY.push_back(center.y);
+	centerZ.push_back(center.z);
+
+	extentX.push_back(extents.x);
+	extentY.push_back(extents.y);
+	extentZ.push_back(extents.z);
+}
+
+void CullingBoxes::add(
+	const AABB &box,
+	const glm::mat4 &transform)
+{
+	AABB bounds = box.getBoundingBox(transform);
+
+	add(bounds.getCenter(), bounds.getSize() * 0.5f);
+}
+
+glm::vec3 CullingBoxes::getCenter(
+	size_t index) const
+{
+	return glm::vec3{ centerX[index], centerY[index], centerZ[index] };
+}
+
+glm::vec3 CullingBoxes::getExtents(
+	size_t index) const
+{
+	return glm::vec3{ extentX[index], extentY[index], extentZ[index] };
+}
+
+void cullBoxes(
+	const Frustum &frustum,
+	const CullingBoxes &boxes,
+	int8_t *results,
+	uint8_t *planeHints)
+{
+	size_t i = 0;
+
+#if FRUSTUM_CULLING_SSE
+	i = cullBoxesSSE2(frustum, boxes, results, planeHints);
+#endif
+
+	for (; i < boxes.size(); ++i)
+	{
+		results[i] = cullBox(frustum, boxes, i, planeHints != nullptr ? planeHints + i : nullptr);
+	}
+}
+
+void cullBoxesScalar(
+	const Frustum &frustum,
+	const CullingBoxes &boxes,
+	int8_t *results,
+	uint8_t *planeHints)
+{
+	for (size_t i = 0; i < boxes.size(); ++i)
+	{
+		results[i] = cullBox(frustum, boxes, i, planeHints != nullptr ? planeHints + i : nullptr);
+	}
+}
+
+int8_t cullBox(
+	const Frustum &frustum,
+	const glm::vec3 &center,
+	const glm::vec3 &extents,
+	uint8_t &planeMask)
+{
+	for (unsigned int i = 0; i < 6; ++i)
+	{
+		if ((planeMask & (1 << i)) == 0)
+		{
+			continue;
+		}
+
+		const Plane &plane = frustum.planes[i];
+
+		float distance = plane.a * center.x + plane.b * center.y + plane.c * center.z + plane.d;
+		float radius = std::abs(plane.a) * extents.x + std::abs(plane.b) * extents.y + std::abs(plane.c) * extents.z;
+
+		if (distance + radius < 0.f)
+		{
+			return -1;
+		}
+
+		// The n-vertex is in front of the plane, so is the whole box.
+		if (distance - radius >= 0.f)
+		{
+			planeMask &= ~(1 << i);
+		}
+	}
+
+	return planeMask == 0 ? 1 : 0;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+#include "Frustum.h"
+#include "AABB.h"
+
+// Axis aligned boxes given by their centres and half extents, with one array
+// per component so that the culling kernel can load four boxes at a time.
+struct CullingBoxes
+{
+	std::vector<float> centerX;
+	std::vector<float> centerY;
+	std::vector<float> centerZ;
+
+	std::vector<float> extentX;
+	std::vector<float> extentY;
+	std::vector<float> extentZ;
+
+	size_t size() const;
+
+	void clear();
+	void reserve(size_t count);
+
+	void add(const glm::vec3& center, const glm::vec3& extents);
+
+	// Adds the axis aligned box enclosing the box after the transform.
+	void add(const AABB& box, const glm::mat4& transform);
+
+	glm::vec3 getCenter(size_t index) const;
+	glm::vec3 getExtents(size_t index) const;
+};
+
+// Classifies the boxes against the six planes of the frustum with the same
+// results as Frustum::boxIntersect: 1 if a box is inside, 0 if it intersects
+// and -1 if it is outside. For every plane only the corner furthest along the
+// normal (the p-vertex) and the one furthest against it (the n-vertex) are
+// tested, which are found from the extents without looking at the corners.
+//
+// Four boxes are tested at once with SSE2 where available. planeHints may be
+// null, otherwise it holds one plane index per box that is tested first and
+// is set to the plane that rejected the box. Objects that stay outside keep
+// being rejected by the same plane, so most of them only need one test. The
+// SIMD kernel only uses the hint when all four boxes share it, so boxes that
+// are close in space should be close in the arrays.
+void cullBoxes(
+	const Frustum& frustum,
+	const CullingBoxes& boxes,
+	int8_t *results,
+	uint8_t *planeHints = nullptr);
+
+// Plain loop without SIMD, for comparison.
+void cullBoxesScalar(
+	const Frustum& frustum,
+	const CullingBoxes& boxes,
+	int8_t *results,
+	uint8_t *planeHints = nullptr);
+
+// Classifies a single box like cullBoxes. planeMask holds one bit per plane
+// that is still tested, planes the box is entirely in front of are cleared
+// from it. Children of a box are inside those planes too, so hierarchies
+// pass the mask on and skip the planes.
+int8_t cullBox(
+	const Frustum& frustum,
+	const glm::vec3& center,
+	const glm::vec3& extents,
+	uint8_t& planeMask);
@@ -0,0 +1,71 @@
+#include "GLSLComputeShader.h"
+
+
+#include <GL/glew.h>
+
+#include "Utils.h"
+#include <iostream>
+
+GLSLComputeShader::GLSLComputeShader(
+	const std::string &path,
+	const std::string &defines)
+	:_path{ path }, _defines{ defines }
+{
+
+}
+
+GLSLComputeShader::~GLSLComputeShader()
+{
+	if (glIsShader(_handle))
+	{
+		glDeleteShader(_handle);
+	}
+}
+
+void GLSLComputeShader::beginCompile()
+{
+	_handle = glCreateShader(GL_COMPUTE_SHADER);
+
+	std::string shaderSource = insertShaderDefines(getStringFromFile(_path), _defines);
+	const char *shaderSourcePtr = shaderSource.c_str();
+	glShaderSource(_handle, 1, &shaderSourcePtr, NULL);
+	glCompileShader(_handle);
+}
+
+int GLSLComputeShader::compile()
+{
+	if (_handle == 0)
+	{
+		beginCompile();
+	}
+
+	GLint success;
+	glGetShaderiv(_handle, GL_COMPILE_STATUS, &success);
+
+	if (!success)
+	{
+		GLchar *infoLog;
+		GLint infoLogSize;
+		glGetShaderiv(_handle, GL_INFO_LOG_LENGTH, &infoLogSize);
+
+		infoLog = static_cast<GLchar *>(malloc(infoLogSize));
+
+		glGetShaderInfoLog(_handle, infoLogSize, NULL, infoLog);
+
+		_infoLog = std::string{ infoLog };
+
+		free(infoLog);
+	}
+
+	return success;
+}
+
+const std::string &  GLSLComputeShader::getInfoLog() const
+{
+	return _infoLog;
+}
+
+GLSLComputeShaderHandle  GLSLComputeShader::getHandle() const
+{
+	return _handle;
+}
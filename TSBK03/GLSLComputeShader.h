@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string>
+
+using GLSLComputeShaderHandle = unsigned int;
+
+class GLSLComputeShader
+{
+public:
+	// The defines are inserted right after the #version line.
+	explicit GLSLComputeShader(const std::string& path, const std::string& defines = "");
+
+	~GLSLComputeShader();
+
+	// Hands the source to the driver without waiting for the result, so
+	// that drivers with parallel compilation can work on several at once.
+	void beginCompile();
+
+	// Compiles if that has not been started and waits for the result.
+	int compile();
+
+	const std::string& getInfoLog() const;
+
+	GLSLComputeShaderHandle getHandle() const;
+private:
+	std::string _path;
+	std::string _defines;
+
+	GLSLComputeShaderHandle _handle{ 0 };
+
+	std::string _infoLog{};
+};
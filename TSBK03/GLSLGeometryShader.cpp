@@ -7,8 +7,9 @@
 #include <iostream>
 
 GLSLGeometryShader::GLSLGeometryShader(
-	const std::string &path)
-	:_path{ path }
+	const std::string &path,
+	const std::string &defines)
+	:_path{ path }, _defines{ defines }
 {
 
 }
@@ -21,14 +22,22 @@ GLSLGeometryShader::~GLSLGeometryShader()
 	}
 }
 
-int  GLSLGeometryShader::compile()
+void GLSLGeometryShader::beginCompile()
 {
 	_handle = glCreateShader(GL_GEOMETRY_SHADER);
 
-	std::string shaderSource = getStringFromFile(_path);
+	std::string shaderSource = insertShaderDefines(getStringFromFile(_path), _defines);
 	const char *shaderSourcePtr = shaderSource.c_str();
 	glShaderSource(_handle, 1, &shaderSourcePtr, NULL);
 	glCompileShader(_handle);
+}
+
+int GLSLGeometryShader::compile()
+{
+	if (_handle == 0)
+	{
+		beginCompile();
+	}
 
 	GLint success;
 	glGetShaderiv(_handle, GL_COMPILE_STATUS, &success);
@@ -13,6 +13,66 @@
 #include "GLSLGeometryShader.h"
 #include "GLSLTessEvalShader.h"
 #include "GLSLTessControlShader.h"
+#include "GLSLComputeShader.h"
+
+#include <fstream>
+#include <iterator>
+#include <cstdio>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+namespace
+{
+	uint64_t fnv1a64(
+		const std::string &data,
+		uint64_t hash = 14695981039346656037ull)
+	{
+		for (unsigned char c : data)
+		{
+			hash ^= c;
+			hash *= 1099511628211ull;
+		}
+
+		return hash;
+	}
+
+	// Binaries are only valid for the driver that produced them.
+	std::string getDriverString()
+	{
+		std::string driver;
+
+		for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION, GL_SHADING_LANGUAGE_VERSION })
+		{
+			const GLubyte *value = glGetString(name);
+
+			if (value != nullptr)
+			{
+				driver += reinterpret_cast<const char *>(value);
+			}
+
+			driver += '\n';
+		}
+
+		return driver;
+	}
+
+	// Does nothing if the directory already exists.
+	void makeDirectory(
+		const std::string &path)
+	{
+#ifdef _WIN32
+		_mkdir(path.c_str());
+#else
+		mkdir(path.c_str(), 0755);
+#endif
+	}
+}
+
+std::string GLSLShader::_binaryCacheDirectory{ "shadercache" };
 
 GLSLShader::GLSLShader()
 {
@@ -21,6 +81,8 @@ GLSLShader::GLSLShader()
 
 GLSLShader::~GLSLShader()
 {
+	releaseStages();
+
 	if (glIsProgram(_programId))
 	{
 		glDeleteProgram(_programId);
@@ -57,82 +119,190 @@ void GLSLShader::setFragmentShaderSource(
 	_fragmentShaderSource = source;
 }
 
+void GLSLShader::setComputeShaderSource(
+	const std::string &source)
+{
+	_computeShaderSource = source;
+}
+
+void GLSLShader::setDefines(
+	const std::string &defines)
+{
+	_defines = defines;
+}
+
+const std::string & GLSLShader::getDefines() const
+{
+	return _defines;
+}
+
+void GLSLShader::setPermutationFeatures(
+	const std::vector<std::string> &features)
+{
+	_permutationFeatures = features;
+}
+
+GLSLShader & GLSLShader::getPermutation(
+	const GLSLShaderPermutation &permutation)
+{
+	auto it = _permutations.find(permutation.getKey());
+
+	if (it == _permutations.end())
+	{
+		std::unique_ptr<GLSLShader> variant{ new GLSLShader{} };
+
+		variant->setVertexShaderSource(_vertexShaderSource);
+		variant->setTessellationControlSource(_tessellationControlSource);
+		variant->setTessellationEvaluationSource(_tessellationEvaluationSource);
+		variant->setGeometryShaderSource(_geometryShaderSource);
+		variant->setFragmentShaderSource(_fragmentShaderSource);
+		variant->setComputeShaderSource(_computeShaderSource);
+		variant->setDefines(_defines + permutation.getDefines(_permutationFeatures));
+
+		try
+		{
+			variant->compile();
+		}
+		catch (const GLSLShaderCompilationException& ex)
+		{
+			std::cerr << ex.what() << std::endl;
+			variant.reset();
+		}
+
+		it = _permutations.emplace(permutation.getKey(), std::move(variant)).first;
+	}
+
+	return it->second ? *it->second : *this;
+}
+
+unsigned int GLSLShader::getNumPermutations() const
+{
+	return static_cast<unsigned int>(_permutations.size());
+}
+
 void GLSLShader::compile()
+{
+	beginCompile();
+	finishCompile();
+}
+
+void GLSLShader::beginCompile()
 {
 	if (glIsProgram(_programId))
 	{
-		glDeleteShader(_programId);
+		glDeleteProgram(_programId);
 	}
 
+	releaseStages();
+
 	_programId = glCreateProgram();
 
-	GLSLVertexShader vertexShader{ _vertexShaderSource };
-	GLSLFragmentShader fragmentShader{ _fragmentShaderSource };
-	GLSLGeometryShader geometryShader{ _geometryShaderSource };
-	GLSLTessEvalShader tessEvalShader{ _tessellationEvaluationSource };
-	GLSLTessControlShader tessControlShader{ _tessellationControlSource };
+	_fromBinaryCache = false;
 
-	if (!_vertexShaderSource.empty())
+	if (!_binaryCacheDirectory.empty())
 	{
-		int success = vertexShader.compile();
+		_binaryCacheKey = getBinaryCacheKey();
 
-		if (!success)
+		if (loadBinary())
 		{
-			throw GLSLShaderCompilationException{ std::string{ "[SHADER][" + _vertexShaderSource + "]Vertex Shader Compilation Error: " } +vertexShader.getInfoLog() };
+			_fromBinaryCache = true;
+			return;
 		}
 
-		glAttachShader(_programId, vertexShader.getHandle());
+		// Start over with a clean program if the binary was rejected.
+		glDeleteProgram(_programId);
+		_programId = glCreateProgram();
+
+		glProgramParameteri(_programId, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
 	}
 
-	if (!_fragmentShaderSource.empty())
+	if (!_vertexShaderSource.empty())
 	{
-		int success = fragmentShader.compile();
+		_vertexShader.reset(new GLSLVertexShader{ _vertexShaderSource, _defines });
+		_vertexShader->beginCompile();
 
-		if (!success)
-		{
-			throw GLSLShaderCompilationException{ std::string{ "[SHADER][" + _fragmentShaderSource+ "] Fragment Shader Compilation Error: " } +fragmentShader.getInfoLog() };
-		}
+		glAttachShader(_programId, _vertexShader->getHandle());
+	}
+
+	if (!_fragmentShaderSource.empty())
+	{
+		_fragmentShader.reset(new GLSLFragmentShader{ _fragmentShaderSource, _defines });
+		_fragmentShader->beginCompile();
 
-		glAttachShader(_programId, fragmentShader.getHandle());
+		glAttachShader(_programId, _fragmentShader->getHandle());
 	}
 
 	if (!_geometryShaderSource.empty())
 	{
-		int success = geometryShader.compile();
-
-		if (!success)
-		{
-			throw GLSLShaderCompilationException{ std::string{ "[SHADER][" + _geometryShaderSource + "] Geometry Shader Compilation Error: " } +geometryShader.getInfoLog() };
-		}
+		_geometryShader.reset(new GLSLGeometryShader{ _geometryShaderSource, _defines });
+		_geometryShader->beginCompile();
 
-		glAttachShader(_programId, geometryShader.getHandle());
+		glAttachShader(_programId, _geometryShader->getHandle());
 	}
 
 	if (!_tessellationEvaluationSource.empty())
 	{
-		int success = tessEvalShader.compile();
-
-		if (!success)
-		{
-			throw GLSLShaderCompilationException{ std::string{ "[SHADER][" + _tessellationEvaluationSource + "] Fragment Shader Compilation Error: " } +tessEvalShader.getInfoLog() };
-		}
+		_tessEvalShader.reset(new GLSLTessEvalShader{ _tessellationEvaluationSource, _defines });
+		_tessEvalShader->beginCompile();
 
-		glAttachShader(_programId, tessEvalShader.getHandle());
+		glAttachShader(_programId, _tessEvalShader->getHandle());
 	}
 
 	if (!_tessellationControlSource.empty())
 	{
-		int success = tessControlShader.compile();
+		_tessControlShader.reset(new GLSLTessControlShader{ _tessellationControlSource, _defines });
+		_tessControlShader->beginCompile();
 
-		if (!success)
-		{
-			throw GLSLShaderCompilationException{ std::string{ "[SHADER][" + _tessellationControlSource + "] Fragment Shader Compilation Error: " } +tessControlShader.getInfoLog() };
-		}
+		glAttachShader(_programId, _tessControlShader->getHandle());
+	}
+
+	if (!_computeShaderSource.empty())
+	{
+		_computeShader.reset(new GLSLComputeShader{ _computeShaderSource, _defines });
+		_computeShader->beginCompile();
 
-		glAttachShader(_programId, tessControlShader.getHandle());
+		glAttachShader(_programId, _computeShader->getHandle());
 	}
 
 	glLinkProgram(_programId);
+}
+
+void GLSLShader::finishCompile()
+{
+	if (_fromBinaryCache)
+	{
+		return;
+	}
+
+	if (_vertexShader && !_vertexShader->compile())
+	{
+		throw GLSLShaderCompilationException{ std::string{ "[SHADER][" + _vertexShaderSource + "]Vertex Shader Compilation Error: " } +_vertexShader->getInfoLog() };
+	}
+
+	if (_fragmentShader && !_fragmentShader->compile())
+	{
+		throw GLSLShaderCompilationException{ std::string{ "[SHADER][" + _fragmentShaderSource+ "] Fragment Shader Compilation Error: " } +_fragmentShader->getInfoLog() };
+	}
+
+	if (_geometryShader && !_geometryShader->compile())
+	{
+		throw GLSLShaderCompilationException{ std::string{ "[SHADER][" + _geometryShaderSource + "] Geometry Shader Compilation Error: " } +_geometryShader->getInfoLog() };
+	}
+
+	if (_tessEvalShader && !_tessEvalShader->compile())
+	{
+		throw GLSLShaderCompilationException{ std::string{ "[SHADER][" + _tessellationEvaluationSource + "] Tessellation Evaluation Shader Compilation Error: " } +_tessEvalShader->getInfoLog() };
+	}
+
+	if (_tessControlShader && !_tessControlShader->compile())
+	{
+		throw GLSLShaderCompilationException{ std::string{ "[SHADER][" + _tessellationControlSource + "] Tessellation Control Shader Compilation Error: " } +_tessControlShader->getInfoLog() };
+	}
+
+	if (_computeShader && !_computeShader->compile())
+	{
+		throw GLSLShaderCompilationException{ std::string{ "[SHADER][" + _computeShaderSource + "] Compute Shader Compilation Error: " } +_computeShader->getInfoLog() };
+	}
 
 	GLint success;
 	glGetProgramiv(_programId, GL_LINK_STATUS, &success);
@@ -153,6 +323,180 @@ void GLSLShader::compile()
 
 		throw GLSLShaderCompilationException{ std::string{"[SHADER] Link Error: "} +_infoLog };
 	}
+
+	// The linked program no longer needs the stages.
+	releaseStages();
+
+	if (!_binaryCacheDirectory.empty())
+	{
+		saveBinary();
+	}
+}
+
+void GLSLShader::compile(
+	const std::vector<GLSLShader *> &shaders)
+{
+	if (GLEW_ARB_parallel_shader_compile)
+	{
+		// Let the driver pick the number of threads.
+		glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+	}
+
+	for (auto shader : shaders)
+	{
+		shader->beginCompile();
+	}
+
+	for (auto shader : shaders)
+	{
+		shader->finishCompile();
+	}
+}
+
+bool GLSLShader::isFromBinaryCache() const
+{
+	return _fromBinaryCache;
+}
+
+void GLSLShader::setBinaryCacheDirectory(
+	const std::string &directory)
+{
+	_binaryCacheDirectory = directory;
+}
+
+const std::string & GLSLShader::getBinaryCacheDirectory()
+{
+	return _binaryCacheDirectory;
+}
+
+uint64_t GLSLShader::getBinaryCacheKey() const
+{
+	uint64_t key = fnv1a64(getDriverString());
+
+	key = fnv1a64(_defines, key);
+
+	const std::string *sources[] = {
+		&_vertexShaderSource,
+		&_tessellationControlSource,
+		&_tessellationEvaluationSource,
+		&_geometryShaderSource,
+		&_fragmentShaderSource,
+		&_computeShaderSource
+	};
+
+	// The stage is part of the key as well, an empty source separates the
+	// stages.
+	for (auto source : sources)
+	{
+		if (!source->empty())
+		{
+			key = fnv1a64(getStringFromFile(*source), key);
+		}
+
+		key = fnv1a64("\n", key);
+	}
+
+	return key;
+}
+
+std::string GLSLShader::getBinaryCachePath() const
+{
+	char name[17];
+	snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(_binaryCacheKey));
+
+	return _binaryCacheDirectory + "/" + name + ".bin";
+}
+
+bool GLSLShader::loadBinary()
+{
+	std::ifstream file{ getBinaryCachePath(), std::ios::binary };
+
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	GLenum format;
+
+	if (!file.read(reinterpret_cast<char *>(&format), sizeof(format)))
+	{
+		return false;
+	}
+
+	std::vector<char> binary{ std::istreambuf_iterator<char>{ file }, std::istreambuf_iterator<char>{} };
+
+	if (binary.empty())
+	{
+		return false;
+	}
+
+	glProgramBinary(_programId, format, binary.data(), static_cast<GLsizei>(binary.size()));
+
+	// Drivers reject binaries from other versions, which is not an error.
+	GLint success;
+	glGetProgramiv(_programId, GL_LINK_STATUS, &success);
+
+	return success == GL_TRUE;
+}
+
+void GLSLShader::saveBinary() const
+{
+	GLint numFormats = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats);
+
+	GLint size = 0;
+	glGetProgramiv(_programId, GL_PROGRAM_BINARY_LENGTH, &size);
+
+	if (numFormats == 0 || size == 0)
+	{
+		return;
+	}
+
+	std::vector<char> binary(size);
+	GLenum format;
+
+	glGetProgramBinary(_programId, size, nullptr, &format, binary.data());
+
+	makeDirectory(_binaryCacheDirectory);
+
+	std::ofstream file{ getBinaryCachePath(), std::ios::binary };
+
+	if (!file.is_open())
+	{
+		std::cerr << "[SHADER] Could not write the program binary to " << getBinaryCachePath() << std::endl;
+		return;
+	}
+
+	file.write(reinterpret_cast<const char *>(&format), sizeof(format));
+	file.write(binary.data(), binary.size());
+}
+
+void GLSLShader::releaseStages()
+{
+	const GLuint handles[] = {
+		_vertexShader ? _vertexShader->getHandle() : 0,
+		_fragmentShader ? _fragmentShader->getHandle() : 0,
+		_geometryShader ? _geometryShader->getHandle() : 0,
+		_tessEvalShader ? _tessEvalShader->getHandle() : 0,
+		_tessControlShader ? _tessControlShader->getHandle() : 0,
+		_computeShader ? _computeShader->getHandle() : 0
+	};
+
+	// Attached shaders are only deleted once they are detached.
+	for (auto handle : handles)
+	{
+		if (handle != 0 && glIsProgram(_programId))
+		{
+			glDetachShader(_programId, handle);
+		}
+	}
+
+	_vertexShader.reset();
+	_fragmentShader.reset();
+	_geometryShader.reset();
+	_tessEvalShader.reset();
+	_tessControlShader.reset();
+	_computeShader.reset();
 }
 
 void GLSLShader::use() const
@@ -3,17 +3,29 @@
 #include <string>
 #include <glm/glm.hpp>
 #include <vector>
+#include <memory>
+#include <cstdint>
+#include <unordered_map>
 
 #include "GLSLShaderMethodNotImplementedException.h"
 #include "GLSLShaderCompilationException.h"
 #include "Color.h"
+#include "GLSLShaderPermutation.h"
 
 using GLSLTessellationControlShaderHandle = unsigned int;
 using GLSLTessellationEvaluationShaderHandle = unsigned int;
 using GLSLGeometryShaderHandle = unsigned int;
+using GLSLComputeShaderHandle = unsigned int;
 
 using GLSLShaderProgramHandle = unsigned int;
 
+class GLSLVertexShader;
+class GLSLFragmentShader;
+class GLSLGeometryShader;
+class GLSLTessEvalShader;
+class GLSLTessControlShader;
+class GLSLComputeShader;
+
 class GLSLShader
 {
 public:
@@ -32,9 +44,43 @@ public:
 	void setTessellationEvaluationSource(const std::string& source);
 	void setGeometryShaderSource(const std::string& source);
 	void setFragmentShaderSource(const std::string& source);
+	void setComputeShaderSource(const std::string& source);
+
+	// Lines of #defines inserted into every stage after its #version line.
+	void setDefines(const std::string& defines);
+	const std::string& getDefines() const;
+
+	// Names defined by the feature bits of a permutation, lowest bit first.
+	void setPermutationFeatures(const std::vector<std::string>& features);
+
+	// Returns the variant of the program for the permutation, compiling it
+	// the first time it is asked for. Falls back to this program if the
+	// variant does not compile.
+	GLSLShader& getPermutation(const GLSLShaderPermutation& permutation);
+
+	unsigned int getNumPermutations() const;
 
+	// Loads the program from the binary cache, or compiles and links it and
+	// stores the binary. Throws GLSLShaderCompilationException on errors.
 	void compile();
 
+	// compile() split in two. beginCompile hands everything to the driver
+	// and finishCompile waits for it, so that drivers that compile in
+	// parallel can work on several programs in between.
+	void beginCompile();
+	void finishCompile();
+
+	// Compiles the programs concurrently where the driver supports it.
+	static void compile(const std::vector<GLSLShader *>& shaders);
+
+	// True if the program was loaded from the binary cache.
+	bool isFromBinaryCache() const;
+
+	// Program binaries are cached in the directory, keyed by the sources and
+	// the driver. An empty directory disables the cache.
+	static void setBinaryCacheDirectory(const std::string& directory);
+	static const std::string& getBinaryCacheDirectory();
+
 	void use() const;
 
 	static void use(unsigned int program);
@@ -84,15 +130,45 @@ public:
 		const std::vector<TYPE> &value);
 
 private:
+
+	uint64_t getBinaryCacheKey() const;
+	std::string getBinaryCachePath() const;
+
+	bool loadBinary();
+	void saveBinary() const;
+
+	void releaseStages();
+
 	std::string _vertexShaderSource{};
 	std::string _tessellationControlSource{};
 	std::string _tessellationEvaluationSource{};
 	std::string _geometryShaderSource{};
 	std::string _fragmentShaderSource{};
+	std::string _computeShaderSource{};
+
+	std::string _defines{};
+
+	std::vector<std::string> _permutationFeatures{};
+
+	// Null for variants that failed to compile.
+	std::unordered_map<uint64_t, std::unique_ptr<GLSLShader>> _permutations{};
 
 	GLSLShaderProgramHandle _programId{ 0 };
 
 	std::string _infoLog{};
+
+	// Only alive between beginCompile and finishCompile.
+	std::unique_ptr<GLSLVertexShader> _vertexShader{};
+	std::unique_ptr<GLSLFragmentShader> _fragmentShader{};
+	std::unique_ptr<GLSLGeometryShader> _geometryShader{};
+	std::unique_ptr<GLSLTessEvalShader> _tessEvalShader{};
+	std::unique_ptr<GLSLTessControlShader> _tessControlShader{};
+	std::unique_ptr<GLSLComputeShader> _computeShader{};
+
+	uint64_t _binaryCacheKey{ 0 };
+	bool _fromBinaryCache{ false };
+
+	static std::string _binaryCacheDirectory;
 };
 
 template <typename TYPE>
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Selects a variant of a GLSLShader. Each set feature bit defines the feature
+// name with the same index given to GLSLShader::setPermutationFeatures, and
+// the light counts are defined as NUM_POINT_LIGHTS and
+// NUM_DIRECTIONAL_LIGHTS, so that loops over the lights have constant bounds.
+struct GLSLShaderPermutation
+{
+	uint32_t features{ 0 };
+
+	uint8_t numPointLights{ 0 };
+	uint8_t numDirectionalLights{ 0 };
+
+	uint64_t getKey() const
+	{
+		return static_cast<uint64_t>(features) |
+			static_cast<uint64_t>(numPointLights) << 32 |
+			static_cast<uint64_t>(numDirectionalLights) << 40;
+	}
+
+	std::string getDefines(const std::vector<std::string>& featureNames) const
+	{
+		std::string defines;
+
+		for (size_t i = 0; i < featureNames.size() && i < 32; ++i)
+		{
+			if (features & (1u << i))
+			{
+				defines += "#define " + featureNames[i] + "\n";
+			}
+		}
+
+		defines += "#define NUM_POINT_LIGHTS " + std::to_string(numPointLights) + "\n";
+		defines += "#define NUM_DIRECTIONAL_LIGHTS " + std::to_string(numDirectionalLights) + "\n";
+
+		return defines;
+	}
+};
@@ -6,8 +6,9 @@
 #include <iostream>
 
 GLSLTessEvalShader::GLSLTessEvalShader(
-	const std::string &path)
-	:_path{ path }
+	const std::string &path,
+	const std::string &defines)
+	:_path{ path }, _defines{ defines }
 {
 
 }
@@ -20,14 +21,22 @@ GLSLTessEvalShader::~GLSLTessEvalShader()
 	}
 }
 
-int GLSLTessEvalShader::compile()
+void GLSLTessEvalShader::beginCompile()
 {
 	_handle = glCreateShader(GL_TESS_EVALUATION_SHADER);
 
-	std::string shaderSource = getStringFromFile(_path);
+	std::string shaderSource = insertShaderDefines(getStringFromFile(_path), _defines);
 	const char *shaderSourcePtr = shaderSource.c_str();
 	glShaderSource(_handle, 1, &shaderSourcePtr, NULL);
 	glCompileShader(_handle);
+}
+
+int GLSLTessEvalShader::compile()
+{
+	if (_handle == 0)
+	{
+		beginCompile();
+	}
 
 	GLint success;
 	glGetShaderiv(_handle, GL_COMPILE_STATUS, &success);
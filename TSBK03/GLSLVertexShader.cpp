@@ -5,8 +5,9 @@
 #include "Utils.h"
 
 GLSLVertexShader::GLSLVertexShader(
-	const std::string &path)
-	:_path{ path }
+	const std::string &path,
+	const std::string &defines)
+	:_path{ path }, _defines{ defines }
 {
 
 }
@@ -19,14 +20,22 @@ GLSLVertexShader::~GLSLVertexShader()
 	}
 }
 
-int GLSLVertexShader::compile()
+void GLSLVertexShader::beginCompile()
 {
 	_handle = glCreateShader(GL_VERTEX_SHADER);
 
-	std::string shaderSource = getStringFromFile(_path);
+	std::string shaderSource = insertShaderDefines(getStringFromFile(_path), _defines);
 	const char *shaderSourcePtr = shaderSource.c_str();
 	glShaderSource(_handle, 1, &shaderSourcePtr, NULL);
 	glCompileShader(_handle);
+}
+
+int GLSLVertexShader::compile()
+{
+	if (_handle == 0)
+	{
+		beginCompile();
+	}
 
 	GLint success;
 	glGetShaderiv(_handle, GL_COMPILE_STATUS, &success);
@@ -7,10 +7,16 @@ using GLSLVertexShaderHandle = unsigned int;
 class GLSLVertexShader
 {
 public:
-	explicit GLSLVertexShader(const std::string& path);
+	// The defines are inserted right after the #version line.
+	explicit GLSLVertexShader(const std::string& path, const std::string& defines = "");
 
 	~GLSLVertexShader();
 
+	// Hands the source to the driver without waiting for the result, so
+	// that drivers with parallel compilation can work on several at once.
+	void beginCompile();
+
+	// Compiles if that has not been started and waits for the result.
 	int compile();
 
 	const std::string& getInfoLog() const;
@@ -18,8 +24,9 @@ public:
 	GLSLVertexShaderHandle getHandle() const;
 private:
 	std::string _path;
+	std::string _defines;
 
-	GLSLVertexShaderHandle _handle;
+	GLSLVertexShaderHandle _handle{ 0 };
 
 	std::string _infoLog{};
 };
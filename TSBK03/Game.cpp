@@ -40,11 +40,12 @@ PendingFunction::PendingFunction(
 static auto pendingFunctionHeapPred = [](const auto& first, const auto& second) {return first.time > second.time;};
 
 Game::Game(
-	Application *application)
+	Application *application,
+	uint32_t seed)
 	: Frame(application),
 	_scene{ new Scene{ SceneNodeType::ROOT, "ROOT" } },
 	_player{ this },
-	_randomGenerator{ static_cast<uint32_t>(time(nullptr)) },
+	_randomGenerator{ seed },
 	_backgroundMusic{ "Music.wav", true },
 	_attackSound{ "Blip_Select.wav", false },
 	_scriptManager{ this },
@@ -57,6 +58,11 @@ Game::Game(
 
 	_scene->addChild(_terrainNode);
 
+	_crowdNode = new CrowdSceneNode{ "warrior", "crowd" };
+	_crowdNode->setTexture("char");
+
+	_scene->addChild(_crowdNode);
+
 	_directionalLightNode = new DirectionalLightSceneNode{
 		DirectionalLight{
 		glm::vec3{ 3.f, -3.f, 3.f },
@@ -71,12 +77,14 @@ Game::Game(
 	application->getEventManager()->addSubscriber<MouseButtonEvent>(&_inputManager);
 	application->getEventManager()->addSubscriber<KeyEvent>(&_inputManager);
 
-	Terrain *terrain = _application->getAssetManager()->fetch<Terrain>(_terrainNode->getTerrain());
+	Terrain *terrain = _application->getAssetManager()->resolve(_terrainNode->getTerrainRef(), _terrainNode->getTerrain());
 
 
 	spawnEnemy(glm::vec3{ 200.f, 0.f, 220.f });
 	spawnEnemy(glm::vec3{ 240.f, 0.f, 220.f });
 
+	spawnCrowd(glm::vec3{ 220.f, 0.f, 260.f }, 8, 8);
+
 	_player.getInventory()->addItem(ItemInstance(2, 10));
 	_player.getInventory()->addItem(ItemInstance(5, 1));
 	_player.getInventory()->addItem(ItemInstance(6, 1));
@@ -115,40 +123,47 @@ Game::~Game()
 void Game::update(
 	float dt)
 {
-	// Decrement times for all pending functions by dt
-	for (auto& it : _pendingFunctions)
-	{
-		it.time -= dt;
-	}
+	Profiler& profiler = _application->getRenderer()->getProfiler();
 
-	// Check all pending functions if the time left is below zero
-	// By the heap property the function with the lowest time is placed
-	// first in the vector.
-	while (!_pendingFunctions.empty() && _pendingFunctions[0].time < 0.f)
 	{
-		// Pop the function with the lowest time from the heap, placing it in
-		// the last position
-		std::pop_heap(
-			_pendingFunctions.begin(),
-			_pendingFunctions.end(),
-			pendingFunctionHeapPred);
+		ProfilerScope scope{ profiler, "Pending Functions" };
+
+		// Decrement times for all pending functions by dt
+		for (auto& it : _pendingFunctions)
+		{
+			it.time -= dt;
+		}
+
+		// Check all pending functions if the time left is below zero
+		// By the heap property the function with the lowest time is placed
+		// first in the vector.
+		while (!_pendingFunctions.empty() && _pendingFunctions[0].time < 0.f)
+		{
+			// Pop the function with the lowest time from the heap, placing it in
+			// the last position
+			std::pop_heap(
+				_pendingFunctions.begin(),
+				_pendingFunctions.end(),
+				pendingFunctionHeapPred);
 
-		// Extract the function pointer
-		auto func = _pendingFunctions.back().func;
+			// Extract the function pointer
+			auto func = _pendingFunctions.back().func;
 
-		// Remove the function from the list
-		_pendingFunctions.pop_back();
+			// Remove the function from the list
+			_pendingFunctions.pop_back();
 
-		// Invoke the function, passing the game pointer as parameter.
-		func(this);
+			// Invoke the function, passing the game pointer as parameter.
+			func(this);
+		}
 	}
 
-	Terrain *terrain = _application->getAssetManager()->fetch<Terrain>(_terrainNode->getTerrain());
+	Terrain *terrain = _application->getAssetManager()->resolve(_terrainNode->getTerrainRef(), _terrainNode->getTerrain());
 
 	static bool lastLClick = _inputManager.leftClick;
 	static bool lastEKey = _inputManager.keys[KEY_E];
 	static bool lastIKey = _inputManager.keys[KEY_I];
 	static bool lastCKey = _inputManager.keys[KEY_C];
+	static bool lastF9Key = _inputManager.keys[KEY_F9];
 	static bool lastF10Key = _inputManager.keys[KEY_F10];
 
 	static float currTime = 0;
@@ -165,57 +180,66 @@ void Game::update(
 	// Detect falling flank on left click
 	if (!_inputManager.dragging && lastLClick && !_inputManager.leftClick)
 	{
-		RendererPickingInfo pickingInfo;
-
-		// Get the picking information at the mouse position
-		pickingInfo = _application->getRenderer()->getPickingInfo(
+		// Get the picking information at the mouse position, it may arrive
+		// a frame or two later.
+		_application->getRenderer()->requestPicking(
 			static_cast<int>(_inputManager.mouseX),
-			static_cast<int>(_inputManager.mouseY));
-
-		bool found = false;
-
-		// Iterate through all enemies and check if that enemy was the one that
-		// was clcked
-		for (auto it : _enemies)
+			static_cast<int>(_inputManager.mouseY),
+			[this](const RendererPickingInfo& pickingInfo)
 		{
-			// If the id matches the clicked id
-			if (it->getSceneNodeID() == pickingInfo.objectID)
+			bool found = false;
+
+			// Iterate through all enemies and check if that enemy was the one that
+			// was clcked
+			for (auto it : _enemies)
 			{
-				// If we already have a target, send an untarget event to that
-				// enemy
-				if (_currentTarget != nullptr)
+				// If the id matches the clicked id
+				if (it->getSceneNodeID() == pickingInfo.objectID)
 				{
-					_currentTarget->onUntargeted();
-				}
+					// If we already have a target, send an untarget event to that
+					// enemy
+					if (_currentTarget != nullptr)
+					{
+						_currentTarget->onUntargeted();
+					}
 
-				// Update the current target
-				_currentTarget = it;
+					// Update the current target
+					_currentTarget = it;
 
-				// Send the targeted event to the new target.
-				_currentTarget->onTargeted();
+					// Send the targeted event to the new target.
+					_currentTarget->onTargeted();
 
-				found = true;
+					found = true;
 
-				break;
+					break;
+				}
 			}
-		}
 
-		// If we did not click an enemy and we had a target
-		if (!found && _currentTarget != nullptr)
-		{
-			// Send the untargeted event 
-			_currentTarget->onUntargeted();
+			// If we did not click an enemy and we had a target
+			if (!found && _currentTarget != nullptr)
+			{
+				// Send the untargeted event 
+				_currentTarget->onUntargeted();
 
-			// Clear the target pointer.
-			_currentTarget = nullptr;
-		}
+				// Clear the target pointer.
+				_currentTarget = nullptr;
+			}
+		});
 	}
 
-	_player.handlePlayerMovement(_inputManager, dt, terrain);
+	{
+		ProfilerScope scope{ profiler, "Player" };
+
+		_player.handlePlayerMovement(_inputManager, dt, terrain);
+	}
 
-	for (auto it : _enemies)
 	{
-		it->update(dt, terrain);
+		ProfilerScope scope{ profiler, "Enemies" };
+
+		for (auto it : _enemies)
+		{
+			it->update(dt, terrain);
+		}
 	}
 
 	if (_inputManager.keys[KEY_E] && !lastEKey)
@@ -236,50 +260,60 @@ void Game::update(
 		_showCharacterScreen = !_showCharacterScreen;
 	}
 
+	if (_inputManager.keys[KEY_F9] && !lastF9Key)
+	{
+		_showProfiler = !_showProfiler;
+	}
+
 	if(_inputManager.keys[KEY_F10] && !lastF10Key)
 	{
 		_showDebugWindow = !_showDebugWindow;
 	}
 
-	std::vector<Enemy *> _enemiesPendingRemove;
-
-	for (auto it = _enemies.begin(); it != _enemies.end();)
 	{
-		Enemy *enemy = *it;
+		ProfilerScope scope{ profiler, "Enemy Removal" };
+
+		std::vector<Enemy *> _enemiesPendingRemove;
 
-		if (enemy->getHealth() <= 0)
+		for (auto it = _enemies.begin(); it != _enemies.end();)
 		{
-			// Send death event to the enemy.
-			enemy->onDeath();
+			Enemy *enemy = *it;
 
-			// If the enemy was our current target, clear the current target.
-			if (_currentTarget == enemy)
+			if (enemy->getHealth() <= 0)
 			{
-				_currentTarget->onUntargeted();
-				_currentTarget = nullptr;
-			}
+				// Send death event to the enemy.
+				enemy->onDeath();
+
+				// If the enemy was our current target, clear the current target.
+				if (_currentTarget == enemy)
+				{
+					_currentTarget->onUntargeted();
+					_currentTarget = nullptr;
+				}
 
-			_enemiesPendingRemove.push_back(enemy);
+				_enemiesPendingRemove.push_back(enemy);
 
-			it = _enemies.erase(it);
+				it = _enemies.erase(it);
+			}
+			else
+			{
+				++it;
+			}
 		}
-		else
+
+		for (auto it : _enemiesPendingRemove)
 		{
-			++it;
+			delete it;
 		}
-	}
 
-	for (auto it : _enemiesPendingRemove)
-	{
-		delete it;
+		_enemiesPendingRemove.clear();
 	}
 
-	_enemiesPendingRemove.clear();
-
 	lastLClick = _inputManager.leftClick;
 	lastEKey = _inputManager.keys[KEY_E];
 	lastIKey = _inputManager.keys[KEY_I];
 	lastCKey = _inputManager.keys[KEY_C];
+	lastF9Key = _inputManager.keys[KEY_F9];
 	lastF10Key = _inputManager.keys[KEY_F10];
 
 	// Handle player death
@@ -291,6 +325,8 @@ void Game::update(
 		_application->shutDown();
 	}
 
+	ProfilerScope scope{ profiler, "Audio" };
+
 	AudioListener& audioListener = getApplication()->getAudioManager()->getAudioListener();
 
 	audioListener.setPosition(_application->getRenderer()->getCameraPosition());
@@ -466,7 +502,7 @@ InputManager * Game::getInputManager()
 unsigned int Game::spawnEnemy(
 	const glm::vec3 &position)
 {
-	Terrain *terrain = _application->getAssetManager()->fetch<Terrain>(_terrainNode->getTerrain());
+	Terrain *terrain = _application->getAssetManager()->resolve(_terrainNode->getTerrainRef(), _terrainNode->getTerrain());
 
 	// Even for very long games, this have a low chance of running out
 	unsigned int id = _nextEnemyID++;
@@ -476,6 +512,43 @@ unsigned int Game::spawnEnemy(
 	return id;
 }
 
+void Game::spawnCrowd(
+	const glm::vec3 &center,
+	unsigned int rows,
+	unsigned int columns)
+{
+	Terrain *terrain = _application->getAssetManager()->resolve(_terrainNode->getTerrainRef(), _terrainNode->getTerrain());
+
+	const float spacing = 3.f;
+
+	for (unsigned int row = 0; row < rows; ++row)
+	{
+		for (unsigned int column = 0; column < columns; ++column)
+		{
+			glm::vec3 position{
+				center.x + spacing * (column - 0.5f * (columns - 1)),
+				0.f,
+				center.z + spacing * (row - 0.5f * (rows - 1)) };
+			position.y = terrain->getHeight(position.x, position.z);
+
+			float facing = _randomGenerator.randFloatRange(0.f, glm::two_pi<float>());
+
+			CrowdInstance instance;
+			instance.transform = glm::translate(glm::mat4{ 1.f }, position);
+			instance.transform = glm::rotate(instance.transform, facing, glm::vec3{ 0.f, 1.f, 0.f });
+			instance.transform = glm::scale(instance.transform, glm::vec3{ 0.1f, 0.1f, 0.1f });
+
+			// Same clips the enemies use, spread out so the crowd does not
+			// move in lockstep.
+			instance.animation = _randomGenerator.randBool(0.25f) ? "idle" : "anim0";
+			instance.timeOffset = _randomGenerator.randFloatRange(0.f, 10.f);
+			instance.playbackRate = _randomGenerator.randFloatRange(0.8f, 1.2f);
+
+			_crowdNode->addInstance(instance);
+		}
+	}
+}
+
 RandomGenerator<MersenneDevice> * Game::getRandomGenerator()
 {
 	return &_randomGenerator;
@@ -575,7 +648,7 @@ void Game::renderUIInventoryItemFrame(
 	float iconWidth = imageWidth / 28.f;
 	float iconHeight = imageHeight / 29.f;
 
-	Texture2D *iconTexture = _application->getAssetManager()->fetch<Texture2D>("icons");
+	Texture2D *iconTexture = _application->getAssetManager()->resolve(_iconTextureRef, "icons");
 
 	Item *item = _itemDatabase.getItemById(itemInstance.getID());
 
@@ -892,7 +965,7 @@ void Game::renderUICharacterScreenCharacterPanelItemPanel(unsigned int offset)
 		float iconWidth = imageWidth / 28.f;
 		float iconHeight = imageHeight / 29.f;
 
-		Texture2D *iconTexture = _application->getAssetManager()->fetch<Texture2D>("icons");
+		Texture2D *iconTexture = _application->getAssetManager()->resolve(_iconTextureRef, "icons");
 
 		if (i < static_cast<unsigned int>(ItemSlot::COUNT))
 		{
@@ -1070,4 +1143,9 @@ void Game::renderUIDebugWindow()
 	{
 		_debugWindow.render(&_showDebugWindow);
 	}
+
+	if (_showProfiler)
+	{
+		_debugWindow.renderProfiler(&_showProfiler);
+	}
 }
@@ -3,6 +3,7 @@
 #include "Frame.h"
 
 #include "SceneNode.h"
+#include "CrowdSceneNode.h"
 #include "MouseMovedEvent.h"
 #include "InputManager.h"
 #include "Player.h"
@@ -119,7 +120,8 @@ struct PendingFunction
 class Game : public Frame
 {
 public:
-	explicit Game(Application *application);
+	// Every random choice of the game is drawn from the seed.
+	Game(Application *application, uint32_t seed);
 	Game(const Game& other) = delete;
 	Game& operator=(const Game& other) = delete;
 
@@ -138,6 +140,9 @@ public:
 	InputManager *getInputManager();
 
 	unsigned int spawnEnemy(const glm::vec3& position);
+	// Adds a grid of animated warriors to the crowd, drawn in one instanced
+	// draw call from the baked pose texture.
+	void spawnCrowd(const glm::vec3& center, unsigned int rows, unsigned int columns);
 
 	RandomGenerator<MersenneDevice> *getRandomGenerator();
 
@@ -173,6 +178,7 @@ private:
 	bool _showCharacterScreen{ false };
 	int _currentCharacterScreenTab{ 0 };
 	bool _showDebugWindow{ true };
+	bool _showProfiler{ false };
 
 	int _moveFrom = -1;
 	int _moveTo = -1;
@@ -182,6 +188,7 @@ private:
 	DirectionalLightSceneNode *_directionalLightNode;
 
 	TerrainSceneNode *_terrainNode;
+	CrowdSceneNode *_crowdNode;
 	Scene *_scene{ nullptr };
 
 	InputManager _inputManager;
@@ -194,6 +201,9 @@ private:
 
 	ItemDatabase _itemDatabase{};
 
+	// Drawn by every item frame, so resolved once instead of per icon.
+	AssetRef<Texture2D> _iconTextureRef{};
+
 	RandomGenerator<MersenneDevice> _randomGenerator;
 
 	std::vector<PendingFunction> _pendingFunctions;
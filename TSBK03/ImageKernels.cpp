@@ -0,0 +1,268 @@
+#include "ImageKernels.h"
+
+#include <cstring>
+#include <algorithm>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define IMAGE_KERNELS_SSE 1
+#include <emmintrin.h>
+#include <tmmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#else
+#define IMAGE_KERNELS_SSE 0
+#endif
+
+// MSVC allows all intrinsics everywhere, GCC and Clang need the functions
+// using SSSE3 to be marked.
+#if IMAGE_KERNELS_SSE && defined(__GNUC__)
+#define IMAGE_KERNELS_TARGET_SSSE3 __attribute__((target("ssse3")))
+#else
+#define IMAGE_KERNELS_TARGET_SSSE3
+#endif
+
+namespace
+{
+	inline uint8_t multiplyByAlpha(
+		unsigned int channel,
+		unsigned int alpha)
+	{
+		// Rounded division by 255.
+		unsigned int value = channel * alpha + 128;
+
+		return static_cast<uint8_t>((value + (value >> 8)) >> 8);
+	}
+
+#if IMAGE_KERNELS_SSE
+	bool hasSSSE3()
+	{
+		static const bool supported = []()
+		{
+#ifdef _MSC_VER
+			int info[4];
+			__cpuid(info, 1);
+
+			return (info[2] & (1 << 9)) != 0;
+#else
+			unsigned int eax, ebx, ecx, edx;
+
+			return __get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & (1 << 9)) != 0;
+#endif
+		}();
+
+		return supported;
+	}
+
+	// Swizzles five pixels per iteration. The sixteenth byte of every block
+	// is written back unchanged and is overwritten by the next block.
+	IMAGE_KERNELS_TARGET_SSSE3 size_t swizzleRedBlue3SSSE3(
+		uint8_t *destination,
+		const uint8_t *source,
+		size_t pixelCount)
+	{
+		const __m128i mask = _mm_setr_epi8(2, 1, 0, 5, 4, 3, 8, 7, 6, 11, 10, 9, 14, 13, 12, 15);
+
+		size_t i = 0;
+
+		// Keep the loads and stores of 16 bytes inside the image.
+		for (; i + 6 <= pixelCount; i += 5)
+		{
+			__m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source + i * 3));
+
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(destination + i * 3), _mm_shuffle_epi8(pixels, mask));
+		}
+
+		return i;
+	}
+
+	size_t swizzleRedBlue4SSE2(
+		uint8_t *destination,
+		const uint8_t *source,
+		size_t pixelCount)
+	{
+		const __m128i alphaGreenMask = _mm_set1_epi32(0xFF00FF00);
+		const __m128i redBlueMask = _mm_set1_epi32(0x00FF00FF);
+
+		size_t i = 0;
+
+		for (; i + 4 <= pixelCount; i += 4)
+		{
+			__m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source + i * 4));
+
+			__m128i alphaGreen = _mm_and_si128(pixels, alphaGreenMask);
+			__m128i redBlue = _mm_and_si128(pixels, redBlueMask);
+
+			redBlue = _mm_or_si128(_mm_slli_epi32(redBlue, 16), _mm_srli_epi32(redBlue, 16));
+
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(destination + i * 4), _mm_or_si128(alphaGreen, redBlue));
+		}
+
+		return i;
+	}
+
+	inline __m128i multiplyByAlphaSSE2(
+		__m128i channels)
+	{
+		const __m128i rounding = _mm_set1_epi16(128);
+
+		// Broadcast the alpha of each of the two pixels to all four channels.
+		__m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(channels, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+
+		__m128i value = _mm_add_epi16(_mm_mullo_epi16(channels, alpha), rounding);
+
+		return _mm_srli_epi16(_mm_add_epi16(value, _mm_srli_epi16(value, 8)), 8);
+	}
+
+	size_t premultiplyAlphaSSE2(
+		uint8_t *pixels,
+		size_t pixelCount)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i alphaMask = _mm_set1_epi32(0xFF000000);
+
+		size_t i = 0;
+
+		for (; i + 4 <= pixelCount; i += 4)
+		{
+			__m128i *block = reinterpret_cast<__m128i *>(pixels + i * 4);
+			__m128i rgba = _mm_loadu_si128(block);
+
+			__m128i low = multiplyByAlphaSSE2(_mm_unpacklo_epi8(rgba, zero));
+			__m128i high = multiplyByAlphaSSE2(_mm_unpackhi_epi8(rgba, zero));
+
+			__m128i result = _mm_packus_epi16(low, high);
+
+			// Keep the original alpha.
+			result = _mm_or_si128(_mm_andnot_si128(alphaMask, result), _mm_and_si128(alphaMask, rgba));
+
+			_mm_storeu_si128(block, result);
+		}
+
+		return i;
+	}
+#endif
+}
+
+void swizzleRedBlue(
+	uint8_t *destination,
+	const uint8_t *source,
+	size_t pixelCount,
+	unsigned int channels)
+{
+	size_t i = 0;
+
+#if IMAGE_KERNELS_SSE
+	if (channels == 4)
+	{
+		i = swizzleRedBlue4SSE2(destination, source, pixelCount);
+	}
+	else if (channels == 3 && hasSSSE3())
+	{
+		i = swizzleRedBlue3SSSE3(destination, source, pixelCount);
+	}
+#endif
+
+	for (; i < pixelCount; ++i)
+	{
+		const uint8_t *pixel = source + i * channels;
+		uint8_t *result = destination + i * channels;
+
+		uint8_t red = pixel[2];
+		uint8_t green = pixel[1];
+		uint8_t blue = pixel[0];
+
+		result[0] = red;
+		result[1] = green;
+		result[2] = blue;
+
+		if (channels == 4)
+		{
+			result[3] = pixel[3];
+		}
+	}
+}
+
+void premultiplyAlpha(
+	uint8_t *pixels,
+	size_t pixelCount)
+{
+	size_t i = 0;
+
+#if IMAGE_KERNELS_SSE
+	i = premultiplyAlphaSSE2(pixels, pixelCount);
+#endif
+
+	for (; i < pixelCount; ++i)
+	{
+		uint8_t *pixel = pixels + i * 4;
+
+		pixel[0] = multiplyByAlpha(pixel[0], pixel[3]);
+		pixel[1] = multiplyByAlpha(pixel[1], pixel[3]);
+		pixel[2] = multiplyByAlpha(pixel[2], pixel[3]);
+	}
+}
+
+void flipVertically(
+	uint8_t *pixels,
+	size_t rowSize,
+	size_t rowCount)
+{
+	for (size_t y = 0; y < rowCount / 2; ++y)
+	{
+		uint8_t *top = pixels + y * rowSize;
+		uint8_t *bottom = pixels + (rowCount - 1 - y) * rowSize;
+
+		size_t x = 0;
+
+#if IMAGE_KERNELS_SSE
+		for (; x + 16 <= rowSize; x += 16)
+		{
+			__m128i topBlock = _mm_loadu_si128(reinterpret_cast<const __m128i *>(top + x));
+			__m128i bottomBlock = _mm_loadu_si128(reinterpret_cast<const __m128i *>(bottom + x));
+
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(top + x), bottomBlock);
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(bottom + x), topBlock);
+		}
+#endif
+
+		std::swap_ranges(top + x, top + rowSize, bottom + x);
+	}
+}
+
+void convertRows(
+	uint8_t *destination,
+	const uint8_t *source,
+	size_t width,
+	size_t height,
+	unsigned int channels,
+	size_t sourceStride,
+	unsigned int flags)
+{
+	const size_t rowSize = width * channels;
+
+	for (size_t y = 0; y < height; ++y)
+	{
+		size_t sourceRow = (flags & IMAGE_CONVERT_FLIP_VERTICALLY) ? height - 1 - y : y;
+
+		const uint8_t *from = source + sourceRow * sourceStride;
+		uint8_t *to = destination + y * rowSize;
+
+		if (flags & IMAGE_CONVERT_SWIZZLE_RED_BLUE)
+		{
+			swizzleRedBlue(to, from, width, channels);
+		}
+		else if (to != from)
+		{
+			memmove(to, from, rowSize);
+		}
+
+		// The row is still in the cache.
+		if ((flags & IMAGE_CONVERT_PREMULTIPLY_ALPHA) && channels == 4)
+		{
+			premultiplyAlpha(to, width);
+		}
+	}
+}
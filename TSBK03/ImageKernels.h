@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Pixel conversions used when decoding images. All kernels work on 8 bit
+// RGB or RGBA pixels, use SSE2/SSSE3 where available and fall back to plain
+// loops otherwise. Source and destination may be the same memory.
+
+// Swaps the red and blue channels, i.e. converts BGR(A) to RGB(A).
+void swizzleRedBlue(
+	uint8_t *destination,
+	const uint8_t *source,
+	size_t pixelCount,
+	unsigned int channels);
+
+// Multiplies the color channels of RGBA pixels with their alpha.
+void premultiplyAlpha(
+	uint8_t *pixels,
+	size_t pixelCount);
+
+// Reverses the order of the rows in place.
+void flipVertically(
+	uint8_t *pixels,
+	size_t rowSize,
+	size_t rowCount);
+
+enum IMAGE_CONVERT_FLAGS : unsigned int
+{
+	IMAGE_CONVERT_NONE = 0,
+	IMAGE_CONVERT_SWIZZLE_RED_BLUE = 1 << 0,
+	IMAGE_CONVERT_PREMULTIPLY_ALPHA = 1 << 1,
+	IMAGE_CONVERT_FLIP_VERTICALLY = 1 << 2
+};
+
+// Copies rows of sourceStride bytes into tightly packed rows, applying all of
+// the requested conversions in a single pass over each row. The destination
+// may only be the same memory as the source when not flipping.
+void convertRows(
+	uint8_t *destination,
+	const uint8_t *source,
+	size_t width,
+	size_t height,
+	unsigned int channels,
+	size_t sourceStride,
+	unsigned int flags);
@@ -2,6 +2,7 @@
 #include <rapidxml/rapidxml.hpp>
 #include <iostream>
 #include "Utils.h"
+#include "AssetFileSystem.h"
 #include "ConsumableItem.h"
 
 #include "Game.h"
@@ -50,9 +51,14 @@ void ItemDatabase::loadItems()
 
 	std::cout << "Parsing " + itemFilePath << "..." << std::endl;
 
-	std::string file = getStringFromFile(itemFilePath);
+	// rapidxml parses in place, so it gets a terminated copy of the mapped
+	// file. Throws if the file could not be opened.
+	AssetStream stream = AssetFileSystem::open(itemFilePath);
 
-	doc.parse<0>(const_cast<char *>(file.c_str()));
+	std::vector<char> file(stream.getData(), stream.getData() + stream.getSize());
+	file.push_back('\0');
+
+	doc.parse<0>(file.data());
 
 	xml_node<> *itemsnode = doc.first_node("items");
 
@@ -0,0 +1,231 @@
+#include "KTXFile.h"
+#include "AssetFileSystem.h"
+
+#include <fstream>
+#include <cstring>
+#include <stdexcept>
+
+namespace
+{
+	const uint8_t ktxIdentifier[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x31, 0x31, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+	const uint32_t ktxEndianness = 0x04030201;
+
+	// Tells readers that the first row is the bottom row.
+	const char ktxOrientationKey[] = "KTXorientation";
+	const char ktxOrientationValue[] = "S=r,T=u";
+
+	struct KTXHeader
+	{
+		uint8_t identifier[12];
+		uint32_t endianness;
+		uint32_t glType;
+		uint32_t glTypeSize;
+		uint32_t glFormat;
+		uint32_t glInternalFormat;
+		uint32_t glBaseInternalFormat;
+		uint32_t pixelWidth;
+		uint32_t pixelHeight;
+		uint32_t pixelDepth;
+		uint32_t numberOfArrayElements;
+		uint32_t numberOfFaces;
+		uint32_t numberOfMipmapLevels;
+		uint32_t bytesOfKeyValueData;
+	};
+
+	size_t alignToFour(
+		size_t size)
+	{
+		return (size + 3) & ~static_cast<size_t>(3);
+	}
+}
+
+KTXFile::KTXFile(
+	const std::string &filePath)
+	: _filePath{ filePath }
+{
+	// Throws if the file could not be opened.
+	_file = AssetFileSystem::open(filePath);
+
+	KTXHeader header;
+
+	if (_file.read(&header, sizeof(KTXHeader)) != sizeof(KTXHeader) ||
+		memcmp(header.identifier, ktxIdentifier, sizeof(ktxIdentifier)) != 0)
+	{
+		throw std::invalid_argument(std::string("File (") + filePath + ") is not a KTX file.");
+	}
+
+	if (header.endianness != ktxEndianness)
+	{
+		throw std::invalid_argument(std::string("KTX file (") + filePath + ") has the wrong endianness.");
+	}
+
+	if (header.glType != 0 || header.glFormat != 0)
+	{
+		throw std::invalid_argument(std::string("KTX file (") + filePath + ") is not compressed.");
+	}
+
+	if (header.pixelDepth > 1 || header.numberOfArrayElements > 1 || (header.numberOfFaces != 1 && header.numberOfFaces != 6))
+	{
+		throw std::invalid_argument(std::string("KTX file (") + filePath + ") is not a 2D texture or cube map.");
+	}
+
+	_internalFormat = header.glInternalFormat;
+	_baseInternalFormat = header.glBaseInternalFormat;
+	_width = header.pixelWidth;
+	_height = header.pixelHeight;
+	_numFaces = header.numberOfFaces;
+
+	_file.skip(header.bytesOfKeyValueData);
+
+	// Zero levels means that the mip chain should be generated on upload.
+	uint32_t numLevels = header.numberOfMipmapLevels == 0 ? 1 : header.numberOfMipmapLevels;
+
+	for (uint32_t level = 0; level < numLevels; ++level)
+	{
+		uint32_t imageSize;
+
+		if (_file.read(&imageSize, sizeof(imageSize)) != sizeof(imageSize))
+		{
+			throw std::invalid_argument(std::string("Unexpected end of KTX file (") + filePath + ").");
+		}
+
+		for (uint32_t face = 0; face < _numFaces; ++face)
+		{
+			if (_file.getSize() - _file.tell() < imageSize)
+			{
+				throw std::invalid_argument(std::string("Unexpected end of KTX file (") + filePath + ").");
+			}
+
+			_imageOffsets.push_back(_file.tell());
+			_imageSizes.push_back(imageSize);
+
+			_file.skip(alignToFour(imageSize));
+		}
+	}
+}
+
+uint32_t KTXFile::getInternalFormat() const
+{
+	return _internalFormat;
+}
+
+uint32_t KTXFile::getBaseInternalFormat() const
+{
+	return _baseInternalFormat;
+}
+
+uint32_t KTXFile::getWidth() const
+{
+	return _width;
+}
+
+uint32_t KTXFile::getHeight() const
+{
+	return _height;
+}
+
+uint32_t KTXFile::getNumFaces() const
+{
+	return _numFaces;
+}
+
+uint32_t KTXFile::getNumLevels() const
+{
+	return static_cast<uint32_t>(_imageOffsets.size() / _numFaces);
+}
+
+size_t KTXFile::getImageSize(
+	uint32_t level) const
+{
+	return _imageSizes[level * _numFaces];
+}
+
+const uint8_t * KTXFile::getImageData(
+	uint32_t level,
+	uint32_t face) const
+{
+	return _file.getData() + _imageOffsets[level * _numFaces + face];
+}
+
+size_t KTXFile::getTotalImageSize() const
+{
+	size_t size = 0;
+
+	for (size_t imageSize : _imageSizes)
+	{
+		size += imageSize;
+	}
+
+	return size;
+}
+
+const std::string & KTXFile::getFilePath() const
+{
+	return _filePath;
+}
+
+void KTXFile::write(
+	const std::string &filePath,
+	uint32_t internalFormat,
+	uint32_t baseInternalFormat,
+	uint32_t width,
+	uint32_t height,
+	uint32_t numFaces,
+	const std::vector<std::vector<uint8_t>> &images)
+{
+	std::ofstream file{ filePath, std::ios::binary };
+
+	if (!file.is_open())
+	{
+		throw std::invalid_argument("File (" + filePath + ") could not be opened.");
+	}
+
+	const char padding[4]{};
+
+	// One key value pair: its size, the key and the value, both terminated.
+	uint32_t keyValueSize = static_cast<uint32_t>(sizeof(ktxOrientationKey) + sizeof(ktxOrientationValue));
+	uint32_t keyValueDataSize = static_cast<uint32_t>(alignToFour(sizeof(uint32_t) + keyValueSize));
+
+	KTXHeader header;
+	memcpy(header.identifier, ktxIdentifier, sizeof(ktxIdentifier));
+	header.endianness = ktxEndianness;
+	header.glType = 0;
+	header.glTypeSize = 1;
+	header.glFormat = 0;
+	header.glInternalFormat = internalFormat;
+	header.glBaseInternalFormat = baseInternalFormat;
+	header.pixelWidth = width;
+	header.pixelHeight = height;
+	header.pixelDepth = 0;
+	header.numberOfArrayElements = 0;
+	header.numberOfFaces = numFaces;
+	header.numberOfMipmapLevels = static_cast<uint32_t>(images.size() / numFaces);
+	header.bytesOfKeyValueData = keyValueDataSize;
+
+	file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+	file.write(reinterpret_cast<const char *>(&keyValueSize), sizeof(keyValueSize));
+	file.write(ktxOrientationKey, sizeof(ktxOrientationKey));
+	file.write(ktxOrientationValue, sizeof(ktxOrientationValue));
+	file.write(padding, keyValueDataSize - sizeof(uint32_t) - keyValueSize);
+
+	for (size_t level = 0; level < header.numberOfMipmapLevels; ++level)
+	{
+		uint32_t imageSize = static_cast<uint32_t>(images[level * numFaces].size());
+
+		file.write(reinterpret_cast<const char *>(&imageSize), sizeof(imageSize));
+
+		for (size_t face = 0; face < numFaces; ++face)
+		{
+			const std::vector<uint8_t> &image = images[level * numFaces + face];
+
+			file.write(reinterpret_cast<const char *>(image.data()), image.size());
+			file.write(padding, alignToFour(image.size()) - image.size());
+		}
+	}
+
+	if (!file.good())
+	{
+		throw std::invalid_argument("File (" + filePath + ") could not be written.");
+	}
+}
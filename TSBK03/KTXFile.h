@@ -0,0 +1,83 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "AssetStream.h"
+
+// Internal formats of the block compressed textures, the same values as the
+// GL_EXT_texture_compression_s3tc enums. Kept here so that the format can be
+// read and written without OpenGL.
+#define KTX_COMPRESSED_RGB_S3TC_DXT1	0x83F0
+#define KTX_COMPRESSED_RGBA_S3TC_DXT5	0x83F3
+
+#define KTX_BASE_FORMAT_RGB				0x1907
+#define KTX_BASE_FORMAT_RGBA			0x1908
+
+// Khronos KTX 1.1 texture container holding compressed 2D textures or cube
+// maps with their mip chains. The file stays mapped and the images are
+// uploaded straight from it.
+class KTXFile
+{
+public:
+	// Throws std::invalid_argument if the file could not be opened or is not
+	// a compressed KTX file.
+	explicit KTXFile(const std::string& filePath);
+
+	KTXFile(const KTXFile& other) = delete;
+	KTXFile(KTXFile&& other) = delete;
+
+	KTXFile& operator=(const KTXFile& other) = delete;
+	KTXFile& operator=(KTXFile&& other) = delete;
+
+	uint32_t getInternalFormat() const;
+	uint32_t getBaseInternalFormat() const;
+
+	uint32_t getWidth() const;
+	uint32_t getHeight() const;
+
+	// One for 2D textures, six for cube maps.
+	uint32_t getNumFaces() const;
+	uint32_t getNumLevels() const;
+
+	// Size of one face of a level.
+	size_t getImageSize(uint32_t level) const;
+	const uint8_t *getImageData(uint32_t level, uint32_t face) const;
+
+	// Sum of all images, the amount of video memory the texture takes.
+	size_t getTotalImageSize() const;
+
+	const std::string& getFilePath() const;
+
+	// Images are ordered by level and then by face. Rows are stored bottom
+	// row first, as OpenGL expects them. Throws std::invalid_argument if the
+	// file could not be written.
+	static void write(
+		const std::string& filePath,
+		uint32_t internalFormat,
+		uint32_t baseInternalFormat,
+		uint32_t width,
+		uint32_t height,
+		uint32_t numFaces,
+		const std::vector<std::vector<uint8_t>>& images);
+
+private:
+
+	AssetStream _file;
+
+	std::string _filePath;
+
+	uint32_t _internalFormat{ 0 };
+	uint32_t _baseInternalFormat{ 0 };
+
+	uint32_t _width{ 0 };
+	uint32_t _height{ 0 };
+
+	uint32_t _numFaces{ 0 };
+
+	// Offsets of the images into the file, by level and then by face.
+	std::vector<size_t> _imageOffsets;
+	std::vector<size_t> _imageSizes;
+};
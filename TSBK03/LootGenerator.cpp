@@ -3,6 +3,7 @@
 #include <rapidxml/rapidxml.hpp>
 #include <iostream>
 #include "Utils.h"
+#include "AssetFileSystem.h"
 
 LootGenerator::LootGenerator()
 	:_randomDevice{ time(nullptr) }
@@ -14,9 +15,14 @@ LootGenerator::LootGenerator()
 
 	std::cout << "Parsing " + lootTableFilePath << "..." << std::endl;
 
-	std::string file = getStringFromFile(lootTableFilePath);
+	// rapidxml parses in place, so it gets a terminated copy of the mapped
+	// file. Throws if the file could not be opened.
+	AssetStream stream = AssetFileSystem::open(lootTableFilePath);
 
-	doc.parse<0>(const_cast<char *>(file.c_str()));
+	std::vector<char> file(stream.getData(), stream.getData() + stream.getSize());
+	file.push_back('\0');
+
+	doc.parse<0>(file.data());
 
 	xml_node<> *tablenode = doc.first_node("table");
 
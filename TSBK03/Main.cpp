@@ -24,14 +24,13 @@
 #include "Terrain.h"
 
 #include "Application.h"
+#include "Benchmark.h"
 
 #include "Utils.h"
 
 /*
  * TODO List Engine:
  *
- * Have picking take skinning into account.
- *
  * Move engine to class
  *  - Renderer
  *  - Asset Manager
@@ -89,7 +88,17 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, char*, int nSho
 int main(int argc, char **argv)
 #endif
 {
-	Application app{};
+#ifdef TSBK03_NO_CONSOLE
+	int argc = __argc;
+	char **argv = __argv;
+#endif
+
+	// --benchmark runs the scripted benchmark instead of the game.
+	BenchmarkSettings benchmarkSettings;
+
+	bool benchmark = Benchmark::parseArguments(argc, argv, benchmarkSettings);
+
+	Application app{ benchmark ? &benchmarkSettings : nullptr };
 
 	app.run();
 
@@ -0,0 +1,130 @@
+#include "MappedFile.h"
+
+#include <stdexcept>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(
+	const std::string &filePath)
+	: _filePath{ filePath }
+{
+#ifdef _WIN32
+	HANDLE file = CreateFileA(
+		filePath.c_str(),
+		GENERIC_READ,
+		FILE_SHARE_READ,
+		nullptr,
+		OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+		nullptr);
+
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		throw std::invalid_argument(std::string("File (") + filePath + ") could not be opened.");
+	}
+
+	LARGE_INTEGER size;
+	GetFileSizeEx(file, &size);
+
+	_fileHandle = file;
+	_size = static_cast<size_t>(size.QuadPart);
+
+	// Empty files can not be mapped.
+	if (_size == 0)
+	{
+		return;
+	}
+
+	_mappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+	if (_mappingHandle == nullptr)
+	{
+		CloseHandle(file);
+		throw std::invalid_argument(std::string("File (") + filePath + ") could not be mapped.");
+	}
+
+	_data = static_cast<const unsigned char *>(MapViewOfFile(_mappingHandle, FILE_MAP_READ, 0, 0, 0));
+#else
+	_fileDescriptor = open(filePath.c_str(), O_RDONLY);
+
+	if (_fileDescriptor < 0)
+	{
+		throw std::invalid_argument(std::string("File (") + filePath + ") could not be opened.");
+	}
+
+	struct stat fileStat;
+	fstat(_fileDescriptor, &fileStat);
+
+	_size = static_cast<size_t>(fileStat.st_size);
+
+	// Empty files can not be mapped.
+	if (_size == 0)
+	{
+		return;
+	}
+
+	void *data = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, _fileDescriptor, 0);
+
+	if (data == MAP_FAILED)
+	{
+		close(_fileDescriptor);
+		throw std::invalid_argument(std::string("File (") + filePath + ") could not be mapped.");
+	}
+
+	_data = static_cast<const unsigned char *>(data);
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+#ifdef _WIN32
+	if (_data)
+	{
+		UnmapViewOfFile(_data);
+	}
+
+	if (_mappingHandle)
+	{
+		CloseHandle(_mappingHandle);
+	}
+
+	if (_fileHandle)
+	{
+		CloseHandle(_fileHandle);
+	}
+#else
+	if (_data)
+	{
+		munmap(const_cast<unsigned char *>(_data), _size);
+	}
+
+	if (_fileDescriptor >= 0)
+	{
+		close(_fileDescriptor);
+	}
+#endif
+}
+
+const unsigned char * MappedFile::getData() const
+{
+	return _data;
+}
+
+size_t MappedFile::getSize() const
+{
+	return _size;
+}
+
+const std::string & MappedFile::getFilePath() const
+{
+	return _filePath;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+// Read-only memory mapping of a whole file. The contents stay valid for the
+// lifetime of the object.
+class MappedFile
+{
+public:
+	explicit MappedFile(const std::string& filePath);
+
+	MappedFile(const MappedFile& other) = delete;
+	MappedFile(MappedFile&& other) = delete;
+
+	MappedFile& operator=(const MappedFile& other) = delete;
+	MappedFile& operator=(MappedFile&& other) = delete;
+
+	~MappedFile();
+
+	const unsigned char *getData() const;
+	size_t getSize() const;
+
+	const std::string& getFilePath() const;
+private:
+
+	std::string _filePath;
+
+	const unsigned char *_data{ nullptr };
+	size_t _size{ 0 };
+
+#ifdef _WIN32
+	void *_fileHandle{ nullptr };
+	void *_mappingHandle{ nullptr };
+#else
+	int _fileDescriptor{ -1 };
+#endif
+};
@@ -2,23 +2,25 @@
 #include <GL/glew.h>
 
 #include <iostream>
+#include <utility>
 
 Mesh::Mesh(
 	const std::string& name,
-	const std::vector<Vertex>& vertices,
-	const std::vector<unsigned int>& indices,
-	const std::vector<VertexBoneData>& boneData,
-	unsigned int materialIndex)
+	std::vector<Vertex> vertices,
+	std::vector<unsigned int> indices,
+	std::vector<VertexBoneData> boneData,
+	unsigned int materialIndex,
+	bool upload)
 	: _name{ name },
 	_materialIndex{ materialIndex },
-	_vertices{ vertices },
-	_indices{ indices },
-	_vertexBoneData{ boneData },
-	_vbo{ VertexBufferObjectTarget::ARRAY_BUFFER },
-	_boneData{ VertexBufferObjectTarget::ARRAY_BUFFER },
-	_ibo{ VertexBufferObjectTarget::ELEMENT_BUFFER }
+	_vertices{ std::move(vertices) },
+	_indices{ std::move(indices) },
+	_vertexBoneData{ std::move(boneData) }
 {
-	setupMesh();
+	if (upload)
+	{
+		this->upload();
+	}
 }
 
 Mesh::~Mesh()
@@ -26,11 +28,39 @@ Mesh::~Mesh()
 
 }
 
+void Mesh::upload()
+{
+	if (isUploaded())
+	{
+		return;
+	}
+
+	_vao = std::make_unique<VertexArrayObject>();
+	_vbo = std::make_unique<VertexBufferObject>(VertexBufferObjectTarget::ARRAY_BUFFER);
+	_boneData = std::make_unique<VertexBufferObject>(VertexBufferObjectTarget::ARRAY_BUFFER);
+	_ibo = std::make_unique<VertexBufferObject>(VertexBufferObjectTarget::ELEMENT_BUFFER);
+
+	setupMesh();
+}
+
+bool Mesh::isUploaded() const
+{
+	return _vao != nullptr;
+}
+
+size_t Mesh::getMemoryUsage() const
+{
+	return
+		_vertices.size() * sizeof(Vertex) +
+		_indices.size() * sizeof(unsigned int) +
+		_vertexBoneData.size() * sizeof(VertexBoneData);
+}
+
 void Mesh::render() const
 {
-	_vao.bind();
-	_vbo.bind();
-	_ibo.bind();
+	_vao->bind();
+	_vbo->bind();
+	_ibo->bind();
 
 	glDrawElements(
 		GL_TRIANGLES,
@@ -38,8 +68,27 @@ void Mesh::render() const
 		GL_UNSIGNED_INT,
 		nullptr);
 
-	_ibo.unbind();
-	_vbo.unbind();
+	_ibo->unbind();
+	_vbo->unbind();
+	VertexArrayObject::unbind();
+}
+
+void Mesh::renderInstanced(
+	unsigned int instanceCount) const
+{
+	_vao->bind();
+	_vbo->bind();
+	_ibo->bind();
+
+	glDrawElementsInstanced(
+		GL_TRIANGLES,
+		static_cast<GLsizei>(_indices.size()),
+		GL_UNSIGNED_INT,
+		nullptr,
+		static_cast<GLsizei>(instanceCount));
+
+	_ibo->unbind();
+	_vbo->unbind();
 	VertexArrayObject::unbind();
 }
 
@@ -58,6 +107,21 @@ const std::vector<VertexBoneData> & Mesh::getBoneData() const
 	return _vertexBoneData;
 }
 
+const VertexBufferObject & Mesh::getVertexBuffer() const
+{
+	return *_vbo;
+}
+
+const VertexBufferObject & Mesh::getBoneDataBuffer() const
+{
+	return *_boneData;
+}
+
+const VertexBufferObject & Mesh::getIndexBuffer() const
+{
+	return *_ibo;
+}
+
 unsigned Mesh::getMaterialIndex() const
 {
 	return _materialIndex;
@@ -70,33 +134,33 @@ const std::string & Mesh::getName() const
 
 void Mesh::setupMesh()
 {
-	_vao.bind();
+	_vao->bind();
 
-	_vbo.storeData(
+	_vbo->storeData(
 		static_cast<unsigned int>(_vertices.size()) * sizeof(Vertex),
 		&_vertices[0],
 		VertexBufferObjectUsage::STATIC_DRAW);
 
-	_ibo.storeData(
+	_ibo->storeData(
 		static_cast<unsigned int>(_indices.size()) * sizeof(unsigned int),
 		&_indices[0],
 		VertexBufferObjectUsage::STATIC_DRAW);
 
-	_vbo.setupVertexAttribPointer(0, 3, sizeof(Vertex), offsetof(Vertex, _position));
-	_vbo.setupVertexAttribPointer(1, 3, sizeof(Vertex), offsetof(Vertex, _normal));
-	_vbo.setupVertexAttribPointer(2, 2, sizeof(Vertex), offsetof(Vertex, _texCoord));
-	_vbo.setupVertexAttribPointer(3, 3, sizeof(Vertex), offsetof(Vertex, _tangent));
-	_vbo.setupVertexAttribPointer(4, 3, sizeof(Vertex), offsetof(Vertex, _bitangent));
+	_vbo->setupVertexAttribPointer(0, 3, sizeof(Vertex), offsetof(Vertex, _position));
+	_vbo->setupVertexAttribPointer(1, 3, sizeof(Vertex), offsetof(Vertex, _normal));
+	_vbo->setupVertexAttribPointer(2, 2, sizeof(Vertex), offsetof(Vertex, _texCoord));
+	_vbo->setupVertexAttribPointer(3, 3, sizeof(Vertex), offsetof(Vertex, _tangent));
+	_vbo->setupVertexAttribPointer(4, 3, sizeof(Vertex), offsetof(Vertex, _bitangent));
 
 	if (!_vertexBoneData.empty())
 	{
-		_boneData.storeData(
+		_boneData->storeData(
 			static_cast<unsigned int>(_vertexBoneData.size()) * sizeof(VertexBoneData),
 			&_vertexBoneData[0],
 			VertexBufferObjectUsage::STATIC_DRAW);
 
-		_boneData.setupVertexAttribPointer(5, 4, sizeof(VertexBoneData), offsetof(VertexBoneData, IDs));
-		_boneData.setupVertexAttribPointer(6, 4, sizeof(VertexBoneData), offsetof(VertexBoneData, weights));
+		_boneData->setupVertexAttribPointer(5, 4, sizeof(VertexBoneData), offsetof(VertexBoneData, IDs));
+		_boneData->setupVertexAttribPointer(6, 4, sizeof(VertexBoneData), offsetof(VertexBoneData, weights));
 	}
 
 	VertexArrayObject::unbind();
@@ -2,6 +2,7 @@
 
 #include <string>
 #include <vector>
+#include <memory>
 
 #include "Vertex.h"
 #include "VertexArrayObject.h"
@@ -11,20 +12,36 @@
 class Mesh
 {
 public:
+	// The vertex data is taken by value, so callers that are done with it
+	// can move it in instead of copying.
 	Mesh(
 		const std::string& name,
-		const std::vector<Vertex>& vertices,
-		const std::vector<unsigned int>& indices,
-		const std::vector<VertexBoneData>& boneData,
-		unsigned int materialIndex);
+		std::vector<Vertex> vertices,
+		std::vector<unsigned int> indices,
+		std::vector<VertexBoneData> boneData,
+		unsigned int materialIndex,
+		bool upload = true);
 	~Mesh();
 
+	// Creates the OpenGL buffers. Must be called on the context thread.
+	void upload();
+	bool isUploaded() const;
+
+	// Bytes of vertex, index and bone data. The same data is kept both in
+	// system memory and in the buffers once uploaded.
+	size_t getMemoryUsage() const;
+
 	void render() const;
+	void renderInstanced(unsigned int instanceCount) const;
 
 	const std::vector<Vertex>& getVertices() const;
 	const std::vector<unsigned int>& getIndices() const;
 	const std::vector<VertexBoneData>& getBoneData() const;
 
+	const VertexBufferObject& getVertexBuffer() const;
+	const VertexBufferObject& getBoneDataBuffer() const;
+	const VertexBufferObject& getIndexBuffer() const;
+
 	unsigned int getMaterialIndex() const;
 
 	const std::string& getName() const;
@@ -40,8 +57,9 @@ private:
 	std::vector<unsigned int> _indices{};
 	std::vector<VertexBoneData> _vertexBoneData{};
 
-	VertexArrayObject _vao;
-	VertexBufferObject _vbo;
-	VertexBufferObject _boneData;
-	VertexBufferObject _ibo;
+	// Created by upload(), so that a mesh can be built off the context thread.
+	std::unique_ptr<VertexArrayObject> _vao{};
+	std::unique_ptr<VertexBufferObject> _vbo{};
+	std::unique_ptr<VertexBufferObject> _boneData{};
+	std::unique_ptr<VertexBufferObject> _ibo{};
 };
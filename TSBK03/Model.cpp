@@ -1,13 +1,147 @@
 #include "Model.h"
-
+#include "AssetFileSystem.h"
+#include "AssetIOSystem.h"
 
 #include <iostream>
 #include <fstream>
+#include <cstring>
+#include <algorithm>
+#include <utility>
+#include <stdexcept>
+
+//=============================================================================
+// Cooked model format
+//
+// All values are stored in native byte order. Vertices, bone data, indices
+// and animation keys are stored as tightly packed arrays so that they can be
+// copied straight out of the mapped file.
+//=============================================================================
+
+static const char cookedModelMagic[4] = { 'T', 'M', 'D', 'L' };
+static const unsigned int cookedModelVersion = 1;
+
+// Position, normal, texture coordinate, tangent and bitangent.
+static const unsigned int cookedVertexFloats = 14;
+
+template <typename TYPE>
+static void writeCookedValue(
+	std::ofstream &file,
+	const TYPE &value)
+{
+	file.write(reinterpret_cast<const char *>(&value), sizeof(TYPE));
+}
+
+template <typename TYPE>
+static void writeCookedArray(
+	std::ofstream &file,
+	const std::vector<TYPE> &values)
+{
+	writeCookedValue(file, static_cast<unsigned int>(values.size()));
+
+	if (!values.empty())
+	{
+		file.write(reinterpret_cast<const char *>(values.data()), values.size() * sizeof(TYPE));
+	}
+}
+
+static void writeCookedString(
+	std::ofstream &file,
+	const std::string &value)
+{
+	writeCookedValue(file, static_cast<unsigned int>(value.size()));
+	file.write(value.data(), value.size());
+}
+
+// Reads values sequentially from a cooked model held in memory.
+class CookedModelReader
+{
+public:
+	CookedModelReader(const AssetStream &file)
+		: _current{ file.getData() },
+		_end{ file.getData() + file.getSize() },
+		_filePath{ file.getName() }
+	{
+
+	}
+
+	const unsigned char *take(size_t size)
+	{
+		if (static_cast<size_t>(_end - _current) < size)
+		{
+			throw std::invalid_argument(std::string("Unexpected end of cooked model (") + _filePath + ").");
+		}
+
+		const unsigned char *data = _current;
+		_current += size;
+
+		return data;
+	}
+
+	template <typename TYPE>
+	TYPE read()
+	{
+		TYPE value;
+		memcpy(&value, take(sizeof(TYPE)), sizeof(TYPE));
+
+		return value;
+	}
+
+	template <typename TYPE>
+	void readArray(std::vector<TYPE> &values)
+	{
+		unsigned int count = read<unsigned int>();
+
+		values.resize(count);
+
+		if (count > 0)
+		{
+			memcpy(values.data(), take(count * sizeof(TYPE)), count * sizeof(TYPE));
+		}
+	}
+
+	std::string readString()
+	{
+		unsigned int length = read<unsigned int>();
+
+		return std::string{ reinterpret_cast<const char *>(take(length)), length };
+	}
+private:
+
+	const unsigned char *_current;
+	const unsigned char *_end;
+
+	const std::string &_filePath;
+};
 
 Model::Model(
-	const std::string &fileName)
-	:_fileName{ fileName }
+	const std::string &fileName,
+	bool allowCooked,
+	bool deferUpload)
+	:_deferUpload{ deferUpload },
+	_fileName{ fileName }
 {
+	std::string cookedFileName = getCookedFileName(fileName);
+
+	if (cookedFileName == fileName)
+	{
+		if (!loadCookedModel(fileName))
+		{
+			throw std::invalid_argument(std::string("Failed to load cooked model (") + fileName + ").");
+		}
+
+		return;
+	}
+
+	// A cooked file older than its source is left for the cooker to rebuild,
+	// and a broken one falls back to importing the source.
+	if (allowCooked &&
+		AssetFileSystem::exists(cookedFileName) &&
+		AssetFileSystem::isUpToDate(cookedFileName, fileName) &&
+		loadCookedModel(cookedFileName))
+	{
+		return;
+	}
+
 	loadModel(fileName);
 }
 
@@ -97,6 +231,123 @@ AABB Model::getExtents() const
 	return _extents;
 }
 
+const std::vector<BoneCapsule> & Model::getBoneCapsules() const
+{
+	if (_boneCapsulesBuilt)
+	{
+		return _boneCapsules;
+	}
+
+	_boneCapsulesBuilt = true;
+
+	// The vertices of each bone, assigned to the bone with the largest
+	// weight.
+	std::vector<std::vector<glm::vec3>> points(_numBones);
+
+	for (auto mesh : _meshes)
+	{
+		const std::vector<Vertex>& vertices = mesh->getVertices();
+		const std::vector<VertexBoneData>& boneData = mesh->getBoneData();
+
+		for (size_t i = 0; i < vertices.size() && i < boneData.size(); ++i)
+		{
+			unsigned int bone = boneData[i].IDs[0];
+			float weight = boneData[i].weights[0];
+
+			for (unsigned int j = 1; j < NUM_BONES_PER_VERTEX; ++j)
+			{
+				if (boneData[i].weights[j] > weight)
+				{
+					bone = boneData[i].IDs[j];
+					weight = boneData[i].weights[j];
+				}
+			}
+
+			if (weight > 0.f && bone < _numBones)
+			{
+				points[bone].push_back(vertices[i]._position);
+			}
+		}
+	}
+
+	for (unsigned int bone = 0; bone < _numBones; ++bone)
+	{
+		const std::vector<glm::vec3>& bonePoints = points[bone];
+
+		if (bonePoints.empty())
+		{
+			continue;
+		}
+
+		glm::vec3 center{ 0.f };
+
+		for (const glm::vec3& it : bonePoints)
+		{
+			center += it;
+		}
+
+		center /= static_cast<float>(bonePoints.size());
+
+		glm::mat3 covariance{ 0.f };
+
+		for (const glm::vec3& it : bonePoints)
+		{
+			glm::vec3 offset = it - center;
+
+			covariance += glm::outerProduct(offset, offset);
+		}
+
+		// The axis of the capsule is the direction the vertices spread out
+		// the most in, found by power iteration.
+		glm::vec3 axis{ 1.f, 1.f, 1.f };
+
+		for (int i = 0; i < 16; ++i)
+		{
+			glm::vec3 next = covariance * axis;
+			float length = glm::length(next);
+
+			if (length < 1e-12f)
+			{
+				break;
+			}
+
+			axis = next / length;
+		}
+
+		axis = glm::normalize(axis);
+
+		float minAlong = 0.f;
+		float maxAlong = 0.f;
+
+		for (const glm::vec3& it : bonePoints)
+		{
+			float along = glm::dot(it - center, axis);
+
+			minAlong = std::min(minAlong, along);
+			maxAlong = std::max(maxAlong, along);
+		}
+
+		BoneCapsule capsule;
+
+		capsule.bone = bone;
+		capsule.start = center + axis * minAlong;
+		capsule.end = center + axis * maxAlong;
+
+		// The segment spans all vertices, so the radius only has to reach
+		// them sideways.
+		for (const glm::vec3& it : bonePoints)
+		{
+			glm::vec3 offset = it - center;
+
+			capsule.radius = std::max(capsule.radius, glm::length(offset - axis * glm::dot(offset, axis)));
+		}
+
+		_boneCapsules.push_back(capsule);
+	}
+
+	return _boneCapsules;
+}
+
 int Model::getVertexCount() const
 {
 	int i = 0;
@@ -153,11 +404,188 @@ const std::vector<Mesh *> & Model::getMeshes() const
 	return _meshes;
 }
 
+bool Model::isCooked() const
+{
+	return _cooked;
+}
+
+void Model::upload()
+{
+	for (auto it : _meshes)
+	{
+		it->upload();
+	}
+}
+
+size_t Model::getCPUMemoryUsage() const
+{
+	size_t bytes = 0;
+
+	for (auto it : _meshes)
+	{
+		bytes += it->getMemoryUsage();
+	}
+
+	return bytes;
+}
+
+size_t Model::getGPUMemoryUsage() const
+{
+	size_t bytes = 0;
+
+	for (auto it : _meshes)
+	{
+		if (it->isUploaded())
+		{
+			bytes += it->getMemoryUsage();
+		}
+	}
+
+	return bytes;
+}
+
+bool Model::isUploaded() const
+{
+	for (auto it : _meshes)
+	{
+		if (!it->isUploaded())
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void Model::saveCookedModel(
+	const std::string &fileName) const
+{
+	std::ofstream file{ fileName, std::ios::out | std::ios::binary };
+
+	if (!file.is_open())
+	{
+		throw std::invalid_argument(std::string("File (") + fileName + ") could not be opened.");
+	}
+
+	file.write(cookedModelMagic, sizeof(cookedModelMagic));
+	writeCookedValue(file, cookedModelVersion);
+
+	writeCookedValue(file, _globalTransform);
+	writeCookedValue(file, _globalInverseTransform);
+	writeCookedValue(file, _extents);
+
+	// Meshes
+	writeCookedValue(file, static_cast<unsigned int>(_meshes.size()));
+
+	for (const Mesh *mesh : _meshes)
+	{
+		writeCookedString(file, mesh->getName());
+		writeCookedValue(file, mesh->getMaterialIndex());
+
+		std::vector<float> vertices;
+		vertices.reserve(mesh->getVertices().size() * cookedVertexFloats);
+
+		for (const Vertex &vertex : mesh->getVertices())
+		{
+			const glm::vec3 attributes[] = { vertex._position, vertex._normal };
+
+			for (const auto &it : attributes)
+			{
+				vertices.insert(vertices.end(), glm::value_ptr(it), glm::value_ptr(it) + 3);
+			}
+
+			vertices.insert(vertices.end(), glm::value_ptr(vertex._texCoord), glm::value_ptr(vertex._texCoord) + 2);
+			vertices.insert(vertices.end(), glm::value_ptr(vertex._tangent), glm::value_ptr(vertex._tangent) + 3);
+			vertices.insert(vertices.end(), glm::value_ptr(vertex._bitangent), glm::value_ptr(vertex._bitangent) + 3);
+		}
+
+		writeCookedArray(file, vertices);
+		writeCookedArray(file, mesh->getIndices());
+		writeCookedArray(file, mesh->getBoneData());
+	}
+
+	// Bones
+	writeCookedValue(file, _numBones);
+
+	for (const BoneInfo &bone : _boneInfo)
+	{
+		writeCookedValue(file, bone.boneOffset);
+	}
+
+	writeCookedValue(file, static_cast<unsigned int>(_boneMapping.size()));
+
+	for (const auto &it : _boneMapping)
+	{
+		writeCookedString(file, it.first);
+		writeCookedValue(file, it.second);
+	}
+
+	// Nodes
+	writeCookedValue(file, static_cast<unsigned int>(_nodes.size()));
+
+	for (const ModelNode &node : _nodes)
+	{
+		writeCookedString(file, node.name);
+		writeCookedValue(file, node.parent);
+		writeCookedValue(file, node.transform);
+		writeCookedArray(file, node.children);
+	}
+
+	// Animations
+	writeCookedValue(file, static_cast<unsigned int>(_animations.size()));
+
+	for (const Animation &animation : _animations)
+	{
+		writeCookedString(file, animation.name);
+		writeCookedValue(file, animation.ticksPerSecond);
+		writeCookedValue(file, animation.duration);
+
+		writeCookedValue(file, static_cast<unsigned int>(animation.channels.size()));
+
+		for (const AnimationChannel &channel : animation.channels)
+		{
+			writeCookedString(file, channel.name);
+			writeCookedArray(file, channel.positionKeys);
+			writeCookedArray(file, channel.rotationKeys);
+			writeCookedArray(file, channel.scalingKeys);
+		}
+	}
+
+	// Materials
+	writeCookedValue(file, static_cast<unsigned int>(_materials.size()));
+
+	for (const Material &material : _materials)
+	{
+		writeCookedString(file, material.name);
+		writeCookedValue(file, material.ambientColor);
+		writeCookedValue(file, material.diffuseColor);
+		writeCookedValue(file, material.specularColor);
+		writeCookedValue(file, material.exponent);
+	}
+}
+
+std::string Model::getCookedFileName(
+	const std::string &fileName)
+{
+	size_t extension = fileName.find_last_of('.');
+	size_t directory = fileName.find_last_of("/\\");
+
+	if (extension == std::string::npos || (directory != std::string::npos && extension < directory))
+	{
+		return fileName + ".model";
+	}
+
+	return fileName.substr(0, extension) + ".model";
+}
+
 void Model::loadModel(
 	const std::string &fileName)
 {
 	Assimp::Importer importer;
 
+	// The importer takes ownership of the IO system.
+	importer.SetIOHandler(new AssetIOSystem{});
+
 	const aiScene *scene = importer.ReadFile(
 		fileName.c_str(),
 		aiProcess_Triangulate /*| aiProcess_FlipUVs*/ | aiProcess_CalcTangentSpace);
@@ -214,6 +642,178 @@ void Model::loadModel(
 	importer.FreeScene();
 }
 
+bool Model::loadCookedModel(
+	const std::string &fileName)
+{
+	try
+	{
+		AssetStream file = AssetFileSystem::open(fileName);
+		CookedModelReader reader{ file };
+
+		if (memcmp(reader.take(sizeof(cookedModelMagic)), cookedModelMagic, sizeof(cookedModelMagic)) != 0 ||
+			reader.read<unsigned int>() != cookedModelVersion)
+		{
+			std::cerr << "[MODEL] " << fileName << " is not a cooked model of version " << cookedModelVersion << std::endl;
+			return false;
+		}
+
+		_directory = fileName.substr(0, fileName.find_last_of('/'));
+
+		_globalTransform = reader.read<glm::mat4>();
+		_globalInverseTransform = reader.read<glm::mat4>();
+		_extents = reader.read<AABB>();
+
+		// Meshes
+		unsigned int numMeshes = reader.read<unsigned int>();
+
+		for (unsigned int i = 0; i < numMeshes; ++i)
+		{
+			std::string name = reader.readString();
+			unsigned int materialIndex = reader.read<unsigned int>();
+
+			std::vector<unsigned int> indices;
+			std::vector<VertexBoneData> boneData;
+
+			// Vertex is polymorphic, so the packed vertices are unpacked
+			// straight from the mapped file instead of being copied as a block.
+			unsigned int numPackedFloats = reader.read<unsigned int>();
+			const unsigned char *packedVertices = reader.take(numPackedFloats * sizeof(float));
+
+			reader.readArray(indices);
+			reader.readArray(boneData);
+
+			std::vector<Vertex> vertices(numPackedFloats / cookedVertexFloats);
+
+			for (size_t j = 0; j < vertices.size(); ++j)
+			{
+				// The mapped file gives no alignment guarantees.
+				float packed[cookedVertexFloats];
+				memcpy(packed, packedVertices + j * sizeof(packed), sizeof(packed));
+
+				vertices[j]._position = glm::make_vec3(packed);
+				vertices[j]._normal = glm::make_vec3(packed + 3);
+				vertices[j]._texCoord = glm::make_vec2(packed + 6);
+				vertices[j]._tangent = glm::make_vec3(packed + 8);
+				vertices[j]._bitangent = glm::make_vec3(packed + 11);
+			}
+
+			_meshes.push_back(new Mesh(name, std::move(vertices), std::move(indices), std::move(boneData), materialIndex, !_deferUpload));
+		}
+
+		// Bones
+		_numBones = reader.read<unsigned int>();
+		_boneInfo.resize(_numBones);
+
+		for (BoneInfo &bone : _boneInfo)
+		{
+			bone.boneOffset = reader.read<glm::mat4>();
+		}
+
+		unsigned int numBoneMappings = reader.read<unsigned int>();
+
+		for (unsigned int i = 0; i < numBoneMappings; ++i)
+		{
+			std::string name = reader.readString();
+			_boneMapping[name] = reader.read<unsigned int>();
+		}
+
+		// Nodes
+		unsigned int numNodes = reader.read<unsigned int>();
+		_nodes.resize(numNodes);
+
+		for (unsigned int i = 0; i < numNodes; ++i)
+		{
+			ModelNode &node = _nodes[i];
+
+			node.id = i;
+			node.name = reader.readString();
+			node.parent = reader.read<unsigned int>();
+			node.transform = reader.read<glm::mat4>();
+			reader.readArray(node.children);
+
+			_nodeMapping.emplace(node.name, node.id);
+		}
+
+		// Animations
+		unsigned int numAnimations = reader.read<unsigned int>();
+		_animations.resize(numAnimations);
+
+		for (unsigned int i = 0; i < numAnimations; ++i)
+		{
+			Animation &animation = _animations[i];
+
+			animation.name = reader.readString();
+			animation.ticksPerSecond = reader.read<float>();
+			animation.duration = reader.read<float>();
+
+			animation.channels.resize(reader.read<unsigned int>());
+
+			for (AnimationChannel &channel : animation.channels)
+			{
+				channel.name = reader.readString();
+				reader.readArray(channel.positionKeys);
+				reader.readArray(channel.rotationKeys);
+				reader.readArray(channel.scalingKeys);
+			}
+
+			_animationMapping.emplace(animation.name, i);
+		}
+
+		// Materials
+		unsigned int numMaterials = reader.read<unsigned int>();
+		_materials.resize(numMaterials);
+
+		for (Material &material : _materials)
+		{
+			material.name = reader.readString();
+			material.ambientColor = reader.read<glm::vec3>();
+			material.diffuseColor = reader.read<glm::vec3>();
+			material.specularColor = reader.read<glm::vec3>();
+			material.exponent = reader.read<float>();
+		}
+
+		_cooked = true;
+	}
+	catch (const std::invalid_argument &ex)
+	{
+		std::cerr << "[MODEL] " << ex.what() << std::endl;
+
+		clear();
+		return false;
+	}
+
+	return true;
+}
+
+void Model::clear()
+{
+	while (!_meshes.empty())
+	{
+		delete _meshes.back();
+		_meshes.pop_back();
+	}
+
+	_directory.clear();
+
+	_numBones = 0;
+	_boneMapping.clear();
+	_boneInfo.clear();
+
+	_animationMapping.clear();
+	_animations.clear();
+
+	_nodeMapping.clear();
+	_nodes.clear();
+
+	_materials.clear();
+
+	_globalTransform = glm::mat4{};
+	_globalInverseTransform = glm::mat4{};
+	_extents = AABB{};
+
+	_cooked = false;
+}
+
 unsigned int Model::processNode(
 	aiNode *node,
 	const aiScene *scene,
@@ -537,7 +1137,7 @@ Mesh *Model::processMesh(
 
 	unsigned int materialIndex = mesh->mMaterialIndex;
 
-	return new Mesh(name, vertices, indices, boneData, materialIndex);
+	return new Mesh(name, std::move(vertices), std::move(indices), std::move(boneData), materialIndex, !_deferUpload);
 }
 
 void Model::recurseGetTransforms(
@@ -11,6 +11,7 @@
 #include "Mesh.h"
 #include "Vertex.h"
 #include "BoneInfo.h"
+#include "BoneCapsule.h"
 #include "Animation.h"
 #include "ModelNode.h"
 
@@ -20,7 +21,11 @@
 class Model
 {
 public:
-	explicit Model(const std::string& fileName);
+	// Loads the cooked version of the model if one exists next to the source
+	// file, otherwise the model is imported with Assimp. With deferUpload the
+	// model can be loaded off the context thread and upload() has to be called
+	// on the context thread before it is rendered.
+	explicit Model(const std::string& fileName, bool allowCooked = true, bool deferUpload = false);
 
 	~Model();
 
@@ -43,6 +48,10 @@ public:
 
 	AABB getExtents() const;
 
+	// Capsules around the vertices of each bone in the bind pose, built the
+	// first time they are asked for. Empty for models without bones.
+	const std::vector<BoneCapsule>& getBoneCapsules() const;
+
 	int getVertexCount() const;
 	int getIndicesCount() const;
 
@@ -54,11 +63,28 @@ public:
 	const std::string& getDefaultAnimation() const;
 
 	const std::vector<Mesh *>& getMeshes() const;
+
+	bool isCooked() const;
+
+	void upload();
+	bool isUploaded() const;
+
+	size_t getCPUMemoryUsage() const;
+	size_t getGPUMemoryUsage() const;
+
+	void saveCookedModel(const std::string& fileName) const;
+
+	static std::string getCookedFileName(const std::string& fileName);
 private:
 
 	glm::vec3 _correctionRotation{ 0.f, 0.f, 0.f };
 	
 	void loadModel(const std::string& fileName);
+	// Returns false, leaving the model empty, if the file is not a complete
+	// cooked model of the current version.
+	bool loadCookedModel(const std::string& fileName);
+
+	void clear();
 
 	unsigned int processNode(aiNode *node, const aiScene *scene, unsigned int parentID);
 	void processAnimations(aiNode *node, const aiScene *scene);
@@ -69,6 +95,10 @@ private:
 
 	bool _wireframe{false};
 
+	bool _cooked{ false };
+
+	bool _deferUpload{ false };
+
 	std::vector<Mesh *> _meshes;
 
 	std::string _directory{};
@@ -102,4 +132,7 @@ private:
 		AnimationChannel *out);
 
 	AABB _extents;
+
+	mutable std::vector<BoneCapsule> _boneCapsules{};
+	mutable bool _boneCapsulesBuilt{ false };
 };
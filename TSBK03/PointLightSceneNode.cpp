@@ -10,6 +10,8 @@ PointLightSceneNode::PointLightSceneNode(
 
 PointLight & PointLightSceneNode::getPointLight()
 {
+	notifyChanged(SceneNodeChange::LIGHT);
+
 	return _pointLight;
 }
 
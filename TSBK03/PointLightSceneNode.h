@@ -9,6 +9,7 @@ public:
 		const PointLight& pointLight, 
 		const std::string& tag);
 
+	// The light is returned for modification, so it is marked as changed.
 	PointLight& getPointLight();
 	const PointLight& getPointLight() const;
 
@@ -0,0 +1,731 @@
+#include "Profiler.h"
+#include "Utils.h"
+
+#include <algorithm>
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+
+Profiler::Profiler(
+	unsigned int windowSize)
+	: _windowSize{ std::max(windowSize, 1u) }
+{
+	_startTime = std::chrono::steady_clock::now();
+
+	_frameTimes.resize(_windowSize, 0.f);
+	_gpuMeasured.resize(_windowSize, false);
+}
+
+Profiler::~Profiler()
+{
+	finishCapture();
+
+	for (auto& record : _records)
+	{
+		if (!record.queries.empty())
+		{
+			glDeleteQueries(static_cast<GLsizei>(record.queries.size()), record.queries.data());
+		}
+	}
+}
+
+void Profiler::beginFrame()
+{
+	if (_inFrame)
+	{
+		endFrame();
+	}
+
+	resolveFrames();
+
+	if (_capturing && _captureFramesLeft == 0 && _captureUnresolved == 0)
+	{
+		writeCapture();
+	}
+
+	_enabled = _wantEnabled || _captureFramesLeft > 0;
+
+	if (!_enabled)
+	{
+		return;
+	}
+
+	++_frame;
+	_inFrame = true;
+
+	FrameRecord& record = _records[_frame % PROFILER_FRAME_LATENCY];
+
+	// Too late, the slot is needed for this frame.
+	if (record.pending && record.captured)
+	{
+		--_captureUnresolved;
+	}
+
+	record.pending = false;
+	record.captured = false;
+
+	record.frame = _frame;
+	record.samples.clear();
+	record.numQueries = 0;
+
+	size_t slot = _frame % _windowSize;
+
+	_gpuMeasured[slot] = false;
+
+	for (auto& node : _nodes)
+	{
+		node.cpuTimes[slot] = 0.f;
+		node.cpuStarts[slot] = -1.f;
+	}
+
+	Sample frameSample;
+	frameSample.cpuStart = getTime();
+	frameSample.beginQuery = addQuery();
+
+	record.samples.push_back(frameSample);
+
+	if (_captureFramesLeft > 0)
+	{
+		if (!_capturing)
+		{
+			// Lines the GPU timestamps up with the CPU clock. The GPU clock
+			// does not drift noticeably over a capture.
+			GLint64 gpuTime = 0;
+			glGetInteger64v(GL_TIMESTAMP, &gpuTime);
+
+			_captureGPUOffset = getTime() - gpuTime / 1000000.0;
+
+			std::lock_guard<std::mutex> lock{ _captureMutex };
+
+			_captureEvents.clear();
+			_captureThreads = { "Main Thread", "GPU" };
+
+			_capturing = true;
+		}
+
+		record.captured = true;
+		--_captureFramesLeft;
+	}
+}
+
+void Profiler::endFrame()
+{
+	if (!_inFrame)
+	{
+		return;
+	}
+
+	if (!_stack.empty())
+	{
+		std::cerr << "[PROFILER] " << _stack.size() << " scopes were not ended." << std::endl;
+
+		while (!_stack.empty())
+		{
+			endScope();
+		}
+	}
+
+	_inFrame = false;
+
+	FrameRecord& record = _records[_frame % PROFILER_FRAME_LATENCY];
+
+	size_t slot = _frame % _windowSize;
+
+	Sample& frameSample = record.samples.front();
+
+	frameSample.endQuery = addQuery();
+	frameSample.cpuEnd = getTime();
+
+	double frameStart = frameSample.cpuStart;
+
+	record.cpuTime = static_cast<float>(frameSample.cpuEnd - frameStart);
+
+	_frameTimes[slot] = record.cpuTime;
+
+	for (size_t i = 1; i < record.samples.size(); ++i)
+	{
+		const Sample& sample = record.samples[i];
+		Node& node = _nodes[sample.node];
+
+		node.cpuTimes[slot] += static_cast<float>(sample.cpuEnd - sample.cpuStart);
+
+		if (node.cpuStarts[slot] < 0.f)
+		{
+			node.cpuStarts[slot] = static_cast<float>(sample.cpuStart - frameStart);
+		}
+	}
+
+	++_numMeasuredFrames;
+
+	record.pending = true;
+
+	if (record.captured)
+	{
+		std::lock_guard<std::mutex> lock{ _captureMutex };
+
+		TraceEvent frameEvent;
+		frameEvent.name = "Frame";
+		frameEvent.start = frameStart;
+		frameEvent.duration = record.cpuTime;
+		frameEvent.frame = _frame;
+
+		_captureEvents.push_back(frameEvent);
+
+		for (size_t i = 1; i < record.samples.size(); ++i)
+		{
+			const Sample& sample = record.samples[i];
+
+			TraceEvent event;
+			event.name = _nodes[sample.node].name;
+			event.start = sample.cpuStart;
+			event.duration = sample.cpuEnd - sample.cpuStart;
+
+			_captureEvents.push_back(event);
+		}
+
+		++_captureUnresolved;
+	}
+}
+
+void Profiler::resolveFrames()
+{
+	// The timestamps of earlier frames arrive in order, so stop at the
+	// first frame that is not done.
+	for (unsigned long long frame = _frame + 1 - std::min<unsigned long long>(_frame, PROFILER_FRAME_LATENCY); frame <= _frame; ++frame)
+	{
+		FrameRecord& record = _records[frame % PROFILER_FRAME_LATENCY];
+
+		if (record.pending && record.frame == frame && !resolveFrame(record))
+		{
+			break;
+		}
+	}
+}
+
+unsigned long long Profiler::getFrame() const
+{
+	return _frame;
+}
+
+void Profiler::setFrameCallback(
+	const std::function<void(unsigned long long, float, float)> &callback)
+{
+	_frameCallback = callback;
+}
+
+void Profiler::beginScope(
+	const std::string &name,
+	bool gpu)
+{
+	if (!_inFrame)
+	{
+		return;
+	}
+
+	FrameRecord& record = _records[_frame % PROFILER_FRAME_LATENCY];
+
+	int parent = _stack.empty() ? -1 : record.samples[_stack.back()].node;
+
+	Sample sample;
+	sample.node = getChild(parent, name, gpu);
+	sample.cpuStart = getTime();
+
+	if (gpu)
+	{
+		sample.beginQuery = addQuery();
+	}
+
+	_stack.push_back(static_cast<int>(record.samples.size()));
+	record.samples.push_back(sample);
+}
+
+void Profiler::endScope()
+{
+	if (!_inFrame || _stack.empty())
+	{
+		return;
+	}
+
+	FrameRecord& record = _records[_frame % PROFILER_FRAME_LATENCY];
+
+	Sample& sample = record.samples[_stack.back()];
+	_stack.pop_back();
+
+	if (sample.beginQuery >= 0)
+	{
+		sample.endQuery = addQuery();
+	}
+
+	sample.cpuEnd = getTime();
+}
+
+void Profiler::setEnabled(
+	bool enabled)
+{
+	_wantEnabled = enabled;
+}
+
+bool Profiler::isEnabled() const
+{
+	return _wantEnabled;
+}
+
+unsigned int Profiler::getWindowSize() const
+{
+	return _windowSize;
+}
+
+const std::vector<Profiler::Node>& Profiler::getNodes() const
+{
+	return _nodes;
+}
+
+const std::vector<int>& Profiler::getRoots() const
+{
+	return _roots;
+}
+
+float Profiler::getAverageCPUTime(
+	int node) const
+{
+	size_t numFrames = static_cast<size_t>(std::min<unsigned long long>(_numMeasuredFrames, _windowSize));
+
+	if (numFrames == 0)
+	{
+		return 0.f;
+	}
+
+	float sum = 0.f;
+
+	for (size_t i = 0; i < _windowSize; ++i)
+	{
+		sum += _nodes[node].cpuTimes[i];
+	}
+
+	return sum / numFrames;
+}
+
+float Profiler::getMaxCPUTime(
+	int node) const
+{
+	const std::vector<float>& times = _nodes[node].cpuTimes;
+
+	return *std::max_element(times.begin(), times.end());
+}
+
+float Profiler::getAverageGPUTime(
+	int node) const
+{
+	float sum = 0.f;
+	size_t numFrames = 0;
+
+	for (size_t i = 0; i < _windowSize; ++i)
+	{
+		if (_gpuMeasured[i])
+		{
+			sum += _nodes[node].gpuTimes[i];
+			++numFrames;
+		}
+	}
+
+	return numFrames == 0 ? 0.f : sum / numFrames;
+}
+
+float Profiler::getMaxGPUTime(
+	int node) const
+{
+	float result = 0.f;
+
+	for (size_t i = 0; i < _windowSize; ++i)
+	{
+		if (_gpuMeasured[i])
+		{
+			result = std::max(result, _nodes[node].gpuTimes[i]);
+		}
+	}
+
+	return result;
+}
+
+float Profiler::getAverageCPUStart(
+	int node) const
+{
+	float sum = 0.f;
+	size_t numFrames = 0;
+
+	for (float start : _nodes[node].cpuStarts)
+	{
+		if (start >= 0.f)
+		{
+			sum += start;
+			++numFrames;
+		}
+	}
+
+	return numFrames == 0 ? 0.f : sum / numFrames;
+}
+
+float Profiler::getAverageGPUStart(
+	int node) const
+{
+	float sum = 0.f;
+	size_t numFrames = 0;
+
+	for (size_t i = 0; i < _windowSize; ++i)
+	{
+		float start = _nodes[node].gpuStarts[i];
+
+		if (_gpuMeasured[i] && start >= 0.f)
+		{
+			sum += start;
+			++numFrames;
+		}
+	}
+
+	return numFrames == 0 ? 0.f : sum / numFrames;
+}
+
+float Profiler::getAverageFrameTime() const
+{
+	size_t numFrames = static_cast<size_t>(std::min<unsigned long long>(_numMeasuredFrames, _windowSize));
+
+	if (numFrames == 0)
+	{
+		return 0.f;
+	}
+
+	float sum = 0.f;
+
+	for (float time : _frameTimes)
+	{
+		sum += time;
+	}
+
+	return sum / numFrames;
+}
+
+bool Profiler::startCapture(
+	unsigned int numFrames,
+	const std::string &filePath)
+{
+	if (isCapturing())
+	{
+		std::cerr << "[PROFILER] A capture is already running." << std::endl;
+
+		return false;
+	}
+
+	_capturePath = filePath;
+	_captureFramesLeft = std::max(numFrames, 1u);
+
+	return true;
+}
+
+void Profiler::finishCapture()
+{
+	_captureFramesLeft = 0;
+
+	if (_capturing)
+	{
+		writeCapture();
+	}
+}
+
+bool Profiler::isCapturing() const
+{
+	return _captureFramesLeft > 0 || _capturing;
+}
+
+void Profiler::addThreadScope(
+	const std::string &threadName,
+	const std::string &name,
+	std::chrono::steady_clock::time_point start,
+	std::chrono::steady_clock::time_point end)
+{
+	if (!_capturing)
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock{ _captureMutex };
+
+	// The capture may have been written while waiting for the lock.
+	if (!_capturing)
+	{
+		return;
+	}
+
+	TraceEvent event;
+	event.name = name;
+	event.thread = getCaptureThread(threadName);
+	event.start = std::chrono::duration<double, std::milli>(start - _startTime).count();
+	event.duration = std::chrono::duration<double, std::milli>(end - start).count();
+
+	_captureEvents.push_back(event);
+}
+
+double Profiler::getTime() const
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - _startTime).count();
+}
+
+int Profiler::getChild(
+	int parent,
+	const std::string &name,
+	bool gpu)
+{
+	std::vector<int>& siblings = parent < 0 ? _roots : _nodes[parent].children;
+
+	for (int index : siblings)
+	{
+		if (_nodes[index].name == name)
+		{
+			// A scope that has been measured on the GPU once keeps its
+			// column.
+			_nodes[index].gpu = _nodes[index].gpu || gpu;
+
+			return index;
+		}
+	}
+
+	int index = static_cast<int>(_nodes.size());
+
+	Node node;
+	node.name = name;
+	node.parent = parent;
+	node.depth = parent < 0 ? 0 : _nodes[parent].depth + 1;
+	node.gpu = gpu;
+	node.cpuTimes.resize(_windowSize, 0.f);
+	node.cpuStarts.resize(_windowSize, -1.f);
+	node.gpuTimes.resize(_windowSize, 0.f);
+	node.gpuStarts.resize(_windowSize, -1.f);
+
+	_nodes.push_back(std::move(node));
+
+	// The reference may have been invalidated by the push.
+	(parent < 0 ? _roots : _nodes[parent].children).push_back(index);
+
+	return index;
+}
+
+int Profiler::addQuery()
+{
+	FrameRecord& record = _records[_frame % PROFILER_FRAME_LATENCY];
+
+	if (record.numQueries == record.queries.size())
+	{
+		GLuint query;
+		glGenQueries(1, &query);
+
+		record.queries.push_back(query);
+	}
+
+	glQueryCounter(record.queries[record.numQueries], GL_TIMESTAMP);
+
+	return static_cast<int>(record.numQueries++);
+}
+
+bool Profiler::resolveFrame(
+	FrameRecord &record)
+{
+	// The timestamps are written in order, so the last one arrives last.
+	GLint available = 0;
+	glGetQueryObjectiv(record.queries[record.numQueries - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+
+	if (!available)
+	{
+		return false;
+	}
+
+	record.pending = false;
+
+	_timestamps.resize(record.numQueries);
+
+	for (unsigned int i = 0; i < record.numQueries; ++i)
+	{
+		glGetQueryObjectui64v(record.queries[i], GL_QUERY_RESULT, &_timestamps[i]);
+	}
+
+	if (record.captured)
+	{
+		captureGPUScopes(record);
+
+		--_captureUnresolved;
+	}
+
+	if (_frameCallback)
+	{
+		const Sample& frameSample = record.samples.front();
+
+		GLuint64 begin = _timestamps[frameSample.beginQuery];
+		GLuint64 end = _timestamps[frameSample.endQuery];
+
+		_frameCallback(record.frame, record.cpuTime, end > begin ? (end - begin) / 1000000.f : 0.f);
+	}
+
+	size_t slot = record.frame % _windowSize;
+
+	// The window has moved past the frame.
+	if (_frame - record.frame >= _windowSize)
+	{
+		return true;
+	}
+
+	for (auto& node : _nodes)
+	{
+		node.gpuTimes[slot] = 0.f;
+		node.gpuStarts[slot] = -1.f;
+	}
+
+	GLuint64 frameStart = _timestamps[0];
+
+	for (const auto& sample : record.samples)
+	{
+		if (sample.node < 0 || sample.beginQuery < 0 || sample.endQuery < 0)
+		{
+			continue;
+		}
+
+		Node& node = _nodes[sample.node];
+
+		GLuint64 begin = _timestamps[sample.beginQuery];
+		GLuint64 end = _timestamps[sample.endQuery];
+
+		node.gpuTimes[slot] += (end - begin) / 1000000.f;
+
+		if (node.gpuStarts[slot] < 0.f)
+		{
+			node.gpuStarts[slot] = begin > frameStart ? (begin - frameStart) / 1000000.f : 0.f;
+		}
+	}
+
+	_gpuMeasured[slot] = true;
+
+	return true;
+}
+
+void Profiler::captureGPUScopes(
+	const FrameRecord &record)
+{
+	std::lock_guard<std::mutex> lock{ _captureMutex };
+
+	for (const auto& sample : record.samples)
+	{
+		if (sample.beginQuery < 0 || sample.endQuery < 0)
+		{
+			continue;
+		}
+
+		GLuint64 begin = _timestamps[sample.beginQuery];
+		GLuint64 end = _timestamps[sample.endQuery];
+
+		TraceEvent event;
+		event.name = sample.node < 0 ? "Frame" : _nodes[sample.node].name;
+		event.thread = 1;
+		event.start = begin / 1000000.0 + _captureGPUOffset;
+		event.duration = end > begin ? (end - begin) / 1000000.0 : 0.0;
+
+		if (sample.node < 0)
+		{
+			event.frame = record.frame;
+		}
+
+		_captureEvents.push_back(event);
+	}
+}
+
+unsigned int Profiler::getCaptureThread(
+	const std::string &name)
+{
+	for (size_t i = 0; i < _captureThreads.size(); ++i)
+	{
+		if (_captureThreads[i] == name)
+		{
+			return static_cast<unsigned int>(i);
+		}
+	}
+
+	_captureThreads.push_back(name);
+
+	return static_cast<unsigned int>(_captureThreads.size() - 1);
+}
+
+void Profiler::writeCapture()
+{
+	std::vector<TraceEvent> events;
+	std::vector<std::string> threads;
+
+	{
+		std::lock_guard<std::mutex> lock{ _captureMutex };
+
+		_capturing = false;
+
+		events.swap(_captureEvents);
+		threads.swap(_captureThreads);
+	}
+
+	_captureUnresolved = 0;
+
+	for (auto& record : _records)
+	{
+		record.captured = false;
+	}
+
+	std::ofstream file{ _capturePath };
+
+	if (!file)
+	{
+		std::cerr << "[PROFILER] Could not open " << _capturePath << " to write the capture." << std::endl;
+
+		return;
+	}
+
+	// Timestamps are in microseconds.
+	file << std::fixed << std::setprecision(3);
+	file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+	for (size_t i = 0; i < threads.size(); ++i)
+	{
+		file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << i << ",\"args\":{\"name\":";
+		writeJSONString(file, threads[i]);
+		file << "}},\n";
+
+		file << "{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":1,\"tid\":" << i << ",\"args\":{\"sort_index\":" << i << "}}";
+		file << (i + 1 < threads.size() || !events.empty() ? ",\n" : "\n");
+	}
+
+	for (size_t i = 0; i < events.size(); ++i)
+	{
+		const TraceEvent& event = events[i];
+
+		file << "{\"name\":";
+		writeJSONString(file, event.name);
+		file << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.thread;
+		file << ",\"ts\":" << event.start * 1000.0 << ",\"dur\":" << event.duration * 1000.0;
+
+		if (event.frame != 0)
+		{
+			file << ",\"args\":{\"frame\":" << event.frame << "}";
+		}
+
+		file << (i + 1 < events.size() ? "},\n" : "}\n");
+	}
+
+	file << "]}\n";
+
+	std::cout << "[PROFILER] Wrote " << events.size() << " events to " << _capturePath << std::endl;
+}
+
+ProfilerScope::ProfilerScope(
+	Profiler &profiler,
+	const std::string &name,
+	bool gpu)
+	: _profiler{ profiler }
+{
+	_profiler.beginScope(name, gpu);
+}
+
+ProfilerScope::~ProfilerScope()
+{
+	_profiler.endScope();
+}
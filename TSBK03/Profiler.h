@@ -0,0 +1,262 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <mutex>
+#include <atomic>
+#include <functional>
+
+// Frames the GPU timestamps of a frame may take to arrive before they are
+// dropped.
+#define PROFILER_FRAME_LATENCY 4
+
+// Measures the CPU and GPU time spent in nested scopes and keeps them for a
+// rolling window of frames. Scopes with the same name under the same parent
+// are merged into one node, so the nodes form a tree that stays the same from
+// frame to frame. GPU times come from timestamp queries that are read a few
+// frames later without waiting for them. Only used from the main thread,
+// except for addThreadScope.
+//
+// A capture records every scope of a number of frames, along with the scopes
+// of other threads, and writes them as Chrome trace event JSON that can be
+// opened in chrome://tracing or Perfetto.
+class Profiler
+{
+public:
+	struct Node
+	{
+		std::string name{};
+
+		int parent{ -1 };
+		int depth{ 0 };
+
+		// Measured with timestamp queries as well.
+		bool gpu{ false };
+
+		std::vector<int> children{};
+
+		// By frame of the window, in milliseconds. The start is relative to
+		// the start of the frame and negative in frames the scope was not
+		// entered.
+		std::vector<float> cpuTimes{};
+		std::vector<float> cpuStarts{};
+		std::vector<float> gpuTimes{};
+		std::vector<float> gpuStarts{};
+	};
+
+	explicit Profiler(unsigned int windowSize = 120);
+
+	Profiler(const Profiler& other) = delete;
+	Profiler(Profiler&& other) = delete;
+
+	Profiler& operator=(const Profiler& other) = delete;
+	Profiler& operator=(Profiler&& other) = delete;
+
+	~Profiler();
+
+	// Frames enclose all scopes. Beginning a frame also reads the timestamps
+	// of earlier frames that the GPU has finished.
+	void beginFrame();
+	void endFrame();
+
+	// Reads the timestamps of the frames the GPU has finished without
+	// beginning a new frame. Calling glFinish first reads all of them.
+	void resolveFrames();
+
+	// Number of the current frame, or of the last one if none is running.
+	unsigned long long getFrame() const;
+
+	// Called with the number, CPU time and GPU time in milliseconds of every
+	// frame once its timestamps have been read. Frames whose timestamps were
+	// dropped are not reported.
+	void setFrameCallback(const std::function<void(unsigned long long, float, float)>& callback);
+
+	// Scopes must be ended in the reverse order they were begun, within the
+	// same frame. GPU scopes should only enclose GL commands of the main
+	// context.
+	void beginScope(const std::string& name, bool gpu);
+	void endScope();
+
+	// Takes effect from the next frame.
+	void setEnabled(bool enabled);
+	bool isEnabled() const;
+
+	unsigned int getWindowSize() const;
+
+	const std::vector<Node>& getNodes() const;
+
+	// Nodes without a parent, in the order they were first entered.
+	const std::vector<int>& getRoots() const;
+
+	// Over the frames of the window that have been measured. Frames where the
+	// scope was not entered count as zero time.
+	float getAverageCPUTime(int node) const;
+	float getMaxCPUTime(int node) const;
+	float getAverageGPUTime(int node) const;
+	float getMaxGPUTime(int node) const;
+
+	// Over the frames of the window where the scope was entered.
+	float getAverageCPUStart(int node) const;
+	float getAverageGPUStart(int node) const;
+
+	// Average time from the start to the end of a frame on the CPU.
+	float getAverageFrameTime() const;
+
+	// Captures the next numFrames frames and writes them to filePath once
+	// their GPU timestamps have arrived. The profiler is enabled while
+	// capturing. Returns false if a capture is already running.
+	bool startCapture(unsigned int numFrames, const std::string& filePath);
+
+	// Writes what has been captured so far and ends the capture. Frames whose
+	// timestamps have not arrived are written without their GPU scopes.
+	void finishCapture();
+
+	bool isCapturing() const;
+
+	// Adds a scope of another thread to the capture, ignored when not
+	// capturing. The thread is shown under its name. May be called from any
+	// thread.
+	void addThreadScope(
+		const std::string& threadName,
+		const std::string& name,
+		std::chrono::steady_clock::time_point start,
+		std::chrono::steady_clock::time_point end);
+
+private:
+
+	struct Sample
+	{
+		int node{ -1 };
+
+		double cpuStart{ 0.0 };
+		double cpuEnd{ 0.0 };
+
+		// Indices into the queries of the frame, -1 for CPU scopes. Both
+		// are set for the first sample, which covers the whole frame.
+		int beginQuery{ -1 };
+		int endQuery{ -1 };
+	};
+
+	struct FrameRecord
+	{
+		unsigned long long frame{ 0 };
+
+		std::vector<Sample> samples{};
+
+		// The first query is the start of the frame.
+		std::vector<GLuint> queries{};
+		unsigned int numQueries{ 0 };
+
+		// From the start to the end of the frame on the CPU, in milliseconds.
+		float cpuTime{ 0.f };
+
+		// Waiting for the timestamps.
+		bool pending{ false };
+
+		// Part of the capture.
+		bool captured{ false };
+	};
+
+	struct TraceEvent
+	{
+		std::string name{};
+
+		// Index into the capture threads.
+		unsigned int thread{ 0 };
+
+		// In milliseconds since the profiler was created.
+		double start{ 0.0 };
+		double duration{ 0.0 };
+
+		// Shown as an argument of frame events, zero otherwise.
+		unsigned long long frame{ 0 };
+	};
+
+	// Milliseconds since the profiler was created.
+	double getTime() const;
+
+	int getChild(int parent, const std::string& name, bool gpu);
+
+	// Appends a timestamp query to the current frame and returns its index.
+	int addQuery();
+
+	// Returns false if the timestamps have not arrived yet.
+	bool resolveFrame(FrameRecord& record);
+
+	// Adds the GPU scopes of a captured frame once its timestamps are read.
+	void captureGPUScopes(const FrameRecord& record);
+
+	// Requires the capture mutex to be held.
+	unsigned int getCaptureThread(const std::string& name);
+
+	void writeCapture();
+
+	unsigned int _windowSize;
+
+	bool _enabled{ true };
+	bool _wantEnabled{ true };
+
+	bool _inFrame{ false };
+
+	unsigned long long _frame{ 0 };
+
+	std::chrono::steady_clock::time_point _startTime{};
+
+	std::vector<Node> _nodes{};
+	std::vector<int> _roots{};
+
+	// Indices into the samples of the current frame.
+	std::vector<int> _stack{};
+
+	FrameRecord _records[PROFILER_FRAME_LATENCY];
+
+	// By frame of the window.
+	std::vector<float> _frameTimes{};
+	std::vector<bool> _gpuMeasured{};
+
+	unsigned long long _numMeasuredFrames{ 0 };
+
+	std::vector<GLuint64> _timestamps{};
+
+	std::function<void(unsigned long long, float, float)> _frameCallback{};
+
+	// Frames left to be begun in the capture.
+	unsigned int _captureFramesLeft{ 0 };
+
+	// Captured frames still waiting for their timestamps.
+	unsigned int _captureUnresolved{ 0 };
+
+	// Set from the first captured frame until the capture is written.
+	std::atomic<bool> _capturing{ false };
+
+	std::string _capturePath{};
+
+	// Added to GPU timestamps, in milliseconds, to get the time since the
+	// profiler was created.
+	double _captureGPUOffset{ 0.0 };
+
+	// Guards the events and threads of the capture.
+	std::mutex _captureMutex{};
+
+	std::vector<TraceEvent> _captureEvents{};
+	std::vector<std::string> _captureThreads{};
+};
+
+// Profiles the enclosing block.
+class ProfilerScope
+{
+public:
+	ProfilerScope(Profiler& profiler, const std::string& name, bool gpu = false);
+
+	ProfilerScope(const ProfilerScope& other) = delete;
+	ProfilerScope& operator=(const ProfilerScope& other) = delete;
+
+	~ProfilerScope();
+
+private:
+
+	Profiler& _profiler;
+};
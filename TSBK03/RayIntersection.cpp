@@ -0,0 +1,165 @@
+#include "RayIntersection.h"
+
+#include <cmath>
+
+namespace
+{
+	// Distance to the first intersection with a sphere along a normalized
+	// direction.
+	bool intersectRaySphere(
+		const glm::vec3 &origin,
+		const glm::vec3 &direction,
+		const glm::vec3 &center,
+		float radius,
+		float &distance)
+	{
+		glm::vec3 offset = origin - center;
+
+		float b = glm::dot(direction, offset);
+		float c = glm::dot(offset, offset) - radius * radius;
+
+		float discriminant = b * b - c;
+
+		if (discriminant < 0.f)
+		{
+			return false;
+		}
+
+		float root = std::sqrt(discriminant);
+
+		// Rays starting inside hit the far side.
+		distance = -b - root >= 0.f ? -b - root : -b + root;
+
+		return distance >= 0.f;
+	}
+}
+
+bool intersectRayTriangle(
+	const glm::vec3 &origin,
+	const glm::vec3 &direction,
+	const glm::vec3 &v0,
+	const glm::vec3 &v1,
+	const glm::vec3 &v2,
+	float &distance)
+{
+	const float epsilon = 1e-8f;
+
+	glm::vec3 edge1 = v1 - v0;
+	glm::vec3 edge2 = v2 - v0;
+
+	glm::vec3 p = glm::cross(direction, edge2);
+
+	float determinant = glm::dot(edge1, p);
+
+	// The ray is parallel to the triangle.
+	if (std::abs(determinant) < epsilon)
+	{
+		return false;
+	}
+
+	float inverseDeterminant = 1.f / determinant;
+
+	glm::vec3 offset = origin - v0;
+
+	float u = glm::dot(offset, p) * inverseDeterminant;
+
+	if (u < 0.f || u > 1.f)
+	{
+		return false;
+	}
+
+	glm::vec3 q = glm::cross(offset, edge1);
+
+	float v = glm::dot(direction, q) * inverseDeterminant;
+
+	if (v < 0.f || u + v > 1.f)
+	{
+		return false;
+	}
+
+	distance = glm::dot(edge2, q) * inverseDeterminant;
+
+	return distance >= 0.f;
+}
+
+bool intersectRayCapsule(
+	const glm::vec3 &origin,
+	const glm::vec3 &direction,
+	const glm::vec3 &start,
+	const glm::vec3 &end,
+	float radius,
+	float &distance)
+{
+	float length = glm::length(direction);
+
+	if (length == 0.f)
+	{
+		return false;
+	}
+
+	// Solved with a normalized direction and scaled back at the end.
+	glm::vec3 rayDirection = direction / length;
+
+	glm::vec3 axis = end - start;
+	glm::vec3 offset = origin - start;
+
+	float axisLength2 = glm::dot(axis, axis);
+	float axisDirection = glm::dot(axis, rayDirection);
+	float axisOffset = glm::dot(axis, offset);
+
+	float t = -1.f;
+
+	// The cylinder between the caps, skipped for rays along the axis and
+	// capsules that are spheres.
+	float a = axisLength2 - axisDirection * axisDirection;
+
+	if (a > 1e-8f)
+	{
+		float b = axisLength2 * glm::dot(offset, rayDirection) - axisOffset * axisDirection;
+		float c = axisLength2 * glm::dot(offset, offset) - axisOffset * axisOffset - radius * radius * axisLength2;
+
+		float discriminant = b * b - a * c;
+
+		if (discriminant >= 0.f)
+		{
+			float root = std::sqrt(discriminant);
+
+			float hit = (-b - root) / a;
+
+			// Rays starting inside hit the far side.
+			if (hit < 0.f)
+			{
+				hit = (-b + root) / a;
+			}
+
+			float along = axisOffset + hit * axisDirection;
+
+			if (hit >= 0.f && along > 0.f && along < axisLength2)
+			{
+				t = hit;
+			}
+		}
+	}
+
+	// The spheres at both ends.
+	float sphereHit;
+
+	if (intersectRaySphere(origin, rayDirection, start, radius, sphereHit) && (t < 0.f || sphereHit < t))
+	{
+		t = sphereHit;
+	}
+
+	if (intersectRaySphere(origin, rayDirection, end, radius, sphereHit) && (t < 0.f || sphereHit < t))
+	{
+		t = sphereHit;
+	}
+
+	if (t < 0.f)
+	{
+		return false;
+	}
+
+	distance = t / length;
+
+	return true;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+// Intersection tests for rays given by an origin and a direction that does
+// not need to be normalized. Distances are in multiples of the direction,
+// so a ray between two points can use their difference and only accept
+// distances up to one. Only hits in front of the origin are reported.
+
+// Moller-Trumbore, both sides of the triangle are hit.
+bool intersectRayTriangle(
+	const glm::vec3& origin,
+	const glm::vec3& direction,
+	const glm::vec3& v0,
+	const glm::vec3& v1,
+	const glm::vec3& v2,
+	float& distance);
+
+// Capsule given by the segment between start and end and a radius.
+bool intersectRayCapsule(
+	const glm::vec3& origin,
+	const glm::vec3& direction,
+	const glm::vec3& start,
+	const glm::vec3& end,
+	float radius,
+	float& distance);
@@ -0,0 +1,365 @@
+#include "RenderProxies.h"
+
+#include "StaticModelSceneNode.h"
+#include "TerrainSceneNode.h"
+#include "CrowdSceneNode.h"
+#include "PointLightSceneNode.h"
+#include "DirectionalLightSceneNode.h"
+
+#include <algorithm>
+
+namespace
+{
+	template <typename T>
+	void eraseNode(
+		std::vector<const T *> &nodes,
+		const SceneNode *node)
+	{
+		// Removing keeps the order, so the lights keep their shadow maps.
+		auto it = std::find(nodes.begin(), nodes.end(), static_cast<const T *>(node));
+
+		if (it != nodes.end())
+		{
+			nodes.erase(it);
+		}
+	}
+}
+
+RenderProxies::~RenderProxies()
+{
+	// Stop the scene from notifying a listener that is gone. A scene that
+	// was deleted has already reset _scene through onSceneNodeRemoved.
+	if (_scene != nullptr && _scene->getListener() == this)
+	{
+		_scene->setListener(nullptr);
+	}
+}
+
+void RenderProxies::attach(
+	Scene *scene)
+{
+	clear();
+
+	_scene = scene;
+
+	// Adds every node of the scene through onSceneNodeAdded.
+	_scene->setListener(this);
+
+	update();
+}
+
+bool RenderProxies::isAttached(
+	const Scene *scene) const
+{
+	return scene == _scene && scene->getListener() == this;
+}
+
+void RenderProxies::update()
+{
+	_numChanges = _numPendingChanges;
+	_numPendingChanges = 0;
+
+	if (!_lightsDirty)
+	{
+		return;
+	}
+
+	_pointLights.clear();
+	_directionalLights.clear();
+
+	for (auto it : _pointLightNodes)
+	{
+		_pointLights.emplace_back(it->getPointLight(), it->getPosition());
+	}
+
+	for (auto it : _directionalLightNodes)
+	{
+		_directionalLights.emplace_back(it->getDirectionalLight(), it->getPosition());
+	}
+
+	_lightsDirty = false;
+}
+
+const std::vector<const StaticModelSceneNode *> & RenderProxies::getStaticModels() const
+{
+	return _staticModels;
+}
+
+const std::vector<const TerrainSceneNode *> & RenderProxies::getTerrains() const
+{
+	return _terrains;
+}
+
+const std::vector<const CrowdSceneNode *> & RenderProxies::getCrowds() const
+{
+	return _crowds;
+}
+
+const std::vector<const DirectionalLightSceneNode *> & RenderProxies::getDirectionalLightNodes() const
+{
+	return _directionalLightNodes;
+}
+
+const std::vector<std::pair<PointLight, glm::vec3>> & RenderProxies::getPointLights() const
+{
+	return _pointLights;
+}
+
+const std::vector<std::pair<DirectionalLight, glm::vec3>> & RenderProxies::getDirectionalLights() const
+{
+	return _directionalLights;
+}
+
+void RenderProxies::updateStaticModelBounds(
+	const std::function<bool(const StaticModelSceneNode *, AABB &)> &getBounds)
+{
+	_provisionalStaticModels.clear();
+
+	for (auto it : _movedStaticModels)
+	{
+		size_t index = _staticModelIndices[it];
+
+		AABB bounds;
+
+		if (!getBounds(it, bounds))
+		{
+			_provisionalStaticModels.push_back(it);
+		}
+
+		if (_staticModelProxies[index] == BoundingVolumeHierarchy::NULL_NODE)
+		{
+			_staticModelProxies[index] = _staticModelTree.insert(bounds, static_cast<uint32_t>(index));
+		}
+		else
+		{
+			_staticModelTree.move(_staticModelProxies[index], bounds);
+		}
+
+		_staticModelMoved[index] = false;
+	}
+
+	_numMovedStaticModels = _movedStaticModels.size();
+	_movedStaticModels.clear();
+
+	// No notification is sent when the real model replaces the placeholder.
+	for (auto it : _provisionalStaticModels)
+	{
+		markStaticModelMoved(it);
+	}
+}
+
+size_t RenderProxies::getNumMovedStaticModels() const
+{
+	return _numMovedStaticModels;
+}
+
+const AABB & RenderProxies::getStaticModelBounds(
+	size_t index) const
+{
+	return _staticModelTree.getBox(_staticModelProxies[index]);
+}
+
+const BoundingVolumeHierarchy & RenderProxies::getStaticModelTree() const
+{
+	return _staticModelTree;
+}
+
+void RenderProxies::findStaticModels(
+	const glm::vec3 &center,
+	float radius,
+	std::vector<const StaticModelSceneNode *> &nodes) const
+{
+	_queryValues.clear();
+
+	_staticModelTree.queryRadius(center, radius, _queryValues);
+
+	for (auto it : _queryValues)
+	{
+		nodes.push_back(_staticModels[it]);
+	}
+}
+
+unsigned int RenderProxies::getNumChanges() const
+{
+	return _numChanges;
+}
+
+void RenderProxies::onSceneNodeAdded(
+	SceneNode *node)
+{
+	++_numPendingChanges;
+
+	switch (node->getSceneNodeType())
+	{
+	case SceneNodeType::STATIC_MODEL:
+		addStaticModel(static_cast<const StaticModelSceneNode *>(node));
+		break;
+	case SceneNodeType::TERRAIN:
+		_terrains.push_back(static_cast<const TerrainSceneNode *>(node));
+		break;
+	case SceneNodeType::CROWD:
+		_crowds.push_back(static_cast<const CrowdSceneNode *>(node));
+		break;
+	case SceneNodeType::POINT_LIGHT:
+		_pointLightNodes.push_back(static_cast<const PointLightSceneNode *>(node));
+		_lightsDirty = true;
+		break;
+	case SceneNodeType::DIRECTIONAL_LIGHT:
+		_directionalLightNodes.push_back(static_cast<const DirectionalLightSceneNode *>(node));
+		_lightsDirty = true;
+		break;
+	default:
+		break;
+	}
+}
+
+void RenderProxies::onSceneNodeRemoved(
+	SceneNode *node)
+{
+	++_numPendingChanges;
+
+	switch (node->getSceneNodeType())
+	{
+	case SceneNodeType::STATIC_MODEL:
+		removeStaticModel(node);
+		break;
+	case SceneNodeType::TERRAIN:
+		eraseNode(_terrains, node);
+		break;
+	case SceneNodeType::CROWD:
+		eraseNode(_crowds, node);
+		break;
+	case SceneNodeType::POINT_LIGHT:
+		eraseNode(_pointLightNodes, node);
+		_lightsDirty = true;
+		break;
+	case SceneNodeType::DIRECTIONAL_LIGHT:
+		eraseNode(_directionalLightNodes, node);
+		_lightsDirty = true;
+		break;
+	default:
+		break;
+	}
+
+	if (node == _scene)
+	{
+		_scene = nullptr;
+	}
+}
+
+void RenderProxies::onSceneNodeChanged(
+	SceneNode *node,
+	SceneNodeChange change)
+{
+	++_numPendingChanges;
+
+	// The drawables are read straight from their nodes, only the light
+	// records and the bounds of the static models are copies.
+	if (node->getSceneNodeType() == SceneNodeType::STATIC_MODEL &&
+		(change == SceneNodeChange::TRANSFORM || change == SceneNodeChange::MODEL))
+	{
+		markStaticModelMoved(node);
+	}
+	else if (node->getSceneNodeType() == SceneNodeType::POINT_LIGHT ||
+		node->getSceneNodeType() == SceneNodeType::DIRECTIONAL_LIGHT)
+	{
+		_lightsDirty = true;
+	}
+}
+
+void RenderProxies::clear()
+{
+	_staticModels.clear();
+	_staticModelProxies.clear();
+	_staticModelMoved.clear();
+	_staticModelIndices.clear();
+	_movedStaticModels.clear();
+	_staticModelTree.clear();
+	_terrains.clear();
+	_crowds.clear();
+
+	_pointLightNodes.clear();
+	_directionalLightNodes.clear();
+
+	_pointLights.clear();
+	_directionalLights.clear();
+
+	_lightsDirty = true;
+}
+
+void RenderProxies::addStaticModel(
+	const StaticModelSceneNode *node)
+{
+	_staticModelIndices[node] = _staticModels.size();
+
+	_staticModels.push_back(node);
+	_staticModelProxies.push_back(BoundingVolumeHierarchy::NULL_NODE);
+	_staticModelMoved.push_back(false);
+
+	// Inserted into the tree with the next refit.
+	markStaticModelMoved(node);
+}
+
+void RenderProxies::removeStaticModel(
+	const SceneNode *node)
+{
+	auto it = _staticModelIndices.find(node);
+
+	if (it == _staticModelIndices.end())
+	{
+		return;
+	}
+
+	size_t index = it->second;
+	size_t last = _staticModels.size() - 1;
+
+	_staticModelIndices.erase(it);
+
+	if (_staticModelMoved[index])
+	{
+		_movedStaticModels.erase(std::find(_movedStaticModels.begin(), _movedStaticModels.end(), _staticModels[index]));
+	}
+
+	if (_staticModelProxies[index] != BoundingVolumeHierarchy::NULL_NODE)
+	{
+		_staticModelTree.remove(_staticModelProxies[index]);
+	}
+
+	// Move the last model into the gap, so that only its index changes.
+	if (index != last)
+	{
+		_staticModels[index] = _staticModels[last];
+		_staticModelProxies[index] = _staticModelProxies[last];
+		_staticModelMoved[index] = _staticModelMoved[last];
+
+		_staticModelIndices[_staticModels[index]] = index;
+
+		if (_staticModelProxies[index] != BoundingVolumeHierarchy::NULL_NODE)
+		{
+			_staticModelTree.setValue(_staticModelProxies[index], static_cast<uint32_t>(index));
+		}
+	}
+
+	_staticModels.pop_back();
+	_staticModelProxies.pop_back();
+	_staticModelMoved.pop_back();
+}
+
+void RenderProxies::markStaticModelMoved(
+	const SceneNode *node)
+{
+	auto it = _staticModelIndices.find(node);
+
+	if (it == _staticModelIndices.end())
+	{
+		return;
+	}
+
+	size_t index = it->second;
+
+	if (!_staticModelMoved[index])
+	{
+		_staticModelMoved[index] = true;
+		_movedStaticModels.push_back(_staticModels[index]);
+	}
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <unordered_map>
+#include <functional>
+
+#include <glm/glm.hpp>
+
+#include "SceneNode.h"
+#include "SceneNodeListener.h"
+#include "BoundingVolumeHierarchy.h"
+#include "PointLight.h"
+#include "DirectionalLight.h"
+
+class StaticModelSceneNode;
+class TerrainSceneNode;
+class CrowdSceneNode;
+class PointLightSceneNode;
+class DirectionalLightSceneNode;
+
+// The drawable nodes and lights of a scene, kept in flat lists by type. The
+// lists follow the scene through its change notifications, so the renderer
+// never has to walk the scene graph once a scene is attached. The world
+// bounds of the static models are kept in a bounding volume hierarchy,
+// refit from the models that moved.
+class RenderProxies : public SceneNodeListener
+{
+public:
+	RenderProxies() = default;
+
+	~RenderProxies();
+
+	RenderProxies(const RenderProxies& other) = delete;
+	RenderProxies(RenderProxies&& other) = delete;
+
+	RenderProxies& operator=(const RenderProxies& other) = delete;
+	RenderProxies& operator=(RenderProxies&& other) = delete;
+
+	// Starts following a scene, forgetting the previous one. The previous
+	// scene is not touched, since it might already be gone.
+	void attach(Scene *scene);
+
+	bool isAttached(const Scene *scene) const;
+
+	// Refreshes the light records of lights that were changed since the
+	// last update. Call once per frame before rendering.
+	void update();
+
+	// Removing a static model moves the last one into its place, the other
+	// lists are in the order the nodes were added to the scene.
+	const std::vector<const StaticModelSceneNode *>& getStaticModels() const;
+	const std::vector<const TerrainSceneNode *>& getTerrains() const;
+	const std::vector<const CrowdSceneNode *>& getCrowds() const;
+	const std::vector<const DirectionalLightSceneNode *>& getDirectionalLightNodes() const;
+
+	// The light and its position, one record per light node.
+	const std::vector<std::pair<PointLight, glm::vec3>>& getPointLights() const;
+	const std::vector<std::pair<DirectionalLight, glm::vec3>>& getDirectionalLights() const;
+
+	// Refits the hierarchy to the static models that were added, moved or
+	// given another model since the last refit, asking getBounds for their
+	// world bounds. getBounds returns false if the bounds are provisional,
+	// e.g. taken from a placeholder while the model loads, and those models
+	// are refit again by every refit until it returns true. Call after the
+	// transforms of the scene are updated and before the hierarchy is
+	// queried.
+	void updateStaticModelBounds(const std::function<bool(const StaticModelSceneNode *, AABB&)>& getBounds);
+
+	// Static models whose bounds were updated by the last refit.
+	size_t getNumMovedStaticModels() const;
+
+	// The world bounds of the static model at an index of getStaticModels.
+	const AABB& getStaticModelBounds(size_t index) const;
+
+	// Holds the indices of the static models in getStaticModels.
+	const BoundingVolumeHierarchy& getStaticModelTree() const;
+
+	// Appends the static models whose bounds touch the sphere.
+	void findStaticModels(
+		const glm::vec3& center,
+		float radius,
+		std::vector<const StaticModelSceneNode *>& nodes) const;
+
+	// Notifications received before the last update.
+	unsigned int getNumChanges() const;
+
+	void onSceneNodeAdded(SceneNode *node) override;
+	void onSceneNodeRemoved(SceneNode *node) override;
+	void onSceneNodeChanged(SceneNode *node, SceneNodeChange change) override;
+
+private:
+
+	void clear();
+
+	void addStaticModel(const StaticModelSceneNode *node);
+	void removeStaticModel(const SceneNode *node);
+
+	void markStaticModelMoved(const SceneNode *node);
+
+	Scene *_scene{ nullptr };
+
+	std::vector<const StaticModelSceneNode *> _staticModels{};
+
+	// Per static model, the proxy in the tree or NULL_NODE before the bounds
+	// are first set, and whether it is in the list of moved models.
+	std::vector<int> _staticModelProxies{};
+	std::vector<bool> _staticModelMoved{};
+
+	std::unordered_map<const SceneNode *, size_t> _staticModelIndices{};
+
+	std::vector<const StaticModelSceneNode *> _movedStaticModels{};
+	size_t _numMovedStaticModels{ 0 };
+
+	// Scratch memory for the models with provisional bounds.
+	std::vector<const StaticModelSceneNode *> _provisionalStaticModels{};
+
+	BoundingVolumeHierarchy _staticModelTree{};
+
+	// Scratch memory for the queries.
+	mutable std::vector<uint32_t> _queryValues{};
+	std::vector<const TerrainSceneNode *> _terrains{};
+	std::vector<const CrowdSceneNode *> _crowds{};
+
+	std::vector<const PointLightSceneNode *> _pointLightNodes{};
+	std::vector<const DirectionalLightSceneNode *> _directionalLightNodes{};
+
+	std::vector<std::pair<PointLight, glm::vec3>> _pointLights{};
+	std::vector<std::pair<DirectionalLight, glm::vec3>> _directionalLights{};
+
+	// Lights are changed through references handed out by their nodes, so
+	// the records are refreshed on the next update rather than right away.
+	bool _lightsDirty{ false };
+
+	unsigned int _numPendingChanges{ 0 };
+	unsigned int _numChanges{ 0 };
+};
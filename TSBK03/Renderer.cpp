@@ -10,6 +10,13 @@
 #include "StaticModelSceneNode.h"
 #include "TerrainSceneNode.h"
 #include "Terrain.h"
+#include "CrowdSceneNode.h"
+#include "SkinnedModelInstance.h"
+#include "Timer.h"
+#include "RayIntersection.h"
+
+#include <cstring>
+#include <iterator>
 
 static GLfloat quadVertices[] = {
 	// Positions			// Texture Coords
@@ -60,18 +67,12 @@ Renderer::Renderer(
 	_shader.setVertexShaderSource("shader.vert");
 	_shader.setFragmentShaderSource("shader.frag");
 
-	_skinnedShader.setVertexShaderSource("skinnedshader.vert");
-	_skinnedShader.setFragmentShaderSource("shader.frag");
-
 	_blurShader.setVertexShaderSource("blur.vert");
 	_blurShader.setFragmentShaderSource("blur.frag");
 
 	_hdrShader.setVertexShaderSource("hdr.vert");
 	_hdrShader.setFragmentShaderSource("hdr.frag");
 
-	_pickingShader.setVertexShaderSource("picking.vert");
-	_pickingShader.setFragmentShaderSource("picking.frag");
-
 	_skyboxShader.setVertexShaderSource("skybox.vert");
 	_skyboxShader.setFragmentShaderSource("skybox.frag");
 
@@ -81,9 +82,6 @@ Renderer::Renderer(
 	_csmShader.setVertexShaderSource("csm.vert");
 	_csmShader.setFragmentShaderSource("csm.frag");
 
-	_skinnedCsmShader.setVertexShaderSource("skinnedcsm.vert");
-	_skinnedCsmShader.setFragmentShaderSource("csm.frag");
-
 	_godrayOcclusionShader.setVertexShaderSource("godrayOcclusion.vert");
 	_godrayOcclusionShader.setFragmentShaderSource("godrayOcclusion.frag");
 
@@ -100,21 +98,40 @@ Renderer::Renderer(
 	_grassShader.setFragmentShaderSource("grass.frag");
 	_grassShader.setGeometryShaderSource("grass.geom");
 
+	_skinnedInstancedShader.setVertexShaderSource("skinnedinstanced.vert");
+	_skinnedInstancedShader.setFragmentShaderSource("shader.frag");
+
+	// The variants of the lighting shaders are compiled as they are first
+	// drawn with, the base programs only serve as fallbacks.
+	_shader.setPermutationFeatures({ "USE_TEXTURE", "TERRAIN", "SNOW", "PICKING" });
+	_skinnedInstancedShader.setPermutationFeatures({ "USE_TEXTURE", "TERRAIN", "SNOW", "PICKING" });
+
+	_skinnedInstancedCsmShader.setVertexShaderSource("skinnedinstancedcsm.vert");
+	_skinnedInstancedCsmShader.setFragmentShaderSource("csm.frag");
+
+	_skinningShader.setComputeShaderSource("skinning.comp");
+
+	std::vector<GLSLShader *> shaders{
+		&_shader,
+		&_blurShader,
+		&_hdrShader,
+		&_skyboxShader,
+		&_outlinesBoxShader,
+		&_csmShader,
+		&_godrayOcclusionShader,
+		&_waterShader,
+		&_normalShader,
+		&_grassShader,
+		&_skinnedInstancedShader,
+		&_skinnedInstancedCsmShader,
+		&_skinningShader
+	};
+
+	Timer shaderTimer;
+
 	try
 	{
-		_shader.compile();
-		_skinnedShader.compile();
-		_blurShader.compile();
-		_hdrShader.compile();
-		_pickingShader.compile();
-		_skyboxShader.compile();
-		_outlinesBoxShader.compile();
-		_csmShader.compile();
-		_skinnedCsmShader.compile();
-		_godrayOcclusionShader.compile();
-		_waterShader.compile();
-		_normalShader.compile();
-		_grassShader.compile();
+		GLSLShader::compile(shaders);
 	}
 	catch (const GLSLShaderCompilationException& ex)
 	{
@@ -122,6 +139,18 @@ Renderer::Renderer(
 		exit(1);
 	}
 
+	float shaderTime = shaderTimer.restart();
+
+	unsigned int numCached = 0;
+
+	for (auto shader : shaders)
+	{
+		numCached += shader->isFromBinaryCache() ? 1 : 0;
+	}
+
+	std::cout << "[STARTUP] Shaders: " << shaderTime * 1000.f << "ms, "
+		<< numCached << " of " << shaders.size() << " programs from the binary cache" << std::endl;
+
 	glEnable(GL_DEPTH_TEST);
 	glDepthFunc(GL_LESS);
 
@@ -137,7 +166,10 @@ Renderer::Renderer(
 	// Setup performance query
 	//=========================================================================
 
-	glGenQueries(2, _queryID);
+	for (auto& timing : _frameTimings)
+	{
+		glGenQueries(2, timing.queries);
+	}
 
 	//=========================================================================
 	// Setup Screen Quad
@@ -339,12 +371,70 @@ Renderer::Renderer(
 	glGetIntegerv(GL_MAX_PATCH_VERTICES, &MaxPatchVertices);
 	//printf("Max supported patch vertices %d\n", MaxPatchVertices);
 	glPatchParameteri(GL_PATCH_VERTICES, 3);
+
+	GLint maxStorageBlockSize = 0;
+	glGetIntegerv(GL_MAX_SHADER_STORAGE_BLOCK_SIZE, &maxStorageBlockSize);
+	_maxCrowdInstances = static_cast<unsigned int>(maxStorageBlockSize) / (sizeof(glm::mat4) + sizeof(glm::vec4));
+
+	// The picked pixels are copied into these buffers and only mapped once
+	// the GPU is done with them, so reading them back never waits on the
+	// frame.
+	for (auto& readback : _pickingReadbacks)
+	{
+		glGenBuffers(1, &readback.buffer);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer);
+
+		glBufferData(
+			GL_PIXEL_PACK_BUFFER,
+			MAX_PICKING_REQUESTS * sizeof(RendererPickingInfo),
+			nullptr,
+			GL_STREAM_READ);
+	}
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	_textureStreamer.setProfiler(&_profiler);
+	_assetManager->setProfiler(&_profiler);
 }
 
 Renderer::~Renderer()
 {
+	// The workers may outlive the profiler.
+	_textureStreamer.setProfiler(nullptr);
+	_assetManager->setProfiler(nullptr);
+
 	// TODO: Remove all the framebuffers
 	destroyWindowSizeDependentObjects();
+
+	for (auto& it : _poseTextures)
+	{
+		delete it.second;
+	}
+
+	for (auto& it : _crowdInstanceBuffers)
+	{
+		glDeleteBuffers(1, &it.second.buffer);
+	}
+
+	for (auto& readback : _pickingReadbacks)
+	{
+		if (readback.fence != nullptr)
+		{
+			glDeleteSync(readback.fence);
+		}
+
+		glDeleteBuffers(1, &readback.buffer);
+	}
+
+	for (auto& timing : _frameTimings)
+	{
+		if (timing.fence != nullptr)
+		{
+			glDeleteSync(timing.fence);
+		}
+
+		glDeleteQueries(2, timing.queries);
+	}
 }
 
 void Renderer::constructWindowSizeDependentObjects()
@@ -404,6 +494,37 @@ void Renderer::constructWindowSizeDependentObjects()
 		GL_RENDERBUFFER,
 		_rboDepth);
 
+	// The object IDs for picking, only drawn to while the color pass draws
+	// the scene.
+	if (_gpuPicking)
+	{
+		glGenTextures(1, &_pickingIDBuffer);
+		glBindTexture(GL_TEXTURE_2D, _pickingIDBuffer);
+
+		glTexImage2D(
+			GL_TEXTURE_2D,
+			0,
+			GL_RGBA32UI,
+			_windowWidth,
+			_windowHeight,
+			0,
+			GL_RGBA_INTEGER,
+			GL_UNSIGNED_INT,
+			nullptr);
+
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+		glFramebufferTexture2D(
+			GL_FRAMEBUFFER,
+			GL_COLOR_ATTACHMENT2,
+			GL_TEXTURE_2D,
+			_pickingIDBuffer,
+			0);
+
+		glBindTexture(GL_TEXTURE_2D, 0);
+	}
+
 	GLuint attachments[2] =
 	{
 		GL_COLOR_ATTACHMENT0,
@@ -462,67 +583,6 @@ void Renderer::constructWindowSizeDependentObjects()
 	}
 
 	glBindFramebuffer(GL_FRAMEBUFFER, 0);
-
-	//=========================================================================
-	// Setup the picking texture
-	//=========================================================================
-
-	glGenFramebuffers(1, &_pickingFBO);
-	glBindFramebuffer(GL_FRAMEBUFFER, _pickingFBO);
-
-	glGenTextures(1, &_pickingTexture);
-	glBindTexture(GL_TEXTURE_2D, _pickingTexture);
-
-	glTexImage2D(
-		GL_TEXTURE_2D,
-		0,
-		GL_RGB32F,
-		_windowWidth,
-		_windowHeight,
-		0,
-		GL_RGB,
-		GL_FLOAT,
-		nullptr);
-
-	glFramebufferTexture2D(
-		GL_FRAMEBUFFER,
-		GL_COLOR_ATTACHMENT0,
-		GL_TEXTURE_2D,
-		_pickingTexture,
-		0);
-
-	glGenTextures(1, &_pickingDepth);
-	glBindTexture(GL_TEXTURE_2D, _pickingDepth);
-
-	glTexImage2D(
-		GL_TEXTURE_2D,
-		0,
-		GL_DEPTH_COMPONENT,
-		_windowWidth,
-		_windowHeight,
-		0,
-		GL_DEPTH_COMPONENT,
-		GL_FLOAT,
-		nullptr);
-
-	glFramebufferTexture2D(
-		GL_FRAMEBUFFER,
-		GL_DEPTH_ATTACHMENT,
-		GL_TEXTURE_2D,
-		_pickingDepth,
-		0);
-
-	glReadBuffer(GL_NONE);
-
-	glDrawBuffer(GL_COLOR_ATTACHMENT0);
-
-	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
-	{
-		std::cerr << "Picking Framebuffer not complete!" << std::endl;
-	}
-
-	glBindTexture(GL_TEXTURE_2D, 0);
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
 void Renderer::destroyWindowSizeDependentObjects()
@@ -534,8 +594,8 @@ void Renderer::destroyWindowSizeDependentObjects()
 	glDeleteFramebuffers(2, _pingpongFBO);
 	glDeleteTextures(2, _pingpongColorbuffers);
 
-	glDeleteFramebuffers(1, &_pickingFBO);
-	glDeleteTextures(1, &_pickingTexture);
+	glDeleteTextures(1, &_pickingIDBuffer);
+	_pickingIDBuffer = 0;
 
 }
 
@@ -657,8 +717,7 @@ void Renderer::calculateOrthoProjections(int lightIndex)
 	}
 }
 
-void Renderer::doCSMShadowPass(
-	Scene *scene)
+void Renderer::doCSMShadowPass()
 {
 	for (unsigned int i = 0; i < _directionalLights.size(); ++i)
 	{
@@ -679,7 +738,9 @@ void Renderer::doCSMShadowPass(
 
 			_currentCascade = i * NUM_CASCADES + j;
 
-			renderScene(scene, 2);
+			ProfilerScope scope{ _profiler, "Light " + std::to_string(i) + " Cascade " + std::to_string(j), true };
+
+			renderScene(2);
 		}
 	}
 }
@@ -687,55 +748,189 @@ void Renderer::doCSMShadowPass(
 void Renderer::render(
 	Scene *scene)
 {
-	unsigned long long int startTime;
-	unsigned long long int stopTime;
+	ProfilerScope renderScope{ _profiler, "Render", true };
+
+	++_frameIndex;
+	_frameStats = RendererFrameStats{};
+
+	// Crowds that were not drawn last frame have been removed or have no
+	// instances left.
+	for (auto it = _crowdInstanceBuffers.begin(); it != _crowdInstanceBuffers.end();)
+	{
+		if (it->second.frame + 1 < _frameIndex)
+		{
+			glDeleteBuffers(1, &it->second.buffer);
+			it = _crowdInstanceBuffers.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
 
-	// Extract Lights
-	_pointLights.clear();
-	_directionalLights.clear();
+	// Read the timings of the frames that are done, and wait for the oldest
+	// one if too many are queued. Otherwise the CPU keeps going while the GPU
+	// works on the earlier frames.
+	finishFrameTimings(false);
 
-	glQueryCounter(_queryID[0], GL_TIMESTAMP);
+	if (_frameIndex - _oldestFrameInFlight >= _maxFramesInFlight)
+	{
+		ProfilerScope scope{ _profiler, "Wait For GPU" };
 
-	// TODO: This should only be done when the scene has changed.
-	extractLights(scene);
+		while (_frameIndex - _oldestFrameInFlight >= _maxFramesInFlight)
+		{
+			finishFrameTimings(true);
+		}
+	}
 
-	// Do Render Pass
+	FrameTiming& timing = _frameTimings[_frameIndex % MAX_FRAMES_IN_FLIGHT];
+
+	glQueryCounter(timing.queries[0], GL_TIMESTAMP);
+
+	{
+		ProfilerScope scope{ _profiler, "Picking" };
+
+		// Answer the picking requests of earlier frames before anything is
+		// drawn, so that the callbacks can still change the scene and the
+		// readback buffers can be used again.
+		finishPickingReadbacks();
+
+		if (!_gpuPicking && !_pickingRequests.empty())
+		{
+			// GPU picking was turned off with requests left, cast rays for
+			// them instead.
+			std::vector<PickingRequest> requests = std::move(_pickingRequests);
+			_pickingRequests.clear();
+
+			for (auto& request : requests)
+			{
+				request.callback(pickWithRay(request.x, request.y));
+			}
+		}
+	}
+
+	{
+		ProfilerScope scope{ _profiler, "Scene Update" };
+
+		// The proxies follow the scene through its change notifications, so
+		// the scene is only walked when a different one is rendered.
+		if (!_proxies.isAttached(scene))
+		{
+			_proxies.attach(scene);
+		}
+
+		_proxies.update();
+
+		// Recompute the world matrices of the nodes that moved, once for all
+		// passes.
+		scene->updateTransforms();
+
+		cullStaticModels();
+
+		_frameStats.sceneChanges = _proxies.getNumChanges();
+	}
+
+	{
+		ProfilerScope scope{ _profiler, "Skinning", true };
+
+		doSkinningPass();
+	}
 
-	doPickingRenderPass(scene);
+	// Do Render Pass
 
 	if (_enableGodrays)
 	{
-		doGodrayOcclusionRenderingPass(scene);
+		ProfilerScope scope{ _profiler, "Godrays", true };
+
+		doGodrayOcclusionRenderingPass();
+	}
+
+	{
+		ProfilerScope scope{ _profiler, "CSM", true };
+
+		doCSMShadowPass();
+	}
+
+	{
+		ProfilerScope scope{ _profiler, "Color", true };
+
+		doColorRenderingPass();
 	}
 
-	doCSMShadowPass(scene);
+	if (_gpuPicking && !_pickingRequests.empty())
+	{
+		ProfilerScope scope{ _profiler, "Picking Readback", true };
 
-	doColorRenderingPass(scene);
+		readPickingRequests();
+	}
 
 	if (_bloom)
 	{
+		ProfilerScope scope{ _profiler, "Bloom", true };
+
 		doBloomBlurRenderingPass();
 	}
 
-	doScreenRenderPass();
-
-	// Timing stuff
+	{
+		ProfilerScope scope{ _profiler, "Screen", true };
 
-	glQueryCounter(_queryID[1], GL_TIMESTAMP);
+		doScreenRenderPass();
+	}
 
-	int stopTimerAvailable = 0;
-	while (!stopTimerAvailable)
 	{
-		glGetQueryObjectiv(
-			_queryID[1],
-			GL_QUERY_RESULT_AVAILABLE,
-			&stopTimerAvailable);
+		ProfilerScope scope{ _profiler, "Texture Streaming", true };
+
+		// Stream mips in and out for the textures drawn this frame.
+		_textureStreamer.update(_textureStreamingBudgetMs);
 	}
 
-	glGetQueryObjectui64v(_queryID[0], GL_QUERY_RESULT, &startTime);
-	glGetQueryObjectui64v(_queryID[1], GL_QUERY_RESULT, &stopTime);
+	// The timestamps are read once the fence has been passed.
+	glQueryCounter(timing.queries[1], GL_TIMESTAMP);
+
+	timing.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void Renderer::finishFrameTimings(
+	bool wait)
+{
+	while (_oldestFrameInFlight < _frameIndex)
+	{
+		FrameTiming& timing = _frameTimings[_oldestFrameInFlight % MAX_FRAMES_IN_FLIGHT];
+
+		if (timing.fence != nullptr)
+		{
+			// Flushing makes sure that the fence is reached when waiting.
+			GLenum result = glClientWaitSync(
+				timing.fence,
+				wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0,
+				wait ? 1000000000 : 0);
+
+			if (result == GL_TIMEOUT_EXPIRED)
+			{
+				return;
+			}
+
+			glDeleteSync(timing.fence);
+			timing.fence = nullptr;
+
+			// The queries were issued before the fence, so they are done.
+			if (result != GL_WAIT_FAILED)
+			{
+				GLuint64 startTime = 0;
+				GLuint64 stopTime = 0;
+
+				glGetQueryObjectui64v(timing.queries[0], GL_QUERY_RESULT, &startTime);
+				glGetQueryObjectui64v(timing.queries[1], GL_QUERY_RESULT, &stopTime);
 
-	_lastRenderTime = (stopTime - startTime) / 1000000.f;
+				_lastRenderTime = (stopTime - startTime) / 1000000.f;
+			}
+		}
+
+		++_oldestFrameInFlight;
+
+		// Only the oldest frame is waited for.
+		wait = false;
+	}
 }
 
 void Renderer::setCameraTransform(
@@ -777,6 +972,22 @@ float Renderer::getLastGPURenderTime() const
 	return _lastRenderTime;
 }
 
+void Renderer::setMaxFramesInFlight(
+	unsigned int maxFramesInFlight)
+{
+	_maxFramesInFlight = std::min(std::max(maxFramesInFlight, 1u), static_cast<unsigned int>(MAX_FRAMES_IN_FLIGHT));
+}
+
+unsigned int Renderer::getMaxFramesInFlight() const
+{
+	return _maxFramesInFlight;
+}
+
+const RendererFrameStats & Renderer::getFrameStats() const
+{
+	return _frameStats;
+}
+
 void Renderer::changeResolution(
 	int newWidth,
 	int newHeight)
@@ -847,16 +1058,57 @@ RendererPickingInfo Renderer::getPickingInfo(
 	int x,
 	int y)
 {
-	glBindFramebuffer(GL_READ_FRAMEBUFFER, _pickingFBO);
-	glReadBuffer(GL_COLOR_ATTACHMENT0);
+	return pickWithRay(x, y);
+}
 
-	RendererPickingInfo pixel;
-	glReadPixels(x, _windowHeight - y, 1, 1, GL_RGB, GL_FLOAT, &pixel);
+void Renderer::requestPicking(
+	int x,
+	int y,
+	const std::function<void(const RendererPickingInfo&)>& callback)
+{
+	if (!_gpuPicking)
+	{
+		callback(pickWithRay(x, y));
+		return;
+	}
 
-	glReadBuffer(GL_NONE);
-	glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+	PickingRequest request;
+	request.x = x;
+	request.y = y;
+	request.callback = callback;
+
+	_pickingRequests.push_back(std::move(request));
+}
+
+void Renderer::clearPickingRequests()
+{
+	_pickingRequests.clear();
+
+	// The readbacks in flight still finish, there is just no one to tell.
+	for (auto& readback : _pickingReadbacks)
+	{
+		readback.requests.clear();
+	}
+}
+
+bool Renderer::getGPUPicking() const
+{
+	return _gpuPicking;
+}
+
+void Renderer::setGPUPicking(
+	bool gpuPicking)
+{
+	if (_gpuPicking == gpuPicking)
+	{
+		return;
+	}
+
+	_gpuPicking = gpuPicking;
 
-	return pixel;
+	// The object ID attachment is only allocated with GPU picking.
+	destroyWindowSizeDependentObjects();
+	constructWindowSizeDependentObjects();
 }
 
 bool Renderer::getFXAA() const
@@ -1044,34 +1296,6 @@ void Renderer::setDrawNormals(
 	_drawNormals = value;
 }
 
-void Renderer::extractLights(
-	const SceneNode *node)
-{
-	if (node->getSceneNodeType() == SceneNodeType::POINT_LIGHT)
-	{
-		// TODO: Insert possible culling of point lights depending on the camera position.
-
-		const PointLightSceneNode *pointLightSceneNode = reinterpret_cast<const PointLightSceneNode *>(node);
-
-		_pointLights.emplace_back(
-			pointLightSceneNode->getPointLight(),
-			pointLightSceneNode->getPosition());
-	}
-	else if (node->getSceneNodeType() == SceneNodeType::DIRECTIONAL_LIGHT)
-	{
-		const DirectionalLightSceneNode *directionalLightSceneNode = reinterpret_cast<const DirectionalLightSceneNode *>(node);
-
-		_directionalLights.emplace_back(
-			directionalLightSceneNode->getDirectionalLight(),
-			directionalLightSceneNode->getPosition());
-	}
-
-	for (auto it : node->getChildren())
-	{
-		extractLights(it);
-	}
-}
-
 void Renderer::renderSkybox()
 {
 	_skyboxShader.use();
@@ -1081,8 +1305,8 @@ void Renderer::renderSkybox()
 
 	glm::mat4 skyboxMVP = _projection * skyboxViewMatrix * skyboxModelMatrix;
 
-	Model *model = _assetManager->fetch<Model>(_skybox.getModel());
-	TextureCubeMap *texture = _assetManager->fetch<TextureCubeMap>(_skybox.getTexture());
+	Model *model = _assetManager->resolve(_skybox.getModelRef(), _skybox.getModel());
+	TextureCubeMap *texture = _assetManager->resolve(_skybox.getTextureRef(), _skybox.getTexture());
 
 	_skyboxShader.uploadUniform("mvp", skyboxMVP);
 	_skyboxShader.uploadUniform("texUnit", 0);
@@ -1100,6 +1324,8 @@ void Renderer::renderSkybox()
 	for (unsigned int i = 0; i < model->getMeshes().size(); ++i)
 	{
 		model->getMeshes().at(i)->render();
+
+		addDrawStats(1, model->getMeshes().at(i)->getIndices().size() / 3);
 	}
 
 	glCullFace(OldCullFaceMode);
@@ -1107,8 +1333,7 @@ void Renderer::renderSkybox()
 
 }
 
-void Renderer::doGodrayOcclusionRenderingPass(
-	const SceneNode *scene)
+void Renderer::doGodrayOcclusionRenderingPass()
 {
 	glBindFramebuffer(GL_FRAMEBUFFER, _godrayFBO);
 
@@ -1117,14 +1342,13 @@ void Renderer::doGodrayOcclusionRenderingPass(
 
 	glViewport(0, 0, _godrayOcclusionSize, _godrayOcclusionSize);
 
-	renderScene(scene, 4);
-	renderScene(scene, 3);
+	renderScene(4);
+	renderScene(3);
 
 	glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
-void Renderer::doColorRenderingPass(
-	const SceneNode *scene)
+void Renderer::doColorRenderingPass()
 {
 	glBindFramebuffer(GL_FRAMEBUFFER, _hdrFBO);
 
@@ -1135,7 +1359,22 @@ void Renderer::doColorRenderingPass(
 
 	renderSkybox();
 
-	renderScene(scene, 0);
+	// Only the scene writes object IDs, everything else leaves them cleared
+	// or keeps the IDs of what is behind.
+	if (_gpuPicking)
+	{
+		setPickingOutput(true);
+
+		const GLuint noObject[4] = { 0, 0, 0, 0 };
+		glClearBufferuiv(GL_COLOR, 2, noObject);
+	}
+
+	renderScene(0);
+
+	if (_gpuPicking)
+	{
+		setPickingOutput(false);
+	}
 
 	_waterShader.use();
 	_waterShader.uploadUniform("vp", _projection * _cameraTransform);
@@ -1183,33 +1422,407 @@ void Renderer::doColorRenderingPass(
 	glDrawArraysInstanced(GL_PATCHES, 0, 6, 100);
 	glBindVertexArray(0);
 
+	addDrawStats(1, 2 * 100);
+
 	glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
 
 	glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
-void Renderer::doPickingRenderPass(
-	const SceneNode *scene)
+void Renderer::readPickingRequests()
 {
-	glBindFramebuffer(GL_FRAMEBUFFER, _pickingFBO);
+	PickingReadback *readback = nullptr;
 
-	glClearColor(0.0f, 0.0f, 0.0f, 1.f);
-	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	for (auto& it : _pickingReadbacks)
+	{
+		if (it.fence == nullptr)
+		{
+			readback = &it;
+			break;
+		}
+	}
 
-	glViewport(0, 0, _windowWidth, _windowHeight);
+	// All buffers are being read back, the requests wait for the next frame
+	// rather than stalling on one of them.
+	if (readback == nullptr)
+	{
+		return;
+	}
 
-	glDisable(GL_BLEND);
+	size_t numRequests = std::min(_pickingRequests.size(), static_cast<size_t>(MAX_PICKING_REQUESTS));
 
-	renderScene(scene, 1);
+	readback->requests.assign(
+		std::make_move_iterator(_pickingRequests.begin()),
+		std::make_move_iterator(_pickingRequests.begin() + numRequests));
 
-	glEnable(GL_BLEND);
+	_pickingRequests.erase(_pickingRequests.begin(), _pickingRequests.begin() + numRequests);
 
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
-}
+	// Copy the pixels into the buffer, they are mapped once the fence has
+	// been passed.
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, _hdrFBO);
+	glReadBuffer(GL_COLOR_ATTACHMENT2);
 
-void Renderer::doBloomBlurRenderingPass()
-{
-	_blurShader.use();
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, readback->buffer);
+
+	for (size_t i = 0; i < readback->requests.size(); ++i)
+	{
+		// Rows are counted from the bottom.
+		int x = glm::clamp(readback->requests[i].x, 0, _windowWidth - 1);
+		int y = glm::clamp(_windowHeight - 1 - readback->requests[i].y, 0, _windowHeight - 1);
+
+		glReadPixels(
+			x,
+			y,
+			1,
+			1,
+			GL_RGB_INTEGER,
+			GL_UNSIGNED_INT,
+			reinterpret_cast<void *>(i * sizeof(RendererPickingInfo)));
+	}
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	glReadBuffer(GL_COLOR_ATTACHMENT0);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+
+	readback->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void Renderer::setPickingOutput(
+	bool enabled)
+{
+	GLuint attachments[3] =
+	{
+		GL_COLOR_ATTACHMENT0,
+		GL_COLOR_ATTACHMENT1,
+		GL_COLOR_ATTACHMENT2
+	};
+
+	glDrawBuffers(enabled ? 3 : 2, attachments);
+}
+
+void Renderer::finishPickingReadbacks()
+{
+	for (auto& readback : _pickingReadbacks)
+	{
+		if (readback.fence == nullptr)
+		{
+			continue;
+		}
+
+		GLenum result = glClientWaitSync(readback.fence, 0, 0);
+
+		if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED)
+		{
+			continue;
+		}
+
+		glDeleteSync(readback.fence);
+		readback.fence = nullptr;
+
+		// The callbacks may request or clear picking, so the requests are
+		// taken out of the readback before any of them is called.
+		std::vector<PickingRequest> requests = std::move(readback.requests);
+		readback.requests.clear();
+
+		if (requests.empty())
+		{
+			continue;
+		}
+
+		std::vector<RendererPickingInfo> infos(requests.size());
+
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer);
+
+		const void *data = glMapBufferRange(
+			GL_PIXEL_PACK_BUFFER,
+			0,
+			requests.size() * sizeof(RendererPickingInfo),
+			GL_MAP_READ_BIT);
+
+		if (data != nullptr)
+		{
+			memcpy(infos.data(), data, requests.size() * sizeof(RendererPickingInfo));
+			glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+		}
+
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+		for (size_t i = 0; i < requests.size(); ++i)
+		{
+			requests[i].callback(infos[i]);
+		}
+	}
+}
+
+RendererPickingInfo Renderer::pickWithRay(
+	int x,
+	int y)
+{
+	RendererPickingInfo info;
+
+	// The ray through the centre of the pixel from the near to the far
+	// plane, so the hits are at distances between zero and one.
+	glm::vec2 ndc{
+		2.f * (static_cast<float>(x) + 0.5f) / static_cast<float>(_windowWidth) - 1.f,
+		1.f - 2.f * (static_cast<float>(y) + 0.5f) / static_cast<float>(_windowHeight) };
+
+	glm::mat4 inverseViewProjection = glm::inverse(_projection * _cameraTransform);
+
+	glm::vec4 nearPoint = inverseViewProjection * glm::vec4{ ndc, -1.f, 1.f };
+	glm::vec4 farPoint = inverseViewProjection * glm::vec4{ ndc, 1.f, 1.f };
+
+	glm::vec3 origin = glm::vec3{ nearPoint } / nearPoint.w;
+	glm::vec3 direction = glm::vec3{ farPoint } / farPoint.w - origin;
+
+	float distance = 1.f;
+
+	_pickingHits.clear();
+
+	_proxies.getStaticModelTree().queryRay(origin, direction, distance, _pickingHits);
+
+	const std::vector<const StaticModelSceneNode *>& staticModels = _proxies.getStaticModels();
+
+	// The hits are sorted by where the ray enters the bounds, so the models
+	// further away than the closest hit so far can be skipped.
+	for (auto& it : _pickingHits)
+	{
+		if (it.first > distance)
+		{
+			break;
+		}
+
+		pickStaticModel(staticModels[it.second], origin, direction, distance, info);
+	}
+
+	for (auto terrainNode : _proxies.getTerrains())
+	{
+		pickTerrain(terrainNode, origin, direction, distance, info);
+	}
+
+	return info;
+}
+
+void Renderer::pickStaticModel(
+	const StaticModelSceneNode *modelNode,
+	const glm::vec3 &origin,
+	const glm::vec3 &direction,
+	float &distance,
+	RendererPickingInfo &info)
+{
+	Model *model = _assetManager->resolve(modelNode->getModelRef(), modelNode->getModel());
+
+	// Transforming the ray keeps the distances, so the model is tested in
+	// its own space.
+	glm::mat4 inverseModel = glm::inverse(modelNode->getTransformationMatrix() * model->getCorrectionTransform());
+
+	glm::vec3 modelOrigin = inverseModel * glm::vec4{ origin, 1.f };
+	glm::vec3 modelDirection = inverseModel * glm::vec4{ direction, 0.f };
+
+	float hit;
+
+	if (model->isSkinned())
+	{
+		// The pose last used for rendering, the bind pose before that.
+		const AnimationPoseCache& cache = modelNode->getPoseCache();
+
+		for (const BoneCapsule& capsule : model->getBoneCapsules())
+		{
+			glm::vec3 start = capsule.start;
+			glm::vec3 end = capsule.end;
+
+			if (cache.valid && capsule.bone < cache.boneTransforms.size())
+			{
+				start = cache.boneTransforms[capsule.bone] * glm::vec4{ start, 1.f };
+				end = cache.boneTransforms[capsule.bone] * glm::vec4{ end, 1.f };
+			}
+
+			if (intersectRayCapsule(modelOrigin, modelDirection, start, end, capsule.radius, hit) && hit < distance)
+			{
+				distance = hit;
+
+				info.objectID = modelNode->getID();
+				info.drawID = 0;
+				info.primID = static_cast<uint32_t>(capsule.bone);
+			}
+		}
+
+		return;
+	}
+
+	const std::vector<Mesh *>& meshes = model->getMeshes();
+
+	for (size_t i = 0; i < meshes.size(); ++i)
+	{
+		const std::vector<Vertex>& vertices = meshes[i]->getVertices();
+		const std::vector<unsigned int>& indices = meshes[i]->getIndices();
+
+		for (size_t j = 0; j + 2 < indices.size(); j += 3)
+		{
+			if (intersectRayTriangle(
+					modelOrigin,
+					modelDirection,
+					vertices[indices[j]].getPosition(),
+					vertices[indices[j + 1]].getPosition(),
+					vertices[indices[j + 2]].getPosition(),
+					hit) &&
+				hit < distance)
+			{
+				distance = hit;
+
+				info.objectID = modelNode->getID();
+				info.drawID = static_cast<uint32_t>(i);
+				info.primID = static_cast<uint32_t>(j / 3);
+			}
+		}
+	}
+}
+
+void Renderer::pickTerrain(
+	const TerrainSceneNode *terrainNode,
+	const glm::vec3 &origin,
+	const glm::vec3 &direction,
+	float &distance,
+	RendererPickingInfo &info)
+{
+	const Terrain *terrain = _assetManager->resolve(terrainNode->getTerrainRef(), terrainNode->getTerrain());
+
+	glm::mat4 inverseModel = glm::inverse(terrainNode->getTransformationMatrix());
+
+	glm::vec3 terrainOrigin = inverseModel * glm::vec4{ origin, 1.f };
+	glm::vec3 terrainDirection = inverseModel * glm::vec4{ direction, 0.f };
+
+	// Steps of half a grid cell along the ray, up to the closest hit so far.
+	const float stepLength = 0.5f;
+
+	float length = glm::length(terrainDirection) * distance;
+
+	if (length <= 0.f)
+	{
+		return;
+	}
+
+	int steps = static_cast<int>(std::ceil(length / stepLength));
+
+	auto isBelow = [&](float t)
+	{
+		glm::vec3 point = terrainOrigin + terrainDirection * t;
+
+		return terrain->getChunkIndex(point.x, point.z) >= 0 && point.y <= terrain->getHeight(point.x, point.z);
+	};
+
+	float previous = 0.f;
+
+	for (int i = 1; i <= steps; ++i)
+	{
+		float t = distance * static_cast<float>(i) / static_cast<float>(steps);
+
+		if (!isBelow(t))
+		{
+			previous = t;
+			continue;
+		}
+
+		// The surface is between the last two steps.
+		float above = previous;
+		float below = t;
+
+		for (int j = 0; j < 8; ++j)
+		{
+			float middle = 0.5f * (above + below);
+
+			if (isBelow(middle))
+			{
+				below = middle;
+			}
+			else
+			{
+				above = middle;
+			}
+		}
+
+		glm::vec3 point = terrainOrigin + terrainDirection * below;
+
+		distance = below;
+
+		info.objectID = terrainNode->getID();
+		info.drawID = static_cast<uint32_t>(terrain->getChunkIndex(point.x, point.z));
+		info.primID = 0;
+
+		return;
+	}
+}
+
+void Renderer::doSkinningPass()
+{
+	const std::vector<const StaticModelSceneNode *>& staticModels = _proxies.getStaticModels();
+
+	// Every pass uses the same culling results, so invisible models are
+	// never drawn and do not need to be skinned.
+	for (auto it : _visibleStaticModels)
+	{
+		skinStaticModel(staticModels[it]);
+	}
+
+	// Make the skinned vertices visible to all passes drawing them.
+	glMemoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+}
+
+void Renderer::skinStaticModel(
+	const StaticModelSceneNode *modelNode)
+{
+	Model *model = _assetManager->resolve(modelNode->getModelRef(), modelNode->getModel());
+
+	if (model->isSkinned())
+	{
+		AnimationPoseCache& cache = modelNode->getPoseCache();
+
+		if (!cache.skinnedInstance || cache.skinnedInstance->getModel() != model)
+		{
+			cache.skinnedInstance = std::make_shared<SkinnedModelInstance>(model);
+		}
+
+		const std::vector<glm::mat4>& transforms = getBoneTransforms(modelNode, model);
+
+		// Held poses keep the vertices from the last time they were skinned.
+		if (!cache.skinnedInstance->isReady() || cache.skinnedFrame != cache.frame)
+		{
+			cache.skinnedInstance->skin(_skinningShader, transforms);
+			cache.skinnedFrame = cache.frame;
+
+			++_frameStats.skinnedModels;
+		}
+	}
+}
+
+void Renderer::cullStaticModels()
+{
+	// Only the models that moved since the last frame are refit, along with
+	// the ones that still show the placeholder.
+	_proxies.updateStaticModelBounds([this](const StaticModelSceneNode *modelNode, AABB &bounds)
+	{
+		Model *model = _assetManager->resolve(modelNode->getModelRef(), modelNode->getModel());
+
+		bounds = model->getExtents().getBoundingBox(modelNode->getTransformationMatrix() * model->getCorrectionTransform());
+
+		return _assetManager->isLoaded<Model>(modelNode->getModel());
+	});
+
+	_visibleStaticModels.clear();
+	_visibleStaticModelResults.clear();
+
+	_proxies.getStaticModelTree().cull(
+		Frustum{ _projection * _cameraTransform },
+		_visibleStaticModels,
+		_visibleStaticModelResults);
+
+	_frameStats.movedStaticModels = static_cast<unsigned int>(_proxies.getNumMovedStaticModels());
+	_frameStats.visibleStaticModels = static_cast<unsigned int>(_visibleStaticModels.size());
+}
+
+void Renderer::doBloomBlurRenderingPass()
+{
+	_blurShader.use();
 
 	bool horizontal = true;
 	bool first_iteration = true;
@@ -1244,6 +1857,8 @@ void Renderer::doBloomBlurRenderingPass()
 		glDrawArrays(GL_TRIANGLES, 0, 6);
 		glBindVertexArray(0);
 
+		addDrawStats(1, 2);
+
 		horizontal = !horizontal;
 
 		if (first_iteration)
@@ -1335,23 +1950,24 @@ void Renderer::doScreenRenderPass()
 	glBindVertexArray(_quadVAO);
 	glDrawArrays(GL_TRIANGLES, 0, 6);
 	glBindVertexArray(0);
+
+	addDrawStats(1, 2);
 }
 
 void Renderer::renderScene(
-	const SceneNode *node,
 	int pass)
 {
-	if (node->getSceneNodeType() == SceneNodeType::STATIC_MODEL)
+	const std::vector<const StaticModelSceneNode *>& staticModels = _proxies.getStaticModels();
+
+	for (auto it : _visibleStaticModels)
 	{
-		const StaticModelSceneNode *modelNode = reinterpret_cast<const StaticModelSceneNode *>(node);
+		const StaticModelSceneNode *modelNode = staticModels[it];
 
 		if (pass == 0)
 		{
-			renderStaticModel(modelNode);
-		}
-		else if (pass == 1)
-		{
-			renderStaticModelPicking(modelNode);
+			const AABB& bounds = _proxies.getStaticModelBounds(it);
+
+			renderStaticModel(modelNode, getScreenSize(bounds.getCenter(), glm::length(bounds.getSize()) * 0.5f));
 		}
 		else if (pass == 2)
 		{
@@ -1362,86 +1978,56 @@ void Renderer::renderScene(
 			renderStaticModelGodrayOcclusion(modelNode);
 		}
 	}
-	else if (node->getSceneNodeType() == SceneNodeType::DIRECTIONAL_LIGHT)
-	{
-		const DirectionalLightSceneNode *lightNode = reinterpret_cast<const DirectionalLightSceneNode *>(node);
 
-		if (pass == 4)
+	if (pass == 4)
+	{
+		for (auto lightNode : _proxies.getDirectionalLightNodes())
 		{
 			renderDirectionalLightGodrayOcclusion(lightNode);
 		}
 	}
-	else if (node->getSceneNodeType() == SceneNodeType::TERRAIN)
-	{
-		const TerrainSceneNode *terrainNode = reinterpret_cast<const TerrainSceneNode *>(node);
 
+	for (auto terrainNode : _proxies.getTerrains())
+	{
 		if (pass == 0)
 		{
 			renderTerrain(terrainNode);
 		}
-		else if (pass == 1)
-		{
-			renderTerrainPicking(terrainNode);
-		}
 		else if (pass == 2)
 		{
 			renderTerrainCSM(terrainNode);
 		}
 	}
 
-	for (auto it : node->getChildren())
+	for (auto crowdNode : _proxies.getCrowds())
 	{
-		renderScene(it, pass);
+		if (pass == 0)
+		{
+			renderCrowd(crowdNode);
+		}
+		else if (pass == 2)
+		{
+			renderCrowdCSM(crowdNode);
+		}
 	}
 }
 
 void Renderer::renderStaticModel(
-	const StaticModelSceneNode *modelNode)
+	const StaticModelSceneNode *modelNode,
+	float screenSize)
 {
-	std::string modelTag = modelNode->getModel();
-
-	Model *model = _assetManager->fetch<Model>(modelTag);
-
-	Frustum frustum{ _projection * _cameraTransform };
-
-	std::vector<glm::vec3> points = model->getExtents().getPoints();
+	Model *model = _assetManager->resolve(modelNode->getModelRef(), modelNode->getModel());
 
 	glm::mat4 modelTransform = modelNode->getTransformationMatrix() * model->getCorrectionTransform();
 
-	for(auto& it : points)
-	{
-		it = modelTransform * glm::vec4{ it, 1.f };
-	}
+	const std::string& texture = modelNode->getTexture();
 
-	if(frustum.boxIntersect(points) < 0)
-	{
-		return;
-	}
+	GLSLShaderPermutation permutation = getLightingPermutation(texture.empty() ? 0u : static_cast<uint32_t>(LIGHTING_SHADER_USE_TEXTURE));
 
-	GLSLShader *currentShader = &_shader;
+	// Skinned models have already been skinned by the skinning pass.
+	GLSLShader *currentShader = &_shader.getPermutation(permutation);
 
-	if (model->isSkinned())
-	{
-		_skinnedShader.use();
-		currentShader = &_skinnedShader;
-
-		std::vector<glm::mat4> transforms;
-
-		float time = glfwGetTime();
-
-		if (modelNode->getCurrentAnimation() == "idle")
-		{
-			time = 1.52;
-		}
-
-		model->getBoneTransforms(time, transforms, modelNode->getCurrentAnimation());
-
-		currentShader->uploadUniformArray("bones", transforms.size(), transforms);
-	}
-	else
-	{
-		_shader.use();
-	}
+	currentShader->use();
 
 	glm::mat4 mvp = _projection * _cameraTransform * modelTransform;
 
@@ -1473,7 +2059,7 @@ void Renderer::renderStaticModel(
 
 	const unsigned int CSMIndexStart = 4;
 
-	for (unsigned int i = 0; i < NUM_CASCADES * MAX_LIGHTS; ++i)
+	for (unsigned int i = 0; i < NUM_CASCADES * permutation.numDirectionalLights; ++i)
 	{
 		currentShader->uploadUniform("shadowMap[" + std::to_string(i) + "]",
 			static_cast<int>(CSMIndexStart + i));
@@ -1492,9 +2078,13 @@ void Renderer::renderStaticModel(
 	currentShader->uploadUniform("model", modelTransform);
 	currentShader->uploadUniform("mvp", mvp);
 	currentShader->uploadUniform("texUnit", 0);
-	currentShader->uploadUniform("snow", _snow);
 	currentShader->uploadUniform("tintColor", modelNode->getTintColor());
 
+	if (_gpuPicking)
+	{
+		currentShader->uploadUniform("objectIndex", static_cast<int>(modelNode->getID()));
+	}
+
 	for (unsigned int i = 0; i < NUM_CASCADES; ++i)
 	{
 		glm::vec4 cascadeEndVec{ 0.f, 0.f, _cascadeEnds[i + 1], 1.f };
@@ -1504,17 +2094,12 @@ void Renderer::renderStaticModel(
 		currentShader->uploadUniform("CSMEndClipSpace[" + std::to_string(i) + "]", vClip.z);
 	}
 
-	std::string texture = modelNode->getTexture();
-
 	if (!texture.empty())
 	{
-		Texture2D *tex = _assetManager->fetch<Texture2D>(texture);
+		Texture2D *tex = _assetManager->resolve(modelNode->getTextureRef(), texture);
 		tex->bind(0);
-		currentShader->uploadUniform("useTexture", 1);
-	}
-	else
-	{
-		currentShader->uploadUniform("useTexture", 0);
+
+		_textureStreamer.request(tex, screenSize);
 	}
 
 	if (model->getWireframe())
@@ -1526,8 +2111,6 @@ void Renderer::renderStaticModel(
 		glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
 	}
 
-	_shader.uploadUniform("terrain", false);
-
 	for (unsigned int i = 0; i < model->getMeshes().size(); ++i)
 	{
 		unsigned int materialIndex = model->getMeshes().at(i)->getMaterialIndex();
@@ -1539,7 +2122,12 @@ void Renderer::renderStaticModel(
 		currentShader->uploadUniform("material.specular", material.specularColor);
 		currentShader->uploadUniform("material.exponent", material.exponent);
 
-		model->getMeshes().at(i)->render();
+		if (_gpuPicking)
+		{
+			currentShader->uploadUniform("drawIndex", static_cast<int>(i));
+		}
+
+		renderStaticModelMesh(modelNode, model, i);
 	}
 
 	glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
@@ -1566,129 +2154,444 @@ void Renderer::renderStaticModel(
 	_outlinesBoxShader.uploadUniform("mvp", _projection * _cameraTransform * modelTransform * transform);
 	_outlinesBoxShader.uploadUniform("color", glm::vec3{ 0.f, 0.f, 1.f });
 
+	if (_gpuPicking)
+	{
+		setPickingOutput(false);
+	}
+
 	glBindVertexArray(_boxVAO);
 
 	glDrawArrays(GL_LINES, 0, 24);
 	glBindVertexArray(0);
 
+	addDrawStats(1, 0);
+
+	if (_gpuPicking)
+	{
+		setPickingOutput(true);
+	}
+
 	GLSLShader::use(0);
 }
 
-void Renderer::renderStaticModelPicking(
+void Renderer::renderStaticModelCSM(
 	const StaticModelSceneNode *modelNode)
 {
-	std::string modelTag = modelNode->getModel();
+	glViewport(0, 0, _shadowSize, _shadowSize);
 
-	const Model *model = _assetManager->fetch<Model>(modelTag);
+	Model *model = _assetManager->resolve(modelNode->getModelRef(), modelNode->getModel());
 
-	Frustum frustum{ _projection * _cameraTransform };
+	glm::mat4 mvp =
+		_orthoProjections[_currentCascade] *
+		_lightViewMatrices[_currentCascade] *
+		modelNode->getTransformationMatrix() * model->getCorrectionTransform();
 
-	std::vector<glm::vec3> points = model->getExtents().getPoints();
+	_csmShader.use();
 
-	glm::mat4 modelTransform = modelNode->getTransformationMatrix() * model->getCorrectionTransform();
+	_csmShader.uploadUniform("mvp", mvp);
+
+	for (unsigned int i = 0; i < model->getMeshes().size(); ++i)
+	{
+		renderStaticModelMesh(modelNode, model, i);
+	}
+
+	GLSLShader::use(0);
+}
+
+const std::vector<glm::mat4>& Renderer::getBoneTransforms(
+	const StaticModelSceneNode *modelNode,
+	Model *model)
+{
+	AnimationPoseCache& cache = modelNode->getPoseCache();
 
-	for (auto& it : points)
+	std::string animation = modelNode->getCurrentAnimation();
+
+	bool sameAnimation = cache.valid && cache.model == model && cache.animation == animation;
+
+	// Already resolved this frame by an earlier pass.
+	if (sameAnimation && cache.lastUsed == _frameIndex)
 	{
-		it = modelTransform * glm::vec4{ it, 1.f };
+		return cache.boneTransforms;
 	}
 
-	if (frustum.boxIntersect(points) < 0)
+	cache.lastUsed = _frameIndex;
+
+	// The idle pose is fixed, so it never has to be evaluated again.
+	if (sameAnimation && animation == "idle")
 	{
-		return;
+		++_frameStats.animationIdleCached;
+		return cache.boneTransforms;
 	}
 
-	glm::mat4 mvp = _projection * _cameraTransform * modelNode->getTransformationMatrix() * model->getCorrectionTransform();
+	if (sameAnimation)
+	{
+		glm::vec3 position{ modelNode->getTransformationMatrix()[3] };
+
+		unsigned int interval = modelNode->getAnimationUpdateInterval(glm::distance(position, _cameraPosition));
 
-	_pickingShader.use();
+		if (_frameIndex - cache.frame < interval)
+		{
+			++_frameStats.animationSkipped;
+			return cache.boneTransforms;
+		}
+	}
 
-	_pickingShader.uploadUniform("mvp", mvp);
-	_pickingShader.uploadUniform("objectIndex", static_cast<int>(modelNode->getID()));
+	float time = glfwGetTime();
 
-	for (unsigned int i = 0; i < model->getMeshes().size(); ++i)
+	if (animation == "idle")
 	{
-		_pickingShader.uploadUniform("drawIndex", static_cast<int>(i));
-		model->getMeshes().at(i)->render();
+		time = 1.52;
 	}
 
-	GLSLShader::use(0);
+	model->getBoneTransforms(time, cache.boneTransforms, animation);
+
+	cache.animation = animation;
+	cache.model = model;
+	cache.frame = _frameIndex;
+	cache.valid = true;
+
+	++_frameStats.animationEvaluations;
+
+	return cache.boneTransforms;
 }
 
-void Renderer::renderStaticModelCSM(
-	const StaticModelSceneNode *modelNode)
+AnimationPoseTexture * Renderer::getPoseTexture(
+	const std::string& modelTag)
 {
-	glViewport(0, 0, _shadowSize, _shadowSize);
+	auto it = _poseTextures.find(modelTag);
 
-	std::string modelTag = modelNode->getModel();
+	if (it != _poseTextures.end())
+	{
+		return it->second;
+	}
 
-	Model *model = _assetManager->fetch<Model>(modelTag);
+	// Bake the poses the first time a crowd of this model is drawn.
+	AnimationPoseTexture *poseTexture = new AnimationPoseTexture{ _assetManager->fetch<Model>(modelTag) };
 
-	Frustum frustum{ _projection * _cameraTransform };
+	_poseTextures.emplace(modelTag, poseTexture);
 
-	std::vector<glm::vec3> points = model->getExtents().getPoints();
+	return poseTexture;
+}
 
-	glm::mat4 modelTransform = modelNode->getTransformationMatrix() * model->getCorrectionTransform();
+unsigned int Renderer::uploadCrowdInstances(
+	const CrowdSceneNode *crowdNode,
+	const AnimationPoseTexture *poseTexture)
+{
+	CrowdInstanceBuffer& buffer = _crowdInstanceBuffers[crowdNode->getID()];
+
+	if (buffer.buffer == 0)
+	{
+		glGenBuffers(1, &buffer.buffer);
+	}
+
+	// The other passes and cascades of the frame draw the same instances.
+	if (buffer.frame == _frameIndex)
+	{
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, buffer.buffer);
+
+		return buffer.count;
+	}
+
+	// Matches the std430 layout of CrowdInstance in skinnedinstanced.vert
+	struct GPUCrowdInstance
+	{
+		glm::mat4 model;
+		glm::vec4 animation;
+	};
 
-	for (auto& it : points)
+	unsigned int count = std::min(crowdNode->getInstanceCount(), _maxCrowdInstances);
+
+	if (count < crowdNode->getInstanceCount() && buffer.count != count)
 	{
-		it = modelTransform * glm::vec4{ it, 1.f };
+		std::cerr << "[RENDERER] Crowd " << crowdNode->getTag() << " has "
+			<< crowdNode->getInstanceCount() << " instances, only drawing " << count << std::endl;
 	}
 
-	if (frustum.boxIntersect(points) < 0)
+	std::vector<GPUCrowdInstance> instances;
+	instances.reserve(count);
+
+	for (unsigned int i = 0; i < count; ++i)
+	{
+		const CrowdInstance& it = crowdNode->getInstances()[i];
+
+		GPUCrowdInstance instance;
+
+		instance.model = crowdNode->getTransformationMatrix() * it.transform;
+
+		float timeOffset = it.timeOffset;
+		float playbackRate = it.playbackRate;
+
+		const AnimationPoseTextureClip *clip = &poseTexture->getClips().front();
+
+		// Same fixed pose as the regular skinned path uses for idle.
+		if (it.animation == "idle")
+		{
+			timeOffset = 1.52f;
+			playbackRate = 0.f;
+		}
+		else if (poseTexture->hasClip(it.animation))
+		{
+			clip = &poseTexture->getClip(it.animation);
+		}
+
+		instance.animation = glm::vec4{
+			timeOffset,
+			playbackRate,
+			static_cast<float>(clip->firstFrame),
+			static_cast<float>(clip->frameCount) };
+
+		instances.push_back(instance);
+	}
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer.buffer);
+	glBufferData(
+		GL_SHADER_STORAGE_BUFFER,
+		instances.size() * sizeof(GPUCrowdInstance),
+		instances.data(),
+		GL_STREAM_DRAW);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, buffer.buffer);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	buffer.frame = _frameIndex;
+	buffer.count = count;
+
+	return count;
+}
+
+void Renderer::renderCrowd(
+	const CrowdSceneNode *crowdNode)
+{
+	if (crowdNode->getInstanceCount() == 0)
 	{
 		return;
 	}
 
-	glm::mat4 mvp =
-		_orthoProjections[_currentCascade] *
-		_lightViewMatrices[_currentCascade] *
-		modelNode->getTransformationMatrix() * model->getCorrectionTransform();
+	Model *model = _assetManager->resolve(crowdNode->getModelRef(), crowdNode->getModel());
 
-	if (model->isSkinned())
+	// Poses are baked once per model, so wait until the real model has loaded.
+	if (!_assetManager->isLoaded(crowdNode->getModelRef()))
+	{
+		return;
+	}
+
+	AnimationPoseTexture *poseTexture = getPoseTexture(crowdNode->getModel());
+
+	if (!poseTexture->isValid())
 	{
-		_skinnedCsmShader.use();
+		return;
+	}
+
+	unsigned int instanceCount = uploadCrowdInstances(crowdNode, poseTexture);
+
+	std::string texture = crowdNode->getTexture();
 
-		_skinnedCsmShader.uploadUniform("mvp", mvp);
+	GLSLShaderPermutation permutation = getLightingPermutation(texture.empty() ? 0u : static_cast<uint32_t>(LIGHTING_SHADER_USE_TEXTURE));
 
-		std::vector<glm::mat4> transforms;
+	GLSLShader *currentShader = &_skinnedInstancedShader.getPermutation(permutation);
 
-		// TODO: Move animation time to the model
-		float time = glfwGetTime();
+	currentShader->use();
 
-		if (modelNode->getCurrentAnimation() == "idle")
+	for (unsigned int i = 0; i < _pointLights.size(); ++i)
+	{
+		currentShader->uploadUniform("pointLight[" + std::to_string(i) + "].constant", _pointLights.at(i).first.getConstant());
+		currentShader->uploadUniform("pointLight[" + std::to_string(i) + "].linear", _pointLights.at(i).first.getLinear());
+		currentShader->uploadUniform("pointLight[" + std::to_string(i) + "].quadratic", _pointLights.at(i).first.getQuadratic());
+		currentShader->uploadUniform("pointLight[" + std::to_string(i) + "].ambient", _pointLights.at(i).first.getAmbient());
+		currentShader->uploadUniform("pointLight[" + std::to_string(i) + "].diffuse", _pointLights.at(i).first.getDiffuse());
+		currentShader->uploadUniform("pointLight[" + std::to_string(i) + "].specular", _pointLights.at(i).first.getSpecular());
+		currentShader->uploadUniform("pointLight[" + std::to_string(i) + "].position", _pointLights.at(i).second);
+	}
+
+	for (unsigned int i = 0; i < _directionalLights.size(); ++i)
+	{
+		currentShader->uploadUniform("directionalLight[" + std::to_string(i) + "].ambient", _directionalLights.at(i).first.getAmbient());
+		currentShader->uploadUniform("directionalLight[" + std::to_string(i) + "].diffuse", _directionalLights.at(i).first.getDiffuse());
+		currentShader->uploadUniform("directionalLight[" + std::to_string(i) + "].specular", _directionalLights.at(i).first.getSpecular());
+		currentShader->uploadUniform("directionalLight[" + std::to_string(i) + "].direction", _directionalLights.at(i).first.getDirection());
+
+		// The instances have their own model matrices, so only the light's
+		// view projection is uploaded.
+		for (unsigned int j = 0; j < NUM_CASCADES; ++j)
 		{
-			time = 1.52;
+			glm::mat4 lightVP = _orthoProjections[i * NUM_CASCADES + j] * _lightViewMatrices[i * NUM_CASCADES + j];
+
+			currentShader->uploadUniform("lightVP[" + std::to_string(i * NUM_CASCADES + j) + "]", lightVP);
 		}
+	}
+
+	const unsigned int CSMIndexStart = 4;
+
+	for (unsigned int i = 0; i < NUM_CASCADES * permutation.numDirectionalLights; ++i)
+	{
+		currentShader->uploadUniform("shadowMap[" + std::to_string(i) + "]",
+			static_cast<int>(CSMIndexStart + i));
+
+		glActiveTexture(GL_TEXTURE0 + CSMIndexStart + i);
+		glBindTexture(GL_TEXTURE_2D, _csmTextures[i]);
+	}
+
+	// The pose texture goes right after the shadow maps.
+	const unsigned int poseTextureIndex = CSMIndexStart + NUM_CASCADES * MAX_LIGHTS;
+
+	poseTexture->bind(poseTextureIndex);
+
+	currentShader->uploadUniform("poseTexture", static_cast<int>(poseTextureIndex));
+	currentShader->uploadUniform("sampleRate", poseTexture->getSampleRate());
+	currentShader->uploadUniform("time", static_cast<float>(glfwGetTime()));
+
+	currentShader->uploadUniform("numPointLights", static_cast<int>(_pointLights.size()));
+	currentShader->uploadUniform("numDirectionalLights", static_cast<int>(_directionalLights.size()));
+
+	currentShader->uploadUniform("viewPos", _cameraPosition);
+	currentShader->uploadUniform("celThresholds", _celThresholds);
+	currentShader->uploadUniform("color", _color);
+
+	currentShader->uploadUniform("vp", _projection * _cameraTransform);
+	currentShader->uploadUniform("correction", model->getCorrectionTransform());
+	currentShader->uploadUniform("texUnit", 0);
+	currentShader->uploadUniform("tintColor", glm::vec3{ 1.f, 1.f, 1.f });
+
+	if (_gpuPicking)
+	{
+		currentShader->uploadUniform("objectIndex", static_cast<int>(crowdNode->getID()));
+	}
+
+	for (unsigned int i = 0; i < NUM_CASCADES; ++i)
+	{
+		glm::vec4 cascadeEndVec{ 0.f, 0.f, _cascadeEnds[i + 1], 1.f };
 
-		model->getBoneTransforms(time, transforms, modelNode->getCurrentAnimation());
+		glm::vec4 vClip = _projection * cascadeEndVec;
+
+		currentShader->uploadUniform("CSMEndClipSpace[" + std::to_string(i) + "]", vClip.z);
+	}
+
+	if (!texture.empty())
+	{
+		Texture2D *tex = _assetManager->resolve(crowdNode->getTextureRef(), texture);
+		tex->bind(0);
 
-		_skinnedCsmShader.uploadUniformArray("bones", transforms.size(), transforms);
+		CrowdInstanceBuffer& buffer = _crowdInstanceBuffers[crowdNode->getID()];
 
-		for (unsigned int i = 0; i < model->getMeshes().size(); ++i)
+		if (buffer.streamingFrame != _frameIndex)
 		{
-			model->getMeshes().at(i)->render();
+			buffer.streamingFrame = _frameIndex;
+
+			// The closest instance decides the resolution.
+			float screenSize = 0.f;
+
+			for (unsigned int i = 0; i < instanceCount; ++i)
+			{
+				glm::mat4 instanceTransform = crowdNode->getTransformationMatrix() * crowdNode->getInstances()[i].transform * model->getCorrectionTransform();
+
+				screenSize = std::max(screenSize, getScreenSize(model->getExtents().transform(instanceTransform).getPoints()));
+			}
+
+			_textureStreamer.request(tex, screenSize);
 		}
 	}
-	else
+
+	for (unsigned int i = 0; i < model->getMeshes().size(); ++i)
 	{
-		_csmShader.use();
+		unsigned int materialIndex = model->getMeshes().at(i)->getMaterialIndex();
 
-		_csmShader.uploadUniform("mvp", mvp);
+		Material material = model->getMaterials().at(materialIndex);
 
-		for (unsigned int i = 0; i < model->getMeshes().size(); ++i)
+		currentShader->uploadUniform("material.ambient", material.ambientColor);
+		currentShader->uploadUniform("material.diffuse", material.diffuseColor);
+		currentShader->uploadUniform("material.specular", material.specularColor);
+		currentShader->uploadUniform("material.exponent", material.exponent);
+
+		if (_gpuPicking)
 		{
-			model->getMeshes().at(i)->render();
+			currentShader->uploadUniform("drawIndex", static_cast<int>(i));
 		}
+
+		model->getMeshes().at(i)->renderInstanced(instanceCount);
+
+		addDrawStats(1, model->getMeshes().at(i)->getIndices().size() / 3 * instanceCount);
+	}
+
+	GLSLShader::use(0);
+}
+
+void Renderer::renderCrowdCSM(
+	const CrowdSceneNode *crowdNode)
+{
+	if (crowdNode->getInstanceCount() == 0)
+	{
+		return;
+	}
+
+	Model *model = _assetManager->resolve(crowdNode->getModelRef(), crowdNode->getModel());
+
+	// Poses are baked once per model, so wait until the real model has loaded.
+	if (!_assetManager->isLoaded(crowdNode->getModelRef()))
+	{
+		return;
+	}
+
+	glViewport(0, 0, _shadowSize, _shadowSize);
+
+	AnimationPoseTexture *poseTexture = getPoseTexture(crowdNode->getModel());
+
+	if (!poseTexture->isValid())
+	{
+		return;
+	}
+
+	unsigned int instanceCount = uploadCrowdInstances(crowdNode, poseTexture);
+
+	_skinnedInstancedCsmShader.use();
+
+	poseTexture->bind(0);
+
+	_skinnedInstancedCsmShader.uploadUniform("vp", _orthoProjections[_currentCascade] * _lightViewMatrices[_currentCascade]);
+	_skinnedInstancedCsmShader.uploadUniform("correction", model->getCorrectionTransform());
+	_skinnedInstancedCsmShader.uploadUniform("poseTexture", 0);
+	_skinnedInstancedCsmShader.uploadUniform("sampleRate", poseTexture->getSampleRate());
+	_skinnedInstancedCsmShader.uploadUniform("time", static_cast<float>(glfwGetTime()));
+
+	for (unsigned int i = 0; i < model->getMeshes().size(); ++i)
+	{
+		model->getMeshes().at(i)->renderInstanced(instanceCount);
+
+		addDrawStats(1, model->getMeshes().at(i)->getIndices().size() / 3 * instanceCount);
 	}
 
 	GLSLShader::use(0);
 }
 
+void Renderer::renderStaticModelMesh(
+	const StaticModelSceneNode *modelNode,
+	const Model *model,
+	unsigned int meshIndex)
+{
+	const std::shared_ptr<SkinnedModelInstance>& skinnedInstance = modelNode->getPoseCache().skinnedInstance;
+
+	if (model->isSkinned() && skinnedInstance && skinnedInstance->getModel() == model && skinnedInstance->isReady())
+	{
+		skinnedInstance->render(meshIndex);
+	}
+	else
+	{
+		model->getMeshes().at(meshIndex)->render();
+	}
+
+	addDrawStats(1, model->getMeshes().at(meshIndex)->getIndices().size() / 3);
+}
+
+void Renderer::addDrawStats(
+	unsigned int drawCalls,
+	size_t triangles)
+{
+	_frameStats.drawCalls += drawCalls;
+	_frameStats.triangles += static_cast<unsigned int>(triangles);
+}
+
 void Renderer::renderStaticModelGodrayOcclusion(
 	const StaticModelSceneNode *modelNode)
 {
-	std::string modelTag = modelNode->getModel();
-
-	const Model *model = _assetManager->fetch<Model>(modelTag);
+	const Model *model = _assetManager->resolve(modelNode->getModelRef(), modelNode->getModel());
 
 	const glm::mat4 mvp = _projection * _cameraTransform * modelNode->getTransformationMatrix() * model->getCorrectionTransform();
 
@@ -1699,7 +2602,7 @@ void Renderer::renderStaticModelGodrayOcclusion(
 
 	for (unsigned int i = 0; i < model->getMeshes().size(); ++i)
 	{
-		model->getMeshes().at(i)->render();
+		renderStaticModelMesh(modelNode, model, i);
 	}
 
 	GLSLShader::use(0);
@@ -1734,6 +2637,8 @@ void Renderer::renderDirectionalLightGodrayOcclusion(
 	for (unsigned int i = 0; i < _sphereModel.getMeshes().size(); ++i)
 	{
 		_sphereModel.getMeshes().at(i)->render();
+
+		addDrawStats(1, _sphereModel.getMeshes().at(i)->getIndices().size() / 3);
 	}
 
 	glEnable(GL_DEPTH_TEST);
@@ -1746,11 +2651,22 @@ void Renderer::renderTerrain(
 {
 	glm::mat4 modelMatrix = terrainNode->getTransformationMatrix();
 
-	Terrain *terrain = _assetManager->fetch<Terrain>(terrainNode->getTerrain());
+	Terrain *terrain = _assetManager->resolve(terrainNode->getTerrainRef(), terrainNode->getTerrain());
 
 	const glm::mat4 mvp = _projection * _cameraTransform * modelMatrix;
 
-	_shader.use();
+	GLSLShaderPermutation permutation = getLightingPermutation(LIGHTING_SHADER_TERRAIN);
+
+	GLSLShader *currentShader = &_shader.getPermutation(permutation);
+
+	currentShader->use();
+
+	if (_gpuPicking)
+	{
+		currentShader->uploadUniform("objectIndex", static_cast<int>(terrainNode->getID()));
+	}
+
+	unsigned int chunkIndex = 0;
 
 	for (auto it : terrain->getChunks())
 	{
@@ -1758,50 +2674,49 @@ void Renderer::renderTerrain(
 
 		for (unsigned int i = 0; i < _pointLights.size(); ++i)
 		{
-			_shader.uploadUniform("pointLight[" + std::to_string(i) + "].constant", _pointLights.at(i).first.getConstant());
-			_shader.uploadUniform("pointLight[" + std::to_string(i) + "].linear", _pointLights.at(i).first.getLinear());
-			_shader.uploadUniform("pointLight[" + std::to_string(i) + "].quadratic", _pointLights.at(i).first.getQuadratic());
-			_shader.uploadUniform("pointLight[" + std::to_string(i) + "].ambient", _pointLights.at(i).first.getAmbient());
-			_shader.uploadUniform("pointLight[" + std::to_string(i) + "].diffuse", _pointLights.at(i).first.getDiffuse());
-			_shader.uploadUniform("pointLight[" + std::to_string(i) + "].specular", _pointLights.at(i).first.getSpecular());
-			_shader.uploadUniform("pointLight[" + std::to_string(i) + "].position", _pointLights.at(i).second);
+			currentShader->uploadUniform("pointLight[" + std::to_string(i) + "].constant", _pointLights.at(i).first.getConstant());
+			currentShader->uploadUniform("pointLight[" + std::to_string(i) + "].linear", _pointLights.at(i).first.getLinear());
+			currentShader->uploadUniform("pointLight[" + std::to_string(i) + "].quadratic", _pointLights.at(i).first.getQuadratic());
+			currentShader->uploadUniform("pointLight[" + std::to_string(i) + "].ambient", _pointLights.at(i).first.getAmbient());
+			currentShader->uploadUniform("pointLight[" + std::to_string(i) + "].diffuse", _pointLights.at(i).first.getDiffuse());
+			currentShader->uploadUniform("pointLight[" + std::to_string(i) + "].specular", _pointLights.at(i).first.getSpecular());
+			currentShader->uploadUniform("pointLight[" + std::to_string(i) + "].position", _pointLights.at(i).second);
 		}
 
 		for (unsigned int i = 0; i < _directionalLights.size(); ++i)
 		{
-			_shader.uploadUniform("directionalLight[" + std::to_string(i) + "].ambient", _directionalLights.at(i).first.getAmbient());
-			_shader.uploadUniform("directionalLight[" + std::to_string(i) + "].diffuse", _directionalLights.at(i).first.getDiffuse());
-			_shader.uploadUniform("directionalLight[" + std::to_string(i) + "].specular", _directionalLights.at(i).first.getSpecular());
-			_shader.uploadUniform("directionalLight[" + std::to_string(i) + "].direction", _directionalLights.at(i).first.getDirection());
+			currentShader->uploadUniform("directionalLight[" + std::to_string(i) + "].ambient", _directionalLights.at(i).first.getAmbient());
+			currentShader->uploadUniform("directionalLight[" + std::to_string(i) + "].diffuse", _directionalLights.at(i).first.getDiffuse());
+			currentShader->uploadUniform("directionalLight[" + std::to_string(i) + "].specular", _directionalLights.at(i).first.getSpecular());
+			currentShader->uploadUniform("directionalLight[" + std::to_string(i) + "].direction", _directionalLights.at(i).first.getDirection());
 
 			for (unsigned int j = 0; j < NUM_CASCADES; ++j)
 			{
 				glm::mat4 lightMVP = _orthoProjections[i * NUM_CASCADES + j] * _lightViewMatrices[i * NUM_CASCADES + j] * modelMatrix * chunkOffset;
 
-				_shader.uploadUniform("lightMVP[" + std::to_string(i * NUM_CASCADES + j) + "]", lightMVP);
+				currentShader->uploadUniform("lightMVP[" + std::to_string(i * NUM_CASCADES + j) + "]", lightMVP);
 			}
 		}
 
 		const unsigned int CSMIndexStart = 4;
 
-		for (unsigned int i = 0; i < NUM_CASCADES * MAX_LIGHTS; ++i)
+		for (unsigned int i = 0; i < NUM_CASCADES * permutation.numDirectionalLights; ++i)
 		{
-			_shader.uploadUniform("shadowMap[" + std::to_string(i) + "]",
+			currentShader->uploadUniform("shadowMap[" + std::to_string(i) + "]",
 				static_cast<int>(CSMIndexStart + i));
 
 			glActiveTexture(GL_TEXTURE0 + CSMIndexStart + i);
 			glBindTexture(GL_TEXTURE_2D, _csmTextures[i]);
 		}
 
-		_shader.uploadUniform("numPointLights", static_cast<int>(_pointLights.size()));
-		_shader.uploadUniform("numDirectionalLights", static_cast<int>(_directionalLights.size()));
-		_shader.uploadUniform("viewPos", _cameraPosition);
-		_shader.uploadUniform("celThresholds", _celThresholds);
-		_shader.uploadUniform("color", _color);
+		currentShader->uploadUniform("numPointLights", static_cast<int>(_pointLights.size()));
+		currentShader->uploadUniform("numDirectionalLights", static_cast<int>(_directionalLights.size()));
+		currentShader->uploadUniform("viewPos", _cameraPosition);
+		currentShader->uploadUniform("celThresholds", _celThresholds);
+		currentShader->uploadUniform("color", _color);
 
-		_shader.uploadUniform("mvp", mvp * chunkOffset);
-		_shader.uploadUniform("model", modelMatrix * chunkOffset);
-		_shader.uploadUniform("snow", _snow);
+		currentShader->uploadUniform("mvp", mvp * chunkOffset);
+		currentShader->uploadUniform("model", modelMatrix * chunkOffset);
 
 		for (unsigned int i = 0; i < NUM_CASCADES; ++i)
 		{
@@ -1809,11 +2724,9 @@ void Renderer::renderTerrain(
 
 			glm::vec4 vClip = _projection * cascadeEndVec;
 
-			_shader.uploadUniform("CSMEndClipSpace[" + std::to_string(i) + "]", vClip.z);
+			currentShader->uploadUniform("CSMEndClipSpace[" + std::to_string(i) + "]", vClip.z);
 		}
 
-		_shader.uploadUniform("useTexture", 0);
-
 		Material material;
 
 		material.ambientColor = glm::vec3{ 0.2f, 0.2f, 0.2f };
@@ -1822,19 +2735,32 @@ void Renderer::renderTerrain(
 
 		material.exponent = 4;
 
-		_shader.uploadUniform("material.ambient", material.ambientColor);
-		_shader.uploadUniform("material.diffuse", material.diffuseColor);
-		_shader.uploadUniform("material.specular", material.specularColor);
-
-		_shader.uploadUniform("material.exponent", material.exponent);
+		currentShader->uploadUniform("material.ambient", material.ambientColor);
+		currentShader->uploadUniform("material.diffuse", material.diffuseColor);
+		currentShader->uploadUniform("material.specular", material.specularColor);
 
-		_shader.uploadUniform("terrain", true);
+		currentShader->uploadUniform("material.exponent", material.exponent);
 
 		Frustum frustum{ _projection * _cameraTransform };
 
-		_shader.uploadUniform("divisor", it->getDivisor());
+		currentShader->uploadUniform("divisor", it->getDivisor());
+
+		if (_gpuPicking)
+		{
+			currentShader->uploadUniform("drawIndex", static_cast<int>(chunkIndex));
+		}
+
+		++chunkIndex;
 
 		it->render(frustum);
+
+		addDrawStats(it->getNumDrawCalls(), it->getNumTrianglesDrawn());
+	}
+
+	// Normals and grass keep the IDs of the terrain below them.
+	if (_gpuPicking)
+	{
+		setPickingOutput(false);
 	}
 
 	if (_drawNormals)
@@ -1852,6 +2778,8 @@ void Renderer::renderTerrain(
 			Frustum frustum{ _projection * _cameraTransform };
 
 			it->render(frustum);
+
+			addDrawStats(it->getNumDrawCalls(), it->getNumTrianglesDrawn());
 		}
 	}
 
@@ -1885,11 +2813,18 @@ void Renderer::renderTerrain(
 			Frustum frustum{ _projection * _cameraTransform };
 
 			it->render(frustum);
+
+			addDrawStats(it->getNumDrawCalls(), it->getNumTrianglesDrawn());
 		}
 
 		//glEnable(GL_CULL_FACE);
 	}
 
+	if (_gpuPicking)
+	{
+		setPickingOutput(true);
+	}
+
 	GLSLShader::use(0);
 }
 
@@ -1898,7 +2833,7 @@ void Renderer::renderTerrainCSM(
 {
 	glViewport(0, 0, _shadowSize, _shadowSize);
 
-	Terrain *terrain = _assetManager->fetch<Terrain>(terrainNode->getTerrain());
+	Terrain *terrain = _assetManager->resolve(terrainNode->getTerrainRef(), terrainNode->getTerrain());
 
 	_csmShader.use();
 
@@ -1917,34 +2852,78 @@ void Renderer::renderTerrainCSM(
 		_csmShader.uploadUniform("mvp", mvp);
 
 		it->render(frustum);
+
+		addDrawStats(it->getNumDrawCalls(), it->getNumTrianglesDrawn());
 	}
 }
 
-void Renderer::renderTerrainPicking(
-	const TerrainSceneNode *modelNode)
+TextureStreamer & Renderer::getTextureStreamer()
 {
-	std::string terrainTag = modelNode->getTerrain();
+	return _textureStreamer;
+}
 
-	const Terrain *terrain = _assetManager->fetch<Terrain>(terrainTag);
+Profiler & Renderer::getProfiler()
+{
+	return _profiler;
+}
 
-	glm::mat4 mvp = _projection * _cameraTransform * modelNode->getTransformationMatrix();
+GLSLShaderPermutation Renderer::getLightingPermutation(
+	uint32_t features) const
+{
+	GLSLShaderPermutation permutation;
 
-	_pickingShader.use();
+	permutation.features = features;
 
-	_pickingShader.uploadUniform("mvp", mvp);
+	if (_snow)
+	{
+		permutation.features |= LIGHTING_SHADER_SNOW;
+	}
 
-	_pickingShader.uploadUniform("objectIndex", static_cast<int>(modelNode->getID()));
+	if (_gpuPicking)
+	{
+		permutation.features |= LIGHTING_SHADER_PICKING;
+	}
 
-	unsigned int index = 0;
+	permutation.numPointLights = static_cast<uint8_t>(std::min<size_t>(_pointLights.size(), MAX_LIGHTS));
+	permutation.numDirectionalLights = static_cast<uint8_t>(std::min<size_t>(_directionalLights.size(), MAX_LIGHTS));
 
-	Frustum frustum{ _projection * _cameraTransform };
+	return permutation;
+}
 
-	for (auto it : terrain->getChunks())
+float Renderer::getScreenSize(
+	const std::vector<glm::vec3> &points) const
+{
+	glm::vec3 center{ 0.f };
+
+	for (const auto& it : points)
 	{
-		_pickingShader.uploadUniform("drawIndex", static_cast<int>(index++));
+		center += it;
+	}
 
-		it->render(frustum);
+	center /= static_cast<float>(points.size());
+
+	float radius = 0.f;
+
+	for (const auto& it : points)
+	{
+		radius = std::max(radius, glm::length(it - center));
 	}
 
-	GLSLShader::use(0);
+	return getScreenSize(center, radius);
+}
+
+float Renderer::getScreenSize(
+	const glm::vec3 &center,
+	float radius) const
+{
+	float distance = glm::length(center - _cameraPosition);
+
+	// Close enough to fill the screen.
+	if (distance <= radius)
+	{
+		return static_cast<float>(std::max(_windowWidth, _windowHeight));
+	}
+
+	// The projection scales the height of the view to two units.
+	return radius / distance * _projection[1][1] * _windowHeight;
 }
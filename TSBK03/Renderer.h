@@ -4,6 +4,7 @@
 #include "PointLight.h"
 #include "DirectionalLight.h"
 #include "RendererPickingInfo.h"
+#include "RendererFrameStats.h"
 
 #include "GLSLShader.h"
 #include "StaticModelSceneNode.h"
@@ -13,10 +14,38 @@
 #include "Skybox.h"
 #include "DirectionalLightSceneNode.h"
 #include "TerrainSceneNode.h"
+#include "CrowdSceneNode.h"
+#include "AnimationPoseTexture.h"
+#include "TextureStreamer.h"
+#include "RenderProxies.h"
+#include "Profiler.h"
+
+#include <functional>
 
 #define MAX_LIGHTS 8
 #define NUM_CASCADES 3
 
+// Pixel pack buffers the picking results are read back through, and the
+// most pixels read back in one frame.
+#define NUM_PICKING_READBACKS 3
+#define MAX_PICKING_REQUESTS 16
+
+// Most frames the CPU may queue before waiting for the GPU, the size of the
+// ring of frame timings.
+#define MAX_FRAMES_IN_FLIGHT 4
+
+// Permutation features of the lighting shaders, in the order given to
+// GLSLShader::setPermutationFeatures.
+enum LIGHTING_SHADER_FEATURES : uint32_t
+{
+	LIGHTING_SHADER_USE_TEXTURE = 1 << 0,
+	LIGHTING_SHADER_TERRAIN = 1 << 1,
+	LIGHTING_SHADER_SNOW = 1 << 2,
+
+	// Also writes the object IDs into the third color attachment.
+	LIGHTING_SHADER_PICKING = 1 << 3
+};
+
 class Model;
 
 // TODO: It might be possible to cache some of the models and textures
@@ -44,8 +73,17 @@ public:
 	const glm::vec3& getCameraPosition() const;
 	const glm::vec3& getCameraDirection() const;
 
+	// GPU time of the latest frame the GPU has finished, which is usually
+	// two or three frames behind the one being rendered.
 	float getLastGPURenderTime() const;
 
+	// Frames the CPU may queue before render waits for the oldest one to
+	// finish on the GPU, between one and MAX_FRAMES_IN_FLIGHT.
+	void setMaxFramesInFlight(unsigned int maxFramesInFlight);
+	unsigned int getMaxFramesInFlight() const;
+
+	const RendererFrameStats& getFrameStats() const;
+
 	glm::vec3 _celThresholds{ 0.1f, 0.3f, 0.6f };
 
 	glm::vec4 _color{ 1.f, 1.f, 1.f, 1.f };
@@ -67,8 +105,31 @@ public:
 	void setExposure(float exposure);
 	void setGamma(float gamma);
 
+	// Finds the object under a pixel of the last frame. A ray is cast on the
+	// CPU through the bounding volume hierarchy against the triangles of
+	// static models, the bone capsules of skinned models and the terrain.
 	RendererPickingInfo getPickingInfo(int x, int y);
 
+	// Calls the callback with the object under a pixel. Without GPU picking
+	// the ray is cast and the callback called right away. With GPU picking
+	// the pixel is read from the object IDs of the next frame and the
+	// callback is called from render once it has been read back, usually one
+	// or two frames later.
+	void requestPicking(
+		int x,
+		int y,
+		const std::function<void(const RendererPickingInfo&)>& callback);
+
+	// Drops the requests that have not been answered without calling their
+	// callbacks, for when the owners of the callbacks go away.
+	void clearPickingRequests();
+
+	bool getGPUPicking() const;
+
+	// Answers picking requests by writing the object IDs to an extra color
+	// attachment in the color pass instead of casting rays.
+	void setGPUPicking(bool gpuPicking);
+
 	bool getFXAA() const;
 	bool getShowEdges() const;
 
@@ -110,21 +171,67 @@ public:
 
 	bool getDrawNormals() const;
 	void setDrawNormals(bool value);
+
+	TextureStreamer& getTextureStreamer();
+
+	// Frames are begun and ended by the application, render adds a scope
+	// for each pass.
+	Profiler& getProfiler();
 private:
 
-	void extractLights(
-		const SceneNode *node);
+	// The variant of a lighting shader for the current lights and the
+	// features of the object.
+	GLSLShaderPermutation getLightingPermutation(
+		uint32_t features) const;
 
 	void renderSkybox();
 
-	void doGodrayOcclusionRenderingPass(
-		const SceneNode *scene);
+	void doGodrayOcclusionRenderingPass();
+
+	void doColorRenderingPass();
+
+	// Starts reading back the object IDs of the pending picking requests
+	// from the color pass.
+	void readPickingRequests();
 
-	void doColorRenderingPass(
-		const SceneNode *scene);
+	// Selects whether draws in the color pass write the object IDs. Shaders
+	// without the picking permutation must not draw with it enabled.
+	void setPickingOutput(bool enabled);
 
-	void doPickingRenderPass(
-		const SceneNode *scene);
+	// Calls the callbacks of the picking readbacks the GPU has finished.
+	void finishPickingReadbacks();
+
+	// Reads the timings of the frames the GPU has finished, oldest first.
+	// With wait set, blocks until the oldest frame in flight has finished.
+	void finishFrameTimings(bool wait);
+
+	void doSkinningPass();
+
+	RendererPickingInfo pickWithRay(int x, int y);
+
+	// Test the ray in world space and keep the hit if it is closer than
+	// distance, which is in multiples of the direction.
+	void pickStaticModel(
+		const StaticModelSceneNode *modelNode,
+		const glm::vec3& origin,
+		const glm::vec3& direction,
+		float& distance,
+		RendererPickingInfo& info);
+
+	void pickTerrain(
+		const TerrainSceneNode *terrainNode,
+		const glm::vec3& origin,
+		const glm::vec3& direction,
+		float& distance,
+		RendererPickingInfo& info);
+
+	// Refits the bounding volume hierarchy to the static models that moved
+	// and collects the ones visible to the camera. All passes draw the
+	// models visible to the camera.
+	void cullStaticModels();
+
+	void skinStaticModel(
+		const StaticModelSceneNode *modelNode);
 
 	void doBloomBlurRenderingPass();
 
@@ -142,35 +249,63 @@ private:
 	void renderTerrainCSM(
 		const TerrainSceneNode * terrainNode);
 
-	void renderTerrainPicking(
-		const TerrainSceneNode *modelNode);
-
 	void renderScene(
-		const SceneNode *node,
 		int pass);
 
 	void renderStaticModel(
-		const StaticModelSceneNode *modelNode);
-
-	void renderStaticModelPicking(
-		const StaticModelSceneNode *modelNode);
+		const StaticModelSceneNode *modelNode,
+		float screenSize);
 
 	void renderStaticModelCSM(
 		const StaticModelSceneNode * modelNode);
 
+	void renderStaticModelMesh(
+		const StaticModelSceneNode *modelNode,
+		const Model *model,
+		unsigned int meshIndex);
+
+	// Adds to the draw calls and triangles of the frame stats.
+	void addDrawStats(
+		unsigned int drawCalls,
+		size_t triangles);
+
+	const std::vector<glm::mat4>& getBoneTransforms(
+		const StaticModelSceneNode *modelNode,
+		Model *model);
+
+	void renderCrowd(
+		const CrowdSceneNode *crowdNode);
+
+	void renderCrowdCSM(
+		const CrowdSceneNode *crowdNode);
+
+	// Uploads the instances of the crowd the first time it is drawn in a
+	// frame and binds them. Returns the number of instances to draw.
+	unsigned int uploadCrowdInstances(
+		const CrowdSceneNode *crowdNode,
+		const AnimationPoseTexture *poseTexture);
+
+	AnimationPoseTexture *getPoseTexture(
+		const std::string& modelTag);
+
+	// Approximate diameter in pixels of the box given by its world space
+	// corners, used to decide how many mips a texture needs.
+	float getScreenSize(const std::vector<glm::vec3>& points) const;
+	float getScreenSize(const glm::vec3& center, float radius) const;
+
 	GLSLShader _shader{};
-	GLSLShader _skinnedShader{};
 	GLSLShader _blurShader{};
 	GLSLShader _hdrShader{};
-	GLSLShader _pickingShader{};
 	GLSLShader _skyboxShader{};
 	GLSLShader _outlinesBoxShader{};
 	GLSLShader _csmShader{};
-	GLSLShader _skinnedCsmShader{};
 	GLSLShader _godrayOcclusionShader{};
 	GLSLShader _waterShader{};
 	GLSLShader _normalShader{};
 	GLSLShader _grassShader{};
+	GLSLShader _skinnedInstancedShader{};
+	GLSLShader _skinnedInstancedCsmShader{};
+	GLSLShader _skinningShader{};
 
 	bool _drawNormals = false;
 
@@ -180,16 +315,50 @@ private:
 
 	glm::mat4 _projection{};
 
-	GLuint _queryID[2];
+	struct FrameTiming
+	{
+		// Timestamps at the start and end of the frame.
+		GLuint queries[2]{ 0, 0 };
+
+		// Set while the frame is in flight.
+		GLsync fence{ nullptr };
+	};
+
+	// Indexed by the frame index modulo MAX_FRAMES_IN_FLIGHT.
+	FrameTiming _frameTimings[MAX_FRAMES_IN_FLIGHT];
+
+	// The oldest frame that may still be in flight.
+	unsigned long long _oldestFrameInFlight{ 1 };
+
+	unsigned int _maxFramesInFlight{ 2 };
 
 	float _lastRenderTime{ 0.f };
 
+	unsigned long long _frameIndex{ 0 };
+
+	RendererFrameStats _frameStats{};
+
+	TextureStreamer _textureStreamer{};
+
+	Profiler _profiler{};
+
+	// Time per frame for uploading streamed mips.
+	float _textureStreamingBudgetMs{ 1.f };
+
 	glm::vec3 _cameraPosition{};
 	glm::vec3 _cameraDirection{};
 
-	std::vector<std::pair<PointLight, glm::vec3>> _pointLights;
+	// The nodes and lights of the scene being rendered.
+	RenderProxies _proxies{};
+
+	// Indices of the static models visible to the camera and their culling
+	// results, in the order of the hierarchy.
+	std::vector<uint32_t> _visibleStaticModels{};
+	std::vector<int8_t> _visibleStaticModelResults{};
 
-	std::vector<std::pair<DirectionalLight, glm::vec3>> _directionalLights;
+	const std::vector<std::pair<PointLight, glm::vec3>>& _pointLights = _proxies.getPointLights();
+
+	const std::vector<std::pair<DirectionalLight, glm::vec3>>& _directionalLights = _proxies.getDirectionalLights();
 
 	int _windowWidth;
 	int _windowHeight;
@@ -211,12 +380,62 @@ private:
 	float _exposure{ 1.f };
 	float _gamma{ 1.f };
 
-	GLuint _pickingFBO{ 0 };
-	GLuint _pickingTexture{ 0 };
-	GLuint _pickingDepth{ 0 };
+	bool _gpuPicking{ false };
+
+	struct PickingRequest
+	{
+		int x{ 0 };
+		int y{ 0 };
+
+		std::function<void(const RendererPickingInfo&)> callback{};
+	};
+
+	struct PickingReadback
+	{
+		GLuint buffer{ 0 };
+
+		// Set while the pixels are being read back.
+		GLsync fence{ nullptr };
+
+		// The requests answered by the pixels, in buffer order.
+		std::vector<PickingRequest> requests{};
+	};
+
+	std::vector<PickingRequest> _pickingRequests{};
+
+	PickingReadback _pickingReadbacks[NUM_PICKING_READBACKS];
+
+	std::vector<std::pair<float, uint32_t>> _pickingHits{};
+
+	// Object IDs written by the color pass, only allocated with GPU picking.
+	GLuint _pickingIDBuffer{ 0 };
 
 	AssetManager *_assetManager{ nullptr };
 
+	// Crowds
+	std::map<std::string, AnimationPoseTexture *> _poseTextures{};
+
+	struct CrowdInstanceBuffer
+	{
+		GLuint buffer{ 0 };
+
+		// Frame the instances were uploaded in, shared by every pass and
+		// cascade of that frame.
+		unsigned long long frame{ 0 };
+
+		unsigned int count{ 0 };
+
+		// Frame the texture of the crowd was requested from the streamer in.
+		// Only the main pass requests it, once per frame.
+		unsigned long long streamingFrame{ 0 };
+	};
+
+	// By crowd node ID. Released when the crowd is not drawn for a frame.
+	std::map<unsigned int, CrowdInstanceBuffer> _crowdInstanceBuffers{};
+
+	// Instances that fit in a shader storage block.
+	unsigned int _maxCrowdInstances{ 0 };
+
 	// FXAA
 	bool _fxaa = true;
 	bool _showEdges = false;
@@ -244,8 +463,7 @@ private:
 	void calculateOrthoProjections(
 		int lightIndex);
 
-	void doCSMShadowPass(
-		Scene * scene);
+	void doCSMShadowPass();
 
 	bool _enableGodrays{false};
 	unsigned int _godrayOcclusionSize{ 1024 };
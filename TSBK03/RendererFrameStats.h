@@ -0,0 +1,31 @@
+#pragma once
+
+// Counters collected by the renderer during a single frame.
+struct RendererFrameStats
+{
+	// Skinned poses evaluated on the CPU.
+	unsigned int animationEvaluations{ 0 };
+
+	// Poses held from an earlier frame because of the animation LOD.
+	unsigned int animationSkipped{ 0 };
+
+	// Idle poses that were served from the cache.
+	unsigned int animationIdleCached{ 0 };
+
+	// Models run through the skinning compute shader.
+	unsigned int skinnedModels{ 0 };
+
+	// Scene changes applied to the render proxies.
+	unsigned int sceneChanges{ 0 };
+
+	// Static models refit in the bounding volume hierarchy.
+	unsigned int movedStaticModels{ 0 };
+
+	// Static models that passed frustum culling.
+	unsigned int visibleStaticModels{ 0 };
+
+	// Over all passes, including shadows and post-processing. Tessellated
+	// patches count as their input triangles.
+	unsigned int drawCalls{ 0 };
+	unsigned int triangles{ 0 };
+};
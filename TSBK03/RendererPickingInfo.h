@@ -1,8 +1,19 @@
 #pragma once
 
+#include <cstdint>
+
+// The object under a pixel. The fields are laid out like the red, green and
+// blue channels of the object ID buffer, so that pixels read back from it
+// can be copied straight into this struct.
 struct RendererPickingInfo
 {
-	float objectID{ 0.f };
-	float drawID{ 0.f };
-	float primID{ 0.f };
+	// ID of the scene node, zero if nothing was hit.
+	uint32_t objectID{ 0 };
+
+	// Mesh of a model or chunk of a terrain.
+	uint32_t drawID{ 0 };
+
+	// Triangle of the mesh counted from zero, or the bone of a skinned model
+	// picked on the CPU. The same for CPU and GPU picking.
+	uint32_t primID{ 0 };
 };
\ No newline at end of file
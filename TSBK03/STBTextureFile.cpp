@@ -1,23 +1,83 @@
 #include "STBTextureFile.h"
+#include "AssetFileSystem.h"
+#include "ImageKernels.h"
 
 #include <vector>
+#include <stdexcept>
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
 STBTextureFile::STBTextureFile(
-	const std::string &filePath)
+	const std::string &filePath,
+	bool decodePixels)
+	: _filePath{ filePath }
 {
-	// 
-	stbi_set_flip_vertically_on_load(1);
+	// Throws if the file could not be opened.
+	_file = AssetFileSystem::open(filePath);
 
-	unsigned char *data = stbi_load(filePath.c_str(), &_width, &_height, &_numChannels, 0);
+	int fileChannels;
 
-	_data.resize(_width * _height * _numChannels);
+	if (!stbi_info_from_memory(
+		_file.getData(),
+		static_cast<int>(_file.getSize()),
+		&_width,
+		&_height,
+		&fileChannels))
+	{
+		throw std::invalid_argument(std::string("File (") + filePath + ") could not be decoded: " + stbi_failure_reason());
+	}
 
-	memcpy(&_data[0], data, _width * _height * _numChannels);
+	// Grey images are expanded, the textures are always RGB or RGBA.
+	_numChannels = (fileChannels == 2 || fileChannels == 4) ? 4 : 3;
+
+	if (decodePixels)
+	{
+		_data.resize(getPixelsSize());
+		decode(_data.data());
+	}
+}
+
+void STBTextureFile::decode(
+	unsigned char *destination,
+	bool premultiplyAlpha)
+{
+	if (!_file.isOpen())
+	{
+		throw std::logic_error(std::string("The pixels of file (") + _filePath + ") are already decoded.");
+	}
+
+	int width, height, fileChannels;
+
+	// stb_image allocates the pixels itself. Flipping them while copying them
+	// into the destination is free, unlike stbi_set_flip_vertically_on_load
+	// which flips in a separate pass and is not thread safe.
+	unsigned char *data = stbi_load_from_memory(
+		_file.getData(),
+		static_cast<int>(_file.getSize()),
+		&width,
+		&height,
+		&fileChannels,
+		_numChannels);
+
+	if (data == nullptr)
+	{
+		throw std::invalid_argument(std::string("File (") + _filePath + ") could not be decoded: " + stbi_failure_reason());
+	}
+
+	unsigned int flags = IMAGE_CONVERT_FLIP_VERTICALLY;
+
+	if (premultiplyAlpha)
+	{
+		flags |= IMAGE_CONVERT_PREMULTIPLY_ALPHA;
+	}
+
+	convertRows(destination, data, _width, _height, _numChannels, static_cast<size_t>(_width) * _numChannels, flags);
 
 	stbi_image_free(data);
+
+	// Release the file.
+	_file = AssetStream{};
 }
 
 STBTextureFile::~STBTextureFile()
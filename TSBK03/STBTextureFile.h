@@ -1,11 +1,16 @@
 #pragma once
 
 #include "TextureFile.h"
+#include "AssetStream.h"
+
+#include <string>
 
 class STBTextureFile : public TextureFile
 {
 public:
-	STBTextureFile(const std::string& filePath);
+	// With decodePixels false only the header is read, and the pixels are
+	// decoded later with decode.
+	STBTextureFile(const std::string& filePath, bool decodePixels = true);
 	~STBTextureFile() override;
 public:
 	const std::vector<unsigned char> & getPixels() const override;
@@ -16,9 +21,16 @@ public:
 
 	bool hasAlpha() const override;
 
+	void decode(unsigned char *destination, bool premultiplyAlpha = false) override;
+
 	int _width;
 	int _height;
 	int _numChannels;
 
 	std::vector<unsigned char> _data;
+
+private:
+
+	AssetStream _file;
+	std::string _filePath;
 };
\ No newline at end of file
@@ -17,6 +17,11 @@ SceneNode::SceneNode(
 
 SceneNode::~SceneNode()
 {
+	if (_listener != nullptr)
+	{
+		_listener->onSceneNodeRemoved(this);
+	}
+
 	while (!_children.empty())
 	{
 		SceneNode *it = _children.back();
@@ -42,6 +47,11 @@ void SceneNode::setPosition(
 	const glm::vec3 &newPos)
 {
 	_position = newPos;
+	_localTransformDirty = true;
+
+	markTransformDirty();
+
+	notifyChanged(SceneNodeChange::TRANSFORM);
 }
 
 glm::vec3 SceneNode::getRotation() const
@@ -53,6 +63,11 @@ void SceneNode::setRotation(
 	const glm::vec3 &newRotation)
 {
 	_rotation = newRotation;
+	_localTransformDirty = true;
+
+	markTransformDirty();
+
+	notifyChanged(SceneNodeChange::TRANSFORM);
 }
 
 glm::vec3 SceneNode::getScale() const
@@ -64,26 +79,66 @@ void SceneNode::setScale(
 	const glm::vec3 &newScale)
 {
 	_scale = newScale;
+	_localTransformDirty = true;
+
+	markTransformDirty();
+
+	notifyChanged(SceneNodeChange::TRANSFORM);
 }
 
-glm::mat4 SceneNode::getLocalTransformationMatrix() const
+const glm::mat4 & SceneNode::getLocalTransformationMatrix() const
 {
-	glm::mat4 result{ 1.f };
+	if (_localTransformDirty)
+	{
+		glm::mat4 result{ 1.f };
+
+		result = glm::translate(result, _position);
+
+		result = glm::rotate(result, glm::radians(_rotation.x), glm::vec3{ 1.f, 0.f, 0.f });
+		result = glm::rotate(result, glm::radians(_rotation.y), glm::vec3{ 0.f, 1.f, 0.f });
+		result = glm::rotate(result, glm::radians(_rotation.z), glm::vec3{ 0.f, 0.f, 1.f });
+
+		result = glm::scale(result, _scale);
+
+		_localTransform = result;
+		_localTransformDirty = false;
+	}
+
+	return _localTransform;
+}
 
-	result = glm::translate(result, _position);
-	
-	result = glm::rotate(result, glm::radians(_rotation.x), glm::vec3{ 1.f, 0.f, 0.f });
-	result = glm::rotate(result, glm::radians(_rotation.y), glm::vec3{ 0.f, 1.f, 0.f });
-	result = glm::rotate(result, glm::radians(_rotation.z), glm::vec3{ 0.f, 0.f, 1.f });
+const glm::mat4 & SceneNode::getTransformationMatrix() const
+{
+	// Nodes read between two updates are computed on demand.
+	if (_worldTransformDirty)
+	{
+		_worldTransform = _parent != nullptr ?
+			getLocalTransformationMatrix() * _parent->getTransformationMatrix() :
+			getLocalTransformationMatrix();
 
-	result = glm::scale(result, _scale);
+		_worldTransformDirty = false;
+	}
 
-	return result;
+	return _worldTransform;
 }
 
-glm::mat4 SceneNode::getTransformationMatrix() const
+void SceneNode::updateTransforms()
 {
-	return getLocalTransformationMatrix() * (_parent != nullptr ? _parent->getTransformationMatrix() : glm::mat4{ 1.f });
+	if (_worldTransformDirty)
+	{
+		// The parent has already been updated.
+		getTransformationMatrix();
+	}
+
+	if (_childTransformDirty)
+	{
+		for (auto it : _children)
+		{
+			it->updateTransforms();
+		}
+
+		_childTransformDirty = false;
+	}
 }
 
 SceneNode * SceneNode::getParent() const
@@ -95,6 +150,10 @@ void SceneNode::setParent(
 	SceneNode *newParent)
 {
 	_parent = newParent;
+
+	markTransformDirty();
+
+	notifyChanged(SceneNodeChange::TRANSFORM);
 }
 
 const std::string & SceneNode::getTag() const
@@ -130,6 +189,7 @@ void SceneNode::addChild(
 
 	_children.push_back(newChild);
 	newChild->setParent(this);
+	newChild->setListener(_listener);
 }
 
 SceneNode * SceneNode::findChildrenByTag(
@@ -198,3 +258,68 @@ void SceneNode::removeAllChilds()
 
 	}
 }
+
+void SceneNode::markTransformDirty()
+{
+	markChildTransformsDirty();
+
+	for (SceneNode *it = _parent; it != nullptr && !it->_childTransformDirty; it = it->_parent)
+	{
+		it->_childTransformDirty = true;
+	}
+}
+
+void SceneNode::markChildTransformsDirty()
+{
+	_worldTransformDirty = true;
+	_childTransformDirty = !_children.empty();
+
+	for (auto it : _children)
+	{
+		// Dirty nodes already have dirty children and were notified when
+		// they became dirty.
+		if (!it->_worldTransformDirty)
+		{
+			it->markChildTransformsDirty();
+			it->notifyChanged(SceneNodeChange::TRANSFORM);
+		}
+	}
+}
+
+SceneNodeListener * SceneNode::getListener() const
+{
+	return _listener;
+}
+
+void SceneNode::setListener(
+	SceneNodeListener *listener)
+{
+	if (_listener != listener)
+	{
+		if (_listener != nullptr)
+		{
+			_listener->onSceneNodeRemoved(this);
+		}
+
+		_listener = listener;
+
+		if (_listener != nullptr)
+		{
+			_listener->onSceneNodeAdded(this);
+		}
+	}
+
+	for (auto it : _children)
+	{
+		it->setListener(listener);
+	}
+}
+
+void SceneNode::notifyChanged(
+	SceneNodeChange change)
+{
+	if (_listener != nullptr)
+	{
+		_listener->onSceneNodeChanged(this, change);
+	}
+}
\ No newline at end of file
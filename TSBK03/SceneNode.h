@@ -9,6 +9,7 @@
 #include <glm/gtc/type_ptr.hpp>
 
 #include "SceneNodeType.h"
+#include "SceneNodeListener.h"
 
 class SceneNode
 {
@@ -35,8 +36,15 @@ public:
 	glm::vec3 getScale() const;
 	void setScale(const glm::vec3& newScale);
 
-	glm::mat4 getLocalTransformationMatrix() const;
-	virtual glm::mat4 getTransformationMatrix() const;
+	// Both matrices are cached and only recomputed after the node or one of
+	// its parents has moved.
+	const glm::mat4& getLocalTransformationMatrix() const;
+	virtual const glm::mat4& getTransformationMatrix() const;
+
+	// Recomputes the world matrices of the nodes that have moved since the
+	// last update, parents before children. Subtrees without moved nodes are
+	// skipped, so this is cheap to call on the root once per frame.
+	void updateTransforms();
 
 	SceneNode *getParent() const;
 	void setParent(SceneNode *newParent);
@@ -58,8 +66,17 @@ public:
 
 	void removeChild(SceneNode *child);
 	void removeAllChilds();
+
+	SceneNodeListener *getListener() const;
+
+	// Sets the listener of the node and all of its children, notifying the
+	// old listener that the nodes were removed and the new one that they
+	// were added.
+	void setListener(SceneNodeListener *listener);
 protected:
 
+	void notifyChanged(SceneNodeChange change);
+
 	SceneNodeType _type{ SceneNodeType::INVALID };
 
 	//============================================================================
@@ -79,7 +96,7 @@ protected:
 
 	SceneNode *_parent{ nullptr };
 
-	// TODO: Spatial Partitioning
+	// The renderable nodes are indexed spatially by RenderProxies.
 	// TODO: Map these elements to the tag to reduce searching time for large scenes.
 	std::vector<SceneNode *> _children{};
 
@@ -91,6 +108,36 @@ protected:
 
 	unsigned int _id{ 0 };
 
+	//============================================================================
+	// Change Notification
+	//============================================================================
+
+	SceneNodeListener *_listener{ nullptr };
+
+private:
+
+	// Marks the world matrix of the node and its children as out of date
+	// and flags the parents so that updateTransforms finds the node.
+	void markTransformDirty();
+
+	void markChildTransformsDirty();
+
+	//============================================================================
+	// Cached Transformation
+	//============================================================================
+
+	mutable glm::mat4 _localTransform{ 1.f };
+	mutable glm::mat4 _worldTransform{ 1.f };
+
+	mutable bool _localTransformDirty{ true };
+
+	// A node is only clean if all of its parents are, so a dirty node always
+	// has dirty children.
+	mutable bool _worldTransformDirty{ true };
+
+	// Set on the parents of dirty nodes.
+	bool _childTransformDirty{ false };
+
 };
 
 using Scene = SceneNode;
\ No newline at end of file
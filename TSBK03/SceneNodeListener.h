@@ -0,0 +1,33 @@
+#pragma once
+
+class SceneNode;
+
+// What changed on a node, passed along with SceneNodeListener::onSceneNodeChanged.
+enum class SceneNodeChange
+{
+	// Sent to the node that moved and to all of its children, since their
+	// world transforms move with it.
+	TRANSFORM,
+	MODEL,
+	TEXTURE,
+	LIGHT,
+	INSTANCES
+};
+
+// Receives the changes of a scene graph, so that state derived from the
+// scene can be kept up to date without walking the graph every frame. The
+// listener of a node is inherited by the children added to it.
+class SceneNodeListener
+{
+public:
+	virtual ~SceneNodeListener() = default;
+
+	// Called once for every node of a subtree attached to the listener.
+	virtual void onSceneNodeAdded(SceneNode *node) = 0;
+
+	// Called once for every node of a subtree detached from the listener or
+	// deleted. The node must not be used after this.
+	virtual void onSceneNodeRemoved(SceneNode *node) = 0;
+
+	virtual void onSceneNodeChanged(SceneNode *node, SceneNodeChange change) = 0;
+};
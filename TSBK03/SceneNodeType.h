@@ -12,6 +12,8 @@ enum class SceneNodeType
 
 	TERRAIN,
 
+	CROWD,
+
 	AUDIO_SOURCE,
 
 	PARTICLE_EMITTER,
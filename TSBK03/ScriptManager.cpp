@@ -47,6 +47,21 @@ ScriptManager::ScriptManager(Game *game)
 		game->getDebugWindow()->addToLog(line);
 	});
 
+	// captureTrace(frames, path) writes the next frames as a Chrome trace.
+	_luaState.set_function("captureTrace", [game](unsigned int numFrames, const std::string& path)
+	{
+		Profiler& profiler = game->getApplication()->getRenderer()->getProfiler();
+
+		if (profiler.startCapture(numFrames, path))
+		{
+			game->getDebugWindow()->addToLog("Capturing " + std::to_string(numFrames) + " frames to " + path);
+		}
+		else
+		{
+			game->getDebugWindow()->addToLog("[error] A capture is already running");
+		}
+	});
+
 	std::cout << "LUA initialized" << std::endl;
 }
 
@@ -161,6 +176,7 @@ void ScriptManager::registerUserTypes()
 		_luaState.new_usertype<T>("Game",
 			API_FUNCTION(getPlayer),
 			API_FUNCTION(spawnEnemy),
+			API_FUNCTION(spawnCrowd),
 			API_FUNCTION(getScriptManager),
 			API_FUNCTION(getApplication),
 			API_FUNCTION(getEnemies),
@@ -0,0 +1,116 @@
+#include "SkinnedModelInstance.h"
+
+#include "Model.h"
+#include "GLSLShader.h"
+
+SkinnedModelInstance::SkinnedModelInstance(
+	const Model *model)
+	: _model{ model }
+{
+	const std::vector<Mesh *>& meshes = model->getMeshes();
+
+	_vaos.reserve(meshes.size());
+	_vbos.reserve(meshes.size());
+
+	for (const Mesh *mesh : meshes)
+	{
+		_vaos.emplace_back();
+		_vbos.emplace_back(VertexBufferObjectTarget::ARRAY_BUFFER);
+
+		VertexArrayObject& vao = _vaos.back();
+		VertexBufferObject& vbo = _vbos.back();
+
+		vao.bind();
+
+		// Same layout as the source mesh, so the static shaders can be used.
+		vbo.storeData(
+			static_cast<unsigned int>(mesh->getVertices().size()) * sizeof(Vertex),
+			nullptr,
+			VertexBufferObjectUsage::DYNAMIC_COPY);
+
+		vbo.setupVertexAttribPointer(0, 3, sizeof(Vertex), offsetof(Vertex, _position));
+		vbo.setupVertexAttribPointer(1, 3, sizeof(Vertex), offsetof(Vertex, _normal));
+		vbo.setupVertexAttribPointer(2, 2, sizeof(Vertex), offsetof(Vertex, _texCoord));
+		vbo.setupVertexAttribPointer(3, 3, sizeof(Vertex), offsetof(Vertex, _tangent));
+		vbo.setupVertexAttribPointer(4, 3, sizeof(Vertex), offsetof(Vertex, _bitangent));
+
+		VertexArrayObject::unbind();
+	}
+
+	glGenBuffers(1, &_boneBuffer);
+}
+
+SkinnedModelInstance::~SkinnedModelInstance()
+{
+	glDeleteBuffers(1, &_boneBuffer);
+}
+
+void SkinnedModelInstance::skin(
+	GLSLShader &skinningShader,
+	const std::vector<glm::mat4> &boneTransforms)
+{
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, _boneBuffer);
+	glBufferData(
+		GL_SHADER_STORAGE_BUFFER,
+		boneTransforms.size() * sizeof(glm::mat4),
+		boneTransforms.data(),
+		GL_STREAM_DRAW);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	skinningShader.use();
+
+	skinningShader.uploadUniform("vertexStride", static_cast<int>(sizeof(Vertex) / sizeof(float)));
+	skinningShader.uploadUniform("positionOffset", static_cast<int>(offsetof(Vertex, _position) / sizeof(float)));
+	skinningShader.uploadUniform("normalOffset", static_cast<int>(offsetof(Vertex, _normal) / sizeof(float)));
+	skinningShader.uploadUniform("tangentOffset", static_cast<int>(offsetof(Vertex, _tangent) / sizeof(float)));
+	skinningShader.uploadUniform("bitangentOffset", static_cast<int>(offsetof(Vertex, _bitangent) / sizeof(float)));
+
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, _boneBuffer);
+
+	const std::vector<Mesh *>& meshes = _model->getMeshes();
+
+	for (unsigned int i = 0; i < meshes.size(); ++i)
+	{
+		unsigned int vertexCount = static_cast<unsigned int>(meshes[i]->getVertices().size());
+
+		skinningShader.uploadUniform("vertexCount", static_cast<int>(vertexCount));
+
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, meshes[i]->getVertexBuffer().getHandle());
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, meshes[i]->getBoneDataBuffer().getHandle());
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, _vbos[i].getHandle());
+
+		glDispatchCompute((vertexCount + 63) / 64, 1, 1);
+	}
+
+	GLSLShader::use(0);
+
+	_ready = true;
+}
+
+void SkinnedModelInstance::render(
+	unsigned int meshIndex) const
+{
+	const Mesh *mesh = _model->getMeshes().at(meshIndex);
+
+	_vaos[meshIndex].bind();
+	mesh->getIndexBuffer().bind();
+
+	glDrawElements(
+		GL_TRIANGLES,
+		static_cast<GLsizei>(mesh->getIndices().size()),
+		GL_UNSIGNED_INT,
+		nullptr);
+
+	mesh->getIndexBuffer().unbind();
+	VertexArrayObject::unbind();
+}
+
+const Model * SkinnedModelInstance::getModel() const
+{
+	return _model;
+}
+
+bool SkinnedModelInstance::isReady() const
+{
+	return _ready;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "VertexArrayObject.h"
+#include "VertexBufferObject.h"
+
+class Model;
+class GLSLShader;
+
+// Holds the skinned vertices of one skinned model node. The vertices are
+// written once per frame by the skinning compute shader and every render pass
+// then draws them like static geometry.
+class SkinnedModelInstance
+{
+public:
+	explicit SkinnedModelInstance(const Model *model);
+
+	SkinnedModelInstance(const SkinnedModelInstance& other) = delete;
+	SkinnedModelInstance(SkinnedModelInstance&& other) = delete;
+
+	SkinnedModelInstance& operator=(const SkinnedModelInstance& other) = delete;
+	SkinnedModelInstance& operator=(SkinnedModelInstance&& other) = delete;
+
+	~SkinnedModelInstance();
+
+	// Runs the skinning shader for every mesh. The caller is responsible for
+	// issuing the memory barrier before the vertices are drawn.
+	void skin(
+		GLSLShader& skinningShader,
+		const std::vector<glm::mat4>& boneTransforms);
+
+	void render(unsigned int meshIndex) const;
+
+	const Model *getModel() const;
+
+	bool isReady() const;
+private:
+
+	const Model *_model;
+
+	bool _ready{ false };
+
+	GLuint _boneBuffer{ 0 };
+
+	std::vector<VertexArrayObject> _vaos{};
+	std::vector<VertexBufferObject> _vbos{};
+};
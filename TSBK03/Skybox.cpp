@@ -23,3 +23,13 @@ const std::string & Skybox::getModel() const
 {
 	return _skyboxModel;
 }
+
+AssetRef<TextureCubeMap> & Skybox::getTextureRef() const
+{
+	return _textureRef;
+}
+
+AssetRef<Model> & Skybox::getModelRef() const
+{
+	return _modelRef;
+}
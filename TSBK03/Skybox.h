@@ -1,6 +1,10 @@
 #pragma once
 #include <string>
 
+#include "Model.h"
+#include "Texture.h"
+#include "AssetRef.h"
+
 class Skybox
 {
 public:
@@ -12,8 +16,15 @@ public:
 
 	const std::string& getTexture() const;
 	const std::string& getModel() const;
+
+	// Resolved by the renderer the first time the skybox is drawn.
+	AssetRef<TextureCubeMap>& getTextureRef() const;
+	AssetRef<Model>& getModelRef() const;
 private:
 
 	std::string _skyboxModel;
 	std::string _skyboxTexture;
+
+	mutable AssetRef<TextureCubeMap> _textureRef{};
+	mutable AssetRef<Model> _modelRef{};
 };
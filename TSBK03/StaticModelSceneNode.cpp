@@ -19,6 +19,12 @@ void StaticModelSceneNode::setModel(
 	const std::string &newModel)
 {
 	_model = newModel;
+	_modelRef = AssetRef<Model>{};
+
+	// The bones of the old model do not fit the new one.
+	_poseCache = AnimationPoseCache{};
+
+	notifyChanged(SceneNodeChange::MODEL);
 }
 
 const std::string & StaticModelSceneNode::getTexture() const
@@ -30,6 +36,9 @@ void StaticModelSceneNode::setTexture(
 	const std::string &newTexture)
 {
 	_texture = newTexture;
+	_textureRef = AssetRef<Texture2D>{};
+
+	notifyChanged(SceneNodeChange::TEXTURE);
 }
 
 std::string StaticModelSceneNode::getCurrentAnimation() const
@@ -40,6 +49,11 @@ std::string StaticModelSceneNode::getCurrentAnimation() const
 void StaticModelSceneNode::setCurrentAnimation(
 	const std::string &newAnimation)
 {
+	if (_currentAnimation != newAnimation)
+	{
+		_poseCache.valid = false;
+	}
+
 	_currentAnimation = newAnimation;
 }
 
@@ -64,3 +78,47 @@ void StaticModelSceneNode::setTintColor(
 {
 	_tintColor = tintColor;
 }
+
+const AnimationLOD & StaticModelSceneNode::getAnimationLOD() const
+{
+	return _animationLOD;
+}
+
+void StaticModelSceneNode::setAnimationLOD(
+	const AnimationLOD &animationLOD)
+{
+	_animationLOD = animationLOD;
+}
+
+unsigned int StaticModelSceneNode::getAnimationUpdateInterval(
+	float distance) const
+{
+	if (!_animationLOD.enabled || distance <= _animationLOD.nearDistance)
+	{
+		return 1;
+	}
+
+	if (distance >= _animationLOD.farDistance)
+	{
+		return glm::max(1u, _animationLOD.maxInterval);
+	}
+
+	float t = (distance - _animationLOD.nearDistance) / (_animationLOD.farDistance - _animationLOD.nearDistance);
+
+	return glm::max(1u, static_cast<unsigned int>(glm::mix(1.f, static_cast<float>(_animationLOD.maxInterval), t) + 0.5f));
+}
+
+AnimationPoseCache & StaticModelSceneNode::getPoseCache() const
+{
+	return _poseCache;
+}
+
+AssetRef<Model> & StaticModelSceneNode::getModelRef() const
+{
+	return _modelRef;
+}
+
+AssetRef<Texture2D> & StaticModelSceneNode::getTextureRef() const
+{
+	return _textureRef;
+}
@@ -2,6 +2,9 @@
 
 #include "SceneNode.h"
 #include "Model.h"
+#include "AnimationLOD.h"
+#include "Texture.h"
+#include "AssetRef.h"
 
 class StaticModelSceneNode : public SceneNode
 {
@@ -25,6 +28,20 @@ public:
 
 	glm::vec3 getTintColor() const;
 	void setTintColor(const glm::vec3 tintColor);
+
+	const AnimationLOD& getAnimationLOD() const;
+	void setAnimationLOD(const AnimationLOD& animationLOD);
+
+	unsigned int getAnimationUpdateInterval(float distance) const;
+
+	// The pose cache is owned by the renderer, which only sees const nodes.
+	AnimationPoseCache& getPoseCache() const;
+
+	// Resolved by the renderer the first time the node is drawn and reset
+	// when the model or texture changes. The references keep the assets of
+	// the scene from being evicted.
+	AssetRef<Model>& getModelRef() const;
+	AssetRef<Texture2D>& getTextureRef() const;
 protected:
 
 	std::string _model;
@@ -36,4 +53,11 @@ protected:
 	bool _outline;
 
 	glm::vec3 _tintColor{0.f, 0.f, 0.f};
+
+	AnimationLOD _animationLOD{};
+
+	mutable AnimationPoseCache _poseCache{};
+
+	mutable AssetRef<Model> _modelRef{};
+	mutable AssetRef<Texture2D> _textureRef{};
 };
\ No newline at end of file
@@ -6,43 +6,68 @@
 */
 
 #include "TGA.h"
+#include "AssetFileSystem.h"
+#include "ImageKernels.h"
 
-#include <fstream>
 #include <iostream>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
 
-TGA::TGA(const char* filePath)
+TGA::TGA(const char* filePath, bool decodePixels)
+	: _filePath{ filePath }
 {
-	std::fstream hFile(filePath, std::ios::in | std::ios::binary);
-
-	if (!hFile.is_open())
-	{
-		throw std::invalid_argument(std::string("File (") + filePath + ") could not be opened.");
-	}
+	// Throws if the file could not be opened.
+	_file = AssetFileSystem::open(filePath);
 
 	// Allocate header
 	TGAFileHeader fileHeader;
 	memset(&fileHeader, 0, sizeof(TGAFileHeader));
 
 	// Read header into struct
-	hFile.read(reinterpret_cast<char*>(&fileHeader), sizeof(TGAFileHeader));
-
+	_file.read(reinterpret_cast<char*>(&fileHeader), sizeof(TGAFileHeader));
 
 	if (fileHeader.imageType == IS_TYPE_UNCOMPRESSED_TRUE_COLOR) // File is not compressed and in true color.
 	{
-		readUncompressedTrueColor(hFile, fileHeader, filePath);
+		_isCompressed = false;
 	}
 	else if (fileHeader.imageType == IS_TYPE_RUN_LENGTH_TRUE_COLOR) // File is compressed and in true color
 	{
-		readRunLengthTrueColor(hFile, fileHeader, filePath);
+		_isCompressed = true;
 	}
 	// Add more imageTypes here as needed.
 	else
 	{
-		hFile.close();
 		throw std::invalid_argument(std::string("Invalid file format in file (") + filePath + "). Expected compressed or uncompressed true-color format.");
 	}
 
-	hFile.close();
+	// Read file meta-data
+	_bitsPerPixel = fileHeader.imageSpecification.pixelDepth;
+	_width = fileHeader.imageSpecification.imageWidth;
+	_height = fileHeader.imageSpecification.imageHeight;
+	_isTopToBottom = (fileHeader.imageSpecification.imageDescriptor & ID_TOP_TO_BOTTOM) != 0;
+
+	// Check that it is the correct format.
+	if (_bitsPerPixel != PD_BITCOUNT_24 && _bitsPerPixel != PD_BITCOUNT_32)
+	{
+		throw std::invalid_argument(std::string("Invalid file format in file (") + filePath + "). Expected 24 or 32 bit image.");
+	}
+
+	// Skip the image ID and the color map to get to the image data.
+	size_t colorMapSize = 0;
+
+	if (fileHeader.colorMapType == COLOR_MAP_INCLUDED)
+	{
+		colorMapSize = fileHeader.colorMapSpecification.colorMapLength * ((fileHeader.colorMapSpecification.colorMapEntrySize + 7) / 8);
+	}
+
+	_file.skip(fileHeader.IDLength + colorMapSize);
+
+	if (decodePixels)
+	{
+		_pixels.resize(getPixelsSize());
+		decode(_pixels.data());
+	}
 }
 
 const std::vector<uint8_t>& TGA::getPixels() const
@@ -65,105 +90,115 @@ bool TGA::hasAlpha() const
 	return _bitsPerPixel == PD_BITCOUNT_32;
 }
 
-void TGA::readUncompressedTrueColor(
-	std::fstream &hFile,
-	TGAFileHeader& fileHeader,
-	const char *filePath)
+void TGA::decode(
+	unsigned char *destination,
+	bool premultiplyAlpha)
 {
-	// Read file meta-data
-	_bitsPerPixel = fileHeader.imageSpecification.pixelDepth;
-	_width = fileHeader.imageSpecification.imageWidth;
-	_height = fileHeader.imageSpecification.imageHeight;
-	_size = (_width * _bitsPerPixel + 31) / 8 * _height;
+	if (!_file.isOpen())
+	{
+		throw std::logic_error(std::string("The pixels of file (") + _filePath + ") are already decoded.");
+	}
 
-	// Check that it is the correct format.
-	if (_bitsPerPixel != PD_BITCOUNT_24 && _bitsPerPixel != PD_BITCOUNT_32)
+	// Pixels are stored as BGR(A), OpenGL wants the bottom row first.
+	unsigned int flags = IMAGE_CONVERT_SWIZZLE_RED_BLUE;
+
+	if (premultiplyAlpha)
 	{
-		hFile.close();
-		throw std::invalid_argument(std::string("Invalid file format in file (") + filePath + "). Expected 24 or 32 bit image.");
+		flags |= IMAGE_CONVERT_PREMULTIPLY_ALPHA;
 	}
 
-	// Prepare pixel buffer.
-	_pixels.resize(_size);
-	_isCompressed = false;
+	if (_isTopToBottom)
+	{
+		flags |= IMAGE_CONVERT_FLIP_VERTICALLY;
+	}
+
+	if (_isCompressed)
+	{
+		decodeRunLengthTrueColor(destination, flags);
+	}
+	else
+	{
+		decodeUncompressedTrueColor(destination, flags);
+	}
 
-	// Read file content.
-	hFile.read(reinterpret_cast<char*>(_pixels.data()), _size);
+	// Release the file.
+	_file = AssetStream{};
 }
 
-void TGA::readRunLengthTrueColor(
-	std::fstream &hFile,
-	TGAFileHeader &fileHeader,
-	const char *filePath)
+void TGA::decodeUncompressedTrueColor(
+	uint8_t *destination,
+	unsigned int flags)
 {
-	// Read file meta-data
-	_bitsPerPixel = fileHeader.imageSpecification.pixelDepth;
-	_width = fileHeader.imageSpecification.imageWidth;
-	_height = fileHeader.imageSpecification.imageHeight;
-	_size = (_width * _bitsPerPixel + 31) / 8 * _height;
+	const unsigned int bytesPerPixel = _bitsPerPixel / 8;
 
-	// Check that it is the correct format.
-	if (_bitsPerPixel != PD_BITCOUNT_24 && _bitsPerPixel != PD_BITCOUNT_32)
+	if (_file.getSize() - _file.tell() < getPixelsSize())
 	{
-		hFile.close();
-		throw std::invalid_argument(std::string("Invalid file format in file (") + filePath + "). Expected 24 or 32 bit image.");
+		throw std::invalid_argument(std::string("Unexpected end of file in file (") + _filePath + ").");
 	}
 
-	// Allocate a pixel-struct.
-	PixelInfo pixel;
-	memset(&pixel, 0, sizeof(PixelInfo));
+	// Convert straight from the file contents.
+	convertRows(destination, _file.getCurrent(), _width, _height, bytesPerPixel, _width * bytesPerPixel, flags);
+}
+
+void TGA::decodeRunLengthTrueColor(
+	uint8_t *destination,
+	unsigned int flags)
+{
+	const std::size_t bytesPerPixel = (_bitsPerPixel) / 8;
+	const std::size_t pixelCount = static_cast<std::size_t>(_height) * _width;
 
-	int currentByte = 0;
 	std::size_t currentPixel = 0;
-	_isCompressed = true;
-	uint8_t chunkHeader = 0;
-	const int bytesPerPixel = (_bitsPerPixel) / 8;
-	_pixels.resize(_width * _height * sizeof(PixelInfo));
 
-	// Loop through each pixel in memory array.
-	do
-	{
-		// Read chunk header
-		hFile.read(reinterpret_cast<char*>(&chunkHeader), sizeof(chunkHeader));
+	// Decode straight from the file contents instead of copying out every
+	// chunk header and pixel.
+	const uint8_t *source = _file.getCurrent();
+	const uint8_t *end = _file.getData() + _file.getSize();
 
-		// If chunk header bit 7 is 0, add one to value and read that many pixels from file.
-		if (chunkHeader < 128)
+	uint8_t *target = destination;
+
+	while (currentPixel < pixelCount)
+	{
+		if (source >= end)
 		{
-			++chunkHeader;
-			for (int i{ 0 }; i < chunkHeader; ++i, ++currentPixel)
-			{
-				hFile.read(reinterpret_cast<char*>(&pixel), bytesPerPixel);
+			throw std::invalid_argument(std::string("Unexpected end of file in file (") + _filePath + ").");
+		}
 
-				_pixels[currentByte++] = pixel.B;
-				_pixels[currentByte++] = pixel.G;
-				_pixels[currentByte++] = pixel.R;
+		uint8_t chunkHeader = *source++;
 
-				// Take alpha channel into account if present.
-				if (_bitsPerPixel == PD_BITCOUNT_32)
-				{
-					_pixels[currentByte++] = pixel.A;
-				}
-			}
-		}
+		// If chunk header bit 7 is 0, add one to value and read that many pixels from file.
 		// If chunk header bit 7 is 1, subtract 127 to header and read the next value.
 		// Repeat that value chunk header times.
-		else
+		const bool isRunLength = chunkHeader >= 128;
+		const std::size_t count = std::min<std::size_t>(isRunLength ? chunkHeader - 127 : chunkHeader + 1, pixelCount - currentPixel);
+		const std::size_t chunkSize = isRunLength ? bytesPerPixel : bytesPerPixel * count;
+
+		if (static_cast<std::size_t>(end - source) < chunkSize)
 		{
-			chunkHeader -= 127;
-			hFile.read(reinterpret_cast<char*>(&pixel), bytesPerPixel);
+			throw std::invalid_argument(std::string("Unexpected end of file in file (") + _filePath + ").");
+		}
 
-			for (int i{ 0 }; i < chunkHeader; ++i, ++currentPixel)
+		if (isRunLength)
+		{
+			for (std::size_t i{ 0 }; i < count; ++i)
 			{
-				_pixels[currentByte++] = pixel.B;
-				_pixels[currentByte++] = pixel.G;
-				_pixels[currentByte++] = pixel.R;
-
-				// Take alpha channel into account if present.
-				if (_bitsPerPixel == PD_BITCOUNT_32)
-				{
-					_pixels[currentByte++] = pixel.A;
-				}
+				memcpy(target + i * bytesPerPixel, source, bytesPerPixel);
 			}
 		}
-	} while (currentPixel < (_height * _width));
+		else
+		{
+			memcpy(target, source, chunkSize);
+		}
+
+		source += chunkSize;
+		target += count * bytesPerPixel;
+		currentPixel += count;
+	}
+
+	// Convert the expanded pixels in place.
+	convertRows(destination, destination, _width, _height, bytesPerPixel, _width * bytesPerPixel, flags & ~IMAGE_CONVERT_FLIP_VERTICALLY);
+
+	if (flags & IMAGE_CONVERT_FLIP_VERTICALLY)
+	{
+		flipVertically(destination, _width * bytesPerPixel, _height);
+	}
 }
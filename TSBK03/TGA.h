@@ -8,6 +8,9 @@
 #pragma once
 
 #include "TextureFile.h"
+#include "AssetStream.h"
+
+#include <string>
 
 #define COLOR_MAP_NOT_INCLUDED			0
 #define COLOR_MAP_INCLUDED				1
@@ -27,6 +30,8 @@
 #define PD_BITCOUNT_24					24
 #define PD_BITCOUNT_32					32
 
+#define ID_TOP_TO_BOTTOM				0x20
+
 #pragma pack(push, 1)
 
 // File Format
@@ -148,8 +153,10 @@ public:
 	/**
 	* @brief Constructor
 	* @param filePath Path to the file.
+	* @param decodePixels False to only read the header and decode the
+	* pixels later with decode.
 	*/
-	explicit TGA(const char* filePath);
+	explicit TGA(const char* filePath, bool decodePixels = true);
 
 	TGA(const TGA& other) = delete;
 	TGA(TGA&& other) = delete;
@@ -181,8 +188,25 @@ public:
 	*/
 	bool hasAlpha() const override;
 
+	/**
+	* @brief Decodes the pixels as RGB(A) into the destination.
+	* @param destination Memory for getPixelsSize() bytes.
+	* @param premultiplyAlpha True to multiply the colors with the alpha.
+	*/
+	void decode(unsigned char *destination, bool premultiplyAlpha = false) override;
+
 private:
 
+	/**
+	* @brief The file, open until the pixels are decoded.
+	*/
+	AssetStream _file;
+
+	/**
+	* @brief Path to the file.
+	*/
+	std::string _filePath;
+
 	/**
 	* @brief Vector containing the pixels.
 	*/
@@ -204,34 +228,30 @@ private:
 	uint32_t _height;
 
 	/**
-	* @brief The Size in bytes of the image.
+	* @brief The number of bits per pixel.
 	*/
-	uint32_t _size;
+	uint32_t _bitsPerPixel;
 
 	/**
-	* @brief The number of bits per pixel.
+	* @brief True if the first row in the file is the top row.
 	*/
-	uint32_t _bitsPerPixel;
+	bool _isTopToBottom;
 
 	/**
-	 * @brief Read an uncompressed byte stream from the file
-	 * @param hFile File stream handle
-	 * @param fileHeader TGA file header
-	 * @param filePath Path to file
+	 * @brief Converts uncompressed pixels from the file
+	 * @param destination Memory for the pixels
+	 * @param flags IMAGE_CONVERT_FLAGS to apply
 	 */
-	void readUncompressedTrueColor(
-		std::fstream &hFile,
-		TGAFileHeader &fileHeader,
-		const char *filePath);
+	void decodeUncompressedTrueColor(
+		uint8_t *destination,
+		unsigned int flags);
 
 	/**
-	 * @brief Read a run-length compressed byte stream from the file 
-	 * @param hFile File stream handle
-	 * @param fileHeader TGA file header
-	 * @param filePath Path to file
+	 * @brief Decodes run-length compressed pixels from the file
+	 * @param destination Memory for the pixels
+	 * @param flags IMAGE_CONVERT_FLAGS to apply
 	 */
-	void readRunLengthTrueColor(
-		std::fstream &hFile,
-		TGAFileHeader &fileHeader,
-		const char *filePath);
+	void decodeRunLengthTrueColor(
+		uint8_t *destination,
+		unsigned int flags);
 };
\ No newline at end of file
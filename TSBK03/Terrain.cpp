@@ -44,7 +44,50 @@ float Terrain::getHeight(
 	return maxHeight;
 }
 
+int Terrain::getChunkIndex(
+	float x,
+	float z) const
+{
+	for (size_t i = 0; i < _chunks.size(); ++i)
+	{
+		float x1 = x - _chunks[i]->getOffsetX();
+		float z1 = z - _chunks[i]->getOffsetZ();
+
+		if (x1 > 0 && x1 < _chunks[i]->getSizeX() &&
+			z1 > 0 && z1 < _chunks[i]->getSizeZ())
+		{
+			return static_cast<int>(i);
+		}
+	}
+
+	return -1;
+}
+
 const std::vector<TerrainChunk *> & Terrain::getChunks() const
 {
 	return _chunks;
 }
+
+size_t Terrain::getCPUMemoryUsage() const
+{
+	size_t bytes = 0;
+
+	for (auto it : _chunks)
+	{
+		bytes += it->getCPUMemoryUsage();
+	}
+
+	return bytes;
+}
+
+size_t Terrain::getGPUMemoryUsage() const
+{
+	size_t bytes = 0;
+
+	for (auto it : _chunks)
+	{
+		bytes += it->getGPUMemoryUsage();
+	}
+
+	return bytes;
+}
@@ -20,7 +20,13 @@ public:
 
 	float getHeight(float x, float z) const;
 
+	// Index of the chunk covering the point, or -1 outside the terrain.
+	int getChunkIndex(float x, float z) const;
+
 	const std::vector<TerrainChunk *>& getChunks() const;
+
+	size_t getCPUMemoryUsage() const;
+	size_t getGPUMemoryUsage() const;
 private:
 	std::vector<TerrainChunk *> _chunks;
 };
\ No newline at end of file
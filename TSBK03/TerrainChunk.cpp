@@ -173,21 +173,12 @@ void destroyQuadTree(QuadTreeNode *node)
 	delete node;
 }
 
-static std::vector<glm::vec3> getPoints(QuadTreeNode *node)
+static void addNodeBox(CullingBoxes &boxes, const QuadTreeNode *node)
 {
-	std::vector<glm::vec3> ret;
+	glm::vec3 min{ node->x, node->minY, node->z };
+	glm::vec3 max{ node->x + node->width, node->maxY, node->z + node->height };
 
-	ret.push_back(glm::vec3{ node->x, node->minY, node->z });
-	ret.push_back(glm::vec3{ node->x + node->width, node->minY, node->z });
-	ret.push_back(glm::vec3{ node->x, node->minY, node->z + node->height });
-	ret.push_back(glm::vec3{ node->x + node->width, node->minY, node->z + node->height });
-
-	ret.push_back(glm::vec3{ node->x, node->maxY, node->z });
-	ret.push_back(glm::vec3{ node->x + node->width, node->maxY, node->z });
-	ret.push_back(glm::vec3{ node->x, node->maxY, node->z + node->height });
-	ret.push_back(glm::vec3{ node->x + node->width, node->maxY, node->z + node->height });
-
-	return ret;
+	boxes.add((min + max) * 0.5f, (max - min) * 0.5f);
 }
 
 static float sampleHeightmap(TextureFile *file, int x, int z, int width, int height, int bpp)
@@ -481,8 +472,6 @@ void TerrainChunk::render() const
 	VertexArrayObject::unbind();
 }
 
-static int trianglesDrawn = 0;
-
 void TerrainChunk::render(
 	const Frustum &frustum) const
 {
@@ -490,13 +479,10 @@ void TerrainChunk::render(
 	_vertices.bind();
 	_normals.bind();
 
-	trianglesDrawn = 0;
-
-	renderWithFrustum(_treeRoot, frustum);
-
-	float culled = 100.f * static_cast<float>(trianglesDrawn) / static_cast<float>(_triangleCount);
+	_drawCalls = 0;
+	_trianglesDrawn = 0;
 
-	//std::cout << "Triangles drawn: " << trianglesDrawn << " " << 100 - culled << "% removed" << std::endl;
+	renderWithFrustum(frustum);
 
 	_vertices.unbind();
 	_normals.unbind();
@@ -504,6 +490,16 @@ void TerrainChunk::render(
 	VertexArrayObject::unbind();
 }
 
+unsigned int TerrainChunk::getNumDrawCalls() const
+{
+	return _drawCalls;
+}
+
+unsigned int TerrainChunk::getNumTrianglesDrawn() const
+{
+	return _trianglesDrawn;
+}
+
 float TerrainChunk::getHeight(
 	float x,
 	float z) const
@@ -567,6 +563,17 @@ float TerrainChunk::getDivisor() const
 	return _divisor;
 }
 
+size_t TerrainChunk::getCPUMemoryUsage() const
+{
+	return _heights.size() * sizeof(float);
+}
+
+size_t TerrainChunk::getGPUMemoryUsage() const
+{
+	// One buffer of positions and one of normals.
+	return 2 * static_cast<size_t>(_triangleCount) * sizeof(Triangle);
+}
+
 float TerrainChunk::getGridHeight(
 	int x,
 	int z) const
@@ -575,47 +582,66 @@ float TerrainChunk::getGridHeight(
 }
 
 void TerrainChunk::renderWithFrustum(
-	QuadTreeNode *node,
 	const Frustum &frustum) const
 {
-	// Extract the points of the corners of the current quad-tree node. The
-	// points are given in world space.
-	std::vector<glm::vec3> points = getPoints(node);
-
-	// This will return the result of intersection test of the box spanned by
-	// the points with the frustum passed to the function. A result of one
-	// indicates that the whole box is inside the frustum. A result of negative
-	// one indicates that the box is entirely outside the view frustum and a
-	// result of zero indicates that the box is partially inside the frustum.
-	// The frustum is given in world space coordinates.
-	int res = frustum.boxIntersect(points);
-
-	// If the object is entirely inside the frustum, we can send the object
-	// for rendering at the current level as the hilbert-ordered memory is
-	// guaranteeed to be contiguous for every level of the quad-tree.
-	// If this is a leaf node, we have to render it anyways.
-	// Note that q0 equals zero is equivalent to all q's equals zero.
-	if (res == 1 || (res == 0 && node->q0 == nullptr))
-	{
-		glDrawArrays(GL_TRIANGLES,
-			node->start * 6,
-			node->count * 6);
+	_cullingNodes.clear();
+	_cullingNodes.push_back(_treeRoot);
 
-		trianglesDrawn += node->count * 2;
-	}
-	// If there was an intersection with the planes, we have to go further into
-	// the tree to determine what to cull. We call this function on each of the
-	// subnodes to this tree.
-	else if (res == 0)
+	while (!_cullingNodes.empty())
 	{
-		renderWithFrustum(node->q0, frustum);
-		renderWithFrustum(node->q1, frustum);
-		renderWithFrustum(node->q2, frustum);
-		renderWithFrustum(node->q3, frustum);
+		// Test all nodes of the current level against the frustum at once.
+		// The nodes are boxes given in world space, like the frustum.
+		_cullingBoxes.clear();
+		_cullingPlanes.clear();
+
+		for (auto node : _cullingNodes)
+		{
+			addNodeBox(_cullingBoxes, node);
+			_cullingPlanes.push_back(node->cullingPlane);
+		}
+
+		_cullingResults.resize(_cullingNodes.size());
+
+		cullBoxes(frustum, _cullingBoxes, _cullingResults.data(), _cullingPlanes.data());
+
+		_cullingChildren.clear();
+
+		for (size_t i = 0; i < _cullingNodes.size(); ++i)
+		{
+			QuadTreeNode *node = _cullingNodes[i];
+			int res = _cullingResults[i];
+
+			node->cullingPlane = _cullingPlanes[i];
+
+			// If the node is entirely inside the frustum, we can send it for
+			// rendering at the current level as the hilbert-ordered memory is
+			// guaranteeed to be contiguous for every level of the quad-tree.
+			// If this is a leaf node, we have to render it anyways.
+			// Note that q0 equals zero is equivalent to all q's equals zero.
+			if (res == 1 || (res == 0 && node->q0 == nullptr))
+			{
+				glDrawArrays(GL_TRIANGLES,
+					node->start * 6,
+					node->count * 6);
+
+				++_drawCalls;
+				_trianglesDrawn += node->count * 2;
+			}
+			// If the node intersects the planes, its children are tested
+			// with the next level.
+			else if (res == 0)
+			{
+				_cullingChildren.push_back(node->q0);
+				_cullingChildren.push_back(node->q1);
+				_cullingChildren.push_back(node->q2);
+				_cullingChildren.push_back(node->q3);
+			}
+			// Nodes outside the frustum are discarded with all their
+			// children.
+		}
+
+		std::swap(_cullingNodes, _cullingChildren);
 	}
-	// If there was no intersection, we can safely discard the full chunk at
-	// this level. The entire chunk is outside the frustum and thus not visible
-	// to the camera at all.
 }
 
 glm::vec3 TerrainChunk::getVector(
@@ -10,6 +10,7 @@
 #include <vector>
 #include "AABB.h"
 #include "Frustum.h"
+#include "FrustumCulling.h"
 
 class TextureFile;
 class TGA;
@@ -32,6 +33,9 @@ struct QuadTreeNode
 	QuadTreeNode *q1{ nullptr };
 	QuadTreeNode *q2{ nullptr };
 	QuadTreeNode *q3{ nullptr };
+
+	// The frustum plane that culled the node last time.
+	uint8_t cullingPlane{ 0 };
 };
 
 // TODO: Make this accept all types of texture files.
@@ -46,6 +50,10 @@ public:
 	void render() const;
 	void render(const Frustum& frustum) const;
 
+	// Of the last render with a frustum.
+	unsigned int getNumDrawCalls() const;
+	unsigned int getNumTrianglesDrawn() const;
+
 	float getHeight(float x, float z) const;
 
 	float getSizeX() const;
@@ -55,6 +63,9 @@ public:
 	float getOffsetZ() const;
 
 	float getDivisor() const;
+
+	size_t getCPUMemoryUsage() const;
+	size_t getGPUMemoryUsage() const;
 private:
 
 	unsigned int _width;
@@ -82,7 +93,19 @@ private:
 
 	float getGridHeight(int x, int z) const;
 
-	void renderWithFrustum(QuadTreeNode *node, const Frustum& frustum) const;
+	// Culls one level of the quad-tree at a time, starting at the root, so
+	// that all nodes of a level are tested in one batch.
+	void renderWithFrustum(const Frustum& frustum) const;
+
+	// Scratch memory for renderWithFrustum, kept to avoid allocations.
+	mutable std::vector<QuadTreeNode *> _cullingNodes;
+	mutable std::vector<QuadTreeNode *> _cullingChildren;
+	mutable CullingBoxes _cullingBoxes;
+	mutable std::vector<int8_t> _cullingResults;
+
+	mutable unsigned int _drawCalls{ 0 };
+	mutable unsigned int _trianglesDrawn{ 0 };
+	mutable std::vector<uint8_t> _cullingPlanes;
 
 	glm::vec3 getVector(
 		int x1,
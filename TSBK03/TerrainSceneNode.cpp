@@ -13,3 +13,8 @@ const std::string & TerrainSceneNode::getTerrain() const
 {
 	return _terrain;
 }
+
+AssetRef<Terrain> & TerrainSceneNode::getTerrainRef() const
+{
+	return _terrainRef;
+}
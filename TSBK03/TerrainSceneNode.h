@@ -1,6 +1,8 @@
 #pragma once
 
 #include "SceneNode.h"
+#include "Terrain.h"
+#include "AssetRef.h"
 
 class TerrainSceneNode : public SceneNode
 {
@@ -10,6 +12,12 @@ public:
 		const std::string& tag);
 
 	const std::string& getTerrain() const;
+
+	// Resolved the first time the terrain is fetched through the node. The
+	// reference keeps the terrain from being evicted.
+	AssetRef<Terrain>& getTerrainRef() const;
 private:
 	std::string _terrain;
+
+	mutable AssetRef<Terrain> _terrainRef{};
 };
\ No newline at end of file
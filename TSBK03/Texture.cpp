@@ -5,9 +5,91 @@
 #include <iostream>
 #include "Color.h"
 #include "STBTextureFile.h"
+#include "KTXFile.h"
+#include "TextureCompression.h"
+#include "AssetFileSystem.h"
+
+#include <memory>
+#include <algorithm>
 
 #define USE_OWN_IMAGE_LOADER 0
 
+namespace
+{
+	// Decodes files that were opened without decoding their pixels straight
+	// into a pixel unpack buffer, one after the other. The buffer is left
+	// bound so that the pixels can be uploaded from the returned offsets.
+	GLuint decodeToPixelUnpackBuffer(
+		TextureFile *const *files,
+		size_t count,
+		size_t *offsets)
+	{
+		size_t size = 0;
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			offsets[i] = size;
+			size += files[i]->getPixelsSize();
+		}
+
+		GLuint buffer;
+		glGenBuffers(1, &buffer);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+
+		unsigned char *pixels = static_cast<unsigned char *>(glMapBufferRange(
+			GL_PIXEL_UNPACK_BUFFER,
+			0,
+			size,
+			GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+
+		// Fall back to decoding into system memory if mapping fails.
+		std::vector<unsigned char> fallback;
+
+		if (pixels == nullptr)
+		{
+			fallback.resize(size);
+			pixels = fallback.data();
+		}
+
+		try
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				files[i]->decode(pixels + offsets[i]);
+			}
+		}
+		catch (...)
+		{
+			if (fallback.empty())
+			{
+				glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+			}
+
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+			glDeleteBuffers(1, &buffer);
+			throw;
+		}
+
+		if (fallback.empty())
+		{
+			glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+		}
+		else
+		{
+			glBufferSubData(GL_PIXEL_UNPACK_BUFFER, 0, size, fallback.data());
+		}
+
+		return buffer;
+	}
+}
+
+std::map<unsigned int, Texture2D *> Texture2D::_streamedTextures{};
+unsigned int Texture2D::_nextStreamID{ 0 };
+
+bool Texture2D::_streaming{ true };
+GLuint Texture2D::_streamingInitialSize{ 128 };
+
 Texture2D::Texture2D()
 	:_width{ 0 }, _height{ 0 }, _handle{ 0 }, _fileName{ "" }
 {}
@@ -19,16 +101,313 @@ Texture2D::Texture2D(
 	TEXTURE_2D_FILTERING magFilter,
 	TEXTURE_2D_FILTERING minFilter)
 	: _fileName{ filePath }
+{
+	// Prefer the cooked compressed texture.
+	std::shared_ptr<KTXFile> compressed{ decodeCompressed(filePath) };
+
+	if (compressed)
+	{
+		upload(compressed, sWrap, tWrap, magFilter, minFilter);
+		return;
+	}
+
+	// Only read the header, the pixels are decoded straight into the buffer
+	// they are uploaded from.
+	std::unique_ptr<TextureFile> file{ decode(filePath, false) };
+
+	TextureFile *files[1]{ file.get() };
+	size_t offset;
+
+	GLuint pixelBuffer = decodeToPixelUnpackBuffer(files, 1, &offset);
+
+	upload(file.get(), sWrap, tWrap, magFilter, minFilter);
+
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	glDeleteBuffers(1, &pixelBuffer);
+}
+
+Texture2D::Texture2D(
+	const std::string &filePath,
+	const TextureFile *file,
+	TEXTURE_2D_WRAP sWrap,
+	TEXTURE_2D_WRAP tWrap,
+	TEXTURE_2D_FILTERING magFilter,
+	TEXTURE_2D_FILTERING minFilter)
+	: _fileName{ filePath }
+{
+	upload(file, sWrap, tWrap, magFilter, minFilter);
+}
+
+Texture2D::Texture2D(
+	const std::string &filePath,
+	std::shared_ptr<KTXFile> file,
+	TEXTURE_2D_WRAP sWrap,
+	TEXTURE_2D_WRAP tWrap,
+	TEXTURE_2D_FILTERING magFilter,
+	TEXTURE_2D_FILTERING minFilter)
+	: _fileName{ filePath }
+{
+	upload(file, sWrap, tWrap, magFilter, minFilter);
+}
+
+KTXFile * Texture2D::decodeCompressed(
+	const std::string &filePath)
+{
+	std::string cookedFilePath = getCookedTextureFileName(filePath);
+
+	// A stale cooked texture is ignored until it is cooked again.
+	if (cookedFilePath != filePath &&
+		(!AssetFileSystem::exists(cookedFilePath) || !AssetFileSystem::isUpToDate(cookedFilePath, filePath)))
+	{
+		return nullptr;
+	}
+
+	KTXFile *file = new KTXFile{ cookedFilePath };
+
+	if (file->getNumFaces() != 1)
+	{
+		delete file;
+		throw std::invalid_argument(std::string("Cooked texture (") + cookedFilePath + ") is a cube map.");
+	}
+
+	return file;
+}
+
+void Texture2D::upload(
+	std::shared_ptr<KTXFile> file,
+	TEXTURE_2D_WRAP sWrap,
+	TEXTURE_2D_WRAP tWrap,
+	TEXTURE_2D_FILTERING magFilter,
+	TEXTURE_2D_FILTERING minFilter)
+{
+	_width = file->getWidth();
+	_height = file->getHeight();
+
+	_streamFile = file;
+
+	GLint topLevel = 0;
+
+	// Start out with the mips that are small enough to upload right away.
+	if (_streaming)
+	{
+		while (topLevel + 1 < getNumLevels() && std::max(_width >> topLevel, _height >> topLevel) > _streamingInitialSize)
+		{
+			++topLevel;
+		}
+	}
+
+	// The blocks are uploaded straight from the mapped file, mip chain
+	// included, so there is nothing to generate.
+	setResidentLevel(topLevel);
+
+	setTextureWrapS(sWrap);
+	setTextureWrapT(tWrap);
+	setTextureMagFilter(magFilter);
+	setTextureMinFilter(minFilter);
+
+	_initialLevel = topLevel;
+
+	if (topLevel == 0)
+	{
+		// Fully resident, the file is no longer needed.
+		_streamFile.reset();
+		return;
+	}
+
+	_streamID = ++_nextStreamID;
+	_streamedTextures[_streamID] = this;
+}
+
+void Texture2D::setStreaming(
+	bool enabled,
+	GLuint initialSize)
+{
+	_streaming = enabled;
+	_streamingInitialSize = initialSize;
+}
+
+bool Texture2D::getStreaming()
+{
+	return _streaming;
+}
+
+bool Texture2D::isStreamed() const
+{
+	return _streamID != 0;
+}
+
+GLint Texture2D::getNumLevels() const
+{
+	return _streamFile ? static_cast<GLint>(_streamFile->getNumLevels()) : 1;
+}
+
+GLint Texture2D::getResidentLevel() const
+{
+	return _residentLevel;
+}
+
+GLint Texture2D::getInitialLevel() const
+{
+	return _initialLevel;
+}
+
+size_t Texture2D::getLevelsMemoryUsage(
+	GLint topLevel) const
+{
+	if (!_streamFile)
+	{
+		return getGPUMemoryUsage();
+	}
+
+	size_t size = 0;
+
+	for (GLint level = std::max(topLevel, 0); level < getNumLevels(); ++level)
+	{
+		size += _streamFile->getImageSize(level);
+	}
+
+	return size;
+}
+
+void Texture2D::setResidentLevel(
+	GLint topLevel,
+	GLuint pixelBuffer)
+{
+	if (!_streamFile)
+	{
+		throw std::logic_error("Texture (" + _fileName + ") has no levels to stream.");
+	}
+
+	const GLint numLevels = getNumLevels();
+
+	topLevel = std::min(std::max(topLevel, 0), numLevels - 1);
+
+	if (_handle != 0 && topLevel == _residentLevel)
+	{
+		return;
+	}
+
+	if (pixelBuffer != 0 && (_handle == 0 || topLevel != _residentLevel - 1))
+	{
+		throw std::logic_error("Only a single new level can be uploaded from pixels.");
+	}
+
+	const GLenum internalFormat = _streamFile->getInternalFormat();
+
+	GLint currentTexture;
+
+	glGetIntegerv(GL_TEXTURE_BINDING_2D, &currentTexture);
+
+	// Levels can not be added to or removed from a texture, so the resident
+	// ones are moved to new storage of the right size.
+	GLuint handle;
+
+	glGenTextures(1, &handle);
+	glBindTexture(GL_TEXTURE_2D, handle);
+
+	glTexStorage2D(
+		GL_TEXTURE_2D,
+		numLevels - topLevel,
+		internalFormat,
+		std::max(_width >> topLevel, 1u),
+		std::max(_height >> topLevel, 1u));
+
+	for (GLint level = topLevel; level < numLevels; ++level)
+	{
+		GLsizei width = std::max(_width >> level, 1u);
+		GLsizei height = std::max(_height >> level, 1u);
+
+		if (_handle != 0 && level >= _residentLevel)
+		{
+			glCopyImageSubData(
+				_handle, GL_TEXTURE_2D, level - _residentLevel, 0, 0, 0,
+				handle, GL_TEXTURE_2D, level - topLevel, 0, 0, 0,
+				width, height, 1);
+		}
+		else
+		{
+			if (pixelBuffer != 0)
+			{
+				glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixelBuffer);
+			}
+
+			glCompressedTexSubImage2D(
+				GL_TEXTURE_2D,
+				level - topLevel,
+				0,
+				0,
+				width,
+				height,
+				internalFormat,
+				static_cast<GLsizei>(_streamFile->getImageSize(level)),
+				pixelBuffer != 0 ? nullptr : _streamFile->getImageData(level, 0));
+
+			if (pixelBuffer != 0)
+			{
+				glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+			}
+		}
+	}
+
+	if (_handle != 0)
+	{
+		TEXTURE_2D_WRAP sWrap = getTextureWrapS();
+		TEXTURE_2D_WRAP tWrap = getTextureWrapT();
+		TEXTURE_2D_FILTERING magFilter = getTextureMagFilter();
+		TEXTURE_2D_FILTERING minFilter = getTextureMinFilter();
+
+		if (static_cast<GLuint>(currentTexture) == _handle)
+		{
+			currentTexture = handle;
+		}
+
+		glDeleteTextures(1, &_handle);
+		_handle = handle;
+
+		setTextureWrapS(sWrap);
+		setTextureWrapT(tWrap);
+		setTextureMagFilter(magFilter);
+		setTextureMinFilter(minFilter);
+	}
+	else
+	{
+		_handle = handle;
+	}
+
+	glBindTexture(GL_TEXTURE_2D, currentTexture);
+
+	_residentLevel = topLevel;
+	_gpuMemoryUsage = getLevelsMemoryUsage(topLevel);
+}
+
+unsigned int Texture2D::getStreamID() const
+{
+	return _streamID;
+}
+
+const std::shared_ptr<KTXFile>& Texture2D::getStreamFile() const
+{
+	return _streamFile;
+}
+
+const std::map<unsigned int, Texture2D *>& Texture2D::getStreamedTextures()
+{
+	return _streamedTextures;
+}
+
+TextureFile * Texture2D::decode(
+	const std::string &filePath,
+	bool decodePixels)
 {
 	TextureFile *file{ nullptr };
 #if USE_OWN_IMAGE_LOADER
 	if (filePath.find(".tga") != std::string::npos)
 	{
-		file = new TGA{ filePath.c_str() };
+		file = new TGA{ filePath.c_str(), decodePixels };
 	}
 	else if (filePath.find(".bmp") != std::string::npos)
 	{
-		file = new BMP{ filePath.c_str() };
+		file = new BMP{ filePath.c_str(), decodePixels };
 	}
 	else
 	{
@@ -40,12 +419,28 @@ Texture2D::Texture2D(
 		throw std::invalid_argument(std::string("Invalid file. (") + filePath + ")");
 	}
 #else
-	file = new STBTextureFile(filePath);
+	file = new STBTextureFile(filePath, decodePixels);
 #endif
 
+	return file;
+}
+
+void Texture2D::upload(
+	const TextureFile *file,
+	TEXTURE_2D_WRAP sWrap,
+	TEXTURE_2D_WRAP tWrap,
+	TEXTURE_2D_FILTERING magFilter,
+	TEXTURE_2D_FILTERING minFilter)
+{
+	const std::string &filePath = _fileName;
+
 	glGenTextures(1, &_handle);
 	glBindTexture(GL_TEXTURE_2D, _handle);
 
+	// Rows are tightly packed. Without pixels in system memory they are read
+	// from the bound pixel unpack buffer.
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
 	glTexImage2D(
 		GL_TEXTURE_2D,
 		0,
@@ -55,14 +450,14 @@ Texture2D::Texture2D(
 		0,
 		file->hasAlpha() ? GL_RGBA : GL_RGB,
 		GL_UNSIGNED_BYTE,
-		file->getPixels().data()
+		file->getPixels().empty() ? nullptr : file->getPixels().data()
 	);
 
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
 	_width = file->getWidth();
 	_height = file->getHeight();
 
-	delete file;
-
 	// Setup S coordinate wrap
 	switch (sWrap)
 	{
@@ -291,6 +686,11 @@ Texture2D::Texture2D(
 
 Texture2D::~Texture2D()
 {
+	if (_streamID != 0)
+	{
+		_streamedTextures.erase(_streamID);
+	}
+
 	if (_handle != 0)
 	{
 		glDeleteTextures(1, &_handle);
@@ -1329,6 +1729,23 @@ const std::string & Texture2D::getFilename() const
 	return _fileName;
 }
 
+size_t Texture2D::getCPUMemoryUsage() const
+{
+	return 0;
+}
+
+size_t Texture2D::getGPUMemoryUsage() const
+{
+	// Compressed textures know their exact size.
+	if (_gpuMemoryUsage != 0)
+	{
+		return _gpuMemoryUsage;
+	}
+
+	// Assume four bytes per texel and a full mip chain, which adds a third.
+	return static_cast<size_t>(_width) * _height * 4 * 4 / 3;
+}
+
 void swap(
 	Texture2D &lhs,
 	Texture2D &rhs) noexcept
@@ -1336,6 +1753,22 @@ void swap(
 	std::swap(lhs._width, rhs._width);
 	std::swap(lhs._height, rhs._height);
 	std::swap(lhs._handle, rhs._handle);
+	std::swap(lhs._gpuMemoryUsage, rhs._gpuMemoryUsage);
+	std::swap(lhs._streamFile, rhs._streamFile);
+	std::swap(lhs._residentLevel, rhs._residentLevel);
+	std::swap(lhs._initialLevel, rhs._initialLevel);
+	std::swap(lhs._streamID, rhs._streamID);
+
+	// The streamed textures are tracked by address.
+	if (lhs._streamID != 0)
+	{
+		Texture2D::_streamedTextures[lhs._streamID] = &lhs;
+	}
+
+	if (rhs._streamID != 0)
+	{
+		Texture2D::_streamedTextures[rhs._streamID] = &rhs;
+	}
 }
 
 TextureCubeMap::TextureCubeMap(
@@ -1353,30 +1786,188 @@ TextureCubeMap::TextureCubeMap(
 	_fileNames[4] = posZfile;
 	_fileNames[5] = negZfile;
 
+	// Prefer the cooked compressed cube map.
+	std::unique_ptr<KTXFile> compressed{ decodeCompressed(_fileNames) };
+
+	if (compressed)
+	{
+		upload(compressed.get());
+		return;
+	}
+
+	// Only read the headers, the pixels of all faces are decoded straight into
+	// the buffer they are uploaded from.
+	std::unique_ptr<TextureFile> faces[6];
+	TextureFile *files[6];
+
+	for (unsigned int i = 0; i < 6; ++i)
+	{
+		faces[i].reset(decodeFace(_fileNames[i], false));
+		files[i] = faces[i].get();
+	}
+
+	size_t offsets[6];
+
+	GLuint pixelBuffer = decodeToPixelUnpackBuffer(files, 6, offsets);
+
+	upload(files, offsets);
+
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	glDeleteBuffers(1, &pixelBuffer);
+}
+
+TextureCubeMap::TextureCubeMap(
+	const std::string fileNames[6],
+	const TextureFile *const files[6])
+{
+	for (unsigned int i = 0; i < 6; ++i)
+	{
+		_fileNames[i] = fileNames[i];
+	}
+
+	upload(files);
+}
+
+TextureCubeMap::TextureCubeMap(
+	const std::string fileNames[6],
+	const KTXFile *file)
+{
+	for (unsigned int i = 0; i < 6; ++i)
+	{
+		_fileNames[i] = fileNames[i];
+	}
+
+	upload(file);
+}
+
+TextureCubeMap::TextureCubeMap(
+	const Color &color)
+{
+	float rgba[4];
+	color.getRGBA(rgba);
+
 	glGenTextures(1, &_handle);
 	glBindTexture(GL_TEXTURE_CUBE_MAP, _handle);
 
 	for (unsigned int i = 0; i < 6; ++i)
 	{
-		TextureFile *file;
+		glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_FLOAT, rgba);
+	}
 
-		if (_fileNames[i].find(".tga") != std::string::npos)
-		{
-			file = new TGA{ _fileNames[i].c_str() };
-		}
-		else if (_fileNames[i].find(".bmp") != std::string::npos)
-		{
-			file = new BMP{ _fileNames[i].c_str() };
-		}
-		else
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_BASE_LEVEL, 0);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, 0);
+
+	_gpuMemoryUsage = 6 * 4;
+}
+
+TextureFile * TextureCubeMap::decodeFace(
+	const std::string &filePath,
+	bool decodePixels)
+{
+	TextureFile *file;
+
+	if (filePath.find(".tga") != std::string::npos)
+	{
+		file = new TGA{ filePath.c_str(), decodePixels };
+	}
+	else if (filePath.find(".bmp") != std::string::npos)
+	{
+		file = new BMP{ filePath.c_str(), decodePixels };
+	}
+	else
+	{
+		throw std::invalid_argument(std::string("Invalid file format. (") + filePath + ")");
+	}
+
+	if (file == nullptr)
+	{
+		throw std::invalid_argument(std::string("Invalid file. (") + filePath + ")");
+	}
+
+	return file;
+}
+
+KTXFile * TextureCubeMap::decodeCompressed(
+	const std::string fileNames[6])
+{
+	std::string cookedFilePath = getCookedCubeMapFileName(fileNames[0]);
+
+	if (!AssetFileSystem::exists(cookedFilePath))
+	{
+		return nullptr;
+	}
+
+	for (unsigned int i = 0; i < 6; ++i)
+	{
+		if (!AssetFileSystem::isUpToDate(cookedFilePath, fileNames[i]))
 		{
-			throw std::invalid_argument(std::string("Invalid file format. (") + _fileNames[i] + ")");
+			return nullptr;
 		}
+	}
+
+	KTXFile *file = new KTXFile{ cookedFilePath };
+
+	if (file->getNumFaces() != 6)
+	{
+		delete file;
+		throw std::invalid_argument(std::string("Cooked cube map (") + cookedFilePath + ") does not have six faces.");
+	}
+
+	return file;
+}
+
+void TextureCubeMap::upload(
+	const KTXFile *file)
+{
+	glGenTextures(1, &_handle);
+	glBindTexture(GL_TEXTURE_CUBE_MAP, _handle);
 
-		if (file == nullptr)
+	for (uint32_t level = 0; level < file->getNumLevels(); ++level)
+	{
+		for (uint32_t face = 0; face < 6; ++face)
 		{
-			throw std::invalid_argument(std::string("Invalid file. (") + _fileNames[i] + ")");
+			glCompressedTexImage2D(
+				GL_TEXTURE_CUBE_MAP_POSITIVE_X + face,
+				level,
+				file->getInternalFormat(),
+				std::max(file->getWidth() >> level, 1u),
+				std::max(file->getHeight() >> level, 1u),
+				0,
+				static_cast<GLsizei>(file->getImageSize(level)),
+				file->getImageData(level, face));
 		}
+	}
+
+	// The skybox is only sampled from the top level, like the uncompressed
+	// cube map. The mip chain is there for anything that samples it blurred.
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_BASE_LEVEL, 0);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, file->getNumLevels() - 1);
+
+	_gpuMemoryUsage = file->getTotalImageSize();
+}
+
+void TextureCubeMap::upload(
+	const TextureFile *const files[6],
+	const size_t *pixelBufferOffsets)
+{
+	glGenTextures(1, &_handle);
+	glBindTexture(GL_TEXTURE_CUBE_MAP, _handle);
+
+	// Rows are tightly packed.
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+	for (unsigned int i = 0; i < 6; ++i)
+	{
+		const TextureFile *file = files[i];
+
+		_gpuMemoryUsage += static_cast<size_t>(file->getWidth()) * file->getHeight() * (file->hasAlpha() ? 4 : 3);
 
 		glTexImage2D(
 			GL_TEXTURE_CUBE_MAP_POSITIVE_X + i,
@@ -1387,7 +1978,7 @@ TextureCubeMap::TextureCubeMap(
 			0,
 			file->hasAlpha() ? GL_RGBA : GL_RGB,
 			GL_UNSIGNED_BYTE,
-			file->getPixels().data()
+			pixelBufferOffsets ? reinterpret_cast<const GLvoid *>(pixelBufferOffsets[i]) : file->getPixels().data()
 		);
 
 		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -1397,12 +1988,19 @@ TextureCubeMap::TextureCubeMap(
 		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
 		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_BASE_LEVEL, 0);
 		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, 0);
-
-
-		delete file;
 	}
 
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
 
+size_t TextureCubeMap::getCPUMemoryUsage() const
+{
+	return 0;
+}
+
+size_t TextureCubeMap::getGPUMemoryUsage() const
+{
+	return _gpuMemoryUsage;
 }
 
 TextureCubeMap::~TextureCubeMap()
@@ -7,8 +7,12 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <string>
+#include <map>
+#include <memory>
 
 class Color;
+class TextureFile;
+class KTXFile;
 
 enum class TEXTURE_2D_TEXTURE_MODE
 {
@@ -131,6 +135,26 @@ public:
 		TEXTURE_2D_FILTERING magFilter = TEXTURE_2D_FILTERING::LINEAR,
 		TEXTURE_2D_FILTERING minFilter = TEXTURE_2D_FILTERING::LINEAR_MIPMAP_LINEAR);
 
+	// Creates the texture from an already decoded file.
+	Texture2D(
+		const std::string& filePath,
+		const TextureFile *file,
+		TEXTURE_2D_WRAP sWrap = TEXTURE_2D_WRAP::REPEAT,
+		TEXTURE_2D_WRAP tWrap = TEXTURE_2D_WRAP::REPEAT,
+		TEXTURE_2D_FILTERING magFilter = TEXTURE_2D_FILTERING::LINEAR,
+		TEXTURE_2D_FILTERING minFilter = TEXTURE_2D_FILTERING::LINEAR_MIPMAP_LINEAR);
+
+	// Creates the texture from a cooked compressed file. While streaming is
+	// enabled only the small mips are uploaded and the texture keeps the file
+	// to stream in the others.
+	Texture2D(
+		const std::string& filePath,
+		std::shared_ptr<KTXFile> file,
+		TEXTURE_2D_WRAP sWrap = TEXTURE_2D_WRAP::REPEAT,
+		TEXTURE_2D_WRAP tWrap = TEXTURE_2D_WRAP::REPEAT,
+		TEXTURE_2D_FILTERING magFilter = TEXTURE_2D_FILTERING::LINEAR,
+		TEXTURE_2D_FILTERING minFilter = TEXTURE_2D_FILTERING::LINEAR_MIPMAP_LINEAR);
+
 	Texture2D(
 		GLuint width,
 		GLuint height,
@@ -194,12 +218,91 @@ public:
 
 	const std::string& getFilename() const;
 
+	// Texture2D keeps no pixels in system memory.
+	size_t getCPUMemoryUsage() const;
+	size_t getGPUMemoryUsage() const;
+
+	// Decodes an image file. Does not touch OpenGL, so it may be called from
+	// any thread. With decodePixels false only the header is read.
+	static TextureFile *decode(const std::string& filePath, bool decodePixels = true);
+
+	// Opens the cooked compressed texture of an image file, or the file
+	// itself if it is a .ktx file. Returns nullptr if there is none or it is
+	// older than the image. Does not touch OpenGL.
+	static KTXFile *decodeCompressed(const std::string& filePath);
+
+	// Cooked compressed textures created while streaming is enabled start
+	// out with the mips up to initialSize texels and have their larger
+	// mips streamed in by a TextureStreamer.
+	static void setStreaming(bool enabled, GLuint initialSize = 128);
+	static bool getStreaming();
+
+	bool isStreamed() const;
+
+	// Mip levels of the full texture, resident or not.
+	GLint getNumLevels() const;
+
+	// The largest resident mip level, zero when the texture is fully resident.
+	GLint getResidentLevel() const;
+
+	// The level the texture is created with, which is never dropped.
+	GLint getInitialLevel() const;
+
+	// Video memory taken by the levels from topLevel down to the smallest.
+	size_t getLevelsMemoryUsage(GLint topLevel) const;
+
+	// Replaces the storage with the levels from topLevel down to the
+	// smallest. Levels that are already resident are copied on the GPU and
+	// the others uploaded from the file. If a pixel unpack buffer is given,
+	// the single new top level is uploaded from the start of it instead.
+	void setResidentLevel(GLint topLevel, GLuint pixelBuffer = 0);
+
+	// Identifies the texture for as long as it is streamed, unlike its
+	// address. Zero if it is not streamed.
+	unsigned int getStreamID() const;
+
+	const std::shared_ptr<KTXFile>& getStreamFile() const;
+
+	// Streamed textures by stream ID. Main thread only.
+	static const std::map<unsigned int, Texture2D *>& getStreamedTextures();
+
 private:
+
+	void upload(
+		const TextureFile *file,
+		TEXTURE_2D_WRAP sWrap,
+		TEXTURE_2D_WRAP tWrap,
+		TEXTURE_2D_FILTERING magFilter,
+		TEXTURE_2D_FILTERING minFilter);
+
+	void upload(
+		std::shared_ptr<KTXFile> file,
+		TEXTURE_2D_WRAP sWrap,
+		TEXTURE_2D_WRAP tWrap,
+		TEXTURE_2D_FILTERING magFilter,
+		TEXTURE_2D_FILTERING minFilter);
+
 	GLuint _width;
 	GLuint _height;
 
 	GLuint _handle;
 
+	// Only known for compressed textures.
+	size_t _gpuMemoryUsage{ 0 };
+
+	std::shared_ptr<KTXFile> _streamFile{};
+
+	GLint _residentLevel{ 0 };
+	GLint _initialLevel{ 0 };
+
+	unsigned int _streamID{ 0 };
+
+	static std::map<unsigned int, Texture2D *> _streamedTextures;
+	static unsigned int _nextStreamID;
+
+	static bool _streaming;
+	static GLuint _streamingInitialSize;
+
 	std::string _fileName;
 
 	friend void swap(Texture2D& lhs, Texture2D& rhs) noexcept;
@@ -217,6 +320,19 @@ public:
 		const std::string& posZfile,
 		const std::string& negZfile);
 
+	// Creates the cube map from six already decoded faces.
+	TextureCubeMap(
+		const std::string fileNames[6],
+		const TextureFile *const files[6]);
+
+	// Creates the cube map from a cooked compressed file with six faces.
+	TextureCubeMap(
+		const std::string fileNames[6],
+		const KTXFile *file);
+
+	// Creates a cube map where every face is a single texel of the given color.
+	explicit TextureCubeMap(const Color& color);
+
 	~TextureCubeMap();
 
 	void bind() const;
@@ -226,9 +342,28 @@ public:
 
 	GLuint getHandle() const;
 
+	size_t getCPUMemoryUsage() const;
+	size_t getGPUMemoryUsage() const;
+
+	// Decodes a single face. Does not touch OpenGL, so it may be called from
+	// any thread. With decodePixels false only the header is read.
+	static TextureFile *decodeFace(const std::string& filePath, bool decodePixels = true);
+
+	// Opens the cooked compressed cube map named after the positive x face.
+	// Returns nullptr if there is none or it is older than any of the six
+	// faces. Does not touch OpenGL.
+	static KTXFile *decodeCompressed(const std::string fileNames[6]);
+
 private:
 
+	void upload(const KTXFile *file);
+
+	// Uploads from the bound pixel unpack buffer if offsets are given.
+	void upload(const TextureFile *const files[6], const size_t *pixelBufferOffsets = nullptr);
+
 	std::string _fileNames[6];
 
+	size_t _gpuMemoryUsage{ 0 };
+
 	GLuint _handle;
 };
\ No newline at end of file
@@ -0,0 +1,698 @@
+#include "TextureCompression.h"
+#include "TextureFile.h"
+#include "KTXFile.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+	uint16_t packColor565(
+		const float color[3])
+	{
+		int red = static_cast<int>(std::round(std::min(std::max(color[0], 0.f), 255.f) * 31.f / 255.f));
+		int green = static_cast<int>(std::round(std::min(std::max(color[1], 0.f), 255.f) * 63.f / 255.f));
+		int blue = static_cast<int>(std::round(std::min(std::max(color[2], 0.f), 255.f) * 31.f / 255.f));
+
+		return static_cast<uint16_t>((red << 11) | (green << 5) | blue);
+	}
+
+	void unpackColor565(
+		uint16_t packed,
+		int color[3])
+	{
+		int red = (packed >> 11) & 31;
+		int green = (packed >> 5) & 63;
+		int blue = packed & 31;
+
+		// Replicate the high bits into the low bits.
+		color[0] = (red << 3) | (red >> 2);
+		color[1] = (green << 2) | (green >> 4);
+		color[2] = (blue << 3) | (blue >> 2);
+	}
+
+	void getPalette(
+		uint16_t color0,
+		uint16_t color1,
+		int palette[4][3])
+	{
+		unpackColor565(color0, palette[0]);
+		unpackColor565(color1, palette[1]);
+
+		for (int i = 0; i < 3; ++i)
+		{
+			palette[2][i] = (2 * palette[0][i] + palette[1][i]) / 3;
+			palette[3][i] = (palette[0][i] + 2 * palette[1][i]) / 3;
+		}
+	}
+
+	// Picks the closest palette entry for every pixel. Returns the packed
+	// indices and the total squared error.
+	uint32_t selectColorIndices(
+		const uint8_t pixels[64],
+		uint16_t color0,
+		uint16_t color1,
+		int &error)
+	{
+		int palette[4][3];
+		getPalette(color0, color1, palette);
+
+		uint32_t indices = 0;
+		error = 0;
+
+		for (int i = 0; i < 16; ++i)
+		{
+			const uint8_t *pixel = pixels + i * 4;
+
+			int bestIndex = 0;
+			int bestDistance = INT32_MAX;
+
+			for (int j = 0; j < 4; ++j)
+			{
+				int dr = pixel[0] - palette[j][0];
+				int dg = pixel[1] - palette[j][1];
+				int db = pixel[2] - palette[j][2];
+
+				int distance = dr * dr + dg * dg + db * db;
+
+				if (distance < bestDistance)
+				{
+					bestDistance = distance;
+					bestIndex = j;
+				}
+			}
+
+			indices |= static_cast<uint32_t>(bestIndex) << (i * 2);
+			error += bestDistance;
+		}
+
+		return indices;
+	}
+
+	// Solves for the two end points that best fit the pixels in the least
+	// squares sense, given the palette entry of every pixel.
+	bool refineEndPoints(
+		const uint8_t pixels[64],
+		uint32_t indices,
+		float endPoint0[3],
+		float endPoint1[3])
+	{
+		static const float weights[4] = { 1.f, 0.f, 2.f / 3.f, 1.f / 3.f };
+
+		float aa = 0.f, bb = 0.f, ab = 0.f;
+		float ax[3]{}, bx[3]{};
+
+		for (int i = 0; i < 16; ++i)
+		{
+			float a = weights[(indices >> (i * 2)) & 3];
+			float b = 1.f - a;
+
+			aa += a * a;
+			bb += b * b;
+			ab += a * b;
+
+			for (int c = 0; c < 3; ++c)
+			{
+				ax[c] += a * pixels[i * 4 + c];
+				bx[c] += b * pixels[i * 4 + c];
+			}
+		}
+
+		float determinant = aa * bb - ab * ab;
+
+		if (std::fabs(determinant) < 1e-6f)
+		{
+			return false;
+		}
+
+		for (int c = 0; c < 3; ++c)
+		{
+			endPoint0[c] = (ax[c] * bb - bx[c] * ab) / determinant;
+			endPoint1[c] = (bx[c] * aa - ax[c] * ab) / determinant;
+		}
+
+		return true;
+	}
+
+	// Orders the end points for four color mode and remaps the indices.
+	void writeColorBlock(
+		uint16_t color0,
+		uint16_t color1,
+		uint32_t indices,
+		uint8_t block[8])
+	{
+		if (color0 < color1)
+		{
+			std::swap(color0, color1);
+
+			// 0 <-> 1 and 2 <-> 3.
+			indices ^= 0x55555555;
+		}
+		else if (color0 == color1)
+		{
+			indices = 0;
+		}
+
+		memcpy(block, &color0, 2);
+		memcpy(block + 2, &color1, 2);
+		memcpy(block + 4, &indices, 4);
+	}
+
+	void compressColorBlock(
+		const uint8_t pixels[64],
+		uint8_t block[8])
+	{
+		// Fit a line through the colors along their principal axis.
+		float mean[3]{};
+
+		for (int i = 0; i < 16; ++i)
+		{
+			for (int c = 0; c < 3; ++c)
+			{
+				mean[c] += pixels[i * 4 + c] / 16.f;
+			}
+		}
+
+		float covariance[6]{};
+
+		for (int i = 0; i < 16; ++i)
+		{
+			float r = pixels[i * 4 + 0] - mean[0];
+			float g = pixels[i * 4 + 1] - mean[1];
+			float b = pixels[i * 4 + 2] - mean[2];
+
+			covariance[0] += r * r;
+			covariance[1] += r * g;
+			covariance[2] += r * b;
+			covariance[3] += g * g;
+			covariance[4] += g * b;
+			covariance[5] += b * b;
+		}
+
+		// Power iteration for the largest eigenvector.
+		float axis[3] = { 1.f, 1.f, 1.f };
+
+		for (int iteration = 0; iteration < 8; ++iteration)
+		{
+			float x = covariance[0] * axis[0] + covariance[1] * axis[1] + covariance[2] * axis[2];
+			float y = covariance[1] * axis[0] + covariance[3] * axis[1] + covariance[4] * axis[2];
+			float z = covariance[2] * axis[0] + covariance[4] * axis[1] + covariance[5] * axis[2];
+
+			float length = std::max(std::max(std::fabs(x), std::fabs(y)), std::fabs(z));
+
+			if (length < 1e-6f)
+			{
+				break;
+			}
+
+			axis[0] = x / length;
+			axis[1] = y / length;
+			axis[2] = z / length;
+		}
+
+		float lengthSquared = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+
+		float minimum = 1e30f;
+		float maximum = -1e30f;
+
+		for (int i = 0; i < 16; ++i)
+		{
+			float t = ((pixels[i * 4 + 0] - mean[0]) * axis[0] +
+				(pixels[i * 4 + 1] - mean[1]) * axis[1] +
+				(pixels[i * 4 + 2] - mean[2]) * axis[2]) / lengthSquared;
+
+			minimum = std::min(minimum, t);
+			maximum = std::max(maximum, t);
+		}
+
+		float endPoint0[3], endPoint1[3];
+
+		for (int c = 0; c < 3; ++c)
+		{
+			endPoint0[c] = mean[c] + axis[c] * maximum;
+			endPoint1[c] = mean[c] + axis[c] * minimum;
+		}
+
+		uint16_t color0 = packColor565(endPoint0);
+		uint16_t color1 = packColor565(endPoint1);
+
+		int error;
+		uint32_t indices = selectColorIndices(pixels, color0, color1, error);
+
+		// One least squares refinement usually gains a dB or two.
+		if (color0 != color1 && refineEndPoints(pixels, indices, endPoint0, endPoint1))
+		{
+			uint16_t refined0 = packColor565(endPoint0);
+			uint16_t refined1 = packColor565(endPoint1);
+
+			int refinedError;
+			uint32_t refinedIndices = selectColorIndices(pixels, refined0, refined1, refinedError);
+
+			if (refinedError < error)
+			{
+				color0 = refined0;
+				color1 = refined1;
+				indices = refinedIndices;
+			}
+		}
+
+		writeColorBlock(color0, color1, indices, block);
+	}
+
+	void compressAlphaBlock(
+		const uint8_t pixels[64],
+		uint8_t block[8])
+	{
+		int alpha0 = 0, alpha1 = 255;
+
+		for (int i = 0; i < 16; ++i)
+		{
+			alpha0 = std::max<int>(alpha0, pixels[i * 4 + 3]);
+			alpha1 = std::min<int>(alpha1, pixels[i * 4 + 3]);
+		}
+
+		block[0] = static_cast<uint8_t>(alpha0);
+		block[1] = static_cast<uint8_t>(alpha1);
+
+		uint64_t indices = 0;
+
+		if (alpha0 != alpha1)
+		{
+			// Eight alpha mode: the end points and six values in between.
+			int palette[8];
+			palette[0] = alpha0;
+			palette[1] = alpha1;
+
+			for (int i = 1; i < 7; ++i)
+			{
+				palette[i + 1] = ((7 - i) * alpha0 + i * alpha1) / 7;
+			}
+
+			for (int i = 0; i < 16; ++i)
+			{
+				int alpha = pixels[i * 4 + 3];
+
+				int bestIndex = 0;
+				int bestDistance = INT32_MAX;
+
+				for (int j = 0; j < 8; ++j)
+				{
+					int distance = std::abs(alpha - palette[j]);
+
+					if (distance < bestDistance)
+					{
+						bestDistance = distance;
+						bestIndex = j;
+					}
+				}
+
+				indices |= static_cast<uint64_t>(bestIndex) << (i * 3);
+			}
+		}
+
+		for (int i = 0; i < 6; ++i)
+		{
+			block[2 + i] = static_cast<uint8_t>(indices >> (i * 8));
+		}
+	}
+
+	void decompressColorBlock(
+		const uint8_t block[8],
+		uint8_t pixels[64])
+	{
+		uint16_t color0, color1;
+		uint32_t indices;
+
+		memcpy(&color0, block, 2);
+		memcpy(&color1, block + 2, 2);
+		memcpy(&indices, block + 4, 4);
+
+		int palette[4][3];
+		getPalette(color0, color1, palette);
+
+		// Three color mode, only produced by other encoders.
+		if (color0 <= color1)
+		{
+			for (int i = 0; i < 3; ++i)
+			{
+				palette[2][i] = (palette[0][i] + palette[1][i]) / 2;
+				palette[3][i] = 0;
+			}
+		}
+
+		for (int i = 0; i < 16; ++i)
+		{
+			const int *color = palette[(indices >> (i * 2)) & 3];
+
+			pixels[i * 4 + 0] = static_cast<uint8_t>(color[0]);
+			pixels[i * 4 + 1] = static_cast<uint8_t>(color[1]);
+			pixels[i * 4 + 2] = static_cast<uint8_t>(color[2]);
+			pixels[i * 4 + 3] = 255;
+		}
+	}
+
+	void decompressAlphaBlock(
+		const uint8_t block[8],
+		uint8_t pixels[64])
+	{
+		int palette[8];
+		palette[0] = block[0];
+		palette[1] = block[1];
+
+		if (palette[0] > palette[1])
+		{
+			for (int i = 1; i < 7; ++i)
+			{
+				palette[i + 1] = ((7 - i) * palette[0] + i * palette[1]) / 7;
+			}
+		}
+		else
+		{
+			for (int i = 1; i < 5; ++i)
+			{
+				palette[i + 1] = ((5 - i) * palette[0] + i * palette[1]) / 5;
+			}
+
+			palette[6] = 0;
+			palette[7] = 255;
+		}
+
+		uint64_t indices = 0;
+
+		for (int i = 0; i < 6; ++i)
+		{
+			indices |= static_cast<uint64_t>(block[2 + i]) << (i * 8);
+		}
+
+		for (int i = 0; i < 16; ++i)
+		{
+			pixels[i * 4 + 3] = static_cast<uint8_t>(palette[(indices >> (i * 3)) & 7]);
+		}
+	}
+
+	// Gathers the 4x4 block at (x, y) as RGBA, repeating the edge pixels.
+	void loadBlock(
+		const uint8_t *pixels,
+		size_t width,
+		size_t height,
+		unsigned int channels,
+		size_t x,
+		size_t y,
+		uint8_t block[64])
+	{
+		for (size_t j = 0; j < 4; ++j)
+		{
+			size_t row = std::min(y + j, height - 1);
+
+			for (size_t i = 0; i < 4; ++i)
+			{
+				size_t column = std::min(x + i, width - 1);
+
+				const uint8_t *pixel = pixels + (row * width + column) * channels;
+				uint8_t *target = block + (j * 4 + i) * 4;
+
+				target[0] = pixel[0];
+				target[1] = pixel[1];
+				target[2] = pixel[2];
+				target[3] = channels == 4 ? pixel[3] : 255;
+			}
+		}
+	}
+}
+
+size_t getCompressedBlockSize(
+	TEXTURE_COMPRESSION compression)
+{
+	return compression == TEXTURE_COMPRESSION::BC1 ? 8 : 16;
+}
+
+size_t getCompressedImageSize(
+	TEXTURE_COMPRESSION compression,
+	size_t width,
+	size_t height)
+{
+	return ((width + 3) / 4) * ((height + 3) / 4) * getCompressedBlockSize(compression);
+}
+
+void compressBC1Block(
+	const uint8_t pixels[64],
+	uint8_t block[8])
+{
+	compressColorBlock(pixels, block);
+}
+
+void compressBC3Block(
+	const uint8_t pixels[64],
+	uint8_t block[16])
+{
+	compressAlphaBlock(pixels, block);
+	compressColorBlock(pixels, block + 8);
+}
+
+void decompressBC1Block(
+	const uint8_t block[8],
+	uint8_t pixels[64])
+{
+	decompressColorBlock(block, pixels);
+}
+
+void decompressBC3Block(
+	const uint8_t block[16],
+	uint8_t pixels[64])
+{
+	decompressColorBlock(block + 8, pixels);
+	decompressAlphaBlock(block, pixels);
+}
+
+std::vector<uint8_t> compressImage(
+	const uint8_t *pixels,
+	size_t width,
+	size_t height,
+	unsigned int channels,
+	TEXTURE_COMPRESSION compression)
+{
+	const size_t blockSize = getCompressedBlockSize(compression);
+
+	std::vector<uint8_t> blocks(getCompressedImageSize(compression, width, height));
+
+	uint8_t *target = blocks.data();
+	uint8_t block[64];
+
+	for (size_t y = 0; y < height; y += 4)
+	{
+		for (size_t x = 0; x < width; x += 4)
+		{
+			loadBlock(pixels, width, height, channels, x, y, block);
+
+			if (compression == TEXTURE_COMPRESSION::BC1)
+			{
+				compressBC1Block(block, target);
+			}
+			else
+			{
+				compressBC3Block(block, target);
+			}
+
+			target += blockSize;
+		}
+	}
+
+	return blocks;
+}
+
+std::vector<uint8_t> decompressImage(
+	const uint8_t *blocks,
+	size_t width,
+	size_t height,
+	unsigned int channels,
+	TEXTURE_COMPRESSION compression)
+{
+	const size_t blockSize = getCompressedBlockSize(compression);
+
+	std::vector<uint8_t> pixels(width * height * channels);
+
+	uint8_t block[64];
+
+	for (size_t y = 0; y < height; y += 4)
+	{
+		for (size_t x = 0; x < width; x += 4)
+		{
+			if (compression == TEXTURE_COMPRESSION::BC1)
+			{
+				decompressBC1Block(blocks, block);
+			}
+			else
+			{
+				decompressBC3Block(blocks, block);
+			}
+
+			blocks += blockSize;
+
+			for (size_t j = 0; j < 4 && y + j < height; ++j)
+			{
+				for (size_t i = 0; i < 4 && x + i < width; ++i)
+				{
+					memcpy(&pixels[((y + j) * width + x + i) * channels], block + (j * 4 + i) * 4, channels);
+				}
+			}
+		}
+	}
+
+	return pixels;
+}
+
+std::vector<uint8_t> generateMipLevel(
+	const uint8_t *pixels,
+	size_t width,
+	size_t height,
+	unsigned int channels)
+{
+	size_t mipWidth = std::max<size_t>(width / 2, 1);
+	size_t mipHeight = std::max<size_t>(height / 2, 1);
+
+	std::vector<uint8_t> mip(mipWidth * mipHeight * channels);
+
+	for (size_t y = 0; y < mipHeight; ++y)
+	{
+		size_t y0 = std::min(y * 2, height - 1);
+		size_t y1 = std::min(y * 2 + 1, height - 1);
+
+		for (size_t x = 0; x < mipWidth; ++x)
+		{
+			size_t x0 = std::min(x * 2, width - 1);
+			size_t x1 = std::min(x * 2 + 1, width - 1);
+
+			for (unsigned int c = 0; c < channels; ++c)
+			{
+				unsigned int sum =
+					pixels[(y0 * width + x0) * channels + c] +
+					pixels[(y0 * width + x1) * channels + c] +
+					pixels[(y1 * width + x0) * channels + c] +
+					pixels[(y1 * width + x1) * channels + c];
+
+				mip[(y * mipWidth + x) * channels + c] = static_cast<uint8_t>((sum + 2) / 4);
+			}
+		}
+	}
+
+	return mip;
+}
+
+double getPeakSignalToNoiseRatio(
+	const uint8_t *reference,
+	const uint8_t *pixels,
+	size_t size)
+{
+	double squaredError = 0.0;
+
+	for (size_t i = 0; i < size; ++i)
+	{
+		double difference = static_cast<double>(reference[i]) - pixels[i];
+		squaredError += difference * difference;
+	}
+
+	if (squaredError == 0.0)
+	{
+		return 99.0;
+	}
+
+	return 10.0 * std::log10(255.0 * 255.0 / (squaredError / size));
+}
+
+double cookCompressedTexture(
+	const TextureFile *const *faces,
+	size_t faceCount,
+	const std::string &destination)
+{
+	const TextureFile *first = faces[0];
+
+	const size_t width = first->getWidth();
+	const size_t height = first->getHeight();
+	const unsigned int channels = first->hasAlpha() ? 4 : 3;
+
+	const TEXTURE_COMPRESSION compression = first->hasAlpha() ? TEXTURE_COMPRESSION::BC3 : TEXTURE_COMPRESSION::BC1;
+
+	for (size_t face = 1; face < faceCount; ++face)
+	{
+		if (faces[face]->getWidth() != width || faces[face]->getHeight() != height || faces[face]->hasAlpha() != first->hasAlpha())
+		{
+			throw std::invalid_argument("All faces of (" + destination + ") must have the same size and format.");
+		}
+	}
+
+	size_t numLevels = 1;
+
+	for (size_t size = std::max(width, height); size > 1; size /= 2)
+	{
+		++numLevels;
+	}
+
+	// Images are stored by level and then by face.
+	std::vector<std::vector<uint8_t>> images(numLevels * faceCount);
+
+	double peakSignalToNoiseRatio = 0.0;
+
+	for (size_t face = 0; face < faceCount; ++face)
+	{
+		std::vector<uint8_t> level = faces[face]->getPixels();
+
+		size_t levelWidth = width;
+		size_t levelHeight = height;
+
+		for (size_t mip = 0; mip < numLevels; ++mip)
+		{
+			images[mip * faceCount + face] = compressImage(level.data(), levelWidth, levelHeight, channels, compression);
+
+			if (mip == 0)
+			{
+				std::vector<uint8_t> decompressed = decompressImage(images[face].data(), width, height, channels, compression);
+
+				peakSignalToNoiseRatio += getPeakSignalToNoiseRatio(level.data(), decompressed.data(), level.size()) / faceCount;
+			}
+
+			if (mip + 1 < numLevels)
+			{
+				level = generateMipLevel(level.data(), levelWidth, levelHeight, channels);
+
+				levelWidth = std::max<size_t>(levelWidth / 2, 1);
+				levelHeight = std::max<size_t>(levelHeight / 2, 1);
+			}
+		}
+	}
+
+	KTXFile::write(
+		destination,
+		compression == TEXTURE_COMPRESSION::BC1 ? KTX_COMPRESSED_RGB_S3TC_DXT1 : KTX_COMPRESSED_RGBA_S3TC_DXT5,
+		compression == TEXTURE_COMPRESSION::BC1 ? KTX_BASE_FORMAT_RGB : KTX_BASE_FORMAT_RGBA,
+		static_cast<uint32_t>(width),
+		static_cast<uint32_t>(height),
+		static_cast<uint32_t>(faceCount),
+		images);
+
+	return peakSignalToNoiseRatio;
+}
+
+std::string getCookedTextureFileName(
+	const std::string &fileName)
+{
+	size_t extension = fileName.find_last_of('.');
+	size_t directory = fileName.find_last_of("/\\");
+
+	if (extension == std::string::npos || (directory != std::string::npos && extension < directory))
+	{
+		return fileName + ".ktx";
+	}
+
+	return fileName.substr(0, extension) + ".ktx";
+}
+
+std::string getCookedCubeMapFileName(
+	const std::string &posXFileName)
+{
+	std::string fileName = getCookedTextureFileName(posXFileName);
+
+	return fileName.substr(0, fileName.size() - 4) + ".cube.ktx";
+}
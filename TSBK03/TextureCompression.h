@@ -0,0 +1,82 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+class TextureFile;
+
+// CPU encoder for the block compressed texture formats that every desktop
+// OpenGL 4.3 driver supports. Nothing in here touches OpenGL, so textures can
+// be cooked and verified headless.
+enum class TEXTURE_COMPRESSION
+{
+	// 8 bytes per 4x4 block, RGB.
+	BC1,
+
+	// 16 bytes per 4x4 block, BC1 colors plus interpolated alpha.
+	BC3
+};
+
+size_t getCompressedBlockSize(TEXTURE_COMPRESSION compression);
+
+size_t getCompressedImageSize(
+	TEXTURE_COMPRESSION compression,
+	size_t width,
+	size_t height);
+
+// Encodes 4x4 RGBA pixels.
+void compressBC1Block(const uint8_t pixels[64], uint8_t block[8]);
+void compressBC3Block(const uint8_t pixels[64], uint8_t block[16]);
+
+// Decodes into 4x4 RGBA pixels.
+void decompressBC1Block(const uint8_t block[8], uint8_t pixels[64]);
+void decompressBC3Block(const uint8_t block[16], uint8_t pixels[64]);
+
+// Encodes RGB or RGBA pixels. Blocks on the right and top edges are padded
+// by repeating the last column and row.
+std::vector<uint8_t> compressImage(
+	const uint8_t *pixels,
+	size_t width,
+	size_t height,
+	unsigned int channels,
+	TEXTURE_COMPRESSION compression);
+
+// Decodes to RGB or RGBA pixels.
+std::vector<uint8_t> decompressImage(
+	const uint8_t *blocks,
+	size_t width,
+	size_t height,
+	unsigned int channels,
+	TEXTURE_COMPRESSION compression);
+
+// Box filters the pixels down to the next mip level, which is half the size
+// rounded down but at least one pixel.
+std::vector<uint8_t> generateMipLevel(
+	const uint8_t *pixels,
+	size_t width,
+	size_t height,
+	unsigned int channels);
+
+// Peak signal to noise ratio in dB between two images of the same size.
+double getPeakSignalToNoiseRatio(
+	const uint8_t *reference,
+	const uint8_t *pixels,
+	size_t size);
+
+// Compresses decoded faces, one for a 2D texture or six for a cube map, with
+// a full mip chain and writes them to a KTX file. Files with alpha are BC3,
+// the others BC1. Returns the PSNR of the top level. Throws
+// std::invalid_argument if the file could not be written.
+double cookCompressedTexture(
+	const TextureFile *const *faces,
+	size_t faceCount,
+	const std::string& destination);
+
+// The cooked file that is loaded instead of a texture, if it exists.
+std::string getCookedTextureFileName(const std::string& fileName);
+
+// The cooked file that is loaded instead of a cube map, named after the
+// positive x face.
+std::string getCookedCubeMapFileName(const std::string& posXFileName);
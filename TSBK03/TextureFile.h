@@ -1,9 +1,12 @@
 #pragma once
 
 #include <vector>
+#include <cstddef>
 
 #include "PixelInfo.h"
 
+// Decoded pixels are tightly packed RGB or RGBA rows, bottom row first as
+// OpenGL expects them.
 class TextureFile
 {
 public:
@@ -12,4 +15,14 @@ public:
 	virtual unsigned int getWidth() const = 0;
 	virtual unsigned int getHeight() const = 0;
 	virtual bool hasAlpha() const = 0;
+
+	// Decodes the pixels into memory provided by the caller, such as a mapped
+	// pixel unpack buffer, that holds getPixelsSize() bytes. Only for files
+	// that were opened without decoding the pixels, and only once.
+	virtual void decode(unsigned char *destination, bool premultiplyAlpha = false) = 0;
+
+	size_t getPixelsSize() const
+	{
+		return static_cast<size_t>(getWidth()) * getHeight() * (hasAlpha() ? 4 : 3);
+	}
 };
\ No newline at end of file
@@ -0,0 +1,371 @@
+#include "TextureStreamer.h"
+#include "Texture.h"
+#include "KTXFile.h"
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+namespace
+{
+	struct StreamingCandidate
+	{
+		Texture2D *texture;
+
+		GLint wantedLevel;
+
+		// Textures with the lowest priority lose their mips first and get
+		// them back last.
+		float priority;
+
+		bool inFlight;
+	};
+}
+
+TextureStreamer::TextureStreamer(
+	unsigned int numPixelBuffers)
+	: _pixelBuffers(std::max(numPixelBuffers, 1u))
+{
+	for (auto& buffer : _pixelBuffers)
+	{
+		glGenBuffers(1, &buffer.handle);
+	}
+}
+
+TextureStreamer::~TextureStreamer()
+{
+	// Nothing may be writing to the mapped buffers when they are unmapped.
+	_workers.shutdown();
+
+	for (auto& buffer : _pixelBuffers)
+	{
+		if (buffer.state == PIXEL_BUFFER_STATE::FILLING)
+		{
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer.handle);
+			glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		}
+
+		if (buffer.fence != nullptr)
+		{
+			glDeleteSync(buffer.fence);
+		}
+
+		glDeleteBuffers(1, &buffer.handle);
+	}
+}
+
+void TextureStreamer::request(
+	const Texture2D *texture,
+	float screenSize)
+{
+	if (!texture->isStreamed())
+	{
+		return;
+	}
+
+	TextureRequest& request = _requests[texture->getStreamID()];
+
+	if (request.lastRequested != _frame)
+	{
+		request.screenSize = 0.f;
+		request.lastRequested = _frame;
+	}
+
+	request.screenSize = std::max(request.screenSize, screenSize);
+}
+
+void TextureStreamer::update(
+	float budgetMs)
+{
+	_workers.runFinalizers(budgetMs);
+
+	// Buffers the GPU is done uploading from can be filled again.
+	for (auto& buffer : _pixelBuffers)
+	{
+		if (buffer.state != PIXEL_BUFFER_STATE::UPLOADING)
+		{
+			continue;
+		}
+
+		GLenum result = glClientWaitSync(buffer.fence, 0, 0);
+
+		if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED)
+		{
+			glDeleteSync(buffer.fence);
+			buffer.fence = nullptr;
+			buffer.state = PIXEL_BUFFER_STATE::FREE;
+		}
+	}
+
+	const std::map<unsigned int, Texture2D *>& textures = Texture2D::getStreamedTextures();
+
+	// Forget textures that have been destroyed.
+	for (auto it = _requests.begin(); it != _requests.end();)
+	{
+		if (!it->second.inFlight && textures.find(it->first) == textures.end())
+		{
+			it = _requests.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
+
+	std::vector<StreamingCandidate> candidates;
+	candidates.reserve(textures.size());
+
+	size_t wantedMemory = 0;
+
+	for (const auto& it : textures)
+	{
+		Texture2D *texture = it.second;
+		const TextureRequest& request = _requests[it.first];
+
+		StreamingCandidate candidate{ texture, texture->getResidentLevel(), 0.f, request.inFlight };
+
+		if (request.lastRequested == _frame && request.screenSize > 0.f)
+		{
+			candidate.wantedLevel = getWantedLevel(texture, request);
+			candidate.priority = request.screenSize;
+		}
+		else
+		{
+			// Unused textures keep what they have until the budget runs out,
+			// the ones unused for the longest lose their mips first.
+			candidate.priority = -static_cast<float>(_frame - request.lastRequested);
+		}
+
+		wantedMemory += texture->getLevelsMemoryUsage(candidate.wantedLevel);
+
+		candidates.push_back(candidate);
+	}
+
+	std::sort(candidates.begin(), candidates.end(), [](const StreamingCandidate& lhs, const StreamingCandidate& rhs)
+	{
+		return lhs.priority < rhs.priority;
+	});
+
+	if (_budget != 0)
+	{
+		for (auto& candidate : candidates)
+		{
+			if (wantedMemory <= _budget)
+			{
+				break;
+			}
+
+			while (wantedMemory > _budget && candidate.wantedLevel < candidate.texture->getInitialLevel())
+			{
+				wantedMemory -= candidate.texture->getLevelsMemoryUsage(candidate.wantedLevel) -
+					candidate.texture->getLevelsMemoryUsage(candidate.wantedLevel + 1);
+
+				++candidate.wantedLevel;
+			}
+		}
+	}
+
+	// Drop mips first to make room for the new ones.
+	for (auto& candidate : candidates)
+	{
+		if (candidate.wantedLevel > candidate.texture->getResidentLevel())
+		{
+			_numDropped += candidate.wantedLevel - candidate.texture->getResidentLevel();
+
+			candidate.texture->setResidentLevel(candidate.wantedLevel);
+		}
+	}
+
+	// Stream in one level at a time, the largest textures on screen first.
+	for (auto it = candidates.rbegin(); it != candidates.rend(); ++it)
+	{
+		if (it->inFlight || it->wantedLevel >= it->texture->getResidentLevel())
+		{
+			continue;
+		}
+
+		int bufferIndex = acquirePixelBuffer();
+
+		if (bufferIndex < 0)
+		{
+			break;
+		}
+
+		startUpload(it->texture, static_cast<unsigned int>(bufferIndex));
+	}
+
+	_residentMemory = 0;
+
+	for (const auto& it : textures)
+	{
+		_residentMemory += it.second->getLevelsMemoryUsage(it.second->getResidentLevel());
+	}
+
+	++_frame;
+}
+
+void TextureStreamer::setBudget(
+	size_t gpuBytes)
+{
+	_budget = gpuBytes;
+}
+
+size_t TextureStreamer::getBudget() const
+{
+	return _budget;
+}
+
+void TextureStreamer::setLevelBias(
+	float bias)
+{
+	_levelBias = bias;
+}
+
+float TextureStreamer::getLevelBias() const
+{
+	return _levelBias;
+}
+
+size_t TextureStreamer::getResidentMemory() const
+{
+	return _residentMemory;
+}
+
+unsigned int TextureStreamer::getNumInFlight() const
+{
+	return _numInFlight;
+}
+
+unsigned int TextureStreamer::getNumStreamedIn() const
+{
+	return _numStreamedIn;
+}
+
+unsigned int TextureStreamer::getNumDropped() const
+{
+	return _numDropped;
+}
+
+void TextureStreamer::setProfiler(
+	Profiler *profiler)
+{
+	_workers.setProfiler(profiler);
+}
+
+void TextureStreamer::startUpload(
+	Texture2D *texture,
+	unsigned int bufferIndex)
+{
+	PixelBuffer& buffer = _pixelBuffers[bufferIndex];
+
+	const GLint level = texture->getResidentLevel() - 1;
+	const std::shared_ptr<KTXFile>& file = texture->getStreamFile();
+	const size_t size = file->getImageSize(level);
+
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer.handle);
+
+	if (buffer.size < size)
+	{
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+		buffer.size = size;
+	}
+
+	void *pixels = glMapBufferRange(
+		GL_PIXEL_UNPACK_BUFFER,
+		0,
+		size,
+		GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+	// Upload straight from the file if mapping fails.
+	if (pixels == nullptr)
+	{
+		texture->setResidentLevel(level);
+		++_numStreamedIn;
+		return;
+	}
+
+	buffer.state = PIXEL_BUFFER_STATE::FILLING;
+
+	_requests[texture->getStreamID()].inFlight = true;
+	++_numInFlight;
+
+	// The worker keeps the file mapped even if the texture is evicted.
+	std::shared_ptr<KTXFile> sharedFile = file;
+	unsigned int streamID = texture->getStreamID();
+
+	_workers.enqueue([this, sharedFile, streamID, level, bufferIndex, pixels, size]()
+	{
+		// Reading the mapped file is where the disk is touched.
+		memcpy(pixels, sharedFile->getImageData(level, 0), size);
+
+		_workers.finalize([this, streamID, level, bufferIndex]()
+		{
+			finishUpload(streamID, level, bufferIndex);
+		});
+	});
+}
+
+void TextureStreamer::finishUpload(
+	unsigned int streamID,
+	GLint level,
+	unsigned int bufferIndex)
+{
+	PixelBuffer& buffer = _pixelBuffers[bufferIndex];
+
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer.handle);
+
+	// The contents are lost if the buffer was corrupted while mapped.
+	bool copied = glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_TRUE;
+
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+	_requests[streamID].inFlight = false;
+	--_numInFlight;
+
+	const std::map<unsigned int, Texture2D *>& textures = Texture2D::getStreamedTextures();
+	auto it = textures.find(streamID);
+
+	// The texture may have been evicted, or lost mips to the budget, while
+	// the level was being copied.
+	if (!copied || it == textures.end() || it->second->getResidentLevel() != level + 1)
+	{
+		buffer.state = PIXEL_BUFFER_STATE::FREE;
+		return;
+	}
+
+	it->second->setResidentLevel(level, buffer.handle);
+
+	buffer.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	buffer.state = PIXEL_BUFFER_STATE::UPLOADING;
+
+	++_numStreamedIn;
+}
+
+GLint TextureStreamer::getWantedLevel(
+	const Texture2D *texture,
+	const TextureRequest &request) const
+{
+	// One texel per pixel for a texture that covers the object once.
+	float size = static_cast<float>(std::max(texture->getWidth(), texture->getHeight()));
+	float level = std::log2(size / request.screenSize) + _levelBias;
+
+	GLint wanted = static_cast<GLint>(std::floor(level));
+
+	return std::min(std::max(wanted, 0), texture->getInitialLevel());
+}
+
+int TextureStreamer::acquirePixelBuffer()
+{
+	for (unsigned int i = 0; i < _pixelBuffers.size(); ++i)
+	{
+		if (_pixelBuffers[i].state == PIXEL_BUFFER_STATE::FREE)
+		{
+			return static_cast<int>(i);
+		}
+	}
+
+	return -1;
+}
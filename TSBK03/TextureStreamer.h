@@ -0,0 +1,125 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <vector>
+#include <map>
+#include <memory>
+
+#include "AssetWorkerPool.h"
+
+class Texture2D;
+class KTXFile;
+
+// Streams the large mips of cooked compressed textures in and out depending on
+// how large the textures are on screen. Mips are copied from the mapped file on
+// a worker thread into a ring of pixel unpack buffers and uploaded from there,
+// one level per texture at a time. When the resident mips go over the budget
+// the top mips of the textures that are the smallest on screen, or have not
+// been drawn for the longest, are dropped first.
+class TextureStreamer
+{
+public:
+	explicit TextureStreamer(unsigned int numPixelBuffers = 4);
+
+	TextureStreamer(const TextureStreamer& other) = delete;
+	TextureStreamer(TextureStreamer&& other) = delete;
+
+	TextureStreamer& operator=(const TextureStreamer& other) = delete;
+	TextureStreamer& operator=(TextureStreamer&& other) = delete;
+
+	~TextureStreamer();
+
+	// Notes that the texture is drawn this frame covering about screenSize
+	// pixels across. Textures that are not streamed are ignored.
+	void request(const Texture2D *texture, float screenSize);
+
+	// Finishes uploads, drops mips to stay within the budget and starts new
+	// uploads. Must be called on the main thread once per frame.
+	void update(float budgetMs);
+
+	// Video memory for all streamed textures. Zero means no limit.
+	void setBudget(size_t gpuBytes);
+	size_t getBudget() const;
+
+	// Added to the wanted mip level, positive values trade sharpness for
+	// memory.
+	void setLevelBias(float bias);
+	float getLevelBias() const;
+
+	size_t getResidentMemory() const;
+
+	// Levels that are being copied or uploaded.
+	unsigned int getNumInFlight() const;
+
+	unsigned int getNumStreamedIn() const;
+	unsigned int getNumDropped() const;
+
+	// Adds the copies of the worker thread to the captures of the profiler.
+	void setProfiler(Profiler *profiler);
+
+private:
+
+	enum class PIXEL_BUFFER_STATE
+	{
+		FREE,
+
+		// Mapped and being filled by a worker.
+		FILLING,
+
+		// Uploaded from, free once the fence has been passed.
+		UPLOADING
+	};
+
+	struct PixelBuffer
+	{
+		GLuint handle{ 0 };
+		size_t size{ 0 };
+
+		PIXEL_BUFFER_STATE state{ PIXEL_BUFFER_STATE::FREE };
+
+		GLsync fence{ nullptr };
+	};
+
+	struct TextureRequest
+	{
+		// Largest size on screen this frame.
+		float screenSize{ 0.f };
+
+		unsigned long long lastRequested{ 0 };
+
+		bool inFlight{ false };
+	};
+
+	void startUpload(Texture2D *texture, unsigned int bufferIndex);
+
+	void finishUpload(
+		unsigned int streamID,
+		GLint level,
+		unsigned int bufferIndex);
+
+	GLint getWantedLevel(const Texture2D *texture, const TextureRequest &request) const;
+
+	// Returns the index of a free pixel buffer, or -1 if there is none.
+	int acquirePixelBuffer();
+
+	std::vector<PixelBuffer> _pixelBuffers{};
+
+	// By stream ID, so that requests outlive evicted textures.
+	std::map<unsigned int, TextureRequest> _requests{};
+
+	size_t _budget{ 0 };
+	float _levelBias{ 0.f };
+
+	size_t _residentMemory{ 0 };
+
+	unsigned int _numInFlight{ 0 };
+
+	unsigned int _numStreamedIn{ 0 };
+	unsigned int _numDropped{ 0 };
+
+	unsigned long long _frame{ 0 };
+
+	// A single worker keeps the copies in request order.
+	AssetWorkerPool _workers{ 1, "Texture Streamer" };
+};
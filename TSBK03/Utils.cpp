@@ -1,13 +1,83 @@
 #include "Utils.h"
+#include "AssetFileSystem.h"
+
+#include <stdexcept>
 
 std::string getStringFromFile(
 	const std::string &file)
 {
-	return std::string
+	// Missing files read as empty, like an unopened ifstream would.
+	try
+	{
+		return AssetFileSystem::open(file).getString();
+	}
+	catch (const std::invalid_argument&)
+	{
+		return std::string{};
+	}
+}
+
+std::string insertShaderDefines(
+	const std::string &source,
+	const std::string &defines)
+{
+	if (defines.empty())
 	{
-		std::istreambuf_iterator<char>(std::ifstream{file}),
-		std::istreambuf_iterator<char>()
-	};
+		return source;
+	}
+
+	size_t version = source.find("#version");
+
+	if (version == std::string::npos)
+	{
+		return defines + source;
+	}
+
+	size_t lineEnd = source.find('\n', version);
+
+	if (lineEnd == std::string::npos)
+	{
+		return source + "\n" + defines;
+	}
+
+	// Reset the line number so that errors point at the right line.
+	size_t nextLine = std::count(source.begin(), source.begin() + lineEnd, '\n') + 2;
+
+	return source.substr(0, lineEnd + 1) + defines + "#line " + std::to_string(nextLine) + "\n" + source.substr(lineEnd + 1);
+}
+
+void writeJSONString(
+	std::ostream &stream,
+	const std::string &str)
+{
+	stream << '"';
+
+	for (char c : str)
+	{
+		switch (c)
+		{
+		case '"':
+			stream << "\\\"";
+			break;
+		case '\\':
+			stream << "\\\\";
+			break;
+		case '\n':
+			stream << "\\n";
+			break;
+		default:
+			if (static_cast<unsigned char>(c) < 0x20)
+			{
+				stream << ' ';
+			}
+			else
+			{
+				stream << c;
+			}
+		}
+	}
+
+	stream << '"';
 }
 
 std::ostream & operator<<(
@@ -12,6 +12,13 @@
 
 std::string getStringFromFile(const std::string& file);
 
+// Inserts lines of #defines into GLSL source after its #version line, or at
+// the start if it has none.
+std::string insertShaderDefines(const std::string& source, const std::string& defines);
+
+// Writes the string quoted, with the characters JSON does not allow escaped.
+void writeJSONString(std::ostream& stream, const std::string& str);
+
 template <class ForwardIt>
 void mergeSort(ForwardIt first, ForwardIt last)
 {
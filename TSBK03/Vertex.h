@@ -37,6 +37,7 @@ private:
 
 	friend class Model;
 	friend class Mesh;
+	friend class SkinnedModelInstance;
 
 	glm::vec3 _position;
 
@@ -62,6 +62,9 @@ void VertexBufferObject::storeData(
 	case VertexBufferObjectUsage::STATIC_DRAW:
 		usageGL = GL_STATIC_DRAW;
 		break;
+	case VertexBufferObjectUsage::DYNAMIC_COPY:
+		usageGL = GL_DYNAMIC_COPY;
+		break;
 	default:
 		std::cerr << "Error defining usage for vertex buffer object" << std::endl;
 		break;
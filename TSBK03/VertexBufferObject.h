@@ -11,6 +11,7 @@ enum class VertexBufferObjectTarget
 enum class VertexBufferObjectUsage
 {
 	STATIC_DRAW,
+	DYNAMIC_COPY,
 };
 
 class VertexBufferObject
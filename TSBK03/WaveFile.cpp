@@ -6,16 +6,22 @@
 */
 
 #include "WaveFile.h"
+#include "AssetFileSystem.h"
 
-#include <fstream>
 #include <iostream>
+#include <cstring>
+#include <stdexcept>
 
 WaveFile::WaveFile(const std::string& path, ALboolean loop)
 	:_loop{ loop }
 {
-	std::ifstream fStream{ path , std::ios::binary };
+	AssetStream fStream;
 
-	if (!fStream.is_open())
+	try
+	{
+		fStream = AssetFileSystem::open(path);
+	}
+	catch (const std::invalid_argument&)
 	{
 		std::cerr << "Could not open file" << std::endl;
 		return;
@@ -98,27 +104,10 @@ WaveFile::WaveFile(const std::string& path, ALboolean loop)
 	// Allocate memory for data
 	_data = malloc(_size);
 
-	char* dataPtr = static_cast<char*>(_data);
-
-	for (uint32_t i{ 0 }; i < _size; ++i)
+	if (fStream.read(_data, _size) != _size)
 	{
-
-		fStream.read(dataPtr + i, sizeof(char));
-
-		if (fStream.eof())
-		{
-			std::cout << "Unexpected eof" << std::endl;
-			std::cout << i << std::endl;
-			break;
-		}
-
-		if (!fStream.good())
-		{
-			std::cerr << "Error reading file" << std::endl;
-			break;
-		}
+		std::cout << "Unexpected eof" << std::endl;
 	}
-	fStream.close();
 }
 
 WaveFile::~WaveFile()
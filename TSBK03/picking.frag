@@ -1,11 +0,0 @@
-#version 430 core
-
-uniform int drawIndex;
-uniform int objectIndex;
-
-out vec3 FragColor;
-
-void main()
-{
-	FragColor = vec3(float(objectIndex), float(drawIndex), float(gl_PrimitiveID + 1));
-}
\ No newline at end of file
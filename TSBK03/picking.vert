@@ -1,10 +0,0 @@
-#version 430 core
-
-layout (location = 0) in vec3 in_Position;
-
-uniform mat4 mvp;
-
-void main()
-{
-	gl_Position = mvp * vec4(in_Position, 1.0);
-}
\ No newline at end of file
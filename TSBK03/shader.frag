@@ -11,6 +11,26 @@
 #define MAX_LIGHTS 8
 #define NUM_CASCADES 3
 
+// Permutations define the number of lights so that the light loops have
+// constant bounds and the unused arrays go away. The base program loops up
+// to the counts uploaded as uniforms.
+#ifdef NUM_POINT_LIGHTS
+#define POINT_LIGHT_COUNT NUM_POINT_LIGHTS
+#else
+#define NUM_POINT_LIGHTS MAX_LIGHTS
+#define POINT_LIGHT_COUNT numPointLights
+#endif
+
+#ifdef NUM_DIRECTIONAL_LIGHTS
+#define DIRECTIONAL_LIGHT_COUNT NUM_DIRECTIONAL_LIGHTS
+#else
+#define NUM_DIRECTIONAL_LIGHTS MAX_LIGHTS
+#define DIRECTIONAL_LIGHT_COUNT numDirectionalLights
+#endif
+
+// The material is selected by the USE_TEXTURE, TERRAIN and SNOW permutation
+// features. The PICKING feature also writes the object IDs for picking.
+
 struct PointLight
 {
     float constant;
@@ -49,7 +69,9 @@ in vec3 bitangent;
 in vec3 fragPos;
 in vec2 texCoords;
 
-in vec4 lightSpacePos[NUM_CASCADES * MAX_LIGHTS];
+#if NUM_DIRECTIONAL_LIGHTS > 0
+in vec4 lightSpacePos[NUM_CASCADES * NUM_DIRECTIONAL_LIGHTS];
+#endif
 in float clipSpaceZ;
 
 flat in float terrainHeight;
@@ -64,29 +86,36 @@ uniform vec4 color;
 uniform sampler2D texUnit;
 
 uniform int numPointLights;
-uniform PointLight pointLight[MAX_LIGHTS];
+
+#if NUM_POINT_LIGHTS > 0
+uniform PointLight pointLight[NUM_POINT_LIGHTS];
+#endif
 
 uniform int numDirectionalLights;
-uniform DirectionalLight directionalLight[MAX_LIGHTS];
+
+#if NUM_DIRECTIONAL_LIGHTS > 0
+uniform DirectionalLight directionalLight[NUM_DIRECTIONAL_LIGHTS];
+#endif
 
 uniform vec3 viewPos;
 
 uniform vec3 celThresholds;
 
-uniform bool useTexture = true;
-
 uniform float CSMEndClipSpace[NUM_CASCADES + 1];
 
-uniform sampler2DShadow shadowMap[NUM_CASCADES * MAX_LIGHTS];
-
-uniform bool terrain = false;
-
-uniform bool snow;
+#if NUM_DIRECTIONAL_LIGHTS > 0
+uniform sampler2DShadow shadowMap[NUM_CASCADES * NUM_DIRECTIONAL_LIGHTS];
+#endif
 
 uniform vec3 tintColor;
 
 uniform float divisor;
 
+#ifdef PICKING
+uniform int objectIndex;
+uniform int drawIndex;
+#endif
+
 //=============================================================================
 // Outputs
 //=============================================================================
@@ -94,6 +123,10 @@ uniform float divisor;
 layout (location = 0) out vec4 FragColor;
 layout (location = 1) out vec4 BrightColor;
 
+#ifdef PICKING
+layout (location = 2) out uvec4 PickingID;
+#endif
+
 //=============================================================================
 // Variables
 //=============================================================================
@@ -102,6 +135,7 @@ layout (location = 1) out vec4 BrightColor;
 // Functions
 //=============================================================================
 
+#if NUM_DIRECTIONAL_LIGHTS > 0
 float calculateShadowFactor(int lightIndex, int cascadeIndex, vec4 lightSpacePos)
 {
 	// Find the UV coordinates to sample and the depth to compare with.
@@ -116,6 +150,7 @@ float calculateShadowFactor(int lightIndex, int cascadeIndex, vec4 lightSpacePos
 
 	return depth;
 }
+#endif
 
 float stepmix(float edge0, float edge1, float E, float x)
 {
@@ -187,7 +222,8 @@ vec3 calculatePointLights(Material mat)
 	// Allocate a color accumulator
 	vec3 resultColor = vec3(0, 0, 0);
 
-	for(int i = 0; i < numPointLights; ++i)
+#if NUM_POINT_LIGHTS > 0
+	for(int i = 0; i < POINT_LIGHT_COUNT; ++i)
 	{
 		// Calculate the vector from the light to the fragment position
 		vec3 lightDirection = normalize(pointLight[i].position - fragPos);
@@ -214,6 +250,7 @@ vec3 calculatePointLights(Material mat)
 		// Add the color components to the accumulator
 		resultColor += (ambientColor + diffuseColor*celIntensity.x + specularColor*celIntensity.y) * attenuation;
 	}
+#endif
 
 	return resultColor;
 }
@@ -229,7 +266,8 @@ vec3 calculateDirectionalLights(Material mat)
 	// Allocate a color accumulator
 	vec3 resultColor = vec3(0, 0, 0);
 
-	for(int i = 0; i < numDirectionalLights; ++i)
+#if NUM_DIRECTIONAL_LIGHTS > 0
+	for(int i = 0; i < DIRECTIONAL_LIGHT_COUNT; ++i)
 	{
 		// Calculate the vector from the light to the fragment position
 		vec3 lightDirection = normalize(-directionalLight[i].direction);
@@ -274,6 +312,7 @@ vec3 calculateDirectionalLights(Material mat)
 		// resultColor += vec3(shadowFactor) - cascadeIndicator;
 		resultColor += (ambientColor + (0.5 + shadowFactor * 0.5) * (diffuseColor*celIntensity.x + specularColor*celIntensity.y));
 	}
+#endif
 
 	return resultColor;
 }
@@ -298,7 +337,7 @@ void main()
 
 	Material mat;
 
-    if(useTexture)
+#if defined(USE_TEXTURE)
 	{
 		objColor = texture(texUnit, texCoords).rgb;
 
@@ -307,7 +346,7 @@ void main()
 		mat.specular = vec3(1.0, 1.0, 1.0);
 		mat.exponent = 64;
 	}
-	else if(!terrain)
+#elif !defined(TERRAIN)
 	{
 		objColor = color.xyz;
 
@@ -315,7 +354,7 @@ void main()
 
 		mat.exponent = 8;
 	}
-	else
+#else
 	{
 		objColor = color.xyz;
 
@@ -354,17 +393,17 @@ void main()
 			mat = material;
 		}
 	}
+#endif
 
 	vec3 norm = normalize(normal);
 	vec3 up = vec3(0.0, 1.0, 0.0);
 
 	// Snow
 
-	if(snow)
-	{
-		mat.ambient = mix(mat.ambient, vec3(1.0, 1.0, 1.0), smoothstep(0.0, 0.2, max(0.0, dot(norm, up))));
-		mat.diffuse = mix(mat.diffuse, vec3(1.0, 1.0, 1.0), smoothstep(0.0, 0.2, max(0.0, dot(norm, up))));
-	}
+#ifdef SNOW
+	mat.ambient = mix(mat.ambient, vec3(1.0, 1.0, 1.0), smoothstep(0.0, 0.2, max(0.0, dot(norm, up))));
+	mat.diffuse = mix(mat.diffuse, vec3(1.0, 1.0, 1.0), smoothstep(0.0, 0.2, max(0.0, dot(norm, up))));
+#endif
 
 	vec3 lightColor = calculateLight(mat);
 
@@ -384,6 +423,12 @@ void main()
 	{
 		BrightColor = vec4(0.0, 0.0, 0.0, 1.0);
 	}
+
+#ifdef PICKING
+	// Counted from zero like the CPU picking, the object ID tells whether
+	// anything was hit.
+	PickingID = uvec4(uint(objectIndex), uint(drawIndex), uint(gl_PrimitiveID), 0u);
+#endif
 }
 
 //=============================================================================
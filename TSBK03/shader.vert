@@ -11,6 +11,12 @@
 #define NUM_CASCADES 3
 #define MAX_LIGHTS 8
 
+// Permutations define the number of directional lights, the base program
+// handles up to MAX_LIGHTS of them.
+#ifndef NUM_DIRECTIONAL_LIGHTS
+#define NUM_DIRECTIONAL_LIGHTS MAX_LIGHTS
+#endif
+
 //=============================================================================
 // Input
 //=============================================================================
@@ -28,7 +34,9 @@ layout (location = 4) in vec3 in_Bitangents;
 uniform mat4 model;
 uniform mat4 mvp;
 
-uniform mat4 lightMVP[NUM_CASCADES * MAX_LIGHTS];
+#if NUM_DIRECTIONAL_LIGHTS > 0
+uniform mat4 lightMVP[NUM_CASCADES * NUM_DIRECTIONAL_LIGHTS];
+#endif
 
 //=============================================================================
 // Output 
@@ -40,7 +48,9 @@ out vec3 bitangent;
 out vec3 fragPos;
 out vec2 texCoords;
 
-out vec4 lightSpacePos[NUM_CASCADES * MAX_LIGHTS];
+#if NUM_DIRECTIONAL_LIGHTS > 0
+out vec4 lightSpacePos[NUM_CASCADES * NUM_DIRECTIONAL_LIGHTS];
+#endif
 out float clipSpaceZ;
 
 flat out float terrainHeight;
@@ -78,10 +88,12 @@ void main()
 	texCoords = in_TexCoord;
 
 	// Calculate all light space position for each light and cascade index.
-	for(int i = 0; i < NUM_CASCADES * MAX_LIGHTS; ++i)
+#if NUM_DIRECTIONAL_LIGHTS > 0
+	for(int i = 0; i < NUM_CASCADES * NUM_DIRECTIONAL_LIGHTS; ++i)
 	{
 		lightSpacePos[i] = lightMVP[i] * vec4(in_Position, 1.0);
 	}
+#endif
 
 	// Calculate the object's Z position in the clip space.
 	clipSpaceZ = gl_Position.z;
@@ -0,0 +1,156 @@
+//=============================================================================
+// Vertex Shader
+//=============================================================================
+
+#version 430 core
+
+//=============================================================================
+// Types
+//=============================================================================
+
+#define NUM_CASCADES 3
+#define MAX_LIGHTS 8
+
+// Permutations define the number of directional lights, the base program
+// handles up to MAX_LIGHTS of them.
+#ifndef NUM_DIRECTIONAL_LIGHTS
+#define NUM_DIRECTIONAL_LIGHTS MAX_LIGHTS
+#endif
+
+struct CrowdInstance
+{
+	mat4 model;
+
+	// x: Time offset in seconds
+	// y: Playback rate
+	// z: First frame of the clip in the pose texture
+	// w: Number of frames in the clip
+	vec4 animation;
+};
+
+//=============================================================================
+// Input
+//=============================================================================
+
+layout (location = 0) in vec3 in_Position;
+layout (location = 1) in vec3 in_Normal;
+layout (location = 2) in vec2 in_TexCoord;
+layout (location = 3) in vec3 in_Tangents;
+layout (location = 4) in vec3 in_Bitangents;
+layout (location = 5) in ivec4 in_IDs;
+layout (location = 6) in vec4 in_Weights;
+
+layout (std430, binding = 0) readonly buffer CrowdInstances
+{
+	CrowdInstance instances[];
+};
+
+//=============================================================================
+// Uniforms
+//=============================================================================
+
+uniform mat4 vp;
+uniform mat4 correction;
+
+uniform sampler2D poseTexture;
+uniform float sampleRate;
+uniform float time;
+
+#if NUM_DIRECTIONAL_LIGHTS > 0
+uniform mat4 lightVP[NUM_CASCADES * NUM_DIRECTIONAL_LIGHTS];
+#endif
+
+//=============================================================================
+// Output 
+//=============================================================================
+
+out vec3 normal;
+out vec3 tangent;
+out vec3 bitangent;
+out vec3 fragPos;
+out vec2 texCoords;
+
+#if NUM_DIRECTIONAL_LIGHTS > 0
+out vec4 lightSpacePos[NUM_CASCADES * NUM_DIRECTIONAL_LIGHTS];
+#endif
+out float clipSpaceZ;
+
+//=============================================================================
+// Functions
+//=============================================================================
+
+mat4 fetchBone(int bone, int frame)
+{
+	return mat4(
+		texelFetch(poseTexture, ivec2(bone * 4 + 0, frame), 0),
+		texelFetch(poseTexture, ivec2(bone * 4 + 1, frame), 0),
+		texelFetch(poseTexture, ivec2(bone * 4 + 2, frame), 0),
+		texelFetch(poseTexture, ivec2(bone * 4 + 3, frame), 0));
+}
+
+mat4 getBoneTransform(int frame)
+{
+	mat4 boneTransform = fetchBone(in_IDs[0], frame) * in_Weights[0];
+
+	boneTransform += fetchBone(in_IDs[1], frame) * in_Weights[1];
+	boneTransform += fetchBone(in_IDs[2], frame) * in_Weights[2];
+	boneTransform += fetchBone(in_IDs[3], frame) * in_Weights[3];
+
+	return boneTransform;
+}
+
+//=============================================================================
+// Main
+//=============================================================================
+
+void main()
+{
+	CrowdInstance instance = instances[gl_InstanceID];
+
+	// Find the two baked frames surrounding the current time of this instance.
+	int frameCount = int(instance.animation.w);
+	float frame = mod((time * instance.animation.y + instance.animation.x) * sampleRate, float(frameCount));
+
+	int frame0 = int(floor(frame));
+	int frame1 = (frame0 + 1) % frameCount;
+	float blend = fract(frame);
+
+	int firstFrame = int(instance.animation.z);
+
+	mat4 boneTransform =
+		getBoneTransform(firstFrame + frame0) * (1.0 - blend) +
+		getBoneTransform(firstFrame + frame1) * blend;
+
+	mat4 model = instance.model * correction;
+
+	mat3 normalMatrix = mat3(transpose(inverse(model * boneTransform)));
+
+	// Calculate the normal, tangent and bitangent in world space.
+	normal = normalMatrix * in_Normal;
+	tangent = normalMatrix * in_Tangents;
+	bitangent = normalMatrix * in_Bitangents;
+
+	vec4 worldPos = model * boneTransform * vec4(in_Position, 1.0);
+
+	// Calculate the screen-space and world-space position of the vertex.
+	gl_Position = vp * worldPos;
+	fragPos = vec3(worldPos);
+
+	// Pass the texture coordinates.
+	texCoords = in_TexCoord;
+
+	// Calculate all light space position for each light and cascade index.
+#if NUM_DIRECTIONAL_LIGHTS > 0
+	for(int i = 0; i < NUM_CASCADES * NUM_DIRECTIONAL_LIGHTS; ++i)
+	{
+		lightSpacePos[i] = lightVP[i] * worldPos;
+	}
+#endif
+
+	// Calculate the object's Z position in the clip space.
+	clipSpaceZ = gl_Position.z;
+}
+
+//=============================================================================
+// End of file
+//=============================================================================
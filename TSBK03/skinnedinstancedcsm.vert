@@ -0,0 +1,57 @@
+#version 430 core
+
+struct CrowdInstance
+{
+	mat4 model;
+	vec4 animation;
+};
+
+layout (location = 0) in vec3 in_Position;
+
+layout (location = 5) in ivec4 in_IDs;
+layout (location = 6) in vec4 in_Weights;
+
+layout (std430, binding = 0) readonly buffer CrowdInstances
+{
+	CrowdInstance instances[];
+};
+
+uniform mat4 vp;
+uniform mat4 correction;
+
+uniform sampler2D poseTexture;
+uniform float sampleRate;
+uniform float time;
+
+mat4 fetchBone(int bone, int frame)
+{
+	return mat4(
+		texelFetch(poseTexture, ivec2(bone * 4 + 0, frame), 0),
+		texelFetch(poseTexture, ivec2(bone * 4 + 1, frame), 0),
+		texelFetch(poseTexture, ivec2(bone * 4 + 2, frame), 0),
+		texelFetch(poseTexture, ivec2(bone * 4 + 3, frame), 0));
+}
+
+mat4 getBoneTransform(int frame)
+{
+	mat4 boneTransform = fetchBone(in_IDs[0], frame) * in_Weights[0];
+
+	boneTransform += fetchBone(in_IDs[1], frame) * in_Weights[1];
+	boneTransform += fetchBone(in_IDs[2], frame) * in_Weights[2];
+	boneTransform += fetchBone(in_IDs[3], frame) * in_Weights[3];
+
+	return boneTransform;
+}
+
+void main()
+{
+	CrowdInstance instance = instances[gl_InstanceID];
+
+	// Shadows do not need interpolated poses, the nearest frame is enough.
+	int frameCount = int(instance.animation.w);
+	int frame = int(mod((time * instance.animation.y + instance.animation.x) * sampleRate, float(frameCount)));
+
+	mat4 boneTransform = getBoneTransform(int(instance.animation.z) + frame);
+
+	gl_Position = vp * instance.model * correction * boneTransform * vec4(in_Position, 1.0);
+}
@@ -0,0 +1,214 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <algorithm>
+#include <stdexcept>
+
+#include "../TSBK03/AssetFileSystem.h"
+#include "../TSBK03/TGA.h"
+#include "../TSBK03/BMP.h"
+#include "../TSBK03/STBTextureFile.h"
+#include "../TSBK03/KTXFile.h"
+#include "../TSBK03/TextureCompression.h"
+
+// Compresses textures to block compressed KTX files with their full mip
+// chains. Texture2D and TextureCubeMap load the cooked file instead of the
+// image when it exists next to it.
+//
+// Usage: TextureCooker [<file | @list> ...] [-cube <posX> <negX> <posY> <negY> <posZ> <negZ>] ...
+//
+// Without arguments every image in @assets.txt is cooked. Every cooked file is
+// read back and its quality reported as the PSNR of the top level against the
+// source image.
+namespace
+{
+	bool readList(
+		const std::string &listPath,
+		std::vector<std::string> &files)
+	{
+		std::ifstream list{ listPath };
+
+		if (!list.is_open())
+		{
+			std::cerr << "[COOKER] Could not open list " << listPath << std::endl;
+			return false;
+		}
+
+		std::string line;
+
+		while (std::getline(list, line))
+		{
+			if (!line.empty() && line.back() == '\r')
+			{
+				line.pop_back();
+			}
+
+			if (line.empty() || line[0] == '#')
+			{
+				continue;
+			}
+
+			files.push_back(line);
+		}
+
+		return true;
+	}
+
+	std::string getExtension(
+		const std::string &file)
+	{
+		std::string extension = file.substr(file.find_last_of('.') + 1);
+
+		std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+
+		return extension;
+	}
+
+	bool isImage(
+		const std::string &file)
+	{
+		std::string extension = getExtension(file);
+
+		return extension == "tga" || extension == "bmp" || extension == "png" || extension == "jpg";
+	}
+
+	// Decodes the image the same way Texture2D::decode does.
+	TextureFile *openImage(
+		const std::string &file)
+	{
+		std::string extension = getExtension(file);
+
+		if (extension == "tga")
+		{
+			return new TGA{ file.c_str() };
+		}
+		else if (extension == "bmp")
+		{
+			return new BMP{ file.c_str() };
+		}
+		else if (extension == "png" || extension == "jpg")
+		{
+			return new STBTextureFile{ file };
+		}
+
+		throw std::invalid_argument("File (" + file + ") is not a supported image.");
+	}
+
+	size_t getFileSize(
+		const std::string &file)
+	{
+		return AssetFileSystem::open(file).getSize();
+	}
+
+	// Cooks one texture, or a cube map if there are six files.
+	bool cook(
+		const std::vector<std::string> &files,
+		const std::string &destination)
+	{
+		try
+		{
+			auto start = std::chrono::steady_clock::now();
+
+			std::vector<std::unique_ptr<TextureFile>> images;
+			std::vector<const TextureFile *> faces;
+
+			for (const std::string &file : files)
+			{
+				images.emplace_back(openImage(file));
+				faces.push_back(images.back().get());
+			}
+
+			double psnr = cookCompressedTexture(faces.data(), faces.size(), destination);
+
+			auto end = std::chrono::steady_clock::now();
+
+			// Read it back the way the engine does, which also validates it.
+			KTXFile cooked{ destination };
+
+			size_t sourceSize = 0;
+
+			for (const TextureFile *face : faces)
+			{
+				sourceSize += face->getPixelsSize();
+			}
+
+			std::cout << "[COOKER] " << files[0] << " -> " << destination
+				<< std::fixed << std::setprecision(2)
+				<< " (" << cooked.getWidth() << "x" << cooked.getHeight()
+				<< ", " << cooked.getNumLevels() << " levels, "
+				<< psnr << " dB, "
+				<< std::chrono::duration<double, std::milli>(end - start).count() << " ms, "
+				<< static_cast<double>(sourceSize) / cooked.getImageSize(0) / cooked.getNumFaces() << "x smaller, "
+				<< getFileSize(destination) << " bytes)" << std::endl;
+
+			return true;
+		}
+		catch (const std::exception &exception)
+		{
+			std::cerr << "[COOKER] " << exception.what() << std::endl;
+			return false;
+		}
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	std::vector<std::string> files;
+	std::vector<std::vector<std::string>> cubeMaps;
+
+	for (int argument = 1; argument < argc; ++argument)
+	{
+		std::string option{ argv[argument] };
+
+		if (option == "-cube" && argument + 6 < argc)
+		{
+			cubeMaps.emplace_back(argv + argument + 1, argv + argument + 7);
+			argument += 6;
+		}
+		else if (option[0] == '@')
+		{
+			if (!readList(option.substr(1), files))
+			{
+				return 1;
+			}
+		}
+		else if (option[0] == '-')
+		{
+			std::cerr << "Usage: " << argv[0] << " [<file | @list> ...] [-cube <posX> <negX> <posY> <negY> <posZ> <negZ>] ..." << std::endl;
+			return 1;
+		}
+		else
+		{
+			files.push_back(option);
+		}
+	}
+
+	if (files.empty() && cubeMaps.empty() && !readList("assets.txt", files))
+	{
+		return 1;
+	}
+
+	bool succeeded = true;
+
+	for (const std::string &file : files)
+	{
+		// Lists contain every asset, only the images are cooked.
+		if (!isImage(file))
+		{
+			continue;
+		}
+
+		succeeded &= cook({ file }, getCookedTextureFileName(file));
+	}
+
+	for (const std::vector<std::string> &cubeMap : cubeMaps)
+	{
+		succeeded &= cook(cubeMap, getCookedCubeMapFileName(cubeMap[0]));
+	}
+
+	return succeeded ? 0 : 1;
+}